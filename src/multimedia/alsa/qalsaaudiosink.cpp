@@ -17,8 +17,12 @@
 #include <QtMultimedia/private/qaudiohelpers_p.h>
 #include "qalsaaudiosink_p.h"
 #include "qalsaaudiodevice_p.h"
+#include "qalsahelpers_p.h"
 #include <QLoggingCategory>
 
+#include <pthread.h>
+#include <sched.h>
+
 QT_BEGIN_NAMESPACE
 
 static Q_LOGGING_CATEGORY(lcAlsaOutput, "qt.multimedia.alsa.output")
@@ -73,6 +77,7 @@ int QAlsaAudioSink::xrun_recovery(int err)
 #endif
 
     if(err == -EPIPE) {
+        ++m_xrunCount;
         errorState = QAudio::UnderrunError;
         emit errorChanged(errorState);
         err = snd_pcm_prepare(handle);
@@ -197,6 +202,35 @@ QIODevice* QAlsaAudioSink::start()
     return audioSource;
 }
 
+bool QAlsaAudioSink::start(AudioCallback &&callback)
+{
+    if(deviceState != QAudio::StoppedState)
+        deviceState = QAudio::StoppedState;
+
+    errorState = QAudio::NoError;
+
+    // Handle change of mode
+    if(audioSource && !pullMode) {
+        delete audioSource;
+        audioSource = 0;
+    }
+
+    close();
+
+    pullMode = true;
+    m_audioCallback = std::move(callback);
+    deviceState = QAudio::ActiveState;
+
+    if (open())
+        startRendering();
+    else
+        m_audioCallback = {};
+
+    emit stateChanged(deviceState);
+
+    return true;
+}
+
 void QAlsaAudioSink::stop()
 {
     if(deviceState == QAudio::StoppedState)
@@ -217,6 +251,7 @@ bool QAlsaAudioSink::open()
     qDebug()<<now.second()<<"s "<<now.msec()<<"ms :open()";
 #endif
     elapsedTimeOffset = 0;
+    m_volumeRamp.reset();
 
     int dir;
     int err = 0;
@@ -260,6 +295,17 @@ bool QAlsaAudioSink::open()
     QString errMessage;
     unsigned int chunks = 8;
 
+    // the render thread of the callback mode is woken up by the device, and keeps
+    // up with short periods; the timer of the other modes needs longer ones
+    if (m_audioCallback) {
+        period_time = 5000;
+        chunks = 4;
+        buffer_time = period_time * chunks;
+    } else {
+        period_time = 20000;
+        buffer_time = 100000;
+    }
+
     err = snd_pcm_hw_params_any( handle, hwparams );
     if ( err < 0 ) {
         fatal = true;
@@ -273,7 +319,15 @@ bool QAlsaAudioSink::open()
         }
     }
     if ( !fatal ) {
+        // QT_ALSA_MMAP transfers the samples directly to the ring buffer of the device
+        const bool mmap = qEnvironmentVariableIntValue("QT_ALSA_MMAP");
+        access = mmap ? SND_PCM_ACCESS_MMAP_INTERLEAVED : SND_PCM_ACCESS_RW_INTERLEAVED;
         err = snd_pcm_hw_params_set_access( handle, hwparams, access );
+        if ( err < 0 && mmap ) {
+            qCDebug(lcAlsaOutput) << "mmap access is not supported by the device";
+            access = SND_PCM_ACCESS_RW_INTERLEAVED;
+            err = snd_pcm_hw_params_set_access( handle, hwparams, access );
+        }
         if ( err < 0 ) {
             fatal = true;
             errMessage = QString::fromLatin1("QAudioSink: snd_pcm_hw_params_set_access: err = %1").arg(err);
@@ -391,13 +445,17 @@ bool QAlsaAudioSink::open()
     if(audioBuffer == 0)
         audioBuffer = new char[snd_pcm_frames_to_bytes(handle,buffer_frames)];
     snd_pcm_prepare( handle );
-    snd_pcm_start(handle);
+
+    // In the callback mode, the start threshold starts the device once the first period is written
+    if (!m_audioCallback)
+        snd_pcm_start(handle);
 
     // Step 5: Setup timer
     bytesAvailable = bytesFree();
 
     // Step 6: Start audio processing
-    timer->start(period_time/1000);
+    if (!m_audioCallback)
+        timer->start(period_time/1000);
 
     elapsedTimeOffset = 0;
     errorState  = QAudio::NoError;
@@ -410,6 +468,8 @@ bool QAlsaAudioSink::open()
 void QAlsaAudioSink::close()
 {
     timer->stop();
+    stopRendering();
+    m_audioCallback = {};
 
     if ( handle ) {
         snd_pcm_drain( handle );
@@ -436,6 +496,7 @@ qsizetype QAlsaAudioSink::bytesFree() const
     int frames = snd_pcm_avail_update(handle);
     if (frames == -EPIPE) {
         // Try and handle buffer underrun
+        ++m_xrunCount;
         int err = snd_pcm_recover(handle, frames, 0);
         if (err < 0)
             return 0;
@@ -471,9 +532,11 @@ qint64 QAlsaAudioSink::write( const char *data, qint64 len )
 
     frames = snd_pcm_bytes_to_frames(handle, space);
 
-    if (m_volume < 1.0f) {
+    if (access == SND_PCM_ACCESS_MMAP_INTERLEAVED) {
+        err = writeMmap(data, frames);
+    } else if (const qreal volume = m_volume; m_volumeRamp.changesSamples(volume)) {
         QVarLengthArray<char, 4096> out(space);
-        QAudioHelperInternal::qMultiplySamples(m_volume, settings, data, out.data(), space);
+        m_volumeRamp.apply(volume, settings, data, out.data(), space);
         err = snd_pcm_writei(handle, out.constData(), frames);
     } else {
         err = snd_pcm_writei(handle, data, frames);
@@ -527,9 +590,11 @@ void QAlsaAudioSink::resume()
             if(err < 0)
                 xrun_recovery(err);
 
-            err = snd_pcm_start(handle);
-            if(err < 0)
-                xrun_recovery(err);
+            if (!m_audioCallback) {
+                err = snd_pcm_start(handle);
+                if(err < 0)
+                    xrun_recovery(err);
+            }
 
             bytesAvailable = (int)snd_pcm_frames_to_bytes(handle, buffer_frames);
         }
@@ -537,7 +602,10 @@ void QAlsaAudioSink::resume()
 
         deviceState = suspendedInState;
         errorState = QAudio::NoError;
-        timer->start(period_time/1000);
+        if (m_audioCallback)
+            startRendering();
+        else
+            timer->start(period_time/1000);
         emit stateChanged(deviceState);
     }
 }
@@ -556,6 +624,7 @@ void QAlsaAudioSink::suspend()
 {
     if(deviceState == QAudio::ActiveState || deviceState == QAudio::IdleState || resuming) {
         suspendedInState = deviceState;
+        stopRendering();
         snd_pcm_drain(handle);
         timer->stop();
         deviceState = QAudio::SuspendedState;
@@ -650,6 +719,156 @@ bool QAlsaAudioSink::deviceReady()
     return true;
 }
 
+void QAlsaAudioSink::startRendering()
+{
+    m_renderStopped = false;
+    m_renderThread.reset(QThread::create([this] { render(); }));
+    m_renderThread->setObjectName(QStringLiteral("QAlsaAudioSink"));
+    m_renderThread->start(QThread::TimeCriticalPriority);
+}
+
+void QAlsaAudioSink::stopRendering()
+{
+    if (!m_renderThread)
+        return;
+
+    // the render thread checks the flag at least once per buffer time
+    m_renderStopped = true;
+    m_renderThread->wait();
+    m_renderThread.reset();
+}
+
+void QAlsaAudioSink::render()
+{
+    sched_param param = {};
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+    if (pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) != 0)
+        qCDebug(lcAlsaOutput) << "Rendering without real-time priority";
+
+    const int waitTimeout = qMax(int(buffer_time / 1000), 1);
+
+    auto fail = [this] {
+        QMetaObject::invokeMethod(this, [this] {
+            if (deviceState == QAudio::StoppedState)
+                return;
+            close();
+            errorState = QAudio::FatalError;
+            emit errorChanged(errorState);
+            deviceState = QAudio::StoppedState;
+            emit stateChanged(deviceState);
+        }, Qt::QueuedConnection);
+    };
+
+    while (!m_renderStopped.load(std::memory_order_relaxed)) {
+        const snd_pcm_sframes_t avail = snd_pcm_avail_update(handle);
+        if (avail < 0) {
+            if (recover(int(avail)) < 0)
+                return fail();
+            continue;
+        }
+
+        if (snd_pcm_uframes_t(avail) < period_frames) {
+            // wait until the device has consumed a period
+            const int err = snd_pcm_wait(handle, waitTimeout);
+            if (err < 0 && recover(err) < 0)
+                return fail();
+            continue;
+        }
+
+        if (access == SND_PCM_ACCESS_MMAP_INTERLEAVED) {
+            const snd_pcm_sframes_t rendered = renderMmap();
+            if (rendered < 0 && recover(int(rendered)) < 0)
+                return fail();
+            if (rendered > 0)
+                totalTimeValue += rendered;
+            continue;
+        }
+
+        m_audioCallback(QSpan<char>(audioBuffer, period_size));
+
+        m_volumeRamp.apply(m_volume, settings, audioBuffer, audioBuffer, period_size);
+
+        for (snd_pcm_uframes_t written = 0; written < period_frames;) {
+            const snd_pcm_sframes_t result =
+                    snd_pcm_writei(handle, audioBuffer + snd_pcm_frames_to_bytes(handle, written),
+                                   period_frames - written);
+            if (result >= 0)
+                written += result;
+            else if (recover(int(result)) < 0)
+                return fail();
+        }
+
+        totalTimeValue += period_frames;
+    }
+}
+
+snd_pcm_sframes_t QAlsaAudioSink::renderMmap()
+{
+    // a period can wrap around the end of the ring buffer, and is rendered in two parts then
+    snd_pcm_uframes_t rendered = 0;
+    while (rendered < period_frames) {
+        const snd_pcm_channel_area_t *areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t frames = period_frames - rendered;
+        const int err = snd_pcm_mmap_begin(handle, &areas, &offset, &frames);
+        if (err < 0)
+            return err;
+        if (frames == 0)
+            break;
+
+        char *data = QAlsaInternal::mmapAddress(areas, offset);
+        const int bytes = snd_pcm_frames_to_bytes(handle, frames);
+        m_audioCallback(QSpan<char>(data, bytes));
+
+        m_volumeRamp.apply(m_volume, settings, data, data, bytes);
+
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(handle, offset, frames);
+        if (committed < 0)
+            return committed;
+        rendered += committed;
+        if (snd_pcm_uframes_t(committed) != frames)
+            break;
+    }
+    return rendered;
+}
+
+snd_pcm_sframes_t QAlsaAudioSink::writeMmap(const char *data, snd_pcm_uframes_t frames)
+{
+    snd_pcm_uframes_t written = 0;
+    while (written < frames) {
+        const snd_pcm_channel_area_t *areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t count = frames - written;
+        const int err = snd_pcm_mmap_begin(handle, &areas, &offset, &count);
+        if (err < 0)
+            return written ? snd_pcm_sframes_t(written) : err;
+        if (count == 0)
+            break;
+
+        // the volume is applied while copying to the ring buffer
+        const char *source = data + snd_pcm_frames_to_bytes(handle, written);
+        char *dest = QAlsaInternal::mmapAddress(areas, offset);
+        const int bytes = snd_pcm_frames_to_bytes(handle, count);
+        m_volumeRamp.apply(m_volume, settings, source, dest, bytes);
+
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(handle, offset, count);
+        if (committed < 0)
+            return written ? snd_pcm_sframes_t(written) : committed;
+        written += committed;
+        if (snd_pcm_uframes_t(committed) != count)
+            break;
+    }
+    return written;
+}
+
+int QAlsaAudioSink::recover(int err)
+{
+    // called in the render thread, so the error is not reported
+    if (err == -EPIPE)
+        ++m_xrunCount;
+    return snd_pcm_recover(handle, err, 1);
+}
+
 void QAlsaAudioSink::reset()
 {
     if(handle)
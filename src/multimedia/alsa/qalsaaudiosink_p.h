@@ -24,14 +24,19 @@
 #include <QtCore/qstringlist.h>
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/qiodevice.h>
+#include <QtCore/qthread.h>
 
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudiodevice.h>
 #include <private/qaudiosystem_p.h>
+#include <private/qaudiohelpers_p.h>
+
+#include <atomic>
+#include <memory>
 
 QT_BEGIN_NAMESPACE
 
-class QAlsaAudioSink : public QPlatformAudioSink
+class Q_AUTOTEST_EXPORT QAlsaAudioSink : public QPlatformAudioSink
 {
     friend class AlsaOutputPrivate;
     Q_OBJECT
@@ -43,6 +48,7 @@ public:
 
     void start(QIODevice* device) override;
     QIODevice* start() override;
+    bool start(AudioCallback &&callback) override;
     void stop() override;
     void reset() override;
     void suspend() override;
@@ -58,6 +64,8 @@ public:
     void setVolume(qreal) override;
     qreal volume() const override;
 
+    // the number of underruns since the sink was created
+    int xrunCount() const { return m_xrunCount; }
 
     QIODevice* audioSource = nullptr;
     QAudioFormat settings;
@@ -78,7 +86,7 @@ private:
     bool resuming = false;
     int buffer_size = 0;
     int period_size = 0;
-    qint64 totalTimeValue = 0;
+    std::atomic<qint64> totalTimeValue = 0;
     unsigned int buffer_time = 100000;
     unsigned int period_time = 20000;
     snd_pcm_uframes_t buffer_frames;
@@ -89,6 +97,14 @@ private:
     bool open();
     void close();
 
+    // the callback mode renders in a thread of its own
+    void startRendering();
+    void stopRendering();
+    void render();
+    snd_pcm_sframes_t renderMmap();
+    snd_pcm_sframes_t writeMmap(const char *data, snd_pcm_uframes_t frames);
+    int recover(int err);
+
     QTimer* timer = nullptr;
     QByteArray m_device;
     int bytesAvailable = 0;
@@ -98,7 +114,13 @@ private:
     snd_pcm_access_t access = SND_PCM_ACCESS_RW_INTERLEAVED;
     snd_pcm_format_t pcmformat = SND_PCM_FORMAT_S16;
     snd_pcm_hw_params_t *hwparams = nullptr;
-    qreal m_volume = 1.0f;
+    std::atomic<qreal> m_volume = 1.0f;
+    QAudioHelperInternal::VolumeRamp m_volumeRamp;
+
+    AudioCallback m_audioCallback;
+    std::unique_ptr<QThread> m_renderThread;
+    std::atomic<bool> m_renderStopped = false;
+    std::atomic<int> m_xrunCount = 0;
 };
 
 class AlsaOutputPrivate : public QIODevice
@@ -17,6 +17,7 @@
 #include <QtMultimedia/private/qaudiohelpers_p.h>
 #include "qalsaaudiosource_p.h"
 #include "qalsaaudiodevice_p.h"
+#include "qalsahelpers_p.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -41,6 +42,7 @@ QAlsaAudioSource::QAlsaAudioSource(const QByteArray &device, QObject *parent)
     resuming = false;
 
     m_volume = 1.0f;
+    m_xrunCount = 0;
 
     m_device = device;
 
@@ -99,6 +101,7 @@ int QAlsaAudioSource::xrun_recovery(int err)
 #endif
 
     if(err == -EPIPE) {
+        ++m_xrunCount;
         errorState = QAudio::UnderrunError;
         err = snd_pcm_prepare(handle);
         if(err < 0)
@@ -283,7 +286,14 @@ bool QAlsaAudioSource::open()
         }
     }
     if ( !fatal ) {
+        // QT_ALSA_MMAP transfers the samples directly from the ring buffer of the device
+        const bool mmap = qEnvironmentVariableIntValue("QT_ALSA_MMAP");
+        access = mmap ? SND_PCM_ACCESS_MMAP_INTERLEAVED : SND_PCM_ACCESS_RW_INTERLEAVED;
         err = snd_pcm_hw_params_set_access( handle, hwparams, access );
+        if ( err < 0 && mmap ) {
+            access = SND_PCM_ACCESS_RW_INTERLEAVED;
+            err = snd_pcm_hw_params_set_access( handle, hwparams, access );
+        }
         if ( err < 0 ) {
             fatal = true;
             errMessage = QString::fromLatin1("QAudioSource: snd_pcm_hw_params_set_access: err = %1").arg(err);
@@ -419,6 +429,43 @@ qsizetype QAlsaAudioSource::bytesReady() const
     return qMax(bytesAvailable, 0);
 }
 
+int QAlsaAudioSource::readMmap(snd_pcm_uframes_t frames)
+{
+    // unlike snd_pcm_readi(), the mmap transfer doesn't restart the stream after an overrun
+    if (snd_pcm_state(handle) == SND_PCM_STATE_PREPARED) {
+        const int err = snd_pcm_start(handle);
+        if (err < 0)
+            return err;
+    }
+
+    snd_pcm_uframes_t read = 0;
+    while (read < frames) {
+        const snd_pcm_channel_area_t *areas = nullptr;
+        snd_pcm_uframes_t offset = 0;
+        snd_pcm_uframes_t count = frames - read;
+        const int err = snd_pcm_mmap_begin(handle, &areas, &offset, &count);
+        if (err < 0)
+            return read ? int(read) : err;
+        if (count == 0)
+            break;
+
+        // the volume is applied in place, the area is released by the commit anyway
+        char *data = QAlsaInternal::mmapAddress(areas, offset);
+        const int bytes = snd_pcm_frames_to_bytes(handle, count);
+        if (m_volume < 1.0f)
+            QAudioHelperInternal::qMultiplySamples(m_volume, settings, data, data, bytes);
+        ringBuffer.write(data, bytes);
+
+        const snd_pcm_sframes_t committed = snd_pcm_mmap_commit(handle, offset, count);
+        if (committed < 0)
+            return read ? int(read) : int(committed);
+        read += committed;
+        if (snd_pcm_uframes_t(committed) != count)
+            break;
+    }
+    return int(read);
+}
+
 qint64 QAlsaAudioSource::read(char* data, qint64 len)
 {
     // Read in some audio data and write it to QIODevice, pull mode
@@ -453,22 +500,31 @@ qint64 QAlsaAudioSource::read(char* data, qint64 len)
 
         int count=0;
         int err = 0;
-        QVarLengthArray<char, 4096> buffer(bytesToRead);
+        const bool mmap = access == SND_PCM_ACCESS_MMAP_INTERLEAVED;
+        QVarLengthArray<char, 4096> buffer(mmap ? 0 : bytesToRead);
         while(count < 5 && bytesToRead > 0) {
             int chunks = bytesToRead / period_size;
             int frames = chunks * period_frames;
             if (frames > (int)buffer_frames)
                 frames = buffer_frames;
 
-            int readFrames = snd_pcm_readi(handle, buffer.data(), frames);
-            bytesRead = snd_pcm_frames_to_bytes(handle, readFrames);
-            if (m_volume < 1.0f)
-                QAudioHelperInternal::qMultiplySamples(m_volume, settings,
-                                                       buffer.constData(),
-                                                       buffer.data(), bytesRead);
+            int readFrames = 0;
+            if (mmap) {
+                // readMmap() writes to the ring buffer directly
+                readFrames = readMmap(frames);
+                bytesRead = snd_pcm_frames_to_bytes(handle, readFrames);
+            } else {
+                readFrames = snd_pcm_readi(handle, buffer.data(), frames);
+                bytesRead = snd_pcm_frames_to_bytes(handle, readFrames);
+                if (m_volume < 1.0f)
+                    QAudioHelperInternal::qMultiplySamples(m_volume, settings,
+                                                           buffer.constData(),
+                                                           buffer.data(), bytesRead);
+            }
 
             if (readFrames >= 0) {
-                ringBuffer.write(buffer.data(), bytesRead);
+                if (!mmap)
+                    ringBuffer.write(buffer.data(), bytesRead);
 #ifdef DEBUG_AUDIO
                 qDebug() << QString::fromLatin1("read in bytes = %1 (frames=%2)").arg(bytesRead).arg(readFrames).toLatin1().constData();
 #endif
@@ -479,6 +535,7 @@ qint64 QAlsaAudioSource::read(char* data, qint64 len)
                 break;
             } else {
                 if(readFrames == -EPIPE) {
+                    ++m_xrunCount;
                     errorState = QAudio::UnderrunError;
                     err = snd_pcm_prepare(handle);
 #ifdef ESTRPIPE
@@ -58,7 +58,7 @@ private:
     QByteArray m_data;
 };
 
-class QAlsaAudioSource : public QPlatformAudioSource
+class Q_AUTOTEST_EXPORT QAlsaAudioSource : public QPlatformAudioSource
 {
     Q_OBJECT
 public:
@@ -83,6 +83,10 @@ public:
     QAudioFormat format() const override;
     void setVolume(qreal) override;
     qreal volume() const override;
+
+    // the number of overruns since the source was created
+    int xrunCount() const { return m_xrunCount; }
+
     bool resuming;
     snd_pcm_t* handle;
     qint64 totalTimeValue;
@@ -98,6 +102,7 @@ private slots:
 private:
     int checkBytesReady();
     int xrun_recovery(int err);
+    int readMmap(snd_pcm_uframes_t frames);
     int setFormat();
     bool open();
     void close();
@@ -119,6 +124,7 @@ private:
     snd_pcm_format_t pcmformat;
     snd_pcm_hw_params_t *hwparams;
     qreal m_volume;
+    int m_xrunCount;
 };
 
 class AlsaInputPrivate : public QIODevice
@@ -0,0 +1,35 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QALSAHELPERS_P_H
+#define QALSAHELPERS_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API.  It exists purely as an
+// implementation detail.  This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtCore/qglobal.h>
+#include <alsa/asoundlib.h>
+
+QT_BEGIN_NAMESPACE
+
+namespace QAlsaInternal {
+
+// Returns the address of the first frame of an interleaved mmap area
+inline char *mmapAddress(const snd_pcm_channel_area_t *areas, snd_pcm_uframes_t offset)
+{
+    return static_cast<char *>(areas[0].addr) + (areas[0].first + offset * areas[0].step) / 8;
+}
+
+} // namespace QAlsaInternal
+
+QT_END_NAMESPACE
+
+#endif // QALSAHELPERS_P_H
@@ -113,6 +113,7 @@ void QAudioDecoder::start()
 
     // Reset error conditions
     decoder->clearError();
+    decoder->discardRemainingFrames();
     decoder->start();
 }
 
@@ -121,8 +122,11 @@ void QAudioDecoder::start()
 */
 void QAudioDecoder::stop()
 {
-    if (decoder)
-        decoder->stop();
+    if (!decoder)
+        return;
+
+    decoder->discardRemainingFrames();
+    decoder->stop();
 }
 
 /*!
@@ -150,6 +154,7 @@ void QAudioDecoder::setSource(const QUrl &fileName)
         return;
 
     decoder->clearError();
+    decoder->discardRemainingFrames();
     decoder->setSource(fileName);
 }
 
@@ -173,8 +178,11 @@ QIODevice *QAudioDecoder::sourceDevice() const
 */
 void QAudioDecoder::setSourceDevice(QIODevice *device)
 {
-    if (decoder)
-        decoder->setSourceDevice(device);
+    if (!decoder)
+        return;
+
+    decoder->discardRemainingFrames();
+    decoder->setSourceDevice(device);
 }
 
 /*!
@@ -226,7 +234,7 @@ void QAudioDecoder::setAudioFormat(const QAudioFormat &format)
 */
 bool QAudioDecoder::bufferAvailable() const
 {
-    return decoder && decoder->bufferAvailable();
+    return decoder && (decoder->hasRemainingFrames() || decoder->bufferAvailable());
 }
 
 /*!
@@ -249,6 +257,66 @@ qint64 QAudioDecoder::duration() const
     return decoder ? decoder->duration() : -1;
 }
 
+/*!
+    \since 6.8
+
+    Sets the \a position, in milliseconds, from which the audio is decoded.
+
+    If the decoder is decoding, it discards the buffers that haven't been read
+    yet and continues decoding from \a position. Otherwise, \a position applies
+    to the subsequent calls of start(). Decoding starts from the key frame
+    preceding \a position; the audio before \a position is discarded, so the
+    first buffer starts at \a position.
+
+    \note Seeking is supported by the FFmpeg backend only.
+
+    \sa setEndPosition(), position()
+*/
+void QAudioDecoder::setPosition(qint64 position)
+{
+    if (decoder)
+        decoder->setPosition(qMax(position, 0ll));
+}
+
+/*!
+    \since 6.8
+
+    Returns the position, in milliseconds, at which decoding finishes,
+    or -1 if the audio is decoded until the end of the source.
+
+    \sa setEndPosition()
+*/
+qint64 QAudioDecoder::endPosition() const
+{
+    return decoder ? decoder->endPosition() : -1;
+}
+
+/*!
+    \since 6.8
+
+    Sets the \a position, in milliseconds, at which decoding finishes. The last
+    buffer is cut at \a position, and finished() is emitted once it has been
+    read. Pass -1 to decode until the end of the source.
+
+    Together with setPosition(), it allows decoding the range
+    [position, endPosition) of a source:
+
+    \code
+    decoder.setPosition(50 * 60 * 1000);
+    decoder.setEndPosition(50 * 60 * 1000 + 5000);
+    decoder.start();
+    \endcode
+
+    \note Range decoding is supported by the FFmpeg backend only.
+
+    \sa endPosition(), setPosition()
+*/
+void QAudioDecoder::setEndPosition(qint64 position)
+{
+    if (decoder)
+        decoder->setEndPosition(position < 0 ? -1 : position);
+}
+
 /*!
     Read a buffer from the decoder, if one is available. Returns an invalid buffer
     if there are no decoded buffers currently available, or on failure.  In both cases
@@ -261,7 +329,62 @@ qint64 QAudioDecoder::duration() const
 
 QAudioBuffer QAudioDecoder::read() const
 {
-    return decoder ? decoder->read() : QAudioBuffer{};
+    if (!decoder)
+        return {};
+
+    // the rest of a buffer that read(qint64) has split goes first
+    return decoder->hasRemainingFrames() ? decoder->takeRemainingFrames() : decoder->read();
+}
+
+/*!
+    \since 6.8
+
+    Reads up to \a maxFrames frames of the decoded audio as one contiguous
+    buffer. Returns an invalid buffer if there are no decoded buffers currently
+    available, or on failure. This function doesn't block.
+
+    This reduces the overhead of reading a source buffer by buffer, for
+    example, when the whole source is decoded for analysis.
+
+    The FFmpeg backend decodes a number of buffers ahead of the reader, and
+    merges them into the returned buffer. Other backends return the frames of
+    the next decoded buffer only; if it holds more than \a maxFrames frames,
+    the rest of it is returned by the next read.
+
+    \sa waitForBufferAvailable()
+*/
+QAudioBuffer QAudioDecoder::read(qint64 maxFrames) const
+{
+    return decoder && maxFrames > 0 ? decoder->readFrames(maxFrames) : QAudioBuffer{};
+}
+
+/*!
+    \since 6.8
+
+    Blocks until a decoded buffer is available to be read, the decoding
+    finishes or fails, or the \a deadline expires. Returns \c true if a buffer
+    is available.
+
+    Together with read(), it allows decoding synchronously. With the FFmpeg
+    backend, this doesn't require an event loop, so a source can be decoded
+    as fast as possible from a worker thread:
+
+    \code
+    QAudioDecoder decoder;
+    decoder.setSource(url);
+    decoder.start();
+    while (decoder.waitForBufferAvailable())
+        process(decoder.read(4096));
+    \endcode
+
+    Other backends run a local event loop while waiting.
+
+    \sa bufferReady(), read()
+*/
+bool QAudioDecoder::waitForBufferAvailable(QDeadlineTimer deadline)
+{
+    return decoder
+            && (decoder->hasRemainingFrames() || decoder->waitForBufferAvailable(deadline));
 }
 
 // Enums
@@ -5,6 +5,7 @@
 #define QAUDIODECODER_H
 
 #include <QtCore/qobject.h>
+#include <QtCore/qdeadlinetimer.h>
 #include <QtMultimedia/qmediaenumdebug.h>
 
 #include <QtMultimedia/qaudiobuffer.h>
@@ -50,15 +51,23 @@ public:
     QString errorString() const;
 
     QAudioBuffer read() const;
+    QAudioBuffer read(qint64 maxFrames) const;
     bool bufferAvailable() const;
 
+    bool waitForBufferAvailable(QDeadlineTimer deadline = QDeadlineTimer(QDeadlineTimer::Forever));
+
     qint64 position() const;
     qint64 duration() const;
 
+    qint64 endPosition() const;
+    void setEndPosition(qint64 position);
+
 public Q_SLOTS:
     void start();
     void stop();
 
+    void setPosition(qint64 position);
+
 Q_SIGNALS:
     void bufferAvailableChanged(bool);
     void bufferReady();
@@ -4,60 +4,295 @@
 #include "qaudiohelpers_p.h"
 
 #include <QDebug>
+#include <private/qsimd_p.h>
+
+#include <cstring>
+#include <mutex>
+#include <type_traits>
 
 QT_BEGIN_NAMESPACE
 
 namespace QAudioHelperInternal
 {
 
-template<class T> void adjustSamples(qreal factor, const void *src, void *dst, int samples)
+namespace {
+
+// Int32 samples are scaled in double precision, as a float cannot hold them
+template <typename T>
+using Factor = std::conditional_t<std::is_same_v<T, qint32>, double, float>;
+
+template <typename T>
+using MultiplyFunc = void (QT_FASTCALL *)(Factor<T> factor, const T *src, T *dst, int samples);
+template <typename T>
+using ToFloatFunc = void (QT_FASTCALL *)(Factor<T> scale, const T *src, float *dst, int samples);
+template <typename T>
+using FromFloatFunc = void (QT_FASTCALL *)(Factor<T> scale, const float *src, T *dst, int samples);
+using UnpackInt24Func = void (QT_FASTCALL *)(const quint8 *src, qint32 *dst, int samples);
+
+// the range of the integer formats, used as the scale of the float conversions
+template <typename T>
+constexpr double FloatRange = 1.;
+template <>
+constexpr double FloatRange<quint8> = 128.;
+template <>
+constexpr double FloatRange<qint16> = 32768.;
+template <>
+constexpr double FloatRange<qint32> = 2147483648.;
+
+template <typename T>
+void QT_FASTCALL multiplySamples(Factor<T> factor, const T *src, T *dst, int samples)
+{
+    for (int i = 0; i < samples; ++i)
+        dst[i] = Scalar::multiply(src[i], factor);
+}
+
+template <typename T>
+void QT_FASTCALL convertToFloat(Factor<T> scale, const T *src, float *dst, int samples)
+{
+    for (int i = 0; i < samples; ++i)
+        dst[i] = Scalar::toFloat(src[i], scale);
+}
+
+template <typename T>
+void QT_FASTCALL convertFromFloat(Factor<T> scale, const float *src, T *dst, int samples)
 {
-    const T *pSrc = (const T *)src;
-    T *pDst = (T*)dst;
-    for ( int i = 0; i < samples; i++ )
-        pDst[i] = pSrc[i] * factor;
+    for (int i = 0; i < samples; ++i)
+        Scalar::fromFloat(src[i], scale, dst[i]);
 }
 
-// Unsigned samples are biased around 0x80/0x8000 :/
-// This makes a pure template solution a bit unwieldy but possible
-template<class T> struct signedVersion {};
-template<> struct signedVersion<quint8>
+void QT_FASTCALL unpackInt24(const quint8 *src, qint32 *dst, int samples)
 {
-    using TS = qint8;
-    static constexpr int offset = 0x80;
-};
+    for (int i = 0; i < samples; ++i, src += 3)
+        dst[i] = Scalar::unpackInt24(src);
+}
+
+template <typename T>
+void rampSamples(double startFactor, double step, int channelCount, const T *src, T *dst,
+                 int frames)
+{
+    // the factor of the last frame is the end factor, so the next buffer continues from it
+    for (int frame = 0; frame < frames; ++frame) {
+        const auto factor = Factor<T>(startFactor + step * (frame + 1));
+        for (int channel = 0; channel < channelCount; ++channel, ++src, ++dst)
+            *dst = Scalar::multiply(*src, factor);
+    }
+}
+
+} // namespace
+
+static MultiplyFunc<quint8> qMultiplyUInt8 = multiplySamples<quint8>;
+static MultiplyFunc<qint16> qMultiplyInt16 = multiplySamples<qint16>;
+static MultiplyFunc<qint32> qMultiplyInt32 = multiplySamples<qint32>;
+static MultiplyFunc<float> qMultiplyFloat = multiplySamples<float>;
+
+static ToFloatFunc<quint8> qConvertUInt8ToFloat = convertToFloat<quint8>;
+static ToFloatFunc<qint16> qConvertInt16ToFloat = convertToFloat<qint16>;
+static ToFloatFunc<qint32> qConvertInt32ToFloat = convertToFloat<qint32>;
+
+static FromFloatFunc<quint8> qConvertFloatToUInt8 = convertFromFloat<quint8>;
+static FromFloatFunc<qint16> qConvertFloatToInt16 = convertFromFloat<qint16>;
+static FromFloatFunc<qint32> qConvertFloatToInt32 = convertFromFloat<qint32>;
+
+static UnpackInt24Func qUnpackInt24Func = unpackInt24;
 
-template<class T> void adjustUnsignedSamples(qreal factor, const void *src, void *dst, int samples)
+static std::once_flag InitFuncsAsmFlag;
+
+static void qInitFuncsAsm()
 {
-    const T *pSrc = (const T *)src;
-    T *pDst = (T*)dst;
-    for ( int i = 0; i < samples; i++ ) {
-        pDst[i] = signedVersion<T>::offset + ((typename signedVersion<T>::TS)(pSrc[i] - signedVersion<T>::offset) * factor);
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+    extern void QT_FASTCALL qt_multiply_UInt8_sse2(float factor, const quint8 *src, quint8 *dst, int samples);
+    extern void QT_FASTCALL qt_multiply_Int16_sse2(float factor, const qint16 *src, qint16 *dst, int samples);
+    extern void QT_FASTCALL qt_multiply_Int32_sse2(double factor, const qint32 *src, qint32 *dst, int samples);
+    extern void QT_FASTCALL qt_multiply_Float_sse2(float factor, const float *src, float *dst, int samples);
+    extern void QT_FASTCALL qt_convert_UInt8_to_Float_sse2(float scale, const quint8 *src, float *dst, int samples);
+    extern void QT_FASTCALL qt_convert_Int16_to_Float_sse2(float scale, const qint16 *src, float *dst, int samples);
+    extern void QT_FASTCALL qt_convert_Int32_to_Float_sse2(double scale, const qint32 *src, float *dst, int samples);
+    extern void QT_FASTCALL qt_convert_Float_to_UInt8_sse2(float scale, const float *src, quint8 *dst, int samples);
+    extern void QT_FASTCALL qt_convert_Float_to_Int16_sse2(float scale, const float *src, qint16 *dst, int samples);
+    extern void QT_FASTCALL qt_convert_Float_to_Int32_sse2(double scale, const float *src, qint32 *dst, int samples);
+    if (qCpuHasFeature(SSE2)) {
+        qMultiplyUInt8 = qt_multiply_UInt8_sse2;
+        qMultiplyInt16 = qt_multiply_Int16_sse2;
+        qMultiplyInt32 = qt_multiply_Int32_sse2;
+        qMultiplyFloat = qt_multiply_Float_sse2;
+        qConvertUInt8ToFloat = qt_convert_UInt8_to_Float_sse2;
+        qConvertInt16ToFloat = qt_convert_Int16_to_Float_sse2;
+        qConvertInt32ToFloat = qt_convert_Int32_to_Float_sse2;
+        qConvertFloatToUInt8 = qt_convert_Float_to_UInt8_sse2;
+        qConvertFloatToInt16 = qt_convert_Float_to_Int16_sse2;
+        qConvertFloatToInt32 = qt_convert_Float_to_Int32_sse2;
+    }
+#endif
+#ifdef QT_COMPILER_SUPPORTS_SSSE3
+    extern void QT_FASTCALL qt_unpack_Int24_ssse3(const quint8 *src, qint32 *dst, int samples);
+    if (qCpuHasFeature(SSSE3))
+        qUnpackInt24Func = qt_unpack_Int24_ssse3;
+#endif
+#if defined(QT_COMPILER_SUPPORTS_NEON) && defined(Q_PROCESSOR_ARM_64)
+    extern void QT_FASTCALL qt_multiply_UInt8_neon(float factor, const quint8 *src, quint8 *dst, int samples);
+    extern void QT_FASTCALL qt_multiply_Int16_neon(float factor, const qint16 *src, qint16 *dst, int samples);
+    extern void QT_FASTCALL qt_multiply_Int32_neon(double factor, const qint32 *src, qint32 *dst, int samples);
+    extern void QT_FASTCALL qt_multiply_Float_neon(float factor, const float *src, float *dst, int samples);
+    extern void QT_FASTCALL qt_convert_UInt8_to_Float_neon(float scale, const quint8 *src, float *dst, int samples);
+    extern void QT_FASTCALL qt_convert_Int16_to_Float_neon(float scale, const qint16 *src, float *dst, int samples);
+    extern void QT_FASTCALL qt_convert_Int32_to_Float_neon(double scale, const qint32 *src, float *dst, int samples);
+    extern void QT_FASTCALL qt_convert_Float_to_UInt8_neon(float scale, const float *src, quint8 *dst, int samples);
+    extern void QT_FASTCALL qt_convert_Float_to_Int16_neon(float scale, const float *src, qint16 *dst, int samples);
+    extern void QT_FASTCALL qt_convert_Float_to_Int32_neon(double scale, const float *src, qint32 *dst, int samples);
+    extern void QT_FASTCALL qt_unpack_Int24_neon(const quint8 *src, qint32 *dst, int samples);
+    if (qCpuHasFeature(NEON)) {
+        qMultiplyUInt8 = qt_multiply_UInt8_neon;
+        qMultiplyInt16 = qt_multiply_Int16_neon;
+        qMultiplyInt32 = qt_multiply_Int32_neon;
+        qMultiplyFloat = qt_multiply_Float_neon;
+        qConvertUInt8ToFloat = qt_convert_UInt8_to_Float_neon;
+        qConvertInt16ToFloat = qt_convert_Int16_to_Float_neon;
+        qConvertInt32ToFloat = qt_convert_Int32_to_Float_neon;
+        qConvertFloatToUInt8 = qt_convert_Float_to_UInt8_neon;
+        qConvertFloatToInt16 = qt_convert_Float_to_Int16_neon;
+        qConvertFloatToInt32 = qt_convert_Float_to_Int32_neon;
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+        qUnpackInt24Func = qt_unpack_Int24_neon;
+#endif
     }
+#endif
 }
 
 void qMultiplySamples(qreal factor, const QAudioFormat &format, const void* src, void* dest, int len)
 {
     const int samplesCount = len / qMax(1, format.bytesPerSample());
 
+    if (factor == 1.) {
+        // the kernels round to the nearest value, so a factor of 1 doesn't change the samples
+        if (src != dest)
+            memcpy(dest, src, samplesCount * format.bytesPerSample());
+        return;
+    }
+
+    std::call_once(InitFuncsAsmFlag, &qInitFuncsAsm);
+
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Unknown:
+    case QAudioFormat::NSampleFormats:
+        return;
+    case QAudioFormat::UInt8:
+        qMultiplyUInt8(factor, static_cast<const quint8 *>(src), static_cast<quint8 *>(dest),
+                       samplesCount);
+        break;
+    case QAudioFormat::Int16:
+        qMultiplyInt16(factor, static_cast<const qint16 *>(src), static_cast<qint16 *>(dest),
+                       samplesCount);
+        break;
+    case QAudioFormat::Int32:
+        qMultiplyInt32(factor, static_cast<const qint32 *>(src), static_cast<qint32 *>(dest),
+                       samplesCount);
+        break;
+    case QAudioFormat::Float:
+        qMultiplyFloat(factor, static_cast<const float *>(src), static_cast<float *>(dest),
+                       samplesCount);
+        break;
+    }
+}
+
+void qRampSamples(qreal startFactor, qreal endFactor, const QAudioFormat &format,
+                  const void *src, void *dest, int len)
+{
+    // a volume change happens once per buffer at most, so the ramp is not vectorized
+    const int channelCount = format.channelCount();
+    const int frames = len / qMax(1, format.bytesPerFrame());
+    if (frames == 0)
+        return;
+
+    const double step = (endFactor - startFactor) / frames;
+
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Unknown:
+    case QAudioFormat::NSampleFormats:
+        return;
+    case QAudioFormat::UInt8:
+        rampSamples(startFactor, step, channelCount, static_cast<const quint8 *>(src),
+                    static_cast<quint8 *>(dest), frames);
+        break;
+    case QAudioFormat::Int16:
+        rampSamples(startFactor, step, channelCount, static_cast<const qint16 *>(src),
+                    static_cast<qint16 *>(dest), frames);
+        break;
+    case QAudioFormat::Int32:
+        rampSamples(startFactor, step, channelCount, static_cast<const qint32 *>(src),
+                    static_cast<qint32 *>(dest), frames);
+        break;
+    case QAudioFormat::Float:
+        rampSamples(startFactor, step, channelCount, static_cast<const float *>(src),
+                    static_cast<float *>(dest), frames);
+        break;
+    }
+}
+
+void qConvertToFloat(qreal factor, const QAudioFormat &format, const void *src, float *dest,
+                     int samples)
+{
+    std::call_once(InitFuncsAsmFlag, &qInitFuncsAsm);
+
     switch (format.sampleFormat()) {
     case QAudioFormat::Unknown:
     case QAudioFormat::NSampleFormats:
         return;
     case QAudioFormat::UInt8:
-        QAudioHelperInternal::adjustUnsignedSamples<quint8>(factor,src,dest,samplesCount);
+        qConvertUInt8ToFloat(factor / FloatRange<quint8>, static_cast<const quint8 *>(src), dest,
+                             samples);
         break;
     case QAudioFormat::Int16:
-        QAudioHelperInternal::adjustSamples<qint16>(factor,src,dest,samplesCount);
+        qConvertInt16ToFloat(factor / FloatRange<qint16>, static_cast<const qint16 *>(src), dest,
+                             samples);
         break;
     case QAudioFormat::Int32:
-        QAudioHelperInternal::adjustSamples<qint32>(factor,src,dest,samplesCount);
+        qConvertInt32ToFloat(factor / FloatRange<qint32>, static_cast<const qint32 *>(src), dest,
+                             samples);
         break;
     case QAudioFormat::Float:
-        QAudioHelperInternal::adjustSamples<float>(factor,src,dest,samplesCount);
+        qMultiplyFloat(factor, static_cast<const float *>(src), dest, samples);
         break;
     }
 }
+
+void qConvertFromFloat(qreal factor, const QAudioFormat &format, const float *src, void *dest,
+                       int samples)
+{
+    std::call_once(InitFuncsAsmFlag, &qInitFuncsAsm);
+
+    switch (format.sampleFormat()) {
+    case QAudioFormat::Unknown:
+    case QAudioFormat::NSampleFormats:
+        return;
+    case QAudioFormat::UInt8:
+        qConvertFloatToUInt8(factor * FloatRange<quint8>, src, static_cast<quint8 *>(dest),
+                             samples);
+        break;
+    case QAudioFormat::Int16:
+        qConvertFloatToInt16(factor * FloatRange<qint16>, src, static_cast<qint16 *>(dest),
+                             samples);
+        break;
+    case QAudioFormat::Int32:
+        qConvertFloatToInt32(factor * FloatRange<qint32>, src, static_cast<qint32 *>(dest),
+                             samples);
+        break;
+    case QAudioFormat::Float: {
+        // saturated like the integer formats, the mixes may exceed [-1, 1]
+        float *out = static_cast<float *>(dest);
+        qMultiplyFloat(factor, src, out, samples);
+        for (int i = 0; i < samples; ++i)
+            out[i] = std::clamp(out[i], -1.f, 1.f);
+        break;
+    }
+    }
+}
+
+void qUnpackInt24(const void *src, qint32 *dest, int samples)
+{
+    std::call_once(InitFuncsAsmFlag, &qInitFuncsAsm);
+
+    qUnpackInt24Func(static_cast<const quint8 *>(src), dest, samples);
+}
 }
 
 QT_END_NAMESPACE
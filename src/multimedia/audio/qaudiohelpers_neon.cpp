@@ -0,0 +1,259 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qaudiohelpers_p.h"
+
+#include <private/qsimd_p.h>
+
+// the kernels need the rounding conversions and the double lanes of AArch64
+#if defined(QT_COMPILER_SUPPORTS_NEON) && defined(Q_PROCESSOR_ARM_64)
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal {
+
+namespace {
+
+// Like the scalar code, the kernels clamp and round to the nearest even value
+
+inline int32x4_t roundClamped(float32x4_t value, float32x4_t min, float32x4_t max)
+{
+    return vcvtnq_s32_f32(vminq_f32(vmaxq_f32(value, min), max));
+}
+
+inline int32x2_t roundClamped(float64x2_t value, float64x2_t min, float64x2_t max)
+{
+    return vmovn_s64(vcvtnq_s64_f64(vminq_f64(vmaxq_f64(value, min), max)));
+}
+
+inline float64x2_t lowToDouble(int32x4_t value)
+{
+    return vcvtq_f64_s64(vmovl_s32(vget_low_s32(value)));
+}
+
+inline float64x2_t highToDouble(int32x4_t value)
+{
+    return vcvtq_f64_s64(vmovl_high_s32(value));
+}
+
+// Zero-extends the lower or upper 8 of 16 UInt8 samples, and removes their bias
+inline int16x8_t lowUInt8ToInt16(uint8x16_t value)
+{
+    return vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vget_low_u8(value))), vdupq_n_s16(0x80));
+}
+
+inline int16x8_t highUInt8ToInt16(uint8x16_t value)
+{
+    return vsubq_s16(vreinterpretq_s16_u16(vmovl_high_u8(value)), vdupq_n_s16(0x80));
+}
+
+// Packs 16 values in [-128, 127] to biased UInt8 samples
+inline uint8x16_t packUInt8(int32x4_t a, int32x4_t b, int32x4_t c, int32x4_t d)
+{
+    const int16x8_t offset = vdupq_n_s16(0x80);
+    const int16x8_t low = vaddq_s16(vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)), offset);
+    const int16x8_t high = vaddq_s16(vcombine_s16(vqmovn_s32(c), vqmovn_s32(d)), offset);
+    return vcombine_u8(vqmovun_s16(low), vqmovun_s16(high));
+}
+
+} // namespace
+
+void QT_FASTCALL qt_multiply_UInt8_neon(float factor, const quint8 *src, quint8 *dst, int samples)
+{
+    const float32x4_t min = vdupq_n_f32(-128.f);
+    const float32x4_t max = vdupq_n_f32(127.f);
+    const auto multiply = [&](int32x4_t value) {
+        return roundClamped(vmulq_n_f32(vcvtq_f32_s32(value), factor), min, max);
+    };
+
+    int i = 0;
+    for (; i < samples - 15; i += 16) {
+        const uint8x16_t in = vld1q_u8(src + i);
+        const int16x8_t low = lowUInt8ToInt16(in);
+        const int16x8_t high = highUInt8ToInt16(in);
+        const uint8x16_t out = packUInt8(multiply(vmovl_s16(vget_low_s16(low))),
+                                         multiply(vmovl_high_s16(low)),
+                                         multiply(vmovl_s16(vget_low_s16(high))),
+                                         multiply(vmovl_high_s16(high)));
+        vst1q_u8(dst + i, out);
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::multiply(src[i], factor);
+}
+
+void QT_FASTCALL qt_multiply_Int16_neon(float factor, const qint16 *src, qint16 *dst, int samples)
+{
+    const float32x4_t min = vdupq_n_f32(-32768.f);
+    const float32x4_t max = vdupq_n_f32(32767.f);
+    const auto multiply = [&](int32x4_t value) {
+        return roundClamped(vmulq_n_f32(vcvtq_f32_s32(value), factor), min, max);
+    };
+
+    int i = 0;
+    for (; i < samples - 7; i += 8) {
+        const int16x8_t in = vld1q_s16(src + i);
+        const int32x4_t low = multiply(vmovl_s16(vget_low_s16(in)));
+        const int32x4_t high = multiply(vmovl_high_s16(in));
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::multiply(src[i], factor);
+}
+
+void QT_FASTCALL qt_multiply_Int32_neon(double factor, const qint32 *src, qint32 *dst, int samples)
+{
+    const float64x2_t min = vdupq_n_f64(-2147483648.);
+    const float64x2_t max = vdupq_n_f64(2147483647.);
+
+    int i = 0;
+    for (; i < samples - 3; i += 4) {
+        const int32x4_t in = vld1q_s32(src + i);
+        const int32x2_t low = roundClamped(vmulq_n_f64(lowToDouble(in), factor), min, max);
+        const int32x2_t high = roundClamped(vmulq_n_f64(highToDouble(in), factor), min, max);
+        vst1q_s32(dst + i, vcombine_s32(low, high));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::multiply(src[i], factor);
+}
+
+void QT_FASTCALL qt_multiply_Float_neon(float factor, const float *src, float *dst, int samples)
+{
+    int i = 0;
+    for (; i < samples - 7; i += 8) {
+        vst1q_f32(dst + i, vmulq_n_f32(vld1q_f32(src + i), factor));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vld1q_f32(src + i + 4), factor));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::multiply(src[i], factor);
+}
+
+void QT_FASTCALL qt_convert_UInt8_to_Float_neon(float scale, const quint8 *src, float *dst, int samples)
+{
+    const auto convert = [&](int32x4_t value) { return vmulq_n_f32(vcvtq_f32_s32(value), scale); };
+
+    int i = 0;
+    for (; i < samples - 15; i += 16) {
+        const uint8x16_t in = vld1q_u8(src + i);
+        const int16x8_t low = lowUInt8ToInt16(in);
+        const int16x8_t high = highUInt8ToInt16(in);
+        vst1q_f32(dst + i, convert(vmovl_s16(vget_low_s16(low))));
+        vst1q_f32(dst + i + 4, convert(vmovl_high_s16(low)));
+        vst1q_f32(dst + i + 8, convert(vmovl_s16(vget_low_s16(high))));
+        vst1q_f32(dst + i + 12, convert(vmovl_high_s16(high)));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::toFloat(src[i], scale);
+}
+
+void QT_FASTCALL qt_convert_Int16_to_Float_neon(float scale, const qint16 *src, float *dst, int samples)
+{
+    int i = 0;
+    for (; i < samples - 7; i += 8) {
+        const int16x8_t in = vld1q_s16(src + i);
+        vst1q_f32(dst + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(in))), scale));
+        vst1q_f32(dst + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_high_s16(in)), scale));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::toFloat(src[i], scale);
+}
+
+void QT_FASTCALL qt_convert_Int32_to_Float_neon(double scale, const qint32 *src, float *dst, int samples)
+{
+    int i = 0;
+    for (; i < samples - 3; i += 4) {
+        const int32x4_t in = vld1q_s32(src + i);
+        const float32x2_t low = vcvt_f32_f64(vmulq_n_f64(lowToDouble(in), scale));
+        vst1q_f32(dst + i, vcvt_high_f32_f64(low, vmulq_n_f64(highToDouble(in), scale)));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::toFloat(src[i], scale);
+}
+
+void QT_FASTCALL qt_convert_Float_to_UInt8_neon(float scale, const float *src, quint8 *dst, int samples)
+{
+    const float32x4_t min = vdupq_n_f32(-128.f);
+    const float32x4_t max = vdupq_n_f32(127.f);
+    const auto convert = [&](const float *in) {
+        return roundClamped(vmulq_n_f32(vld1q_f32(in), scale), min, max);
+    };
+
+    int i = 0;
+    for (; i < samples - 15; i += 16) {
+        vst1q_u8(dst + i, packUInt8(convert(src + i), convert(src + i + 4), convert(src + i + 8),
+                                    convert(src + i + 12)));
+    }
+
+    for (; i < samples; ++i)
+        Scalar::fromFloat(src[i], scale, dst[i]);
+}
+
+void QT_FASTCALL qt_convert_Float_to_Int16_neon(float scale, const float *src, qint16 *dst, int samples)
+{
+    const float32x4_t min = vdupq_n_f32(-32768.f);
+    const float32x4_t max = vdupq_n_f32(32767.f);
+
+    int i = 0;
+    for (; i < samples - 7; i += 8) {
+        const int32x4_t low = roundClamped(vmulq_n_f32(vld1q_f32(src + i), scale), min, max);
+        const int32x4_t high = roundClamped(vmulq_n_f32(vld1q_f32(src + i + 4), scale), min, max);
+        vst1q_s16(dst + i, vcombine_s16(vqmovn_s32(low), vqmovn_s32(high)));
+    }
+
+    for (; i < samples; ++i)
+        Scalar::fromFloat(src[i], scale, dst[i]);
+}
+
+void QT_FASTCALL qt_convert_Float_to_Int32_neon(double scale, const float *src, qint32 *dst, int samples)
+{
+    const float64x2_t min = vdupq_n_f64(-2147483648.);
+    const float64x2_t max = vdupq_n_f64(2147483647.);
+
+    int i = 0;
+    for (; i < samples - 3; i += 4) {
+        const float32x4_t in = vld1q_f32(src + i);
+        const int32x2_t low = roundClamped(vmulq_n_f64(vcvt_f64_f32(vget_low_f32(in)), scale), min, max);
+        const int32x2_t high = roundClamped(vmulq_n_f64(vcvt_high_f64_f32(in), scale), min, max);
+        vst1q_s32(dst + i, vcombine_s32(low, high));
+    }
+
+    for (; i < samples; ++i)
+        Scalar::fromFloat(src[i], scale, dst[i]);
+}
+
+void QT_FASTCALL qt_unpack_Int24_neon(const quint8 *src, qint32 *dst, int samples)
+{
+    const uint8x16_t zero = vdupq_n_u8(0);
+
+    int i = 0;
+    for (; i < samples - 15; i += 16) {
+        // deinterleaves the low, middle and high bytes of 16 samples, and zips them
+        // back with a zero byte below each sample
+        const uint8x16x3_t in = vld3q_u8(src + 3 * i);
+        const uint8x16x2_t low = vzipq_u8(zero, in.val[0]);
+        const uint8x16x2_t high = vzipq_u8(in.val[1], in.val[2]);
+        const uint16x8x2_t first =
+                vzipq_u16(vreinterpretq_u16_u8(low.val[0]), vreinterpretq_u16_u8(high.val[0]));
+        const uint16x8x2_t second =
+                vzipq_u16(vreinterpretq_u16_u8(low.val[1]), vreinterpretq_u16_u8(high.val[1]));
+        vst1q_s32(dst + i, vreinterpretq_s32_u16(first.val[0]));
+        vst1q_s32(dst + i + 4, vreinterpretq_s32_u16(first.val[1]));
+        vst1q_s32(dst + i + 8, vreinterpretq_s32_u16(second.val[0]));
+        vst1q_s32(dst + i + 12, vreinterpretq_s32_u16(second.val[1]));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::unpackInt24(src + 3 * i);
+}
+
+} // namespace QAudioHelperInternal
+
+QT_END_NAMESPACE
+
+#endif
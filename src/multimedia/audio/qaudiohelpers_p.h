@@ -18,11 +18,123 @@
 #include <qaudioformat.h>
 #include <private/qglobal_p.h>
 
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <utility>
+
 QT_BEGIN_NAMESPACE
 
 namespace QAudioHelperInternal
 {
+// Multiplies the samples by factor; len is in bytes. The results are rounded to
+// the nearest value and saturated; Int32 samples are multiplied in double precision.
 Q_MULTIMEDIA_EXPORT void qMultiplySamples(qreal factor, const QAudioFormat& format, const void *src, void* dest, int len);
+
+// Ramps the factor linearly from startFactor to endFactor over the frames of the buffer
+Q_MULTIMEDIA_EXPORT void qRampSamples(qreal startFactor, qreal endFactor, const QAudioFormat &format,
+                                      const void *src, void *dest, int len);
+
+// Convert samples of the format from and to floats in [-1, 1], and multiply them by factor
+// on the way. The conversions are symmetric, so that a round trip with factor 1 is lossless
+// for UInt8 and Int16. qConvertFromFloat saturates the samples, Float ones included.
+Q_MULTIMEDIA_EXPORT void qConvertToFloat(qreal factor, const QAudioFormat &format,
+                                         const void *src, float *dest, int samples);
+Q_MULTIMEDIA_EXPORT void qConvertFromFloat(qreal factor, const QAudioFormat &format,
+                                           const float *src, void *dest, int samples);
+
+// Expands packed, little endian 24 bit samples to Int32 ones without losing precision.
+// The samples are expanded front to back, so src may point into the last three quarters
+// of dest for an in-place expansion.
+Q_MULTIMEDIA_EXPORT void qUnpackInt24(const void *src, qint32 *dest, int samples);
+
+// Applies the volume to the consecutive buffers of a stream. When the volume changes,
+// the change is ramped over the next buffer instead of being applied as a step.
+class VolumeRamp
+{
+public:
+    // Returns false if apply() would leave the samples unchanged
+    bool changesSamples(qreal volume) const
+    {
+        return volume != 1.0 || (m_volume && *m_volume != 1.0);
+    }
+
+    void apply(qreal volume, const QAudioFormat &format, const void *src, void *dest, int len)
+    {
+        const std::optional<qreal> previous = std::exchange(m_volume, volume);
+        if (previous && *previous != volume)
+            qRampSamples(*previous, volume, format, src, dest, len);
+        else
+            qMultiplySamples(volume, format, src, dest, len);
+    }
+
+    // the first buffer after a reset gets the volume without a ramp
+    void reset() { m_volume.reset(); }
+
+private:
+    std::optional<qreal> m_volume;
+};
+
+// The sample operations of the scalar kernels, shared with the SIMD ones for the leftovers
+namespace Scalar
+{
+inline quint8 multiply(quint8 sample, float factor)
+{
+    const float value = std::clamp((int(sample) - 0x80) * factor, -128.f, 127.f);
+    return quint8(std::lrint(value) + 0x80);
+}
+
+inline qint16 multiply(qint16 sample, float factor)
+{
+    return qint16(std::lrint(std::clamp(sample * factor, -32768.f, 32767.f)));
+}
+
+inline qint32 multiply(qint32 sample, double factor)
+{
+    return qint32(std::lrint(std::clamp(sample * factor, -2147483648., 2147483647.)));
+}
+
+inline float multiply(float sample, float factor)
+{
+    return sample * factor;
+}
+
+// the scale of the conversions includes the factor
+inline float toFloat(quint8 sample, float scale)
+{
+    return (int(sample) - 0x80) * scale;
+}
+
+inline float toFloat(qint16 sample, float scale)
+{
+    return sample * scale;
+}
+
+inline float toFloat(qint32 sample, double scale)
+{
+    return float(sample * scale);
+}
+
+inline void fromFloat(float sample, float scale, quint8 &out)
+{
+    out = quint8(std::lrint(std::clamp(sample * scale, -128.f, 127.f)) + 0x80);
+}
+
+inline void fromFloat(float sample, float scale, qint16 &out)
+{
+    out = qint16(std::lrint(std::clamp(sample * scale, -32768.f, 32767.f)));
+}
+
+inline void fromFloat(float sample, double scale, qint32 &out)
+{
+    out = qint32(std::lrint(std::clamp(sample * scale, -2147483648., 2147483647.)));
+}
+
+inline qint32 unpackInt24(const quint8 *sample)
+{
+    return qint32(quint32(sample[0]) << 8 | quint32(sample[1]) << 16 | quint32(sample[2]) << 24);
+}
+} // namespace Scalar
 }
 
 QT_END_NAMESPACE
@@ -0,0 +1,249 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qaudiohelpers_p.h"
+
+#include <private/qsimd_p.h>
+
+#ifdef QT_COMPILER_SUPPORTS_SSE2
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal {
+
+namespace {
+
+// The kernels convert with the default rounding mode, i.e. to the nearest even value,
+// like std::lrint() in the scalar code, and clamp before converting, so that the
+// results are identical.
+
+inline __m128i roundClamped(__m128 value, __m128 min, __m128 max)
+{
+    return _mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(value, min), max));
+}
+
+// Converts 2 doubles to the lower half of the result
+inline __m128i roundClamped(__m128d value, __m128d min, __m128d max)
+{
+    return _mm_cvtpd_epi32(_mm_min_pd(_mm_max_pd(value, min), max));
+}
+
+// Sign-extends the lower or upper 4 of 8 16-bit values
+inline __m128i lowToInt32(__m128i value)
+{
+    return _mm_srai_epi32(_mm_unpacklo_epi16(value, value), 16);
+}
+
+inline __m128i highToInt32(__m128i value)
+{
+    return _mm_srai_epi32(_mm_unpackhi_epi16(value, value), 16);
+}
+
+// Zero-extends the lower or upper 8 of 16 UInt8 samples, and removes their bias
+inline __m128i lowUInt8ToInt16(__m128i value)
+{
+    return _mm_sub_epi16(_mm_unpacklo_epi8(value, _mm_setzero_si128()), _mm_set1_epi16(0x80));
+}
+
+inline __m128i highUInt8ToInt16(__m128i value)
+{
+    return _mm_sub_epi16(_mm_unpackhi_epi8(value, _mm_setzero_si128()), _mm_set1_epi16(0x80));
+}
+
+// Packs 16 values in [-128, 127] to biased UInt8 samples
+inline __m128i packUInt8(__m128i a, __m128i b, __m128i c, __m128i d)
+{
+    const __m128i offset = _mm_set1_epi16(0x80);
+    return _mm_packus_epi16(_mm_add_epi16(_mm_packs_epi32(a, b), offset),
+                            _mm_add_epi16(_mm_packs_epi32(c, d), offset));
+}
+
+} // namespace
+
+void QT_FASTCALL qt_multiply_UInt8_sse2(float factor, const quint8 *src, quint8 *dst, int samples)
+{
+    const __m128 f = _mm_set1_ps(factor);
+    const __m128 min = _mm_set1_ps(-128.f);
+    const __m128 max = _mm_set1_ps(127.f);
+    const auto multiply = [&](__m128i value) {
+        return roundClamped(_mm_mul_ps(_mm_cvtepi32_ps(value), f), min, max);
+    };
+
+    int i = 0;
+    for (; i < samples - 15; i += 16) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i low = lowUInt8ToInt16(in);
+        const __m128i high = highUInt8ToInt16(in);
+        const __m128i out = packUInt8(multiply(lowToInt32(low)), multiply(highToInt32(low)),
+                                      multiply(lowToInt32(high)), multiply(highToInt32(high)));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), out);
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::multiply(src[i], factor);
+}
+
+void QT_FASTCALL qt_multiply_Int16_sse2(float factor, const qint16 *src, qint16 *dst, int samples)
+{
+    const __m128 f = _mm_set1_ps(factor);
+    const __m128 min = _mm_set1_ps(-32768.f);
+    const __m128 max = _mm_set1_ps(32767.f);
+
+    int i = 0;
+    for (; i < samples - 7; i += 8) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i low = roundClamped(_mm_mul_ps(_mm_cvtepi32_ps(lowToInt32(in)), f), min, max);
+        const __m128i high = roundClamped(_mm_mul_ps(_mm_cvtepi32_ps(highToInt32(in)), f), min, max);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(low, high));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::multiply(src[i], factor);
+}
+
+void QT_FASTCALL qt_multiply_Int32_sse2(double factor, const qint32 *src, qint32 *dst, int samples)
+{
+    const __m128d f = _mm_set1_pd(factor);
+    const __m128d min = _mm_set1_pd(-2147483648.);
+    const __m128d max = _mm_set1_pd(2147483647.);
+
+    int i = 0;
+    for (; i < samples - 3; i += 4) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i low = roundClamped(_mm_mul_pd(_mm_cvtepi32_pd(in), f), min, max);
+        const __m128i high =
+                roundClamped(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(in, 8)), f), min, max);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_unpacklo_epi64(low, high));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::multiply(src[i], factor);
+}
+
+void QT_FASTCALL qt_multiply_Float_sse2(float factor, const float *src, float *dst, int samples)
+{
+    const __m128 f = _mm_set1_ps(factor);
+
+    int i = 0;
+    for (; i < samples - 7; i += 8) {
+        const __m128 a = _mm_loadu_ps(src + i);
+        const __m128 b = _mm_loadu_ps(src + i + 4);
+        _mm_storeu_ps(dst + i, _mm_mul_ps(a, f));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(b, f));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::multiply(src[i], factor);
+}
+
+void QT_FASTCALL qt_convert_UInt8_to_Float_sse2(float scale, const quint8 *src, float *dst, int samples)
+{
+    const __m128 s = _mm_set1_ps(scale);
+    const auto convert = [&](__m128i value) { return _mm_mul_ps(_mm_cvtepi32_ps(value), s); };
+
+    int i = 0;
+    for (; i < samples - 15; i += 16) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128i low = lowUInt8ToInt16(in);
+        const __m128i high = highUInt8ToInt16(in);
+        _mm_storeu_ps(dst + i, convert(lowToInt32(low)));
+        _mm_storeu_ps(dst + i + 4, convert(highToInt32(low)));
+        _mm_storeu_ps(dst + i + 8, convert(lowToInt32(high)));
+        _mm_storeu_ps(dst + i + 12, convert(highToInt32(high)));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::toFloat(src[i], scale);
+}
+
+void QT_FASTCALL qt_convert_Int16_to_Float_sse2(float scale, const qint16 *src, float *dst, int samples)
+{
+    const __m128 s = _mm_set1_ps(scale);
+
+    int i = 0;
+    for (; i < samples - 7; i += 8) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm_storeu_ps(dst + i, _mm_mul_ps(_mm_cvtepi32_ps(lowToInt32(in)), s));
+        _mm_storeu_ps(dst + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(highToInt32(in)), s));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::toFloat(src[i], scale);
+}
+
+void QT_FASTCALL qt_convert_Int32_to_Float_sse2(double scale, const qint32 *src, float *dst, int samples)
+{
+    const __m128d s = _mm_set1_pd(scale);
+
+    int i = 0;
+    for (; i < samples - 3; i += 4) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        const __m128 low = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtepi32_pd(in), s));
+        const __m128 high = _mm_cvtpd_ps(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(in, 8)), s));
+        _mm_storeu_ps(dst + i, _mm_movelh_ps(low, high));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::toFloat(src[i], scale);
+}
+
+void QT_FASTCALL qt_convert_Float_to_UInt8_sse2(float scale, const float *src, quint8 *dst, int samples)
+{
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 min = _mm_set1_ps(-128.f);
+    const __m128 max = _mm_set1_ps(127.f);
+    const auto convert = [&](const float *in) {
+        return roundClamped(_mm_mul_ps(_mm_loadu_ps(in), s), min, max);
+    };
+
+    int i = 0;
+    for (; i < samples - 15; i += 16) {
+        const __m128i out = packUInt8(convert(src + i), convert(src + i + 4), convert(src + i + 8),
+                                      convert(src + i + 12));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), out);
+    }
+
+    for (; i < samples; ++i)
+        Scalar::fromFloat(src[i], scale, dst[i]);
+}
+
+void QT_FASTCALL qt_convert_Float_to_Int16_sse2(float scale, const float *src, qint16 *dst, int samples)
+{
+    const __m128 s = _mm_set1_ps(scale);
+    const __m128 min = _mm_set1_ps(-32768.f);
+    const __m128 max = _mm_set1_ps(32767.f);
+
+    int i = 0;
+    for (; i < samples - 7; i += 8) {
+        const __m128i low = roundClamped(_mm_mul_ps(_mm_loadu_ps(src + i), s), min, max);
+        const __m128i high = roundClamped(_mm_mul_ps(_mm_loadu_ps(src + i + 4), s), min, max);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_packs_epi32(low, high));
+    }
+
+    for (; i < samples; ++i)
+        Scalar::fromFloat(src[i], scale, dst[i]);
+}
+
+void QT_FASTCALL qt_convert_Float_to_Int32_sse2(double scale, const float *src, qint32 *dst, int samples)
+{
+    const __m128d s = _mm_set1_pd(scale);
+    const __m128d min = _mm_set1_pd(-2147483648.);
+    const __m128d max = _mm_set1_pd(2147483647.);
+
+    int i = 0;
+    for (; i < samples - 3; i += 4) {
+        const __m128 in = _mm_loadu_ps(src + i);
+        const __m128i low = roundClamped(_mm_mul_pd(_mm_cvtps_pd(in), s), min, max);
+        const __m128i high = roundClamped(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(in, in)), s), min, max);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_unpacklo_epi64(low, high));
+    }
+
+    for (; i < samples; ++i)
+        Scalar::fromFloat(src[i], scale, dst[i]);
+}
+
+} // namespace QAudioHelperInternal
+
+QT_END_NAMESPACE
+
+#endif
@@ -0,0 +1,34 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qaudiohelpers_p.h"
+
+#include <private/qsimd_p.h>
+
+#ifdef QT_COMPILER_SUPPORTS_SSSE3
+
+QT_BEGIN_NAMESPACE
+
+namespace QAudioHelperInternal {
+
+void QT_FASTCALL qt_unpack_Int24_ssse3(const quint8 *src, qint32 *dst, int samples)
+{
+    // moves the 3 bytes of each sample to the upper bytes of a 32 bit lane
+    const __m128i shuffleMask = _mm_setr_epi8(-1, 0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11);
+
+    // a load reads 16 bytes for the 12 bytes of 4 samples, so it stops 2 samples early
+    int i = 0;
+    for (; i < samples - 5; i += 4) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 3 * i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), _mm_shuffle_epi8(in, shuffleMask));
+    }
+
+    for (; i < samples; ++i)
+        dst[i] = Scalar::unpackInt24(src + 3 * i);
+}
+
+} // namespace QAudioHelperInternal
+
+QT_END_NAMESPACE
+
+#endif
@@ -172,6 +172,50 @@ QIODevice* QAudioSink::start()
     return d->start();
 }
 
+/*!
+    \typealias QAudioSink::AudioCallback
+    \since 6.8
+
+    The type of the function that renders the audio data in the callback mode.
+    It receives a buffer to fill completely with audio data in the format()
+    of the audio sink.
+*/
+
+/*!
+    \since 6.8
+
+    Starts rendering audio data with \a callback.
+
+    The callback is invoked on a real-time audio thread whenever the audio device
+    needs more data, with a buffer of whole frames that it must fill completely.
+    This makes the timing of the playback independent of the event loop of the
+    thread of the QAudioSink, and allows for lower latencies than reading from
+    a QIODevice.
+
+    The callback must not block, allocate memory, or call into QAudioSink: it
+    should only compute or copy the audio data, writing silence if none is
+    available. The volume() is applied to the rendered data.
+
+    Rendering with a callback is supported with the PulseAudio and ALSA backends.
+    With other backends, a warning is printed and the sink stays in
+    QAudio::StoppedState.
+
+    If the QAudioSink is able to access the system's audio device, state() returns
+    QAudio::ActiveState, error() returns QAudio::NoError
+    and the stateChanged() signal is emitted.
+
+    If a problem occurs during this process, error() returns QAudio::OpenError,
+    state() returns QAudio::StoppedState and the stateChanged() signal is emitted.
+*/
+void QAudioSink::start(AudioCallback callback)
+{
+    if (!d)
+        return;
+    d->elapsedTime.restart();
+    if (!d->start(std::move(callback)))
+        qWarning("QAudioSink::start: rendering with a callback is not supported by the audio backend");
+}
+
 /*!
     Stops the audio output, detaching from the system resource.
 
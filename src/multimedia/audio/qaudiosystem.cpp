@@ -11,6 +11,12 @@ QAudioStateChangeNotifier::QAudioStateChangeNotifier(QObject *parent) : QObject(
 
 QPlatformAudioSink::QPlatformAudioSink(QObject *parent) : QAudioStateChangeNotifier(parent) { }
 
+bool QPlatformAudioSink::start(AudioCallback &&callback)
+{
+    Q_UNUSED(callback);
+    return false;
+}
+
 qreal QPlatformAudioSink::volume() const
 {
     return 1.0;
@@ -20,6 +20,7 @@
 #include <QtMultimedia/qaudio.h>
 #include <QtMultimedia/qaudioformat.h>
 #include <QtMultimedia/qaudiodevice.h>
+#include <QtMultimedia/qaudiosink.h>
 
 #include <QtCore/qelapsedtimer.h>
 #include <QtCore/private/qglobal_p.h>
@@ -44,9 +45,13 @@ class Q_MULTIMEDIA_EXPORT QPlatformAudioSink : public QAudioStateChangeNotifier
     Q_OBJECT
 
 public:
+    using AudioCallback = QAudioSink::AudioCallback;
+
     QPlatformAudioSink(QObject *parent);
     virtual void start(QIODevice *device) = 0;
     virtual QIODevice* start() = 0;
+    // Returns false if the backend cannot render with a callback
+    virtual bool start(AudioCallback &&callback);
     virtual void stop() = 0;
     virtual void reset() = 0;
     virtual void suspend() = 0;
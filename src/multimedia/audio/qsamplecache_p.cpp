@@ -9,14 +9,48 @@
 #include <QtNetwork/QNetworkRequest>
 
 #include <QtCore/QDebug>
+#include <QtCore/QFile>
 #include <QtCore/qloggingcategory.h>
 
+#include <private/qaudiohelpers_p.h>
+#include <private/qplatformaudioresampler_p.h>
+#include <private/qplatformmediaintegration_p.h>
+
 static Q_LOGGING_CATEGORY(qLcSampleCache, "qt.multimedia.samplecache")
 
+#include <algorithm>
 #include <mutex>
 
 QT_BEGIN_NAMESPACE
 
+namespace {
+
+constexpr int MaxLoadingThreads = 4;
+
+// Converts the samples without changing their rate and channels
+void convertSampleFormat(const QAudioFormat &format, const QByteArray &data,
+                         const QAudioFormat &targetFormat, QByteArray &converted)
+{
+    using namespace QAudioHelperInternal;
+
+    const int count = int(data.size() / format.bytesPerSample());
+    converted = QByteArray(count * targetFormat.bytesPerSample(), Qt::Uninitialized);
+
+    if (targetFormat.sampleFormat() == QAudioFormat::Float) {
+        qConvertToFloat(1., format, data.constData(), reinterpret_cast<float *>(converted.data()),
+                        count);
+    } else if (format.sampleFormat() == QAudioFormat::Float) {
+        qConvertFromFloat(1., targetFormat, reinterpret_cast<const float *>(data.constData()),
+                          converted.data(), count);
+    } else {
+        std::vector<float> samples(count);
+        qConvertToFloat(1., format, data.constData(), samples.data(), count);
+        qConvertFromFloat(1., targetFormat, samples.data(), converted.data(), count);
+    }
+}
+
+} // namespace
+
 
 /*!
     \class QSampleCache
@@ -61,31 +95,54 @@ QT_BEGIN_NAMESPACE
            m_sample = 0;
        }
     \endcode
+
+    Wave files are parsed by QWaveDecoder; other files are decoded by QAudioDecoder,
+    if the platform provides one. The samples are loaded on a pool of threads, whose
+    size can be set with QT_SAMPLECACHE_LOADING_THREADS, and statistics() reports how
+    the cache performs.
 */
 
 QSampleCache::QSampleCache(QObject *parent)
     : QObject(parent)
-    , m_networkAccessManager(nullptr)
     , m_capacity(0)
     , m_usage(0)
     , m_loadingRefCount(0)
 {
-    m_loadingThread.setObjectName(QLatin1String("QSampleCache::LoadingThread"));
+    // QT_SAMPLECACHE_LOADING_THREADS sets the size of the loading threads pool
+    bool ok = false;
+    int threadCount = qEnvironmentVariableIntValue("QT_SAMPLECACHE_LOADING_THREADS", &ok);
+    if (!ok || threadCount <= 0)
+        threadCount = qBound(1, QThread::idealThreadCount(), MaxLoadingThreads);
+
+    for (int i = 0; i < threadCount; ++i) {
+        auto loadingThread = std::make_unique<LoadingThread>();
+        loadingThread->thread.setObjectName(QLatin1String("QSampleCache::LoadingThread"));
+        m_loadingThreads.push_back(std::move(loadingThread));
+    }
 }
 
+// Called in loading threads
 QNetworkAccessManager& QSampleCache::networkAccessManager()
 {
-    if (!m_networkAccessManager)
-        m_networkAccessManager = new QNetworkAccessManager();
-    return *m_networkAccessManager;
+    auto it = std::find_if(m_loadingThreads.begin(), m_loadingThreads.end(),
+                           [](const auto &loadingThread) {
+                               return &loadingThread->thread == QThread::currentThread();
+                           });
+    // without threads, the samples are loaded in the application thread
+    LoadingThread &loadingThread = it != m_loadingThreads.end() ? **it : *m_loadingThreads.front();
+    if (!loadingThread.networkAccessManager)
+        loadingThread.networkAccessManager = new QNetworkAccessManager();
+    return *loadingThread.networkAccessManager;
 }
 
 QSampleCache::~QSampleCache()
 {
     const std::lock_guard<QRecursiveMutex> locker(m_mutex);
 
-    m_loadingThread.quit();
-    m_loadingThread.wait();
+    for (auto &loadingThread : m_loadingThreads) {
+        loadingThread->thread.quit();
+        loadingThread->thread.wait();
+    }
 
     // Killing the loading thread means that no samples can be
     // deleted using deleteLater.  And some samples that had deleteLater
@@ -97,7 +154,8 @@ QSampleCache::~QSampleCache()
     for (QSample* sample : copyStaleSamples)
         delete sample;
 
-    delete m_networkAccessManager;
+    for (auto &loadingThread : m_loadingThreads)
+        delete loadingThread->networkAccessManager;
 }
 
 void QSampleCache::loadingRelease()
@@ -105,19 +163,22 @@ void QSampleCache::loadingRelease()
     QMutexLocker locker(&m_loadingMutex);
     m_loadingRefCount--;
     if (m_loadingRefCount == 0) {
-        if (m_loadingThread.isRunning()) {
-            if (m_networkAccessManager) {
-                m_networkAccessManager->deleteLater();
-                m_networkAccessManager = nullptr;
+        for (auto &loadingThread : m_loadingThreads) {
+            if (!loadingThread->thread.isRunning())
+                continue;
+            if (loadingThread->networkAccessManager) {
+                loadingThread->networkAccessManager->deleteLater();
+                loadingThread->networkAccessManager = nullptr;
             }
-            m_loadingThread.exit();
+            loadingThread->thread.exit();
         }
     }
 }
 
 bool QSampleCache::isLoading() const
 {
-    return m_loadingThread.isRunning();
+    return std::any_of(m_loadingThreads.begin(), m_loadingThreads.end(),
+                       [](const auto &loadingThread) { return loadingThread->thread.isRunning(); });
 }
 
 bool QSampleCache::isCached(const QUrl &url) const
@@ -126,7 +187,7 @@ bool QSampleCache::isCached(const QUrl &url) const
     return m_samples.contains(url);
 }
 
-QSample* QSampleCache::requestSample(const QUrl& url)
+QSample* QSampleCache::requestSample(const QUrl& url, const QAudioFormat &format)
 {
     //lock and add first to make sure live loadingThread will not be killed during this function call
     m_loadingMutex.lock();
@@ -138,18 +199,26 @@ QSample* QSampleCache::requestSample(const QUrl& url)
     std::unique_lock<QRecursiveMutex> locker(m_mutex);
     QMap<QUrl, QSample*>::iterator it = m_samples.find(url);
     QSample* sample;
+    ++m_statistics.requests;
     if (it == m_samples.end()) {
         if (needsThreadStart) {
-            // Previous thread might be finishing, need to wait for it. If not, this is a no-op.
-            m_loadingThread.wait();
-            m_loadingThread.start();
+            // Previous threads might be finishing, need to wait for them. If not, this is a no-op.
+            for (auto &loadingThread : m_loadingThreads)
+                loadingThread->thread.wait();
         }
-        sample = new QSample(url, this);
+        // the samples are spread over the threads in turn, which are started when needed
+        QThread &thread = m_loadingThreads[m_nextLoadingThread]->thread;
+        m_nextLoadingThread = (m_nextLoadingThread + 1) % m_loadingThreads.size();
+        if (!thread.isRunning())
+            thread.start();
+
+        sample = new QSample(url, format, this);
         m_samples.insert(url, sample);
 #if QT_CONFIG(thread)
-        sample->moveToThread(&m_loadingThread);
+        sample->moveToThread(&thread);
 #endif
     } else {
+        ++m_statistics.hits;
         sample = *it;
     }
 
@@ -182,6 +251,31 @@ void QSampleCache::setCapacity(qint64 capacity)
     refresh(0);
 }
 
+QSampleCache::Statistics QSampleCache::statistics() const
+{
+    const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+    Statistics statistics = m_statistics;
+    statistics.usage = m_usage;
+    statistics.capacity = m_capacity;
+    return statistics;
+}
+
+// Called in loading threads
+void QSampleCache::sampleLoaded(qint64 size, std::chrono::nanoseconds loadingTime)
+{
+    const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+    ++m_statistics.loadedSamples;
+    m_statistics.decodedBytes += size;
+    m_statistics.loadingTime += loadingTime;
+}
+
+// Called in loading threads
+void QSampleCache::sampleFailed()
+{
+    const std::lock_guard<QRecursiveMutex> locker(m_mutex);
+    ++m_statistics.failedSamples;
+}
+
 // Called locked
 void QSampleCache::unloadSample(QSample *sample)
 {
@@ -256,8 +350,10 @@ void QSample::loadIfNecessary()
 // Called in application thread
 bool QSampleCache::notifyUnreferencedSample(QSample* sample)
 {
-    if (m_loadingThread.isRunning())
-        m_loadingThread.wait();
+    for (auto &loadingThread : m_loadingThreads) {
+        if (loadingThread->thread.isRunning())
+            loadingThread->thread.wait();
+    }
 
     const std::lock_guard<QRecursiveMutex> locker(m_mutex);
 
@@ -288,12 +384,17 @@ void QSample::cleanup()
         m_waveDecoder->disconnect(this);
         m_waveDecoder->deleteLater();
     }
+    if (m_audioDecoder) {
+        m_audioDecoder->disconnect(this);
+        m_audioDecoder->deleteLater();
+    }
     if (m_stream) {
         m_stream->disconnect(this);
         m_stream->deleteLater();
     }
 
     m_waveDecoder = nullptr;
+    m_audioDecoder = nullptr;
     m_stream = nullptr;
 }
 
@@ -319,6 +420,7 @@ void QSample::readSample()
     if (m_sampleReadLength < m_waveDecoder->size())
         return;
     Q_ASSERT(m_sampleReadLength == qint64(m_soundData.size()));
+    m_audioFormat = m_waveDecoder->audioFormat();
     onReady();
 }
 
@@ -330,8 +432,8 @@ void QSample::decoderReady()
 #endif
     QMutexLocker m(&m_mutex);
     qCDebug(qLcSampleCache) << "QSample: decoder ready";
-    m_parent->refresh(m_waveDecoder->size());
 
+    m_audioFormat = m_waveDecoder->audioFormat();
     m_soundData.resize(m_waveDecoder->size());
     m_sampleReadLength = 0;
     qint64 read = m_waveDecoder->read(m_soundData.data(), m_waveDecoder->size());
@@ -357,8 +459,21 @@ void QSample::load()
     Q_ASSERT(QThread::currentThread()->objectName() == QLatin1String("QSampleCache::LoadingThread"));
 #endif
     qCDebug(qLcSampleCache) << "QSample: load [" << m_url << "]";
-    m_stream = m_parent->networkAccessManager().get(QNetworkRequest(m_url));
-    connect(m_stream, SIGNAL(errorOccurred(QNetworkReply::NetworkError)), SLOT(loadingError(QNetworkReply::NetworkError)));
+    m_loadingTimer.start();
+    if (m_url.isLocalFile() || m_url.scheme() == QLatin1String("qrc")) {
+        // local files are opened directly, so that the wave decoder can map them
+        auto *file = new QFile(m_url.isLocalFile() ? m_url.toLocalFile()
+                                                   : QLatin1Char(':') + m_url.path());
+        if (!file->open(QIODevice::ReadOnly)) {
+            delete file;
+            loadingError(QNetworkReply::ContentNotFoundError);
+            return;
+        }
+        m_stream = file;
+    } else {
+        m_stream = m_parent->networkAccessManager().get(QNetworkRequest(m_url));
+        connect(m_stream, SIGNAL(errorOccurred(QNetworkReply::NetworkError)), SLOT(loadingError(QNetworkReply::NetworkError)));
+    }
     m_waveDecoder = new QWaveDecoder(m_stream);
     connect(m_waveDecoder, SIGNAL(formatKnown()), SLOT(decoderReady()));
     connect(m_waveDecoder, SIGNAL(parsingError()), SLOT(decoderError()));
@@ -374,10 +489,7 @@ void QSample::loadingError(QNetworkReply::NetworkError errorCode)
 #endif
     QMutexLocker m(&m_mutex);
     qCDebug(qLcSampleCache) << "QSample: loading error" << errorCode;
-    cleanup();
-    m_state = QSample::Error;
-    qobject_cast<QSampleCache*>(m_parent)->loadingRelease();
-    emit error();
+    onError();
 }
 
 // Called in loading thread
@@ -388,10 +500,125 @@ void QSample::decoderError()
 #endif
     QMutexLocker m(&m_mutex);
     qCDebug(qLcSampleCache) << "QSample: decoder error";
-    cleanup();
-    m_state = QSample::Error;
-    qobject_cast<QSampleCache*>(m_parent)->loadingRelease();
-    emit error();
+
+    // not a wave file, so let the platform decoder try
+    m_waveDecoder->disconnect(this);
+    m_waveDecoder->deleteLater();
+    m_waveDecoder = nullptr;
+    startAudioDecoder();
+}
+
+// Called in loading thread. Locked already.
+void QSample::startAudioDecoder()
+{
+    m_audioDecoder = new QAudioDecoder(this);
+    if (!m_audioDecoder->isSupported()) {
+        qCDebug(qLcSampleCache) << "QSample: no audio decoder available";
+        onError();
+        return;
+    }
+
+    if (m_targetFormat.isValid())
+        m_audioDecoder->setAudioFormat(m_targetFormat);
+
+    // the decoder reads the stream from the start again if it can, otherwise it
+    // downloads the source itself
+    if (!m_stream->isSequential() && m_stream->seek(0)) {
+        m_audioDecoder->setSourceDevice(m_stream);
+    } else {
+        m_stream->disconnect(this);
+        m_stream->deleteLater();
+        m_stream = nullptr;
+        m_audioDecoder->setSource(m_url);
+    }
+
+    m_soundData.clear();
+    m_audioFormat = {};
+
+    connect(m_audioDecoder, &QAudioDecoder::bufferReady, this, &QSample::readDecodedBuffers);
+    connect(m_audioDecoder, &QAudioDecoder::finished, this, &QSample::audioDecoderFinished);
+    connect(m_audioDecoder, qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), this,
+            &QSample::audioDecoderError);
+
+    m_audioDecoder->start();
+}
+
+// Called in loading thread
+void QSample::readDecodedBuffers()
+{
+    QMutexLocker m(&m_mutex);
+    while (m_audioDecoder && m_audioDecoder->bufferAvailable()) {
+        const QAudioBuffer buffer = m_audioDecoder->read();
+        if (!buffer.isValid())
+            continue;
+
+        if (!m_audioFormat.isValid()) {
+            m_audioFormat = buffer.format();
+            const qint64 duration = m_audioDecoder->duration();
+            if (duration > 0)
+                m_soundData.reserve(m_audioFormat.bytesForDuration(duration * 1000));
+        } else if (buffer.format() != m_audioFormat) {
+            qCDebug(qLcSampleCache) << "QSample: skipping buffer of format" << buffer.format();
+            continue;
+        }
+
+        m_soundData.append(buffer.constData<char>(), buffer.byteCount());
+    }
+}
+
+// Called in loading thread
+void QSample::audioDecoderFinished()
+{
+    readDecodedBuffers();
+
+    QMutexLocker m(&m_mutex);
+    qCDebug(qLcSampleCache) << "QSample: audio decoder finished, bytes:" << m_soundData.size();
+    if (m_soundData.isEmpty())
+        onError();
+    else
+        onReady();
+}
+
+// Called in loading thread
+void QSample::audioDecoderError(QAudioDecoder::Error error)
+{
+    QMutexLocker m(&m_mutex);
+    qCDebug(qLcSampleCache) << "QSample: audio decoder error" << error
+                            << (m_audioDecoder ? m_audioDecoder->errorString() : QString());
+    onError();
+}
+
+// Called in loading thread when the sample is decoded. Locked already.
+void QSample::convertToTargetFormat()
+{
+    if (!m_targetFormat.isValid() || m_audioFormat == m_targetFormat)
+        return;
+
+    if (m_audioFormat.sampleRate() == m_targetFormat.sampleRate()
+        && m_audioFormat.channelCount() == m_targetFormat.channelCount()) {
+        QByteArray converted;
+        convertSampleFormat(m_audioFormat, m_soundData, m_targetFormat, converted);
+        m_soundData = std::move(converted);
+        m_audioFormat = m_targetFormat;
+        return;
+    }
+
+    auto maybeResampler =
+            QPlatformMediaIntegration::instance()->createAudioResampler(m_audioFormat, m_targetFormat);
+    if (!maybeResampler) {
+        // the sample keeps its format, and the users convert it themselves
+        qCDebug(qLcSampleCache) << "QSample: cannot convert" << m_audioFormat << "to"
+                                << m_targetFormat;
+        return;
+    }
+
+    std::unique_ptr<QPlatformAudioResampler> resampler(maybeResampler.value());
+    const QAudioBuffer buffer = resampler->resample(m_soundData.constData(), m_soundData.size());
+    if (!buffer.isValid() || buffer.format() != m_targetFormat)
+        return;
+
+    m_soundData = QByteArray(buffer.constData<char>(), buffer.byteCount());
+    m_audioFormat = m_targetFormat;
 }
 
 // Called in loading thread from decoder when sample is done. Locked already.
@@ -400,19 +627,35 @@ void QSample::onReady()
 #if QT_CONFIG(thread)
     Q_ASSERT(QThread::currentThread()->objectName() == QLatin1String("QSampleCache::LoadingThread"));
 #endif
-    m_audioFormat = m_waveDecoder->audioFormat();
+    convertToTargetFormat();
     qCDebug(qLcSampleCache) << "QSample: load ready format:" << m_audioFormat;
     cleanup();
     m_state = QSample::Ready;
+    m_parent->refresh(m_soundData.size());
+    m_parent->sampleLoaded(m_soundData.size(), m_loadingTimer.durationElapsed());
     qobject_cast<QSampleCache*>(m_parent)->loadingRelease();
     emit ready();
 }
 
+// Called in loading thread when the sample cannot be loaded. Locked already.
+void QSample::onError()
+{
+    cleanup();
+    m_soundData.clear();
+    m_sampleReadLength = 0;
+    m_state = QSample::Error;
+    m_parent->sampleFailed();
+    qobject_cast<QSampleCache*>(m_parent)->loadingRelease();
+    emit error();
+}
+
 // Called in application thread, then moved to loader thread
-QSample::QSample(const QUrl& url, QSampleCache *parent)
+QSample::QSample(const QUrl& url, const QAudioFormat &format, QSampleCache *parent)
     : m_parent(parent)
+    , m_targetFormat(format)
     , m_stream(nullptr)
     , m_waveDecoder(nullptr)
+    , m_audioDecoder(nullptr)
     , m_url(url)
     , m_sampleReadLength(0)
     , m_state(Creating)
@@ -15,6 +15,7 @@
 // We mean it.
 //
 
+#include <QtCore/qelapsedtimer.h>
 #include <QtCore/qobject.h>
 #include <QtCore/qthread.h>
 #include <QtCore/qurl.h>
@@ -23,8 +24,13 @@
 #include <QtCore/qset.h>
 #include <qaudioformat.h>
 #include <qnetworkreply.h>
+#include <qaudiodecoder.h>
 #include <private/qglobal_p.h>
 
+#include <chrono>
+#include <memory>
+#include <vector>
+
 QT_BEGIN_NAMESPACE
 
 class QIODevice;
@@ -58,7 +64,7 @@ Q_SIGNALS:
     void ready();
 
 protected:
-    QSample(const QUrl& url, QSampleCache *parent);
+    QSample(const QUrl& url, const QAudioFormat &format, QSampleCache *parent);
 
 private Q_SLOTS:
     void load();
@@ -68,7 +74,13 @@ private Q_SLOTS:
     void decoderReady();
 
 private:
+    void startAudioDecoder();
+    void readDecodedBuffers();
+    void audioDecoderFinished();
+    void audioDecoderError(QAudioDecoder::Error error);
+    void convertToTargetFormat();
     void onReady();
+    void onError();
     void cleanup();
     void addRef();
     void loadIfNecessary();
@@ -79,9 +91,12 @@ private:
     QSampleCache *m_parent;
     QByteArray   m_soundData;
     QAudioFormat m_audioFormat;
+    QAudioFormat m_targetFormat;
     QIODevice    *m_stream;
     QWaveDecoder *m_waveDecoder;
+    QAudioDecoder *m_audioDecoder;
     QUrl         m_url;
+    QElapsedTimer m_loadingTimer;
     qint64       m_sampleReadLength;
     State        m_state;
     int          m_ref;
@@ -93,26 +108,60 @@ class Q_MULTIMEDIA_EXPORT QSampleCache : public QObject
 public:
     friend class QSample;
 
+    struct Statistics
+    {
+        qint64 requests = 0;
+        qint64 hits = 0; // the requests of samples that were cached or loading already
+        qint64 loadedSamples = 0;
+        qint64 failedSamples = 0;
+        qint64 decodedBytes = 0;
+        std::chrono::nanoseconds loadingTime{ 0 }; // of the loaded samples
+        qint64 usage = 0;
+        qint64 capacity = 0;
+
+        double hitRate() const { return requests > 0 ? double(hits) / requests : 0.; }
+        std::chrono::nanoseconds averageLoadingTime() const
+        {
+            return loadedSamples > 0 ? loadingTime / loadedSamples : std::chrono::nanoseconds{ 0 };
+        }
+    };
+
     QSampleCache(QObject *parent = nullptr);
     ~QSampleCache();
 
-    QSample* requestSample(const QUrl& url);
+    // Samples that are loaded are converted to the format, if it's valid;
+    // samples that are cached or loading already keep their format.
+    QSample* requestSample(const QUrl& url, const QAudioFormat &format = {});
     void setCapacity(qint64 capacity);
 
     bool isLoading() const;
     bool isCached(const QUrl& url) const;
 
+    Statistics statistics() const;
+
 private:
+    // The samples are loaded on a small pool of threads with event loops. Each sample
+    // stays in the thread it's assigned to, and each thread has a network access manager
+    // of its own, as the manager is bound to its thread.
+    struct LoadingThread
+    {
+        QThread thread;
+        QNetworkAccessManager *networkAccessManager = nullptr;
+    };
+
     QMap<QUrl, QSample*> m_samples;
     QSet<QSample*> m_staleSamples;
-    QNetworkAccessManager *m_networkAccessManager;
     mutable QRecursiveMutex m_mutex;
     qint64 m_capacity;
     qint64 m_usage;
-    QThread m_loadingThread;
+    std::vector<std::unique_ptr<LoadingThread>> m_loadingThreads;
+    size_t m_nextLoadingThread = 0;
+    Statistics m_statistics;
 
     QNetworkAccessManager& networkAccessManager();
     void refresh(qint64 usageChange);
+    void sampleLoaded(qint64 size, std::chrono::nanoseconds loadingTime);
+    void sampleFailed();
     bool notifyUnreferencedSample(QSample* sample);
     void removeUnreferencedSample(QSample* sample);
     void unloadSample(QSample* sample);
@@ -4,6 +4,7 @@
 #include <QtMultimedia/private/qtmultimediaglobal_p.h>
 #include "qsoundeffect.h"
 #include "qsamplecache_p.h"
+#include "qsoundeffectmixer_p.h"
 #include "qaudiodevice.h"
 #include "qaudiosink.h"
 #include "qmediadevices.h"
@@ -40,7 +41,7 @@ struct SampleDeleter
 };
 }
 
-class QSoundEffectPrivate : public QIODevice
+class QSoundEffectPrivate : public QIODevice, public QSoundEffectMixer::Client
 {
 public:
     QSoundEffectPrivate(QSoundEffect *q, const QAudioDevice &audioDevice = QAudioDevice());
@@ -69,6 +70,11 @@ public:
     void setLoopsRemaining(int loopsRemaining);
     void setStatus(QSoundEffect::Status status);
     void setPlaying(bool playing);
+    void startVoice();
+    void releaseOutput();
+
+    void voiceLooped(int serial, int loopsRemaining) override;
+    void voiceFinished(int serial) override;
 
 public Q_SLOTS:
     void sampleReady();
@@ -83,6 +89,9 @@ public:
     bool m_playing = false;
     QSoundEffect::Status m_status = QSoundEffect::Null;
     std::unique_ptr<QAudioSink, AudioSinkDeleter> m_audioSink;
+    std::shared_ptr<QSoundEffectMixer> m_mixer;
+    int m_polyphony = 1;
+    int m_playSerial = 0;
     std::unique_ptr<QSample, SampleDeleter> m_sample;
     QAudioBuffer m_audioBuffer;
     bool m_muted = false;
@@ -94,6 +103,7 @@ public:
 
 QSoundEffectPrivate::QSoundEffectPrivate(QSoundEffect *q, const QAudioDevice &audioDevice)
     : QIODevice(q)
+    , QSoundEffectMixer::Client(this)
     , q_ptr(q)
     , m_audioDevice(audioDevice)
 {
@@ -110,9 +120,19 @@ void QSoundEffectPrivate::sampleReady()
     qCDebug(qLcSoundEffect) << this << "sampleReady: sample size:" << m_sample->data().size();
     disconnect(m_sample.get(), &QSample::error, this, &QSoundEffectPrivate::decoderError);
     disconnect(m_sample.get(), &QSample::ready, this, &QSoundEffectPrivate::sampleReady);
-    if (!m_audioSink) {
-        const auto audioDevice =
-                m_audioDevice.isNull() ? QMediaDevices::defaultAudioOutput() : m_audioDevice;
+    const auto audioDevice =
+            m_audioDevice.isNull() ? QMediaDevices::defaultAudioOutput() : m_audioDevice;
+    if (!m_audioSink && !m_mixer) {
+        m_mixer = QSoundEffectMixer::instance(audioDevice);
+        if (m_mixer) {
+            m_audioBuffer = m_mixer->convert(m_sample->data(), m_sample->format());
+            if (!m_audioBuffer.isValid()) {
+                qCDebug(qLcSoundEffect) << "Cannot play the sample with the mixer";
+                m_mixer.reset();
+            }
+        }
+    }
+    if (!m_audioSink && !m_mixer) {
         const auto &sampleFormat = m_sample->format();
         const auto sampleChannelConfig =
                 sampleFormat.channelConfig() == QAudioFormat::ChannelConfigUnknown
@@ -149,7 +169,10 @@ void QSoundEffectPrivate::sampleReady()
     m_sampleReady = true;
     setStatus(QSoundEffect::Ready);
 
-    if (m_playing && m_audioSink->state() == QAudio::StoppedState) {
+    if (m_mixer) {
+        if (m_playing)
+            startVoice();
+    } else if (m_playing && m_audioSink->state() == QAudio::StoppedState) {
         qCDebug(qLcSoundEffect) << this << "starting playback on audiooutput";
         m_audioSink->start(this);
     }
@@ -234,6 +257,14 @@ void QSoundEffectPrivate::setStatus(QSoundEffect::Status status)
 void QSoundEffectPrivate::setPlaying(bool playing)
 {
     qCDebug(qLcSoundEffect) << this << "setPlaying(" << playing << ")" << m_playing;
+    if (m_mixer) {
+        // with the mixer, each play() starts a new voice
+        if (!playing)
+            m_mixer->stop(this);
+        else if (m_sampleReady)
+            startVoice();
+    }
+
     if (m_audioSink) {
         m_audioSink->stop();
         if (playing && !m_sampleReady)
@@ -250,6 +281,45 @@ void QSoundEffectPrivate::setPlaying(bool playing)
     emit q_ptr->playingChanged();
 }
 
+void QSoundEffectPrivate::startVoice()
+{
+    m_mixer->play(this, ++m_playSerial, m_audioBuffer, m_loopCount, m_muted ? 0.f : m_volume,
+                  m_polyphony);
+}
+
+void QSoundEffectPrivate::releaseOutput()
+{
+    if (m_audioSink) {
+        disconnect(m_audioSink.get(), &QAudioSink::stateChanged, this,
+                   &QSoundEffectPrivate::stateChanged);
+        m_audioSink.reset();
+    }
+
+    // the voices refer to the data of the audio buffer
+    if (m_mixer) {
+        m_mixer->stop(this);
+        m_mixer.reset();
+    }
+
+    m_audioBuffer = {};
+}
+
+void QSoundEffectPrivate::voiceLooped(int serial, int loopsRemaining)
+{
+    // loopsRemaining follows the last started voice
+    if (serial == m_playSerial)
+        setLoopsRemaining(loopsRemaining);
+}
+
+void QSoundEffectPrivate::voiceFinished(int serial)
+{
+    if (serial == m_playSerial)
+        setLoopsRemaining(0);
+
+    if (m_playing && m_mixer && m_mixer->voiceCount(this) == 0)
+        q_ptr->stop();
+}
+
 /*!
     \class QSoundEffect
     \brief The QSoundEffect class provides a way to play low latency sound effects.
@@ -279,6 +349,11 @@ void QSoundEffectPrivate::setPlaying(bool playing)
     Since QSoundEffect requires slightly more resources to achieve lower
     latency playback, the platform may limit the number of simultaneously playing
     sound effects.
+
+    The sound effects of an audio device are mixed into a single audio stream, and
+    up to 32 sounds play at the same time; beyond that, the oldest sound stops.
+    Set the \c QT_SOUNDEFFECT_DISABLE_MIXER environment variable to play each
+    sound effect in an audio stream of its own.
 */
 
 
@@ -336,7 +411,7 @@ QSoundEffect::QSoundEffect(const QAudioDevice &audioDevice, QObject *parent)
 QSoundEffect::~QSoundEffect()
 {
     stop();
-    d->m_audioSink.reset();
+    d->releaseOutput();
     d->m_sample.reset();
     delete d;
 }
@@ -415,13 +490,14 @@ void QSoundEffect::setSource(const QUrl &url)
         d->m_sample = nullptr;
     }
 
-    if (d->m_audioSink) {
-        disconnect(d->m_audioSink.get(), &QAudioSink::stateChanged, d, &QSoundEffectPrivate::stateChanged);
-        d->m_audioSink.reset();
-    }
+    d->releaseOutput();
 
     d->setStatus(QSoundEffect::Loading);
-    d->m_sample.reset(sampleCache()->requestSample(url));
+    // the sample is decoded to the format it's played in, so that it isn't converted later
+    const auto audioDevice =
+            d->m_audioDevice.isNull() ? QMediaDevices::defaultAudioOutput() : d->m_audioDevice;
+    d->m_sample.reset(
+            sampleCache()->requestSample(url, QSoundEffectMixer::soundFormat(audioDevice)));
     connect(d->m_sample.get(), &QSample::error, d, &QSoundEffectPrivate::decoderError);
     connect(d->m_sample.get(), &QSample::ready, d, &QSoundEffectPrivate::sampleReady);
 
@@ -496,11 +572,60 @@ void QSoundEffect::setLoopCount(int loopCount)
         return;
 
     d->m_loopCount = loopCount;
-    if (d->m_playing)
+    if (d->m_playing) {
         d->setLoopsRemaining(loopCount);
+        if (d->m_mixer)
+            d->m_mixer->setLoopsRemaining(d, d->m_playSerial, loopCount);
+    }
     emit loopCountChanged();
 }
 
+/*!
+    \qmlproperty int QtMultimedia::SoundEffect::polyphony
+    \since 6.8
+
+    This property holds the number of times the sound can play simultaneously.
+
+    If the sound is already playing that many times, \l play() restarts the
+    oldest playback. The default value is 1, which means that \l play() restarts
+    the sound effect if it's playing.
+
+    Overlapping playback is only possible if the sound effects of the audio device
+    are mixed into a single audio stream, which is the case unless the sample
+    cannot be converted to the format of the device.
+*/
+/*!
+    \property QSoundEffect::polyphony
+    \since 6.8
+
+    This property holds the number of times the sound can play simultaneously.
+
+    If the sound is already playing that many times, play() restarts the
+    oldest playback. The default value is 1, which means that play() restarts
+    the sound effect if it's playing.
+
+    Overlapping playback is only possible if the sound effects of the audio device
+    are mixed into a single audio stream, which is the case unless the sample
+    cannot be converted to the format of the device.
+*/
+int QSoundEffect::polyphony() const
+{
+    return d->m_polyphony;
+}
+
+void QSoundEffect::setPolyphony(int polyphony)
+{
+    if (polyphony < 1) {
+        qWarning("SoundEffect: polyphony should be a positive integer");
+        return;
+    }
+    if (d->m_polyphony == polyphony)
+        return;
+
+    d->m_polyphony = polyphony;
+    emit polyphonyChanged();
+}
+
 /*!
     \property QSoundEffect::audioDevice
 
@@ -592,6 +717,8 @@ void QSoundEffect::setVolume(float volume)
 
     if (d->m_audioSink && !d->m_muted)
         d->m_audioSink->setVolume(volume);
+    if (d->m_mixer && !d->m_muted)
+        d->m_mixer->setVolume(d, volume);
 
     emit volumeChanged();
 }
@@ -631,6 +758,9 @@ void QSoundEffect::setMuted(bool muted)
     else if (!muted && d->m_audioSink && d->m_muted)
         d->m_audioSink->setVolume(d->m_volume);
 
+    if (d->m_mixer)
+        d->m_mixer->setVolume(d, muted ? 0.f : d->m_volume);
+
     d->m_muted = muted;
     emit mutedChanged();
 }
@@ -802,6 +932,19 @@ void QSoundEffect::stop()
     The \c loopsRemainingChanged signal is emitted when the remaining number of loops has changed.
 */
 
+/*!
+    \fn void QSoundEffect::polyphonyChanged()
+    \since 6.8
+
+    The \c polyphonyChanged signal is emitted when the polyphony has changed.
+*/
+/*!
+    \qmlsignal QtMultimedia::SoundEffect::polyphonyChanged()
+    \since 6.8
+
+    The \c polyphonyChanged signal is emitted when the polyphony has changed.
+*/
+
 /*!
     \fn void QSoundEffect::volumeChanged()
 
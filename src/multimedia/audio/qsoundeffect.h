@@ -24,6 +24,7 @@ class Q_MULTIMEDIA_EXPORT QSoundEffect : public QObject
     Q_PROPERTY(QUrl source READ source WRITE setSource NOTIFY sourceChanged)
     Q_PROPERTY(int loops READ loopCount WRITE setLoopCount NOTIFY loopCountChanged)
     Q_PROPERTY(int loopsRemaining READ loopsRemaining NOTIFY loopsRemainingChanged)
+    Q_PROPERTY(int polyphony READ polyphony WRITE setPolyphony NOTIFY polyphonyChanged)
     Q_PROPERTY(float volume READ volume WRITE setVolume NOTIFY volumeChanged)
     Q_PROPERTY(bool muted READ isMuted WRITE setMuted NOTIFY mutedChanged)
     Q_PROPERTY(bool playing READ isPlaying NOTIFY playingChanged)
@@ -59,6 +60,9 @@ public:
     int loopsRemaining() const;
     void setLoopCount(int loopCount);
 
+    int polyphony() const;
+    void setPolyphony(int polyphony);
+
     QAudioDevice audioDevice();
     void setAudioDevice(const QAudioDevice &device);
 
@@ -77,6 +81,7 @@ Q_SIGNALS:
     void sourceChanged();
     void loopCountChanged();
     void loopsRemainingChanged();
+    void polyphonyChanged();
     void volumeChanged();
     void mutedChanged();
     void loadedChanged();
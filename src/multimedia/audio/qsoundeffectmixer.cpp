@@ -0,0 +1,332 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qsoundeffectmixer_p.h"
+
+#include "qaudiosink.h"
+#include <QtCore/qhash.h>
+#include <QtCore/qloggingcategory.h>
+#include <private/qaudiohelpers_p.h>
+#include <private/qplatformaudioresampler_p.h>
+#include <private/qplatformmediaintegration_p.h>
+
+#include <algorithm>
+
+QT_BEGIN_NAMESPACE
+
+static Q_LOGGING_CATEGORY(qLcSoundEffectMixer, "qt.multimedia.soundeffect.mixer")
+
+namespace {
+
+constexpr int BufferDuration = 20000; // us
+constexpr int IdleDuration = 2000000; // us
+constexpr int MixChunkSamples = 4096;
+
+bool isMixerDisabled()
+{
+    static const bool disabled = qEnvironmentVariableIsSet("QT_SOUNDEFFECT_DISABLE_MIXER");
+    return disabled;
+}
+
+QAudioFormat voiceFormat(const QAudioDevice &device)
+{
+    QAudioFormat format = device.preferredFormat();
+    format.setSampleFormat(QAudioFormat::Float);
+    return format;
+}
+
+} // namespace
+
+std::shared_ptr<QSoundEffectMixer> QSoundEffectMixer::instance(const QAudioDevice &device)
+{
+    if (isMixerDisabled() || device.isNull() || !device.preferredFormat().isValid())
+        return {};
+
+    static QBasicMutex mutex;
+    static QHash<QByteArray, std::weak_ptr<QSoundEffectMixer>> mixers;
+
+    QMutexLocker locker(&mutex);
+
+    auto &mixer = mixers[device.id()];
+    auto result = mixer.lock();
+    if (!result) {
+        result = std::make_shared<QSoundEffectMixer>(device);
+        mixer = result;
+    }
+
+    return result;
+}
+
+QAudioFormat QSoundEffectMixer::soundFormat(const QAudioDevice &device)
+{
+    if (isMixerDisabled() || device.isNull() || !device.preferredFormat().isValid())
+        return device.preferredFormat();
+    return voiceFormat(device);
+}
+
+QSoundEffectMixer::QSoundEffectMixer(const QAudioDevice &device) : m_device(device)
+{
+    m_format = device.preferredFormat();
+    m_voiceFormat = voiceFormat(device);
+    if (device.isFormatSupported(m_voiceFormat))
+        m_format = m_voiceFormat;
+
+    qCDebug(qLcSoundEffectMixer) << "Create sound effect mixer; device:" << device.description()
+                                 << "format:" << m_format;
+
+    open(QIODevice::ReadOnly);
+
+    m_thread.setObjectName(QStringLiteral("QSoundEffectMixer"));
+    moveToThread(&m_thread);
+    m_thread.start(QThread::TimeCriticalPriority);
+}
+
+QSoundEffectMixer::~QSoundEffectMixer()
+{
+    // the sink is destroyed in its thread, and the mixer is destroyed in the calling one
+    QThread *thread = QThread::currentThread();
+    QMetaObject::invokeMethod(this, [this, thread] {
+        if (m_sink)
+            m_sink->disconnect(this);
+        m_sink.reset();
+        moveToThread(thread);
+    }, Qt::BlockingQueuedConnection);
+
+    m_thread.quit();
+    m_thread.wait();
+}
+
+QAudioBuffer QSoundEffectMixer::convert(const QByteArray &data, const QAudioFormat &format) const
+{
+    if (!format.isValid() || data.isEmpty())
+        return {};
+
+    if (format.sampleRate() == m_voiceFormat.sampleRate()
+        && format.channelCount() == m_voiceFormat.channelCount()) {
+        if (format.sampleFormat() == QAudioFormat::Float)
+            return QAudioBuffer(data, m_voiceFormat);
+
+        const qsizetype count = data.size() / format.bytesPerFrame() * format.channelCount();
+        QByteArray converted(count * sizeof(float), Qt::Uninitialized);
+        QAudioHelperInternal::qConvertToFloat(1., format, data.constData(),
+                                              reinterpret_cast<float *>(converted.data()),
+                                              int(count));
+
+        return QAudioBuffer(converted, m_voiceFormat);
+    }
+
+    if (auto maybeResampler =
+                QPlatformMediaIntegration::instance()->createAudioResampler(format, m_voiceFormat)) {
+        std::unique_ptr<QPlatformAudioResampler> resampler(maybeResampler.value());
+        return resampler->resample(data.constData(), data.size());
+    }
+
+    qCDebug(qLcSoundEffectMixer) << "Cannot convert" << format << "to" << m_voiceFormat;
+    return {};
+}
+
+void QSoundEffectMixer::play(Client *client, int serial, const QAudioBuffer &sound, int loops,
+                             float volume, int polyphony)
+{
+    Q_ASSERT(sound.format() == m_voiceFormat);
+    if (sound.frameCount() == 0)
+        return;
+
+    QMutexLocker locker(&m_mutex);
+
+    Voice *free = nullptr;
+    Voice *oldest = nullptr;
+    Voice *oldestOwn = nullptr;
+    int ownCount = 0;
+    for (Voice &voice : m_voices) {
+        if (!voice.client) {
+            if (!free)
+                free = &voice;
+            continue;
+        }
+        if (!oldest || voice.startOrder < oldest->startOrder)
+            oldest = &voice;
+        if (voice.client == client) {
+            ++ownCount;
+            if (!oldestOwn || voice.startOrder < oldestOwn->startOrder)
+                oldestOwn = &voice;
+        }
+    }
+
+    Voice *voice = ownCount >= polyphony ? oldestOwn : free ? free : oldest;
+    if (voice->client)
+        finishVoice(*voice);
+
+    voice->client = client;
+    voice->serial = serial;
+    voice->data = sound.constData<float>();
+    voice->frames = sound.frameCount();
+    voice->position = 0;
+    voice->loopsRemaining = loops;
+    voice->volume = volume;
+    voice->startOrder = ++m_startCounter;
+
+    m_idleFrames = 0;
+    if (!m_running) {
+        m_running = true;
+        QMetaObject::invokeMethod(this, &QSoundEffectMixer::startSink, Qt::QueuedConnection);
+    }
+}
+
+void QSoundEffectMixer::stop(Client *client)
+{
+    QMutexLocker locker(&m_mutex);
+    for (Voice &voice : m_voices) {
+        if (voice.client == client)
+            voice = {};
+    }
+}
+
+void QSoundEffectMixer::setVolume(Client *client, float volume)
+{
+    QMutexLocker locker(&m_mutex);
+    for (Voice &voice : m_voices) {
+        if (voice.client == client)
+            voice.volume = volume;
+    }
+}
+
+void QSoundEffectMixer::setLoopsRemaining(Client *client, int serial, int loops)
+{
+    QMutexLocker locker(&m_mutex);
+    for (Voice &voice : m_voices) {
+        if (voice.client == client && voice.serial == serial)
+            voice.loopsRemaining = loops;
+    }
+}
+
+int QSoundEffectMixer::voiceCount(Client *client) const
+{
+    QMutexLocker locker(&m_mutex);
+    return std::count_if(m_voices.begin(), m_voices.end(),
+                         [client](const Voice &voice) { return voice.client == client; });
+}
+
+int QSoundEffectMixer::activeVoiceCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return std::count_if(m_voices.begin(), m_voices.end(),
+                         [](const Voice &voice) { return voice.client; });
+}
+
+qint64 QSoundEffectMixer::readData(char *data, qint64 len)
+{
+    const int channelCount = m_format.channelCount();
+    const int bytesPerFrame = m_format.bytesPerFrame();
+    const qint64 frames = len / bytesPerFrame;
+    const qint64 chunkFrames = MixChunkSamples / channelCount;
+
+    std::array<float, MixChunkSamples> mixBuffer;
+
+    QMutexLocker locker(&m_mutex);
+
+    for (qint64 done = 0; done < frames;) {
+        const qint64 chunk = qMin(frames - done, chunkFrames);
+        const qsizetype count = chunk * channelCount;
+        std::fill_n(mixBuffer.begin(), count, 0.f);
+        mix(mixBuffer.data(), chunk);
+
+        QAudioHelperInternal::qConvertFromFloat(1., m_format, mixBuffer.data(),
+                                                data + done * bytesPerFrame, int(count));
+
+        done += chunk;
+    }
+
+    const bool idle = std::none_of(m_voices.begin(), m_voices.end(),
+                                   [](const Voice &voice) { return voice.client; });
+    m_idleFrames = idle ? m_idleFrames + frames : 0;
+    if (m_running && m_idleFrames >= m_format.framesForDuration(IdleDuration)) {
+        m_running = false;
+        QMetaObject::invokeMethod(this, &QSoundEffectMixer::suspendSink, Qt::QueuedConnection);
+    }
+
+    return frames * bytesPerFrame;
+}
+
+void QSoundEffectMixer::mix(float *output, qint64 frames)
+{
+    const int channelCount = m_voiceFormat.channelCount();
+
+    for (Voice &voice : m_voices) {
+        for (qint64 done = 0; voice.client && done < frames;) {
+            const qint64 count = qMin(frames - done, voice.frames - voice.position);
+            const float *in = voice.data + voice.position * channelCount;
+            float *out = output + done * channelCount;
+            for (qint64 i = 0; i < count * channelCount; ++i)
+                out[i] += in[i] * voice.volume;
+
+            done += count;
+            voice.position += count;
+            if (voice.position < voice.frames)
+                continue;
+
+            voice.position = 0;
+            if (voice.loopsRemaining < 0)
+                continue;
+
+            if (--voice.loopsRemaining == 0) {
+                finishVoice(voice);
+            } else {
+                QMetaObject::invokeMethod(
+                        voice.client->context(),
+                        [client = voice.client, serial = voice.serial,
+                         loops = voice.loopsRemaining] { client->voiceLooped(serial, loops); },
+                        Qt::QueuedConnection);
+            }
+        }
+    }
+}
+
+void QSoundEffectMixer::finishVoice(Voice &voice)
+{
+    // the clients stop their voices before they're destroyed, so the posted call
+    // is either delivered or discarded with the context object
+    QMetaObject::invokeMethod(
+            voice.client->context(),
+            [client = voice.client, serial = voice.serial] { client->voiceFinished(serial); },
+            Qt::QueuedConnection);
+    voice = {};
+}
+
+void QSoundEffectMixer::startSink()
+{
+    if (!m_sink) {
+        m_sink = std::make_unique<QAudioSink>(m_device, m_format);
+        m_sink->setBufferSize(m_format.bytesForDuration(BufferDuration));
+        connect(m_sink.get(), &QAudioSink::stateChanged, this, [this](QAudio::State state) {
+            if (state != QAudio::StoppedState)
+                return;
+            qCDebug(qLcSoundEffectMixer) << "Sink stopped; error:" << m_sink->error();
+            QMutexLocker locker(&m_mutex);
+            m_running = false;
+            for (Voice &voice : m_voices) {
+                if (voice.client)
+                    finishVoice(voice);
+            }
+        });
+    }
+
+    switch (m_sink->state()) {
+    case QAudio::SuspendedState:
+        m_sink->resume();
+        break;
+    case QAudio::StoppedState:
+        m_sink->start(this);
+        break;
+    default:
+        break;
+    }
+}
+
+void QSoundEffectMixer::suspendSink()
+{
+    if (m_sink && (m_sink->state() == QAudio::ActiveState || m_sink->state() == QAudio::IdleState))
+        m_sink->suspend();
+}
+
+QT_END_NAMESPACE
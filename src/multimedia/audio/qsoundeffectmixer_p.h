@@ -0,0 +1,130 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QSOUNDEFFECTMIXER_P_H
+#define QSOUNDEFFECTMIXER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include <QtMultimedia/private/qtmultimediaglobal_p.h>
+#include <QtMultimedia/qaudiobuffer.h>
+#include <QtMultimedia/qaudiodevice.h>
+#include <QtMultimedia/qaudioformat.h>
+#include <QtCore/qiodevice.h>
+#include <QtCore/qmutex.h>
+#include <QtCore/qthread.h>
+
+#include <array>
+#include <memory>
+
+QT_BEGIN_NAMESPACE
+
+class QAudioSink;
+
+// Plays the sound effects of an audio device through a single audio sink.
+//
+// The mixer is shared by all sound effects of the device and lives as long as they use it.
+// Each play() starts a voice from a fixed pool; the voices are mixed in float and converted
+// to the format of the sink. If the pool is exhausted, the oldest voice is stopped.
+// The sink runs in a thread of its own and is suspended when no voice plays for a while.
+//
+// The sounds are converted to the format of the voices once, when they're loaded, and
+// the clients keep the converted data alive while their voices play.
+// Set QT_SOUNDEFFECT_DISABLE_MIXER to make each sound effect use an audio sink of its own.
+class Q_MULTIMEDIA_EXPORT QSoundEffectMixer : public QIODevice
+{
+public:
+    static constexpr int MaxVoices = 32;
+
+    // Receives the notifications of its voices in the thread of the context object
+    class Client
+    {
+    public:
+        explicit Client(QObject *context) : m_context(context) { }
+
+        QObject *context() const { return m_context; }
+
+        virtual void voiceLooped(int serial, int loopsRemaining) = 0;
+        virtual void voiceFinished(int serial) = 0;
+
+    protected:
+        ~Client() = default;
+
+    private:
+        QObject *m_context;
+    };
+
+    // Returns null if the mixer is disabled
+    static std::shared_ptr<QSoundEffectMixer> instance(const QAudioDevice &device);
+
+    // Returns the format the sounds of the device are best loaded in: the format of the
+    // voices, or the preferred format of the device if the mixer is disabled
+    static QAudioFormat soundFormat(const QAudioDevice &device);
+
+    explicit QSoundEffectMixer(const QAudioDevice &device);
+    ~QSoundEffectMixer() override;
+
+    // Returns an invalid buffer if the sound cannot be converted to the format of the voices
+    QAudioBuffer convert(const QByteArray &data, const QAudioFormat &format) const;
+
+    // loops < 0 means infinite looping; polyphony limits the voices of the client
+    void play(Client *client, int serial, const QAudioBuffer &sound, int loops, float volume,
+              int polyphony);
+    void stop(Client *client);
+    void setVolume(Client *client, float volume);
+    void setLoopsRemaining(Client *client, int serial, int loops);
+    int voiceCount(Client *client) const;
+    int activeVoiceCount() const;
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *data, qint64 len) override;
+    qint64 writeData(const char *, qint64) override { return 0; }
+
+private:
+    struct Voice
+    {
+        Client *client = nullptr;
+        int serial = 0;
+        const float *data = nullptr;
+        qint64 frames = 0;
+        qint64 position = 0;
+        int loopsRemaining = 0;
+        float volume = 1.f;
+        quint64 startOrder = 0;
+    };
+
+    // called with the mutex locked
+    void mix(float *output, qint64 frames);
+    void finishVoice(Voice &voice);
+
+    // called in the thread of the mixer
+    void startSink();
+    void suspendSink();
+
+    QAudioDevice m_device;
+    QAudioFormat m_format;
+    QAudioFormat m_voiceFormat;
+    QThread m_thread;
+    std::unique_ptr<QAudioSink> m_sink;
+
+    mutable QMutex m_mutex;
+    std::array<Voice, MaxVoices> m_voices;
+    quint64 m_startCounter = 0;
+    qint64 m_idleFrames = 0;
+    bool m_running = false;
+};
+
+QT_END_NAMESPACE
+
+#endif // QSOUNDEFFECTMIXER_P_H
@@ -5,6 +5,8 @@
 
 #include <QtCore/qtimer.h>
 #include <QtCore/qendian.h>
+#include <QtCore/qfiledevice.h>
+#include <private/qaudiohelpers_p.h>
 #include <limits.h>
 #include <qdebug.h>
 
@@ -12,21 +14,33 @@ QT_BEGIN_NAMESPACE
 
 namespace  {
 
+enum WaveFormat : quint16 {
+    WaveFormatPcm = 1,
+    WaveFormatIeeeFloat = 3,
+    WaveFormatExtensible = 0xFFFE,
+};
+
 void bswap2(char *data, qsizetype count) noexcept
 {
     for (qsizetype i = 0; i < count; ++i) {
         qSwap(data[0], data[1]);
-        ++count;
         data += 2;
     }
 }
 
+void bswap3(char *data, qsizetype count) noexcept
+{
+    for (qsizetype i = 0; i < count; ++i) {
+        qSwap(data[0], data[2]);
+        data += 3;
+    }
+}
+
 void bswap4(char *data, qsizetype count) noexcept
 {
     for (qsizetype i = 0; i < count; ++i) {
         qSwap(data[0], data[3]);
         qSwap(data[1], data[2]);
-        ++count;
         data += 4;
     }
 }
@@ -46,7 +60,11 @@ QWaveDecoder::QWaveDecoder(QIODevice *device, const QAudioFormat &format, QObjec
 {
 }
 
-QWaveDecoder::~QWaveDecoder() = default;
+QWaveDecoder::~QWaveDecoder()
+{
+    if (mappedFile && mappedFile->isOpen())
+        mappedFile->unmap(mappedData);
+}
 
 bool QWaveDecoder::open(QIODevice::OpenMode mode)
 {
@@ -115,7 +133,7 @@ qint64 QWaveDecoder::size() const
         if (!haveFormat)
             return 0;
         if (bps == 24)
-            return dataSize*2/3;
+            return dataSize / 3 * 4;
         return dataSize;
     } else {
         return device->size();
@@ -129,7 +147,10 @@ bool QWaveDecoder::isSequential() const
 
 qint64 QWaveDecoder::bytesAvailable() const
 {
-    return haveFormat ? device->bytesAvailable() : 0;
+    if (!haveFormat)
+        return 0;
+    const qint64 available = device->bytesAvailable();
+    return bps == 24 ? available / 3 * 4 : available;
 }
 
 qint64 QWaveDecoder::headerLength()
@@ -143,47 +164,60 @@ qint64 QWaveDecoder::readData(char *data, qint64 maxlen)
     if (!haveFormat || bytesPerSample == 0)
         return 0;
 
-    if (bps == 24) {
-        // 24 bit WAV, read in as 16 bit
-        qint64 l = 0;
-        while (l < maxlen - 1) {
-            char tmp[3];
-            device->read(tmp, 3);
-            if (byteSwap)
-                qSwap(tmp[0], tmp[2]);
-#if Q_BYTE_ORDER == Q_BIG_ENDIAN
-            data[0] = tmp[0];
-            data[1] = tmp[1];
-#else
-            data[0] = tmp[1];
-            data[1] = tmp[2];
-#endif
-            data += 2;
-            l += 2;
+    // 24 bit samples are packed in the file, and expanded to Int32 ones
+    const int packedBytesPerSample = bps / 8;
+    qint64 samples = maxlen / bytesPerSample;
+    if (device->isSequential())
+        samples = qMin(samples, device->bytesAvailable() / packedBytesPerSample);
+
+    // The packed samples are read to the back of the buffer, so that they can be
+    // expanded in place
+    char *packed = data + samples * (bytesPerSample - packedBytesPerSample);
+    const char *source = packed;
+    qint64 read = samples * packedBytesPerSample;
+
+    // qUnpackInt24 takes little endian samples whatever the byte order of the host
+    const bool swap = bps == 24 ? bigEndian : byteSwap;
+
+    const qint64 offset = device->pos() - dataStart;
+    if (mappedFile && mappedFile->isOpen() && offset >= 0 && offset <= mappedSize) {
+        read = qMin(read, mappedSize - offset);
+        device->seek(device->pos() + read);
+        source = reinterpret_cast<const char *>(mappedData) + offset;
+        // only samples that are expanded without swapping can be used from the mapping
+        if (bps != 24 || swap) {
+            memcpy(packed, source, read);
+            source = packed;
         }
-        return l;
+    } else {
+        read = device->read(packed, read);
+        if (read <= 0)
+            return read;
     }
 
-    qint64 nSamples = maxlen / bytesPerSample;
-    maxlen = nSamples * bytesPerSample;
-    int read = device->read(data, maxlen);
-
-    if (!byteSwap || format.bytesPerFrame() == 1)
-        return read;
-
-    nSamples = read / bytesPerSample;
-    switch (bytesPerSample) {
-    case 2:
-        bswap2(data, nSamples);
-        break;
-    case 4:
-        bswap4(data, nSamples);
-        break;
-    default:
-        Q_UNREACHABLE();
+    samples = read / packedBytesPerSample;
+    if (swap) {
+        switch (packedBytesPerSample) {
+        case 1:
+            break;
+        case 2:
+            bswap2(packed, samples);
+            break;
+        case 3:
+            bswap3(packed, samples);
+            break;
+        case 4:
+            bswap4(packed, samples);
+            break;
+        default:
+            Q_UNREACHABLE();
+        }
     }
-    return read;
 
+    if (bps == 24)
+        QAudioHelperInternal::qUnpackInt24(source, reinterpret_cast<qint32 *>(data), int(samples));
+
+    return samples * bytesPerSample;
 }
 
 qint64 QWaveDecoder::writeData(const char *data, qint64 len)
@@ -323,37 +357,38 @@ void QWaveDecoder::handleData()
             WAVEHeader wave;
             device->read(reinterpret_cast<char *>(&wave), sizeof(WAVEHeader));
 
-            if (rawChunkSize > sizeof(WAVEHeader))
-                discardBytes(rawChunkSize - sizeof(WAVEHeader));
+            WAVEFormatExtension extension = {};
+            quint32 headerSize = sizeof(WAVEHeader);
+            if (rawChunkSize >= sizeof(WAVEHeader) + sizeof(WAVEFormatExtension)) {
+                device->read(reinterpret_cast<char *>(&extension), sizeof(WAVEFormatExtension));
+                headerSize += sizeof(WAVEFormatExtension);
+            }
+
+            if (rawChunkSize > headerSize)
+                discardBytes(rawChunkSize - headerSize);
 
             // Swizzle this
-            if (bigEndian) {
-                wave.audioFormat = qFromBigEndian<quint16>(wave.audioFormat);
-            } else {
-                wave.audioFormat = qFromLittleEndian<quint16>(wave.audioFormat);
-            }
+            const auto fromFileEndian = [this](auto value) {
+                return bigEndian ? qFromBigEndian(value) : qFromLittleEndian(value);
+            };
+
+            quint16 audioFormat = fromFileEndian(wave.audioFormat);
+            if (audioFormat == WaveFormatExtensible && headerSize > sizeof(WAVEHeader))
+                audioFormat = quint16(fromFileEndian(extension.subFormat));
 
-            if (wave.audioFormat != 0 && wave.audioFormat != 1) {
-                // 32bit wave files have format == 0xFFFE (WAVE_FORMAT_EXTENSIBLE).
-                // but don't support them at the moment.
+            if (audioFormat != 0 && audioFormat != WaveFormatPcm
+                && audioFormat != WaveFormatIeeeFloat) {
                 parsingFailed();
                 return;
             }
 
-            int rate;
-            int channels;
-            if (bigEndian) {
-                 bps = qFromBigEndian<quint16>(wave.bitsPerSample);
-                 rate = qFromBigEndian<quint32>(wave.sampleRate);
-                 channels = qFromBigEndian<quint16>(wave.numChannels);
-            } else {
-                bps = qFromLittleEndian<quint16>(wave.bitsPerSample);
-                rate = qFromLittleEndian<quint32>(wave.sampleRate);
-                channels = qFromLittleEndian<quint16>(wave.numChannels);
-            }
+            bps = fromFileEndian(wave.bitsPerSample);
+            const int rate = fromFileEndian(wave.sampleRate);
+            const int channels = fromFileEndian(wave.numChannels);
 
+            // 24 bit samples are expanded to Int32 ones, so that they keep their precision
             QAudioFormat::SampleFormat fmt = QAudioFormat::Unknown;
-            switch(bps) {
+            switch (bps) {
             case 8:
                 fmt = QAudioFormat::UInt8;
                 break;
@@ -361,20 +396,23 @@ void QWaveDecoder::handleData()
                 fmt = QAudioFormat::Int16;
                 break;
             case 24:
-                fmt = QAudioFormat::Int16;
+                fmt = QAudioFormat::Int32;
                 break;
             case 32:
-                fmt = QAudioFormat::Int32;
+                fmt = audioFormat == WaveFormatIeeeFloat ? QAudioFormat::Float
+                                                         : QAudioFormat::Int32;
                 break;
             }
+            if (audioFormat == WaveFormatIeeeFloat && fmt != QAudioFormat::Float)
+                fmt = QAudioFormat::Unknown;
             if (fmt == QAudioFormat::Unknown || rate == 0 || channels == 0) {
                 parsingFailed();
                 return;
             }
 
             format.setSampleFormat(fmt);
-            format.setSampleRate(/*qFromBigEndian<quint32>*/(wave.sampleRate));
-            format.setChannelCount(/*qFromBigEndian<quint16>*/(wave.numChannels));
+            format.setSampleRate(rate);
+            format.setChannelCount(channels);
 
             state = QWaveDecoder::WaitingForDataState;
         }
@@ -393,7 +431,10 @@ void QWaveDecoder::handleData()
 
             dataSize = descriptor.size; //means the data size from the data header, not the actual file size
             if (!dataSize)
-                dataSize = device->size() - headerLength();
+                dataSize = qMax<qint64>(0, device->size() - headerLength());
+
+            dataStart = device->pos();
+            mapData();
 
             haveFormat = true;
             connect(device, SIGNAL(readyRead()), SIGNAL(readyRead()));
@@ -492,6 +533,25 @@ void QWaveDecoder::discardBytes(qint64 numBytes)
     }
 }
 
+void QWaveDecoder::mapData()
+{
+    // Local files are read from a mapping, which saves copying the samples through
+    // the buffer of the file, and lets packed samples be expanded from the page cache
+    auto *file = qobject_cast<QFileDevice *>(device);
+    if (!file)
+        return;
+
+    const qint64 size = qMin(dataSize, file->size() - dataStart);
+    if (size <= 0)
+        return;
+
+    mappedData = file->map(dataStart, size);
+    if (mappedData) {
+        mappedFile = file;
+        mappedSize = size;
+    }
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qwavedecoder.cpp"
@@ -5,12 +5,13 @@
 #define WAVEDECODER_H
 
 #include <QtCore/qiodevice.h>
+#include <QtCore/qpointer.h>
 #include <QtMultimedia/qaudioformat.h>
 
 
 QT_BEGIN_NAMESPACE
 
-
+class QFileDevice;
 
 class Q_MULTIMEDIA_EXPORT QWaveDecoder : public QIODevice
 {
@@ -53,6 +54,7 @@ private:
     bool findChunk(const char *chunkId);
     void discardBytes(qint64 numBytes);
     void parsingFailed();
+    void mapData();
 
     enum State {
         InitialState,
@@ -83,6 +85,16 @@ private:
         quint16     bitsPerSample;
     };
 
+    // follows the WAVEHeader if the audio format is WAVE_FORMAT_EXTENSIBLE
+    struct WAVEFormatExtension
+    {
+        quint16     size;
+        quint16     validBitsPerSample;
+        quint32     channelMask;
+        quint32     subFormat; // the first field of the sub format GUID is the audio format
+        char        subFormatGuid[12];
+    };
+
     struct DATAHeader
     {
         chunk       descriptor;
@@ -106,6 +118,10 @@ private:
     bool bigEndian = false;
     bool byteSwap = false;
     int bps = 0;
+    qint64 dataStart = 0;
+    QPointer<QFileDevice> mappedFile;
+    uchar *mappedData = nullptr;
+    qint64 mappedSize = 0;
 };
 
 QT_END_NAMESPACE
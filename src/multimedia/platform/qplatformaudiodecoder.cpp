@@ -3,6 +3,8 @@
 
 #include "qplatformaudiodecoder_p.h"
 #include "qthread.h"
+#include "qeventloop.h"
+#include "qtimer.h"
 
 QT_BEGIN_NAMESPACE
 
@@ -12,6 +14,50 @@ QPlatformAudioDecoder::QPlatformAudioDecoder(QAudioDecoder *parent)
 {
 }
 
+QAudioBuffer QPlatformAudioDecoder::readFrames(qint64 maxFrames)
+{
+    QAudioBuffer buffer = hasRemainingFrames() ? takeRemainingFrames() : read();
+    if (!buffer.isValid() || buffer.frameCount() <= maxFrames)
+        return buffer;
+
+    // Keep the rest of the buffer for the next call
+    const QAudioFormat format = buffer.format();
+    const qsizetype headBytes = format.bytesForFrames(static_cast<qint32>(maxFrames));
+    const char *data = buffer.constData<char>();
+
+    const qint64 startTime = buffer.startTime();
+    const qint64 remainingStartTime = startTime < 0
+            ? -1
+            : startTime + format.durationForFrames(static_cast<qint32>(maxFrames));
+
+    m_remainingFrames = QAudioBuffer(QByteArray(data + headBytes, buffer.byteCount() - headBytes),
+                                     format, remainingStartTime);
+
+    return QAudioBuffer(QByteArray(data, headBytes), format, startTime);
+}
+
+bool QPlatformAudioDecoder::waitForBufferAvailable(QDeadlineTimer deadline)
+{
+    if (bufferAvailable() || !isDecoding() || deadline.hasExpired())
+        return bufferAvailable();
+
+    QEventLoop loop;
+    connect(q, &QAudioDecoder::bufferReady, &loop, &QEventLoop::quit);
+    connect(q, &QAudioDecoder::isDecodingChanged, &loop, &QEventLoop::quit);
+
+    QTimer timer;
+    if (!deadline.isForever()) {
+        timer.setSingleShot(true);
+        timer.setTimerType(Qt::PreciseTimer);
+        connect(&timer, &QTimer::timeout, &loop, &QEventLoop::quit);
+        timer.start(deadline.remainingTimeAsDuration());
+    }
+
+    loop.exec();
+
+    return bufferAvailable();
+}
+
 void QPlatformAudioDecoder::error(int error, const QString &errorString)
 {
     if (error == m_error && errorString == m_errorString)
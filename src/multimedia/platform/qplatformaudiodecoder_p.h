@@ -18,6 +18,7 @@
 #include <QtMultimedia/qaudiodecoder.h>
 
 #include <QtCore/qpair.h>
+#include <QtCore/qdeadlinetimer.h>
 
 #include <QtMultimedia/qaudiobuffer.h>
 #include <QtMultimedia/qaudiodecoder.h>
@@ -46,9 +47,27 @@ public:
     virtual QAudioBuffer read() = 0;
     virtual bool bufferAvailable() const { return m_bufferAvailable; }
 
+    // Returns up to maxFrames of the available frames as one buffer.
+    // By default, returns the next buffer as read() does, and keeps the frames
+    // beyond maxFrames for the next call.
+    virtual QAudioBuffer readFrames(qint64 maxFrames);
+
+    // The frames kept by the default readFrames(), which go before the next buffer
+    bool hasRemainingFrames() const { return m_remainingFrames.isValid(); }
+    QAudioBuffer takeRemainingFrames() { return std::exchange(m_remainingFrames, {}); }
+    void discardRemainingFrames() { m_remainingFrames = {}; }
+
+    // By default, runs a local event loop until a buffer is delivered.
+    virtual bool waitForBufferAvailable(QDeadlineTimer deadline);
+
     virtual qint64 position() const { return m_position; }
     virtual qint64 duration() const { return m_duration; }
 
+    // Seeking and range decoding aren't supported by default
+    virtual void setPosition(qint64 position) { Q_UNUSED(position); }
+    virtual qint64 endPosition() const { return -1; }
+    virtual void setEndPosition(qint64 position) { Q_UNUSED(position); }
+
     void formatChanged(const QAudioFormat &format);
 
     void sourceChanged();
@@ -84,6 +103,7 @@ private:
     QString m_errorString;
     bool m_isDecoding = false;
     bool m_bufferAvailable = false;
+    QAudioBuffer m_remainingFrames;
 };
 
 QT_END_NAMESPACE
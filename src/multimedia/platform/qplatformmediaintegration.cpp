@@ -90,13 +90,16 @@ struct InstanceHolder
         instance.reset(
                 qLoadPlugin<QPlatformMediaIntegration, QPlatformMediaPlugin>(loader(), backend));
 
-        if (!instance) {
+        if (instance) {
+            name = backend;
+        } else {
             qWarning() << "could not load multimedia backend" << backend;
             instance = std::make_unique<QDummyIntegration>();
         }
     }
 
     std::unique_ptr<QPlatformMediaIntegration> instance;
+    QString name;
 };
 
 Q_GLOBAL_STATIC(InstanceHolder, instanceHolder);
@@ -110,6 +113,11 @@ QPlatformMediaIntegration *QPlatformMediaIntegration::instance()
     return instanceHolder->instance.get();
 }
 
+QString QPlatformMediaIntegration::backendName()
+{
+    return instanceHolder->name;
+}
+
 QList<QCameraDevice> QPlatformMediaIntegration::videoInputs()
 {
     auto devices = videoDevices();
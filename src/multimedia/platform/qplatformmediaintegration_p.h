@@ -60,6 +60,9 @@ class Q_MULTIMEDIA_EXPORT QPlatformMediaIntegration
 public:
     static QPlatformMediaIntegration *instance();
 
+    // The name of the loaded backend, e.g. "ffmpeg"; empty if no backend could be loaded.
+    static QString backendName();
+
     QPlatformMediaIntegration();
     virtual ~QPlatformMediaIntegration();
     const QPlatformMediaFormatInfo *formatInfo();
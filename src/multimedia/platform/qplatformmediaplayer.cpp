@@ -6,6 +6,8 @@
 #include "qmediaplayer.h"
 #include "qplatformmediadevices_p.h"
 
+#include <QtCore/qdebug.h>
+
 QT_BEGIN_NAMESPACE
 
 QPlatformMediaPlayer::QPlatformMediaPlayer(QMediaPlayer *parent) : player(parent)
@@ -50,4 +52,31 @@ void *QPlatformMediaPlayer::nativePipeline(QMediaPlayer *player)
     return playerPrivate->control->nativePipeline();
 }
 
+void QPlatformMediaPlayer::setBufferingPolicy(QMediaPlayer *player, const BufferingPolicy &policy)
+{
+    if (!player)
+        return;
+
+    if (!policy.isValid()) {
+        qWarning() << "Ignoring invalid buffering policy, max duration:" << policy.maxDuration
+                   << "max size:" << policy.maxSize
+                   << "watermarks:" << policy.lowWatermark << policy.highWatermark;
+        return;
+    }
+
+    auto playerPrivate = player->d_func();
+    if (playerPrivate && playerPrivate->control)
+        playerPrivate->control->setBufferingPolicy(policy);
+}
+
+void QPlatformMediaPlayer::setPlaybackPriority(QMediaPlayer *player, PlaybackPriority priority)
+{
+    if (!player)
+        return;
+
+    auto playerPrivate = player->d_func();
+    if (playerPrivate && playerPrivate->control)
+        playerPrivate->control->setPlaybackPriority(priority);
+}
+
 QT_END_NAMESPACE
@@ -23,6 +23,8 @@
 #include <QtCore/qpair.h>
 #include <QtCore/private/qglobal_p.h>
 
+#include <chrono>
+
 QT_BEGIN_NAMESPACE
 
 class QMediaStreamsControl;
@@ -39,6 +41,8 @@ public:
 
     virtual qint64 position() const { return m_position; }
     virtual void setPosition(qint64 position) = 0;
+    // backends without keyframe-aware seeking don't distinguish the modes
+    virtual void seek(qint64 position, QMediaPlayer::SeekMode /*mode*/) { setPosition(position); }
 
     virtual float bufferProgress() const = 0;
 
@@ -126,6 +130,47 @@ public:
 
     virtual void *nativePipeline() { return nullptr; }
 
+    // How far ahead the backend reads and buffers the media.
+    // The limits are applied per stream; reading stops once any stream reaches the maximum
+    // duration or size, and resumes when its buffered duration drops to the low watermark.
+    // The media is reported as buffered after a stream reaches the high watermark.
+    struct BufferingPolicy
+    {
+        std::chrono::microseconds maxDuration = std::chrono::seconds(4);
+        qint64 maxSize = 32 * 1024 * 1024;
+        std::chrono::microseconds lowWatermark = maxDuration;
+        std::chrono::microseconds highWatermark = maxDuration;
+
+        bool operator==(const BufferingPolicy &other) const
+        {
+            return maxDuration == other.maxDuration && maxSize == other.maxSize
+                    && lowWatermark == other.lowWatermark && highWatermark == other.highWatermark;
+        }
+        bool operator!=(const BufferingPolicy &other) const { return !(*this == other); }
+
+        // The limits must be positive, and the watermarks must fit into [0, maxDuration]
+        // with the low one not above the high one.
+        bool isValid() const
+        {
+            return maxDuration.count() > 0 && maxSize > 0 && lowWatermark.count() >= 0
+                    && lowWatermark <= highWatermark && highWatermark <= maxDuration;
+        }
+    };
+
+    virtual void setBufferingPolicy(const BufferingPolicy & /*policy*/) { }
+
+    // private API, the purpose is tuning the read-ahead of a particular player
+    static void setBufferingPolicy(QMediaPlayer *player, const BufferingPolicy &policy);
+
+    // The share of the resources a player gets if the backend
+    // distributes them between the players, e.g. the focused player of a video wall.
+    enum class PlaybackPriority { Low, Normal, High };
+
+    virtual void setPlaybackPriority(PlaybackPriority /*priority*/) { }
+
+    // private API, the purpose is prioritizing a player over the others in the process
+    static void setPlaybackPriority(QMediaPlayer *player, PlaybackPriority priority);
+
     // private API, the purpose is getting GstPipeline
     static void *nativePipeline(QMediaPlayer *player);
 
@@ -425,6 +425,19 @@ qreal QMediaPlayer::playbackRate() const
     \value Once Play the media once (the default).
 */
 
+/*!
+    \enum QMediaPlayer::SeekMode
+    \since 6.8
+
+    Defines how seek() trades precision for latency.
+
+    \value AccurateSeek Seek exactly to the requested position. The frames
+        between the preceding key frame and the position are decoded, but not
+        presented.
+    \value FastSeek Seek to the key frame nearest to the requested position,
+        without decoding up to the exact position.
+*/
+
 /*!
     \property QMediaPlayer::loops
 
@@ -564,6 +577,31 @@ void QMediaPlayer::setPosition(qint64 position)
     d->control->setPosition(qMax(position, 0ll));
 }
 
+/*!
+    \since 6.8
+
+    Seeks to \a position, in milliseconds, using the seek \a mode.
+
+    QMediaPlayer::FastSeek moves to the key frame nearest to \a position,
+    which is suitable for scrubbing; the position reported afterwards is the
+    one of the key frame. QMediaPlayer::AccurateSeek is the same as
+    setPosition().
+
+    Backends that cannot seek to key frames always seek accurately.
+
+    \sa SeekMode, setPosition()
+*/
+void QMediaPlayer::seek(qint64 position, QMediaPlayer::SeekMode mode)
+{
+    Q_D(QMediaPlayer);
+
+    if (!d->control)
+        return;
+    if (!d->control->isSeekable())
+        return;
+    d->control->seek(qMax(position, 0ll), mode);
+}
+
 void QMediaPlayer::setPlaybackRate(qreal rate)
 {
     Q_D(QMediaPlayer);
@@ -91,6 +91,13 @@ public:
     };
     Q_ENUM(Loops)
 
+    enum SeekMode
+    {
+        AccurateSeek,
+        FastSeek
+    };
+    Q_ENUM(SeekMode)
+
     explicit QMediaPlayer(QObject *parent = nullptr);
     ~QMediaPlayer();
 
@@ -150,6 +157,7 @@ public Q_SLOTS:
     void stop();
 
     void setPosition(qint64 position);
+    void seek(qint64 position, QMediaPlayer::SeekMode mode);
 
     void setPlaybackRate(qreal rate);
 
@@ -24,8 +24,9 @@ static constexpr uint DefaultBufferLengthMs = 100;
 static void  outputStreamWriteCallback(pa_stream *stream, size_t length, void *userdata)
 {
     Q_UNUSED(stream);
-    Q_UNUSED(userdata);
     qCDebug(qLcPulseAudioOut) << "Write callback:" << length;
+    if (userdata)
+        static_cast<QPulseAudioSink *>(userdata)->streamWriteCallback(length);
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
     pa_threaded_mainloop_signal(pulseEngine->mainloop(), 0);
 }
@@ -143,6 +144,42 @@ QAudio::State QPulseAudioSink::state() const
     return m_stateMachine.state();
 }
 
+void QPulseAudioSink::streamWriteCallback(size_t length)
+{
+    // Called in the thread of the PulseAudio main loop with the main loop locked.
+    // Renders straight into the memory block of the stream, so nothing is allocated here.
+    if (!m_audioCallback || !m_stateMachine.isActiveOrIdle())
+        return;
+
+    const size_t frameSize = pa_frame_size(&m_spec);
+    void *dest = nullptr;
+    size_t nbytes = length;
+    if (pa_stream_begin_write(m_stream, &dest, &nbytes) < 0 || !dest) {
+        m_stateMachine.updateActiveOrIdle(false, QAudio::IOError);
+        return;
+    }
+
+    nbytes = qMin(nbytes, length);
+    nbytes -= nbytes % frameSize;
+    if (nbytes == 0) {
+        pa_stream_cancel_write(m_stream);
+        return;
+    }
+
+    m_audioCallback(QSpan<char>(static_cast<char *>(dest), qsizetype(nbytes)));
+
+    m_volumeRamp.apply(m_volume, m_format, dest, dest, int(nbytes));
+
+    if (pa_stream_write(m_stream, dest, nbytes, nullptr, 0, PA_SEEK_RELATIVE) < 0) {
+        m_stateMachine.updateActiveOrIdle(false, QAudio::IOError);
+        return;
+    }
+
+    // recover from an underrun; the state doesn't change otherwise
+    if (m_stateMachine.state() == QAudio::IdleState)
+        m_stateMachine.activateFromIdle();
+}
+
 void QPulseAudioSink::streamUnderflowCallback()
 {
     if (m_audioSource && m_audioSource->atEnd()) {
@@ -211,11 +248,39 @@ QIODevice *QPulseAudioSink::start()
     return m_audioSource;
 }
 
+bool QPulseAudioSink::start(AudioCallback &&callback)
+{
+    reset();
+
+    m_pullMode = true;
+    m_audioCallback = std::move(callback);
+
+    if (!open()) {
+        m_audioCallback = {};
+        return true;
+    }
+
+    // ensure we only process timing infos that are up to date
+    gettimeofday(&lastTimingInfo, nullptr);
+    lastProcessedUSecs = 0;
+
+    m_stateMachine.start();
+
+    // the requests of the stream that came before the start are served at once
+    QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
+    std::lock_guard lock(*pulseEngine);
+    streamWriteCallback(pa_stream_writable_size(m_stream));
+
+    return true;
+}
+
 bool QPulseAudioSink::open()
 {
     if (m_opened)
         return true;
 
+    m_volumeRamp.reset();
+
     QPulseAudioEngine *pulseEngine = QPulseAudioEngine::instance();
 
     if (!pulseEngine->context() || pa_context_get_state(pulseEngine->context()) != PA_CONTEXT_READY) {
@@ -343,7 +408,8 @@ bool QPulseAudioSink::open()
 
     m_opened = true;
 
-    startReading();
+    if (!m_audioCallback)
+        startReading();
 
     m_elapsedTimeOffset = 0;
 
@@ -387,6 +453,7 @@ void QPulseAudioSink::close()
         }
     }
 
+    m_audioCallback = {};
     m_opened = false;
     m_resuming = false;
     m_audioBuffer.clear();
@@ -476,13 +543,9 @@ qint64 QPulseAudioSink::write(const char *data, qint64 len)
 
     len = qMin(len, qint64(nbytes));
 
-    if (m_volume < 1.0f) {
-        // Don't use PulseAudio volume, as it might affect all other streams of the same category
-        // or even affect the system volume if flat volumes are enabled
-        QAudioHelperInternal::qMultiplySamples(m_volume, m_format, data, dest, len);
-    } else {
-        memcpy(dest, data, len);
-    }
+    // Don't use PulseAudio volume, as it might affect all other streams of the same category
+    // or even affect the system volume if flat volumes are enabled
+    m_volumeRamp.apply(m_volume, m_format, data, dest, len);
 
     data = reinterpret_cast<char *>(dest);
 
@@ -632,9 +695,14 @@ void QPulseAudioSink::resume()
 
             operation.reset(pa_stream_trigger(m_stream, outputStreamSuccessCallback, nullptr));
             pulseEngine->wait(operation.get());
+
+            // the requests that came while suspended were skipped
+            if (m_audioCallback)
+                streamWriteCallback(pa_stream_writable_size(m_stream));
         }
 
-        m_tickTimer.start(m_periodTime, this);
+        if (!m_audioCallback)
+            m_tickTimer.start(m_periodTime, this);
     }
 }
 
@@ -701,7 +769,7 @@ qint64 PulseOutputPrivate::writeData(const char *data, qint64 len)
 
 void QPulseAudioSink::setVolume(qreal vol)
 {
-    if (qFuzzyCompare(m_volume, vol))
+    if (qFuzzyCompare(m_volume.load(), vol))
         return;
 
     m_volume = qBound(qreal(0), vol, qreal(1));
@@ -28,6 +28,7 @@
 
 #include <private/qaudiosystem_p.h>
 #include <private/qaudiostatemachine_p.h>
+#include <private/qaudiohelpers_p.h>
 #include <pulse/pulseaudio.h>
 
 QT_BEGIN_NAMESPACE
@@ -43,6 +44,7 @@ public:
 
     void start(QIODevice *device) override;
     QIODevice *start() override;
+    bool start(AudioCallback &&callback) override;
     void stop() override;
     void reset() override;
     void suspend() override;
@@ -59,6 +61,7 @@ public:
     void setVolume(qreal volume) override;
     qreal volume() const override;
 
+    void streamWriteCallback(size_t length);
     void streamUnderflowCallback();
     void streamDrainedCallback();
 
@@ -91,6 +94,7 @@ private:
     QBasicTimer m_tickTimer;
 
     QIODevice *m_audioSource = nullptr;
+    AudioCallback m_audioCallback;
     pa_stream *m_stream = nullptr;
     std::vector<char> m_audioBuffer;
 
@@ -98,7 +102,8 @@ private:
     qint64 m_elapsedTimeOffset = 0;
     mutable qint64 averageLatency = 0; // average latency
     mutable qint64 lastProcessedUSecs = 0;
-    qreal m_volume = 1.0;
+    std::atomic<qreal> m_volume = 1.0;
+    QAudioHelperInternal::VolumeRamp m_volumeRamp;
 
     std::atomic<pa_operation *> m_drainOperation = nullptr;
     int m_periodSize = 0;
@@ -2,28 +2,61 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "qvideoframeconversionhelper_p.h"
+#include "qvideotexturehelper_p.h"
 #include "qrgb.h"
 
+#include <cmath>
 #include <mutex>
 
 QT_BEGIN_NAMESPACE
 
-#define CLAMP(n) (n > 255 ? 255 : (n < 0 ? 0 : n))
+YUVToRGBCoefficients YUVToRGBCoefficients::fromFormat(const QVideoFrameFormat &format)
+{
+    // The color matrix works on normalized samples. Scale it to 8 bit samples with
+    // 8 fractional bits, the offsets get an additional 0.5 for rounding.
+    const QMatrix4x4 m = QVideoTextureHelper::colorMatrix(format);
+    Q_ASSERT(qFuzzyIsNull(m(0, 1)) && qFuzzyIsNull(m(2, 2)));
+
+    const auto coefficient = [&m](int row, int column) { return qRound(m(row, column) * 256); };
+    const auto offset = [&m](int row) { return qRound(m(row, 3) * 255 * 256) + 128; };
+
+    YUVToRGBCoefficients c;
+    c.yFactor = coefficient(0, 0);
+    c.rv = coefficient(0, 2);
+    c.gu = coefficient(1, 1);
+    c.gv = coefficient(1, 2);
+    c.bu = coefficient(2, 1);
+    c.rOffset = offset(0);
+    c.gOffset = offset(1);
+    c.bOffset = offset(2);
+    return c;
+}
 
-#define EXPAND_UV(u, v) \
-    int uu = u - 128; \
-    int vv = v - 128; \
-    int rv = 409 * vv + 128; \
-    int guv = 100 * uu + 208 * vv + 128; \
-    int bu = 516 * uu + 128; \
+VideoFramePlanes VideoFramePlanes::fromMappedFrame(const QVideoFrame &frame)
+{
+    VideoFramePlanes planes;
+    const auto *description = QVideoTextureHelper::textureDescription(frame.pixelFormat());
+    for (int plane = 0; plane < frame.planeCount(); ++plane) {
+        planes.data[plane] = frame.bits(plane);
+        planes.strides[plane] = frame.bytesPerLine(plane);
+        planes.verticalSubsampling[plane] = description->sizeScale[plane].y;
+    }
+    planes.size = frame.size();
+    planes.format = frame.surfaceFormat();
+    planes.coefficients = YUVToRGBCoefficients::fromFormat(planes.format);
+    return planes;
+}
 
-static inline quint32 qYUVToARGB32(int y, int rv, int guv, int bu, int a = 0xff)
+VideoFramePlanes VideoFramePlanes::lines(int from, int count) const
 {
-    int yy = (y - 16) * 298;
-    return (a << 24)
-            | CLAMP((yy + rv) >> 8) << 16
-            | CLAMP((yy - guv) >> 8) << 8
-            | CLAMP((yy + bu) >> 8);
+    VideoFramePlanes result = *this;
+    for (int plane = 0; plane < 4; ++plane) {
+        Q_ASSERT(from % verticalSubsampling[plane] == 0);
+        if (data[plane])
+            result.data[plane] += qsizetype(from / verticalSubsampling[plane]) * strides[plane];
+    }
+    result.size.setHeight(count);
+    return result;
 }
 
 static inline void planarYUV420_to_ARGB32(const uchar *y, int yStride,
@@ -31,7 +64,8 @@ static inline void planarYUV420_to_ARGB32(const uchar *y, int yStride,
                                           const uchar *v, int vStride,
                                           int uvPixelStride,
                                           quint32 *rgb,
-                                          int width, int height)
+                                          int width, int height,
+                                          const YUVToRGBCoefficients &c)
 {
     height &= ~1;
     quint32 *rgb0 = rgb;
@@ -44,14 +78,14 @@ static inline void planarYUV420_to_ARGB32(const uchar *y, int yStride,
         const uchar *lineV = v;
 
         for (int i = 0; i < width; i += 2) {
-            EXPAND_UV(*lineU, *lineV);
+            EXPAND_UV(c, *lineU, *lineV);
             lineU += uvPixelStride;
             lineV += uvPixelStride;
 
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            *rgb1++ = qYUVToARGB32(*lineY1++, rv, guv, bu);
-            *rgb1++ = qYUVToARGB32(*lineY1++, rv, guv, bu);
+            *rgb0++ = qYUVToARGB32(c, *lineY0++, rv, guv, bu);
+            *rgb0++ = qYUVToARGB32(c, *lineY0++, rv, guv, bu);
+            *rgb1++ = qYUVToARGB32(c, *lineY1++, rv, guv, bu);
+            *rgb1++ = qYUVToARGB32(c, *lineY1++, rv, guv, bu);
         }
 
         y += yStride << 1; // stride * 2
@@ -67,7 +101,8 @@ static inline void planarYUV422_to_ARGB32(const uchar *y, int yStride,
                                           const uchar *v, int vStride,
                                           int uvPixelStride,
                                           quint32 *rgb,
-                                          int width, int height)
+                                          int width, int height,
+                                          const YUVToRGBCoefficients &c)
 {
     quint32 *rgb0 = rgb;
 
@@ -77,12 +112,12 @@ static inline void planarYUV422_to_ARGB32(const uchar *y, int yStride,
         const uchar *lineV = v;
 
         for (int i = 0; i < width; i += 2) {
-            EXPAND_UV(*lineU, *lineV);
+            EXPAND_UV(c, *lineU, *lineV);
             lineU += uvPixelStride;
             lineV += uvPixelStride;
 
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
-            *rgb0++ = qYUVToARGB32(*lineY0++, rv, guv, bu);
+            *rgb0++ = qYUVToARGB32(c, *lineY0++, rv, guv, bu);
+            *rgb0++ = qYUVToARGB32(c, *lineY0++, rv, guv, bu);
         }
 
         y += yStride; // stride * 2
@@ -94,7 +129,7 @@ static inline void planarYUV422_to_ARGB32(const uchar *y, int yStride,
 
 
 
-static void QT_FASTCALL qt_convert_YUV420P_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_YUV420P_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
     planarYUV420_to_ARGB32(plane1, plane1Stride,
@@ -102,10 +137,10 @@ static void QT_FASTCALL qt_convert_YUV420P_to_ARGB32(const QVideoFrame &frame, u
                            plane3, plane3Stride,
                            1,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height, frame.coefficients);
 }
 
-static void QT_FASTCALL qt_convert_YUV422P_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_YUV422P_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
     planarYUV422_to_ARGB32(plane1, plane1Stride,
@@ -113,11 +148,11 @@ static void QT_FASTCALL qt_convert_YUV422P_to_ARGB32(const QVideoFrame &frame, u
                            plane3, plane3Stride,
                            1,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height, frame.coefficients);
 }
 
 
-static void QT_FASTCALL qt_convert_YV12_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_YV12_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
     planarYUV420_to_ARGB32(plane1, plane1Stride,
@@ -125,14 +160,15 @@ static void QT_FASTCALL qt_convert_YV12_to_ARGB32(const QVideoFrame &frame, ucha
                            plane2, plane2Stride,
                            1,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height, frame.coefficients);
 }
 
-static void QT_FASTCALL qt_convert_AYUV_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_AYUV_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
 
+    const YUVToRGBCoefficients &c = frame.coefficients;
     quint32 *rgb = reinterpret_cast<quint32*>(output);
 
     for (int i = 0; i < height; ++i) {
@@ -144,20 +180,21 @@ static void QT_FASTCALL qt_convert_AYUV_to_ARGB32(const QVideoFrame &frame, ucha
             int u = *lineSrc++;
             int v = *lineSrc++;
 
-            EXPAND_UV(u, v);
+            EXPAND_UV(c, u, v);
 
-            *rgb++ = qPremultiply(qYUVToARGB32(y, rv, guv, bu, a));
+            *rgb++ = qPremultiply(qYUVToARGB32(c, y, rv, guv, bu, a));
         }
 
         src += stride;
     }
 }
 
-static void QT_FASTCALL qt_convert_AYUV_Premultiplied_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_AYUV_Premultiplied_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
 
+    const YUVToRGBCoefficients &c = frame.coefficients;
     quint32 *rgb = reinterpret_cast<quint32*>(output);
 
     for (int i = 0; i < height; ++i) {
@@ -169,20 +206,21 @@ static void QT_FASTCALL qt_convert_AYUV_Premultiplied_to_ARGB32(const QVideoFram
             int u = *lineSrc++;
             int v = *lineSrc++;
 
-            EXPAND_UV(u, v);
+            EXPAND_UV(c, u, v);
 
-            *rgb++ = qYUVToARGB32(y, rv, guv, bu, a);
+            *rgb++ = qYUVToARGB32(c, y, rv, guv, bu, a);
         }
 
         src += stride;
     }
 }
 
-static void QT_FASTCALL qt_convert_UYVY_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_UYVY_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 2)
 
+    const YUVToRGBCoefficients &c = frame.coefficients;
     quint32 *rgb = reinterpret_cast<quint32*>(output);
 
     for (int i = 0; i < height; ++i) {
@@ -194,21 +232,22 @@ static void QT_FASTCALL qt_convert_UYVY_to_ARGB32(const QVideoFrame &frame, ucha
             int v = *lineSrc++;
             int y1 = *lineSrc++;
 
-            EXPAND_UV(u, v);
+            EXPAND_UV(c, u, v);
 
-            *rgb++ = qYUVToARGB32(y0, rv, guv, bu);
-            *rgb++ = qYUVToARGB32(y1, rv, guv, bu);
+            *rgb++ = qYUVToARGB32(c, y0, rv, guv, bu);
+            *rgb++ = qYUVToARGB32(c, y1, rv, guv, bu);
         }
 
         src += stride;
     }
 }
 
-static void QT_FASTCALL qt_convert_YUYV_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_YUYV_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 2)
 
+    const YUVToRGBCoefficients &c = frame.coefficients;
     quint32 *rgb = reinterpret_cast<quint32*>(output);
 
     for (int i = 0; i < height; ++i) {
@@ -220,17 +259,17 @@ static void QT_FASTCALL qt_convert_YUYV_to_ARGB32(const QVideoFrame &frame, ucha
             int y1 = *lineSrc++;
             int v = *lineSrc++;
 
-            EXPAND_UV(u, v);
+            EXPAND_UV(c, u, v);
 
-            *rgb++ = qYUVToARGB32(y0, rv, guv, bu);
-            *rgb++ = qYUVToARGB32(y1, rv, guv, bu);
+            *rgb++ = qYUVToARGB32(c, y0, rv, guv, bu);
+            *rgb++ = qYUVToARGB32(c, y1, rv, guv, bu);
         }
 
         src += stride;
     }
 }
 
-static void QT_FASTCALL qt_convert_NV12_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_NV12_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
     planarYUV420_to_ARGB32(plane1, plane1Stride,
@@ -238,10 +277,10 @@ static void QT_FASTCALL qt_convert_NV12_to_ARGB32(const QVideoFrame &frame, ucha
                            plane2 + 1, plane2Stride,
                            2,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height, frame.coefficients);
 }
 
-static void QT_FASTCALL qt_convert_NV21_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_NV21_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
     planarYUV420_to_ARGB32(plane1, plane1Stride,
@@ -249,10 +288,10 @@ static void QT_FASTCALL qt_convert_NV21_to_ARGB32(const QVideoFrame &frame, ucha
                            plane2, plane2Stride,
                            2,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height, frame.coefficients);
 }
 
-static void QT_FASTCALL qt_convert_IMC1_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_IMC1_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
     Q_ASSERT(plane1Stride == plane2Stride);
@@ -263,10 +302,10 @@ static void QT_FASTCALL qt_convert_IMC1_to_ARGB32(const QVideoFrame &frame, ucha
                            plane2, plane2Stride,
                            1,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height, frame.coefficients);
 }
 
-static void QT_FASTCALL qt_convert_IMC2_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_IMC2_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
     Q_ASSERT(plane1Stride == plane2Stride);
@@ -276,10 +315,10 @@ static void QT_FASTCALL qt_convert_IMC2_to_ARGB32(const QVideoFrame &frame, ucha
                            plane2, plane1Stride,
                            1,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height, frame.coefficients);
 }
 
-static void QT_FASTCALL qt_convert_IMC3_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_IMC3_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_TRIPLANAR(frame)
     Q_ASSERT(plane1Stride == plane2Stride);
@@ -290,10 +329,10 @@ static void QT_FASTCALL qt_convert_IMC3_to_ARGB32(const QVideoFrame &frame, ucha
                            plane3, plane3Stride,
                            1,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height, frame.coefficients);
 }
 
-static void QT_FASTCALL qt_convert_IMC4_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_IMC4_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
     Q_ASSERT(plane1Stride == plane2Stride);
@@ -303,12 +342,12 @@ static void QT_FASTCALL qt_convert_IMC4_to_ARGB32(const QVideoFrame &frame, ucha
                            plane2 + (plane1Stride >> 1), plane1Stride,
                            1,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height, frame.coefficients);
 }
 
 
 template<typename Pixel>
-static void QT_FASTCALL qt_convert_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
@@ -342,7 +381,7 @@ static void QT_FASTCALL qt_convert_to_ARGB32(const QVideoFrame &frame, uchar *ou
 }
 
 template<typename Pixel>
-static void QT_FASTCALL qt_convert_premultiplied_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_premultiplied_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
@@ -380,7 +419,8 @@ static inline void planarYUV420_16bit_to_ARGB32(const uchar *y, int yStride,
                                                   const uchar *v, int vStride,
                                                   int uvPixelStride,
                                           quint32 *rgb,
-                                          int width, int height)
+                                          int width, int height,
+                                          const YUVToRGBCoefficients &c)
 {
     height &= ~1;
     quint32 *rgb0 = rgb;
@@ -393,17 +433,17 @@ static inline void planarYUV420_16bit_to_ARGB32(const uchar *y, int yStride,
         const uchar *lineV = v;
 
         for (int i = 0; i < width; i += 2) {
-            EXPAND_UV(*lineU, *lineV);
+            EXPAND_UV(c, *lineU, *lineV);
             lineU += uvPixelStride;
             lineV += uvPixelStride;
 
-            *rgb0++ = qYUVToARGB32(*lineY0, rv, guv, bu);
+            *rgb0++ = qYUVToARGB32(c, *lineY0, rv, guv, bu);
             lineY0 += 2;
-            *rgb0++ = qYUVToARGB32(*lineY0, rv, guv, bu);
+            *rgb0++ = qYUVToARGB32(c, *lineY0, rv, guv, bu);
             lineY0 += 2;
-            *rgb1++ = qYUVToARGB32(*lineY1, rv, guv, bu);
+            *rgb1++ = qYUVToARGB32(c, *lineY1, rv, guv, bu);
             lineY1 += 2;
-            *rgb1++ = qYUVToARGB32(*lineY1, rv, guv, bu);
+            *rgb1++ = qYUVToARGB32(c, *lineY1, rv, guv, bu);
             lineY1 += 2;
         }
 
@@ -415,7 +455,7 @@ static inline void planarYUV420_16bit_to_ARGB32(const uchar *y, int yStride,
     }
 }
 
-static void QT_FASTCALL qt_convert_P016_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_P016_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_BIPLANAR(frame)
     planarYUV420_16bit_to_ARGB32(plane1 + 1, plane1Stride,
@@ -423,12 +463,142 @@ static void QT_FASTCALL qt_convert_P016_to_ARGB32(const QVideoFrame &frame, ucha
                            plane2 + 3, plane2Stride,
                            4,
                            reinterpret_cast<quint32*>(output),
-                           width, height);
+                           width, height, frame.coefficients);
+
+}
+
+namespace {
+
+// Tabulated transfer functions used by the HDR converter, linearly
+// interpolated between the entries.
+struct HdrTransferTables
+{
+    static constexpr int Size = 4096;
+    static constexpr int SRGBSize = 16384; // finer, pow(x, 1/2.2) is steep close to black
+
+    static const HdrTransferTables &instance()
+    {
+        static const HdrTransferTables tables;
+        return tables;
+    }
+
+    template<int N>
+    static float lookup(const float (&table)[N], float x)
+    {
+        x = qBound(0.f, x, 1.f) * (N - 1);
+        const int i = int(x);
+        if (i >= N - 1)
+            return table[N - 1];
+        return table[i] + (x - i) * (table[i + 1] - table[i]);
+    }
+
+    float pqToLinear[Size];
+    float hlgToLinear[Size];
+    float hlgGamma[Size];
+    float sRGBFromLinear[SRGBSize];
+
+private:
+    HdrTransferTables()
+    {
+        for (int i = 0; i < Size; ++i) {
+            const float x = float(i) / (Size - 1);
+            pqToLinear[i] = QVideoTextureHelper::convertPQToLinear(x);
+            hlgToLinear[i] = QVideoTextureHelper::convertHLGToLinear(x);
+            hlgGamma[i] = powf(x, 0.2f); // gamma - 1 with gamma = 1.2
+        }
+        for (int i = 0; i < SRGBSize; ++i)
+            sRGBFromLinear[i] = powf(float(i) / (SRGBSize - 1), 1.f / 2.2f);
+    }
+};
+
+// see hdrtonemapper.glsl
+float tonemapScaleForLuminosity(float y, float masteringWhite, float maxLum)
+{
+    float p = y / masteringWhite;
+    const float ks = 1.5f * maxLum - 0.5f;
+    if (p < ks)
+        return 1.f;
+
+    const float t = (p - ks) / (1 - ks);
+    const float t2 = t * t;
+    const float t3 = t * t2;
+    p = (2 * t3 - 3 * t2 + 1) * ks + (t3 - 2 * t2 + t) * (1.f - ks) + (-2 * t3 + 3 * t2) * maxLum;
+
+    return p * masteringWhite / y;
+}
+
+} // namespace
+
+// CPU counterpart of the nv12_bt2020_pq and nv12_bt2020_hlg shaders: color matrix,
+// BT.2390 tone mapping to SDR, linearization, Rec.2020 to sRGB and sRGB encoding.
+static void QT_FASTCALL qt_convert_P016_HDR_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
+{
+    FETCH_INFO_BIPLANAR(frame)
+    const HdrTransferTables &tables = HdrTransferTables::instance();
+    const bool hlg = frame.format.colorTransfer() == QVideoFrameFormat::ColorTransfer_STD_B67;
+    const QMatrix4x4 m = QVideoTextureHelper::colorMatrix(frame.format);
+    const auto toneMapping = QVideoTextureHelper::toneMappingRange(frame.format);
+
+    // The tone mapping scale only depends on Y, tabulate it by its 10 most significant bits
+    constexpr int ToneMapBits = 10;
+    float toneMapScale[1 << ToneMapBits];
+    for (int i = 0; i < (1 << ToneMapBits); ++i) {
+        const float Y = (i + 0.5f) / (1 << ToneMapBits);
+        const float y = (Y - 16.f / 256.f) * 256.f / 219.f; // Video range (16...235)
+        toneMapScale[i] = tonemapScaleForLuminosity(y, toneMapping.masteringWhite, toneMapping.maxLum);
+    }
+
+    const auto toRGB = [&](int Y, float ruv, float guv, float buv) -> quint32 {
+        const float y = Y / 65535.f;
+        const float scale = toneMapScale[Y >> (16 - ToneMapBits)];
+        float r = (m(0, 0) * y + ruv) * scale;
+        float g = (m(1, 0) * y + guv) * scale;
+        float b = (m(2, 0) * y + buv) * scale;
+
+        if (hlg) {
+            r = HdrTransferTables::lookup(tables.hlgToLinear, r);
+            g = HdrTransferTables::lookup(tables.hlgToLinear, g);
+            b = HdrTransferTables::lookup(tables.hlgToLinear, b);
+            const float lum = 0.2627f * r + 0.6780f * g + 0.0593f * b;
+            const float factor = HdrTransferTables::lookup(tables.hlgGamma, lum) * toneMapping.maxLum;
+            r *= factor;
+            g *= factor;
+            b *= factor;
+        } else {
+            r = HdrTransferTables::lookup(tables.pqToLinear, r);
+            g = HdrTransferTables::lookup(tables.pqToLinear, g);
+            b = HdrTransferTables::lookup(tables.pqToLinear, b);
+        }
+
+        // Rec.2020 to sRGB, see colorconvert.glsl
+        const float sr = 1.6605f * r - 0.5876f * g - 0.0728f * b;
+        const float sg = -0.1246f * r + 1.1329f * g - 0.0083f * b;
+        const float sb = -0.0182f * r - 0.1006f * g + 1.1187f * b;
+
+        return 0xff000000
+                | qRound(HdrTransferTables::lookup(tables.sRGBFromLinear, sr) * 255.f) << 16
+                | qRound(HdrTransferTables::lookup(tables.sRGBFromLinear, sg) * 255.f) << 8
+                | qRound(HdrTransferTables::lookup(tables.sRGBFromLinear, sb) * 255.f);
+    };
 
+    quint32 *rgb = reinterpret_cast<quint32 *>(output);
+    for (int j = 0; j < height; ++j) {
+        const quint16 *lineY = reinterpret_cast<const quint16 *>(plane1 + j * plane1Stride);
+        const quint16 *lineUV = reinterpret_cast<const quint16 *>(plane2 + (j >> 1) * plane2Stride);
+
+        for (int i = 0; i < width; ++i) {
+            const float u = lineUV[(i & ~1)] / 65535.f;
+            const float v = lineUV[(i & ~1) + 1] / 65535.f;
+            *rgb++ = toRGB(lineY[i],
+                           m(0, 1) * u + m(0, 2) * v + m(0, 3),
+                           m(1, 1) * u + m(1, 2) * v + m(1, 3),
+                           m(2, 1) * u + m(2, 2) * v + m(2, 3));
+        }
+    }
 }
 
 template <typename Y>
-static void QT_FASTCALL qt_convert_Y_to_ARGB32(const QVideoFrame &frame, uchar *output)
+static void QT_FASTCALL qt_convert_Y_to_ARGB32(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, (int)sizeof(Y))
@@ -509,11 +679,19 @@ static std::once_flag InitFuncsAsmFlag;
 static void qInitFuncsAsm()
 {
 #ifdef QT_COMPILER_SUPPORTS_SSE2
-    extern void QT_FASTCALL  qt_convert_ARGB8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_ARGB8888_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output);
     extern void QT_FASTCALL  qt_copy_pixels_with_mask_sse2(uint32_t * dst, const uint32_t *src, size_t size, uint32_t mask);
+    extern void QT_FASTCALL  qt_convert_YUV420P_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YUV422P_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YV12_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_UYVY_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YUYV_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_NV12_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_NV21_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_P016_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output);
 
     if (qCpuHasFeature(SSE2)){
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888] = qt_convert_ARGB8888_to_ARGB32_sse2;
@@ -526,15 +704,24 @@ static void qInitFuncsAsm()
         qConvertFuncs[QVideoFrameFormat::Format_XBGR8888] = qt_convert_ABGR8888_to_ARGB32_sse2;
         qConvertFuncs[QVideoFrameFormat::Format_RGBA8888] = qt_convert_RGBA8888_to_ARGB32_sse2;
         qConvertFuncs[QVideoFrameFormat::Format_RGBX8888] = qt_convert_RGBA8888_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_YUV420P] = qt_convert_YUV420P_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_YUV422P] = qt_convert_YUV422P_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_YV12] = qt_convert_YV12_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_UYVY] = qt_convert_UYVY_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_YUYV] = qt_convert_YUYV_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_NV12] = qt_convert_NV12_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_NV21] = qt_convert_NV21_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_P010] = qt_convert_P016_to_ARGB32_sse2;
+        qConvertFuncs[QVideoFrameFormat::Format_P016] = qt_convert_P016_to_ARGB32_sse2;
 
         qPixelsCopyFunc = qt_copy_pixels_with_mask_sse2;
     }
 #endif
 #ifdef QT_COMPILER_SUPPORTS_SSSE3
-    extern void QT_FASTCALL  qt_convert_ARGB8888_to_ARGB32_ssse3(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_ssse3(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_ssse3(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_ssse3(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_ARGB8888_to_ARGB32_ssse3(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_ssse3(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_ssse3(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_ssse3(const VideoFramePlanes &frame, uchar *output);
     if (qCpuHasFeature(SSSE3)){
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888] = qt_convert_ARGB8888_to_ARGB32_ssse3;
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888_Premultiplied] = qt_convert_ARGB8888_to_ARGB32_ssse3;
@@ -549,11 +736,19 @@ static void qInitFuncsAsm()
     }
 #endif
 #ifdef QT_COMPILER_SUPPORTS_AVX2
-    extern void QT_FASTCALL  qt_convert_ARGB8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
-    extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_ARGB8888_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_ABGR8888_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_RGBA8888_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_BGRA8888_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output);
     extern void QT_FASTCALL  qt_copy_pixels_with_mask_avx2(uint32_t * dst, const uint32_t *src, size_t size, uint32_t mask);
+    extern void QT_FASTCALL  qt_convert_YUV420P_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YUV422P_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YV12_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_UYVY_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YUYV_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_NV12_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_NV21_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_P016_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output);
     if (qCpuHasFeature(AVX2)){
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888] = qt_convert_ARGB8888_to_ARGB32_avx2;
         qConvertFuncs[QVideoFrameFormat::Format_ARGB8888_Premultiplied] = qt_convert_ARGB8888_to_ARGB32_avx2;
@@ -565,16 +760,53 @@ static void qInitFuncsAsm()
         qConvertFuncs[QVideoFrameFormat::Format_XBGR8888] = qt_convert_ABGR8888_to_ARGB32_avx2;
         qConvertFuncs[QVideoFrameFormat::Format_RGBA8888] = qt_convert_RGBA8888_to_ARGB32_avx2;
         qConvertFuncs[QVideoFrameFormat::Format_RGBX8888] = qt_convert_RGBA8888_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_YUV420P] = qt_convert_YUV420P_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_YUV422P] = qt_convert_YUV422P_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_YV12] = qt_convert_YV12_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_UYVY] = qt_convert_UYVY_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_YUYV] = qt_convert_YUYV_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_NV12] = qt_convert_NV12_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_NV21] = qt_convert_NV21_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_P010] = qt_convert_P016_to_ARGB32_avx2;
+        qConvertFuncs[QVideoFrameFormat::Format_P016] = qt_convert_P016_to_ARGB32_avx2;
 
         qPixelsCopyFunc = qt_copy_pixels_with_mask_avx2;
     }
 #endif
+#if defined(QT_COMPILER_SUPPORTS_NEON) && Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    extern void QT_FASTCALL  qt_convert_YUV420P_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YUV422P_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YV12_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_UYVY_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_YUYV_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_NV12_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_NV21_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output);
+    extern void QT_FASTCALL  qt_convert_P016_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output);
+    if (qCpuHasFeature(NEON)) {
+        qConvertFuncs[QVideoFrameFormat::Format_YUV420P] = qt_convert_YUV420P_to_ARGB32_neon;
+        qConvertFuncs[QVideoFrameFormat::Format_YUV422P] = qt_convert_YUV422P_to_ARGB32_neon;
+        qConvertFuncs[QVideoFrameFormat::Format_YV12] = qt_convert_YV12_to_ARGB32_neon;
+        qConvertFuncs[QVideoFrameFormat::Format_UYVY] = qt_convert_UYVY_to_ARGB32_neon;
+        qConvertFuncs[QVideoFrameFormat::Format_YUYV] = qt_convert_YUYV_to_ARGB32_neon;
+        qConvertFuncs[QVideoFrameFormat::Format_NV12] = qt_convert_NV12_to_ARGB32_neon;
+        qConvertFuncs[QVideoFrameFormat::Format_NV21] = qt_convert_NV21_to_ARGB32_neon;
+        qConvertFuncs[QVideoFrameFormat::Format_P010] = qt_convert_P016_to_ARGB32_neon;
+        qConvertFuncs[QVideoFrameFormat::Format_P016] = qt_convert_P016_to_ARGB32_neon;
+    }
+#endif
 }
 
-VideoFrameConvertFunc qConverterForFormat(QVideoFrameFormat::PixelFormat format)
+VideoFrameConvertFunc qConverterForFormat(QVideoFrameFormat::PixelFormat format,
+                                          QVideoFrameFormat::ColorTransfer colorTransfer)
 {
     std::call_once(InitFuncsAsmFlag, &qInitFuncsAsm);
 
+    if (format == QVideoFrameFormat::Format_P010 || format == QVideoFrameFormat::Format_P016) {
+        if (colorTransfer == QVideoFrameFormat::ColorTransfer_ST2084
+            || colorTransfer == QVideoFrameFormat::ColorTransfer_STD_B67)
+            return qt_convert_P016_HDR_to_ARGB32;
+    }
+
     VideoFrameConvertFunc convert = qConvertFuncs[format];
     return convert;
 }
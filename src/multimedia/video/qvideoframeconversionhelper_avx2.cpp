@@ -10,7 +10,7 @@ QT_BEGIN_NAMESPACE
 namespace  {
 
 template<int a, int r, int g, int b>
-void convert_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output)
+void convert_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
@@ -73,22 +73,22 @@ void convert_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output)
 }
 
 
-void QT_FASTCALL qt_convert_ARGB8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_ARGB8888_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output)
 {
     convert_to_ARGB32_avx2<0, 1, 2, 3>(frame, output);
 }
 
-void QT_FASTCALL qt_convert_ABGR8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_ABGR8888_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output)
 {
     convert_to_ARGB32_avx2<0, 3, 2, 1>(frame, output);
 }
 
-void QT_FASTCALL qt_convert_RGBA8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_RGBA8888_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output)
 {
     convert_to_ARGB32_avx2<3, 0, 1, 2>(frame, output);
 }
 
-void QT_FASTCALL qt_convert_BGRA8888_to_ARGB32_avx2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_BGRA8888_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output)
 {
     convert_to_ARGB32_avx2<3, 2, 1, 0>(frame, output);
 }
@@ -130,6 +130,195 @@ void QT_FASTCALL qt_copy_pixels_with_mask_avx2(uint32_t *dst, const uint32_t *sr
         *(dst++) = *(src++) | mask;
 }
 
+namespace {
+
+inline __m256i coefficientPairs_avx2(short first, short second)
+{
+    return _mm256_set1_epi32(int(quint32(quint16(second)) << 16 | quint16(first)));
+}
+
+// Coefficients for the interleaved (y, v), (y, u) and (v, 0) pairs
+struct YUVCoefficients_avx2
+{
+    explicit YUVCoefficients_avx2(const YUVToRGBCoefficients &c)
+        : r(coefficientPairs_avx2(c.yFactor, c.rv)),
+          g(coefficientPairs_avx2(c.yFactor, c.gu)),
+          gv(coefficientPairs_avx2(c.gv, 0)),
+          b(coefficientPairs_avx2(c.yFactor, c.bu)),
+          rOffset(_mm256_set1_epi32(c.rOffset)),
+          gOffset(_mm256_set1_epi32(c.gOffset)),
+          bOffset(_mm256_set1_epi32(c.bOffset))
+    {
+    }
+
+    __m256i r, g, gv, b;
+    __m256i rOffset, gOffset, bOffset;
+};
+
+// Converts 16 pixels. y holds 16 luma samples, uv 8 interleaved U/V pairs,
+// all zero extended to 16 bit. Matches qYUVToARGB32() bit for bit.
+inline void yuvToArgb32_avx2(__m256i y, __m256i uv, quint32 *rgb, const YUVCoefficients_avx2 &k)
+{
+    // duplicate each chroma sample for the two pixels sharing it
+    const __m256i lowWords = _mm256_set1_epi32(0x0000ffff);
+    const __m256i u = _mm256_or_si256(_mm256_and_si256(uv, lowWords), _mm256_slli_epi32(uv, 16));
+    const __m256i v = _mm256_or_si256(_mm256_andnot_si256(lowWords, uv), _mm256_srli_epi32(uv, 16));
+    const __m256i zero = _mm256_setzero_si256();
+
+    // unpacking works per 128 bit lane, so the low halves hold pixels 0-3 and 8-11
+    const __m256i yvLo = _mm256_unpacklo_epi16(y, v);
+    const __m256i yvHi = _mm256_unpackhi_epi16(y, v);
+    const __m256i yuLo = _mm256_unpacklo_epi16(y, u);
+    const __m256i yuHi = _mm256_unpackhi_epi16(y, u);
+
+    auto toInt16 = [](__m256i lo, __m256i hi) {
+        return _mm256_packs_epi32(_mm256_srai_epi32(lo, 8), _mm256_srai_epi32(hi, 8));
+    };
+
+    const __m256i r = toInt16(_mm256_add_epi32(_mm256_madd_epi16(yvLo, k.r), k.rOffset),
+                              _mm256_add_epi32(_mm256_madd_epi16(yvHi, k.r), k.rOffset));
+    const __m256i b = toInt16(_mm256_add_epi32(_mm256_madd_epi16(yuLo, k.b), k.bOffset),
+                              _mm256_add_epi32(_mm256_madd_epi16(yuHi, k.b), k.bOffset));
+    const __m256i g = toInt16(
+            _mm256_add_epi32(
+                    _mm256_add_epi32(_mm256_madd_epi16(yuLo, k.g),
+                                     _mm256_madd_epi16(_mm256_unpacklo_epi16(v, zero), k.gv)),
+                    k.gOffset),
+            _mm256_add_epi32(
+                    _mm256_add_epi32(_mm256_madd_epi16(yuHi, k.g),
+                                     _mm256_madd_epi16(_mm256_unpackhi_epi16(v, zero), k.gv)),
+                    k.gOffset));
+
+    // saturate to 8 bit and interleave to B, G, R, A bytes
+    const __m256i br = _mm256_packus_epi16(b, r);
+    const __m256i ga = _mm256_packus_epi16(g, _mm256_set1_epi16(0xff));
+    const __m256i bg = _mm256_unpacklo_epi8(br, ga);
+    const __m256i ra = _mm256_unpackhi_epi8(br, ga);
+    const __m256i pixelsLo = _mm256_unpacklo_epi16(bg, ra); // pixels 0-3, 8-11
+    const __m256i pixelsHi = _mm256_unpackhi_epi16(bg, ra); // pixels 4-7, 12-15
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(rgb),
+                        _mm256_permute2x128_si256(pixelsLo, pixelsHi, 0x20));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(rgb + 8),
+                        _mm256_permute2x128_si256(pixelsLo, pixelsHi, 0x31));
+}
+
+struct YUVKernels_avx2
+{
+    static void planarLine(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb,
+                           int width, const YUVToRGBCoefficients &c)
+    {
+        const YUVCoefficients_avx2 k(c);
+        int x = 0;
+        for (; x < width - 15; x += 16) {
+            const __m128i yData = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x));
+            const __m128i uvData = _mm_unpacklo_epi8(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i *>(u + x / 2)),
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i *>(v + x / 2)));
+            yuvToArgb32_avx2(_mm256_cvtepu8_epi16(yData), _mm256_cvtepu8_epi16(uvData), rgb + x, k);
+        }
+        qt_convert_YUV_to_ARGB32_tail(y, 1, u, v, 1, rgb, x, width, c);
+    }
+
+    template<bool swapUV>
+    static void semiPlanarLine(const uchar *y, const uchar *uv, quint32 *rgb, int width,
+                               const YUVToRGBCoefficients &c)
+    {
+        const YUVCoefficients_avx2 k(c);
+        int x = 0;
+        for (; x < width - 15; x += 16) {
+            const __m128i yData = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + x));
+            __m256i uvData = _mm256_cvtepu8_epi16(
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + x)));
+            if constexpr (swapUV) {
+                uvData = _mm256_shufflelo_epi16(uvData, _MM_SHUFFLE(2, 3, 0, 1));
+                uvData = _mm256_shufflehi_epi16(uvData, _MM_SHUFFLE(2, 3, 0, 1));
+            }
+            yuvToArgb32_avx2(_mm256_cvtepu8_epi16(yData), uvData, rgb + x, k);
+        }
+        qt_convert_YUV_to_ARGB32_tail(y, 1, swapUV ? uv + 1 : uv, swapUV ? uv : uv + 1, 2, rgb,
+                                      x, width, c);
+    }
+
+    static void semiPlanar16Line(const uchar *y, const uchar *uv, quint32 *rgb, int width,
+                                 const YUVToRGBCoefficients &c)
+    {
+        const YUVCoefficients_avx2 k(c);
+        int x = 0;
+        for (; x < width - 15; x += 16) {
+            const __m256i yData =
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + 2 * x));
+            const __m256i uvData =
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(uv + 2 * x));
+            yuvToArgb32_avx2(_mm256_srli_epi16(yData, 8), _mm256_srli_epi16(uvData, 8), rgb + x, k);
+        }
+        qt_convert_YUV_to_ARGB32_tail(y + 1, 2, uv + 1, uv + 3, 4, rgb, x, width, c);
+    }
+
+    template<bool uyvy>
+    static void packedLine(const uchar *src, quint32 *rgb, int width,
+                           const YUVToRGBCoefficients &c)
+    {
+        const YUVCoefficients_avx2 k(c);
+        const __m256i lowBytes = _mm256_set1_epi16(0xff);
+        int x = 0;
+        for (; x < width - 15; x += 16) {
+            const __m256i data =
+                    _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + 2 * x));
+            const __m256i even = _mm256_and_si256(data, lowBytes);
+            const __m256i odd = _mm256_srli_epi16(data, 8);
+            yuvToArgb32_avx2(uyvy ? odd : even, uyvy ? even : odd, rgb + x, k);
+        }
+        if constexpr (uyvy)
+            qt_convert_YUV_to_ARGB32_tail(src + 1, 2, src, src + 2, 4, rgb, x, width, c);
+        else
+            qt_convert_YUV_to_ARGB32_tail(src, 2, src + 1, src + 3, 4, rgb, x, width, c);
+    }
+};
+
+using YUVConverter_avx2 = YUVToARGB32Converter<YUVKernels_avx2>;
+
+} // namespace
+
+void QT_FASTCALL qt_convert_YUV420P_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_avx2::convertYUV420P(frame, output);
+}
+
+void QT_FASTCALL qt_convert_YUV422P_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_avx2::convertYUV422P(frame, output);
+}
+
+void QT_FASTCALL qt_convert_YV12_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_avx2::convertYV12(frame, output);
+}
+
+void QT_FASTCALL qt_convert_UYVY_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_avx2::convertUYVY(frame, output);
+}
+
+void QT_FASTCALL qt_convert_YUYV_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_avx2::convertYUYV(frame, output);
+}
+
+void QT_FASTCALL qt_convert_NV12_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_avx2::convertNV12(frame, output);
+}
+
+void QT_FASTCALL qt_convert_NV21_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_avx2::convertNV21(frame, output);
+}
+
+void QT_FASTCALL qt_convert_P016_to_ARGB32_avx2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_avx2::convertP016(frame, output);
+}
+
 QT_END_NAMESPACE
 
 #endif
@@ -0,0 +1,169 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qvideoframeconversionhelper_p.h"
+
+#if defined(QT_COMPILER_SUPPORTS_NEON) && Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+
+QT_BEGIN_NAMESPACE
+
+namespace {
+
+// Converts 8 pixels, u and v hold one (duplicated) chroma sample per pixel.
+// Matches qYUVToARGB32() bit for bit.
+inline void yuvToArgb32_neon(uint8x8_t y, uint8x8_t u, uint8x8_t v, quint32 *rgb,
+                             const YUVToRGBCoefficients &c)
+{
+    const int16x8_t yy = vreinterpretq_s16_u16(vmovl_u8(y));
+    const int16x8_t uu = vreinterpretq_s16_u16(vmovl_u8(u));
+    const int16x8_t vv = vreinterpretq_s16_u16(vmovl_u8(v));
+
+    const int32x4_t yLo = vmull_n_s16(vget_low_s16(yy), int16_t(c.yFactor));
+    const int32x4_t yHi = vmull_n_s16(vget_high_s16(yy), int16_t(c.yFactor));
+
+    const int32x4_t rOffset = vdupq_n_s32(c.rOffset);
+    const int32x4_t gOffset = vdupq_n_s32(c.gOffset);
+    const int32x4_t bOffset = vdupq_n_s32(c.bOffset);
+
+    const int32x4_t rLo = vmlal_n_s16(vaddq_s32(yLo, rOffset), vget_low_s16(vv), int16_t(c.rv));
+    const int32x4_t rHi = vmlal_n_s16(vaddq_s32(yHi, rOffset), vget_high_s16(vv), int16_t(c.rv));
+    const int32x4_t gLo =
+            vmlal_n_s16(vmlal_n_s16(vaddq_s32(yLo, gOffset), vget_low_s16(uu), int16_t(c.gu)),
+                        vget_low_s16(vv), int16_t(c.gv));
+    const int32x4_t gHi =
+            vmlal_n_s16(vmlal_n_s16(vaddq_s32(yHi, gOffset), vget_high_s16(uu), int16_t(c.gu)),
+                        vget_high_s16(vv), int16_t(c.gv));
+    const int32x4_t bLo = vmlal_n_s16(vaddq_s32(yLo, bOffset), vget_low_s16(uu), int16_t(c.bu));
+    const int32x4_t bHi = vmlal_n_s16(vaddq_s32(yHi, bOffset), vget_high_s16(uu), int16_t(c.bu));
+
+    auto toUInt8 = [](int32x4_t lo, int32x4_t hi) {
+        return vqmovun_s16(vcombine_s16(vshrn_n_s32(lo, 8), vshrn_n_s32(hi, 8)));
+    };
+
+    uint8x8x4_t pixels;
+    pixels.val[0] = toUInt8(bLo, bHi);
+    pixels.val[1] = toUInt8(gLo, gHi);
+    pixels.val[2] = toUInt8(rLo, rHi);
+    pixels.val[3] = vdup_n_u8(0xff);
+    vst4_u8(reinterpret_cast<uint8_t *>(rgb), pixels);
+}
+
+// Converts 16 pixels from 16 luma samples and 8 samples of each chroma component
+inline void yuvToArgb32x16_neon(uint8x16_t y, uint8x8_t u, uint8x8_t v, quint32 *rgb,
+                                const YUVToRGBCoefficients &c)
+{
+    const uint8x8x2_t u2 = vzip_u8(u, u);
+    const uint8x8x2_t v2 = vzip_u8(v, v);
+    yuvToArgb32_neon(vget_low_u8(y), u2.val[0], v2.val[0], rgb, c);
+    yuvToArgb32_neon(vget_high_u8(y), u2.val[1], v2.val[1], rgb + 8, c);
+}
+
+struct YUVKernels_neon
+{
+    static void planarLine(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb,
+                           int width, const YUVToRGBCoefficients &c)
+    {
+        int x = 0;
+        for (; x < width - 15; x += 16) {
+            yuvToArgb32x16_neon(vld1q_u8(y + x), vld1_u8(u + x / 2), vld1_u8(v + x / 2), rgb + x,
+                                c);
+        }
+        qt_convert_YUV_to_ARGB32_tail(y, 1, u, v, 1, rgb, x, width, c);
+    }
+
+    template<bool swapUV>
+    static void semiPlanarLine(const uchar *y, const uchar *uv, quint32 *rgb, int width,
+                               const YUVToRGBCoefficients &c)
+    {
+        int x = 0;
+        for (; x < width - 15; x += 16) {
+            const uint8x8x2_t uvData = vld2_u8(uv + x);
+            yuvToArgb32x16_neon(vld1q_u8(y + x), uvData.val[swapUV ? 1 : 0],
+                                uvData.val[swapUV ? 0 : 1], rgb + x, c);
+        }
+        qt_convert_YUV_to_ARGB32_tail(y, 1, swapUV ? uv + 1 : uv, swapUV ? uv : uv + 1, 2, rgb,
+                                      x, width, c);
+    }
+
+    static void semiPlanar16Line(const uchar *y, const uchar *uv, quint32 *rgb, int width,
+                                 const YUVToRGBCoefficients &c)
+    {
+        int x = 0;
+        for (; x < width - 15; x += 16) {
+            const uint16_t *y16 = reinterpret_cast<const uint16_t *>(y + 2 * x);
+            const uint8x16_t yData = vcombine_u8(vshrn_n_u16(vld1q_u16(y16), 8),
+                                                 vshrn_n_u16(vld1q_u16(y16 + 8), 8));
+            const uint16x8x2_t uvData = vld2q_u16(reinterpret_cast<const uint16_t *>(uv + 2 * x));
+            yuvToArgb32x16_neon(yData, vshrn_n_u16(uvData.val[0], 8),
+                                vshrn_n_u16(uvData.val[1], 8), rgb + x, c);
+        }
+        qt_convert_YUV_to_ARGB32_tail(y + 1, 2, uv + 1, uv + 3, 4, rgb, x, width, c);
+    }
+
+    template<bool uyvy>
+    static void packedLine(const uchar *src, quint32 *rgb, int width,
+                           const YUVToRGBCoefficients &c)
+    {
+        int x = 0;
+        for (; x < width - 15; x += 16) {
+            // YUYV deinterleaves to y0, u, y1, v; UYVY to u, y0, v, y1
+            const uint8x8x4_t data = vld4_u8(src + 2 * x);
+            const uint8x8x2_t yData = uyvy ? vzip_u8(data.val[1], data.val[3])
+                                           : vzip_u8(data.val[0], data.val[2]);
+            yuvToArgb32x16_neon(vcombine_u8(yData.val[0], yData.val[1]),
+                                data.val[uyvy ? 0 : 1], data.val[uyvy ? 2 : 3], rgb + x, c);
+        }
+        if constexpr (uyvy)
+            qt_convert_YUV_to_ARGB32_tail(src + 1, 2, src, src + 2, 4, rgb, x, width, c);
+        else
+            qt_convert_YUV_to_ARGB32_tail(src, 2, src + 1, src + 3, 4, rgb, x, width, c);
+    }
+};
+
+using YUVConverter_neon = YUVToARGB32Converter<YUVKernels_neon>;
+
+} // namespace
+
+void QT_FASTCALL qt_convert_YUV420P_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_neon::convertYUV420P(frame, output);
+}
+
+void QT_FASTCALL qt_convert_YUV422P_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_neon::convertYUV422P(frame, output);
+}
+
+void QT_FASTCALL qt_convert_YV12_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_neon::convertYV12(frame, output);
+}
+
+void QT_FASTCALL qt_convert_UYVY_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_neon::convertUYVY(frame, output);
+}
+
+void QT_FASTCALL qt_convert_YUYV_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_neon::convertYUYV(frame, output);
+}
+
+void QT_FASTCALL qt_convert_NV12_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_neon::convertNV12(frame, output);
+}
+
+void QT_FASTCALL qt_convert_NV21_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_neon::convertNV21(frame, output);
+}
+
+void QT_FASTCALL qt_convert_P016_to_ARGB32_neon(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_neon::convertP016(frame, output);
+}
+
+QT_END_NAMESPACE
+
+#endif
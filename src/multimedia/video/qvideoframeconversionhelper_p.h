@@ -20,11 +20,56 @@
 
 QT_BEGIN_NAMESPACE
 
+// Fixed point conversion of 8 bit YUV samples to RGB, derived from the color
+// matrix the shaders use (QVideoTextureHelper::colorMatrix()):
+//   R = (yFactor * Y           + rv * V + rOffset) >> 8
+//   G = (yFactor * Y + gu * U + gv * V + gOffset) >> 8
+//   B = (yFactor * Y + bu * U          + bOffset) >> 8
+// The defaults are BT.601 with limited range.
+struct Q_MULTIMEDIA_EXPORT YUVToRGBCoefficients
+{
+    static YUVToRGBCoefficients fromFormat(const QVideoFrameFormat &format);
+
+    int yFactor = 298;
+    int rv = 409;
+    int gu = -100;
+    int gv = -208;
+    int bu = 516;
+    int rOffset = -56718;
+    int gOffset = 34700;
+    int bOffset = -70440;
+};
+
+// Mapped planes of a video frame, or of a range of its lines, as seen by the
+// CPU converters. Allows converting a frame in independent horizontal stripes.
+struct Q_MULTIMEDIA_EXPORT VideoFramePlanes
+{
+    static VideoFramePlanes fromMappedFrame(const QVideoFrame &frame);
+
+    // lines [from, from + count) of the frame; from must be a multiple of the
+    // vertical chroma subsampling
+    VideoFramePlanes lines(int from, int count) const;
+
+    const uchar *bits(int plane) const { return data[plane]; }
+    int bytesPerLine(int plane) const { return strides[plane]; }
+    int width() const { return size.width(); }
+    int height() const { return size.height(); }
+
+    const uchar *data[4] = {};
+    int strides[4] = {};
+    int verticalSubsampling[4] = { 1, 1, 1, 1 };
+    QSize size;
+    QVideoFrameFormat format;
+    YUVToRGBCoefficients coefficients;
+};
+
 // Converts to RGB32 or ARGB32_Premultiplied
-typedef void (QT_FASTCALL *VideoFrameConvertFunc)(const QVideoFrame &frame, uchar *output);
+typedef void (QT_FASTCALL *VideoFrameConvertFunc)(const VideoFramePlanes &frame, uchar *output);
 typedef void(QT_FASTCALL *PixelsCopyFunc)(uint32_t *dst, const uint32_t *src, size_t size, uint32_t mask);
 
-VideoFrameConvertFunc qConverterForFormat(QVideoFrameFormat::PixelFormat format);
+VideoFrameConvertFunc Q_MULTIMEDIA_EXPORT qConverterForFormat(
+        QVideoFrameFormat::PixelFormat format,
+        QVideoFrameFormat::ColorTransfer colorTransfer = QVideoFrameFormat::ColorTransfer_Unknown);
 
 void Q_MULTIMEDIA_EXPORT qCopyPixelsWithAlphaMask(uint32_t *dst,
                                                   const uint32_t *src,
@@ -136,6 +181,162 @@ using BGRX8888 = RgbPixel<2, 1, 0>;
 #define ALIGN(boundary, ptr, x, length) \
     for (; ((reinterpret_cast<qintptr>(ptr) & (boundary - 1)) != 0) && x < length; ++x)
 
+#define EXPAND_UV(c, u, v) \
+    int rv = c.rv * (v) + c.rOffset; \
+    int guv = c.gu * (u) + c.gv * (v) + c.gOffset; \
+    int bu = c.bu * (u) + c.bOffset;
+
+inline quint32 qYUVToARGB32(const YUVToRGBCoefficients &c, int y, int rv, int guv, int bu,
+                            int a = 0xff)
+{
+    const int yy = y * c.yFactor;
+    return (a << 24)
+            | qBound(0, (yy + rv) >> 8, 255) << 16
+            | qBound(0, (yy + guv) >> 8, 255) << 8
+            | qBound(0, (yy + bu) >> 8, 255);
+}
+
+// Scalar conversion of the pixels [from, width) of a line with horizontally
+// subsampled chroma. Used by the vectorized converters for the leftovers.
+inline void qt_convert_YUV_to_ARGB32_tail(const uchar *y, int yPixelStride,
+                                          const uchar *u, const uchar *v, int uvPixelStride,
+                                          quint32 *rgb, int from, int width,
+                                          const YUVToRGBCoefficients &c)
+{
+    for (int x = from; x < width; x += 2) {
+        const int uvIndex = (x >> 1) * uvPixelStride;
+        EXPAND_UV(c, u[uvIndex], v[uvIndex]);
+        rgb[x] = qYUVToARGB32(c, y[x * yPixelStride], rv, guv, bu);
+        if (x + 1 < width)
+            rgb[x + 1] = qYUVToARGB32(c, y[(x + 1) * yPixelStride], rv, guv, bu);
+    }
+}
+
+// Runs a line converter over a frame with separate luma and chroma lines.
+// With verticalSubsampling (4:2:0) two consecutive luma lines share a chroma line.
+template<typename LineFunc>
+inline void qt_convert_YUV_lines(const uchar *y, int yStride,
+                                 const uchar *u, int uStride,
+                                 const uchar *v, int vStride,
+                                 quint32 *rgb, int width, int height,
+                                 bool verticalSubsampling, LineFunc convertLine)
+{
+    if (verticalSubsampling)
+        height &= ~1;
+
+    for (int j = 0; j < height; ++j) {
+        convertLine(y, u, v, rgb, width);
+        y += yStride;
+        rgb += width;
+        if (!verticalSubsampling || (j & 1)) {
+            u += uStride;
+            v += vStride;
+        }
+    }
+}
+
+// Frame level drivers shared by the vectorized YUV converters. Kernel provides
+// the line conversions, each handling its own leftovers and taking the
+// frame's YUVToRGBCoefficients as last argument:
+//   planarLine(y, u, v, rgb, width)        - 8 bit planes, horizontally subsampled chroma
+//   semiPlanarLine<swapUV>(y, uv, rgb, width) - 8 bit interleaved chroma (NV12/NV21)
+//   semiPlanar16Line(y, uv, rgb, width)    - 16 bit samples, MSB used (P010/P016)
+//   packedLine<uyvy>(src, rgb, width)      - packed 4:2:2 (YUYV/UYVY)
+template<typename Kernel>
+struct YUVToARGB32Converter
+{
+    static void planar(const VideoFramePlanes &frame, uchar *output, int uPlane, int vPlane,
+                       bool verticalSubsampling)
+    {
+        qt_convert_YUV_lines(frame.bits(0), frame.bytesPerLine(0),
+                             frame.bits(uPlane), frame.bytesPerLine(uPlane),
+                             frame.bits(vPlane), frame.bytesPerLine(vPlane),
+                             reinterpret_cast<quint32 *>(output), frame.width(), frame.height(),
+                             verticalSubsampling,
+                             [&c = frame.coefficients](const uchar *y, const uchar *u,
+                                                       const uchar *v, quint32 *rgb, int width) {
+                                 Kernel::planarLine(y, u, v, rgb, width, c);
+                             });
+    }
+
+    template<bool swapUV>
+    static void semiPlanar(const VideoFramePlanes &frame, uchar *output)
+    {
+        FETCH_INFO_BIPLANAR(frame)
+        qt_convert_YUV_lines(plane1, plane1Stride, plane2, plane2Stride, plane2, plane2Stride,
+                             reinterpret_cast<quint32 *>(output), width, height, true,
+                             [&c = frame.coefficients](const uchar *y, const uchar *uv,
+                                                       const uchar *, quint32 *rgb, int width) {
+                                 Kernel::template semiPlanarLine<swapUV>(y, uv, rgb, width, c);
+                             });
+    }
+
+    static void semiPlanar16(const VideoFramePlanes &frame, uchar *output)
+    {
+        FETCH_INFO_BIPLANAR(frame)
+        qt_convert_YUV_lines(plane1, plane1Stride, plane2, plane2Stride, plane2, plane2Stride,
+                             reinterpret_cast<quint32 *>(output), width, height, true,
+                             [&c = frame.coefficients](const uchar *y, const uchar *uv,
+                                                       const uchar *, quint32 *rgb, int width) {
+                                 Kernel::semiPlanar16Line(y, uv, rgb, width, c);
+                             });
+    }
+
+    template<bool uyvy>
+    static void packed(const VideoFramePlanes &frame, uchar *output)
+    {
+        FETCH_INFO_PACKED(frame)
+        MERGE_LOOPS(width, height, stride, 2)
+        quint32 *rgb = reinterpret_cast<quint32 *>(output);
+
+        for (int y = 0; y < height; ++y) {
+            Kernel::template packedLine<uyvy>(src, rgb, width, frame.coefficients);
+            src += stride;
+            rgb += width;
+        }
+    }
+
+    static void QT_FASTCALL convertYUV420P(const VideoFramePlanes &frame, uchar *output)
+    {
+        planar(frame, output, 1, 2, true);
+    }
+
+    static void QT_FASTCALL convertYUV422P(const VideoFramePlanes &frame, uchar *output)
+    {
+        planar(frame, output, 1, 2, false);
+    }
+
+    static void QT_FASTCALL convertYV12(const VideoFramePlanes &frame, uchar *output)
+    {
+        planar(frame, output, 2, 1, true);
+    }
+
+    static void QT_FASTCALL convertUYVY(const VideoFramePlanes &frame, uchar *output)
+    {
+        packed<true>(frame, output);
+    }
+
+    static void QT_FASTCALL convertYUYV(const VideoFramePlanes &frame, uchar *output)
+    {
+        packed<false>(frame, output);
+    }
+
+    static void QT_FASTCALL convertNV12(const VideoFramePlanes &frame, uchar *output)
+    {
+        semiPlanar<false>(frame, output);
+    }
+
+    static void QT_FASTCALL convertNV21(const VideoFramePlanes &frame, uchar *output)
+    {
+        semiPlanar<true>(frame, output);
+    }
+
+    static void QT_FASTCALL convertP016(const VideoFramePlanes &frame, uchar *output)
+    {
+        semiPlanar16(frame, output);
+    }
+};
+
 QT_END_NAMESPACE
 
 #endif // QVIDEOFRAMECONVERSIONHELPER_P_H
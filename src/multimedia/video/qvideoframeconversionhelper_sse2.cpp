@@ -10,7 +10,7 @@ QT_BEGIN_NAMESPACE
 namespace  {
 
 template<int a, int r, int b, int g>
-void convert_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+void convert_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output)
 {
     FETCH_INFO_PACKED(frame)
     MERGE_LOOPS(width, height, stride, 4)
@@ -60,22 +60,22 @@ void convert_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
 
 }
 
-void QT_FASTCALL qt_convert_ARGB8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_ARGB8888_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output)
 {
     convert_to_ARGB32_sse2<0, 1, 2, 3>(frame, output);
 }
 
-void QT_FASTCALL qt_convert_ABGR8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_ABGR8888_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output)
 {
     convert_to_ARGB32_sse2<0, 3, 2, 1>(frame, output);
 }
 
-void QT_FASTCALL qt_convert_RGBA8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_RGBA8888_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output)
 {
     convert_to_ARGB32_sse2<3, 0, 1, 2>(frame, output);
 }
 
-void QT_FASTCALL qt_convert_BGRA8888_to_ARGB32_sse2(const QVideoFrame &frame, uchar *output)
+void QT_FASTCALL qt_convert_BGRA8888_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output)
 {
     convert_to_ARGB32_sse2<3, 2, 1, 0>(frame, output);
 }
@@ -118,6 +118,195 @@ void QT_FASTCALL qt_copy_pixels_with_mask_sse2(uint32_t *dst, const uint32_t *sr
         *(dst++) = *(src++) | mask;
 }
 
+namespace {
+
+inline __m128i coefficientPairs_sse2(short first, short second)
+{
+    return _mm_set_epi16(second, first, second, first, second, first, second, first);
+}
+
+// Coefficients for the interleaved (y, v), (y, u) and (v, 0) pairs
+struct YUVCoefficients_sse2
+{
+    explicit YUVCoefficients_sse2(const YUVToRGBCoefficients &c)
+        : r(coefficientPairs_sse2(c.yFactor, c.rv)),
+          g(coefficientPairs_sse2(c.yFactor, c.gu)),
+          gv(coefficientPairs_sse2(c.gv, 0)),
+          b(coefficientPairs_sse2(c.yFactor, c.bu)),
+          rOffset(_mm_set1_epi32(c.rOffset)),
+          gOffset(_mm_set1_epi32(c.gOffset)),
+          bOffset(_mm_set1_epi32(c.bOffset))
+    {
+    }
+
+    __m128i r, g, gv, b;
+    __m128i rOffset, gOffset, bOffset;
+};
+
+// Converts 8 pixels. y holds 8 luma samples, uv 4 interleaved U/V pairs,
+// all zero extended to 16 bit. Matches qYUVToARGB32() bit for bit.
+inline void yuvToArgb32_sse2(__m128i y, __m128i uv, quint32 *rgb, const YUVCoefficients_sse2 &k)
+{
+    // duplicate each chroma sample for the two pixels sharing it
+    const __m128i lowWords = _mm_set1_epi32(0x0000ffff);
+    const __m128i u = _mm_or_si128(_mm_and_si128(uv, lowWords), _mm_slli_epi32(uv, 16));
+    const __m128i v = _mm_or_si128(_mm_andnot_si128(lowWords, uv), _mm_srli_epi32(uv, 16));
+    const __m128i zero = _mm_setzero_si128();
+
+    const __m128i yvLo = _mm_unpacklo_epi16(y, v);
+    const __m128i yvHi = _mm_unpackhi_epi16(y, v);
+    const __m128i yuLo = _mm_unpacklo_epi16(y, u);
+    const __m128i yuHi = _mm_unpackhi_epi16(y, u);
+
+    auto toInt16 = [](__m128i lo, __m128i hi) {
+        return _mm_packs_epi32(_mm_srai_epi32(lo, 8), _mm_srai_epi32(hi, 8));
+    };
+
+    const __m128i r = toInt16(_mm_add_epi32(_mm_madd_epi16(yvLo, k.r), k.rOffset),
+                              _mm_add_epi32(_mm_madd_epi16(yvHi, k.r), k.rOffset));
+    const __m128i b = toInt16(_mm_add_epi32(_mm_madd_epi16(yuLo, k.b), k.bOffset),
+                              _mm_add_epi32(_mm_madd_epi16(yuHi, k.b), k.bOffset));
+    const __m128i g = toInt16(
+            _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(yuLo, k.g),
+                                        _mm_madd_epi16(_mm_unpacklo_epi16(v, zero), k.gv)),
+                          k.gOffset),
+            _mm_add_epi32(_mm_add_epi32(_mm_madd_epi16(yuHi, k.g),
+                                        _mm_madd_epi16(_mm_unpackhi_epi16(v, zero), k.gv)),
+                          k.gOffset));
+
+    // saturate to 8 bit and interleave to B, G, R, A bytes
+    const __m128i br = _mm_packus_epi16(b, r);
+    const __m128i ga = _mm_packus_epi16(g, _mm_set1_epi16(0xff));
+    const __m128i bg = _mm_unpacklo_epi8(br, ga);
+    const __m128i ra = _mm_unpackhi_epi8(br, ga);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(rgb), _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(rgb + 4), _mm_unpackhi_epi16(bg, ra));
+}
+
+inline __m128i loadUInt32_sse2(const uchar *src)
+{
+    quint32 data;
+    memcpy(&data, src, sizeof(data));
+    return _mm_cvtsi32_si128(data);
+}
+
+struct YUVKernels_sse2
+{
+    static void planarLine(const uchar *y, const uchar *u, const uchar *v, quint32 *rgb,
+                           int width, const YUVToRGBCoefficients &c)
+    {
+        const YUVCoefficients_sse2 k(c);
+        const __m128i zero = _mm_setzero_si128();
+        int x = 0;
+        for (; x < width - 7; x += 8) {
+            const __m128i yData = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(y + x));
+            const __m128i uvData = _mm_unpacklo_epi8(loadUInt32_sse2(u + x / 2),
+                                                     loadUInt32_sse2(v + x / 2));
+            yuvToArgb32_sse2(_mm_unpacklo_epi8(yData, zero), _mm_unpacklo_epi8(uvData, zero),
+                             rgb + x, k);
+        }
+        qt_convert_YUV_to_ARGB32_tail(y, 1, u, v, 1, rgb, x, width, c);
+    }
+
+    template<bool swapUV>
+    static void semiPlanarLine(const uchar *y, const uchar *uv, quint32 *rgb, int width,
+                               const YUVToRGBCoefficients &c)
+    {
+        const YUVCoefficients_sse2 k(c);
+        const __m128i zero = _mm_setzero_si128();
+        int x = 0;
+        for (; x < width - 7; x += 8) {
+            const __m128i yData = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(y + x));
+            __m128i uvData = _mm_unpacklo_epi8(
+                    _mm_loadl_epi64(reinterpret_cast<const __m128i *>(uv + x)), zero);
+            if constexpr (swapUV) {
+                uvData = _mm_shufflelo_epi16(uvData, _MM_SHUFFLE(2, 3, 0, 1));
+                uvData = _mm_shufflehi_epi16(uvData, _MM_SHUFFLE(2, 3, 0, 1));
+            }
+            yuvToArgb32_sse2(_mm_unpacklo_epi8(yData, zero), uvData, rgb + x, k);
+        }
+        qt_convert_YUV_to_ARGB32_tail(y, 1, swapUV ? uv + 1 : uv, swapUV ? uv : uv + 1, 2, rgb,
+                                      x, width, c);
+    }
+
+    static void semiPlanar16Line(const uchar *y, const uchar *uv, quint32 *rgb, int width,
+                                 const YUVToRGBCoefficients &c)
+    {
+        const YUVCoefficients_sse2 k(c);
+        int x = 0;
+        for (; x < width - 7; x += 8) {
+            const __m128i yData = _mm_loadu_si128(reinterpret_cast<const __m128i *>(y + 2 * x));
+            const __m128i uvData =
+                    _mm_loadu_si128(reinterpret_cast<const __m128i *>(uv + 2 * x));
+            yuvToArgb32_sse2(_mm_srli_epi16(yData, 8), _mm_srli_epi16(uvData, 8), rgb + x, k);
+        }
+        qt_convert_YUV_to_ARGB32_tail(y + 1, 2, uv + 1, uv + 3, 4, rgb, x, width, c);
+    }
+
+    template<bool uyvy>
+    static void packedLine(const uchar *src, quint32 *rgb, int width,
+                           const YUVToRGBCoefficients &c)
+    {
+        const YUVCoefficients_sse2 k(c);
+        const __m128i lowBytes = _mm_set1_epi16(0xff);
+        int x = 0;
+        for (; x < width - 7; x += 8) {
+            const __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 2 * x));
+            const __m128i even = _mm_and_si128(data, lowBytes);
+            const __m128i odd = _mm_srli_epi16(data, 8);
+            yuvToArgb32_sse2(uyvy ? odd : even, uyvy ? even : odd, rgb + x, k);
+        }
+        if constexpr (uyvy)
+            qt_convert_YUV_to_ARGB32_tail(src + 1, 2, src, src + 2, 4, rgb, x, width, c);
+        else
+            qt_convert_YUV_to_ARGB32_tail(src, 2, src + 1, src + 3, 4, rgb, x, width, c);
+    }
+};
+
+using YUVConverter_sse2 = YUVToARGB32Converter<YUVKernels_sse2>;
+
+} // namespace
+
+void QT_FASTCALL qt_convert_YUV420P_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_sse2::convertYUV420P(frame, output);
+}
+
+void QT_FASTCALL qt_convert_YUV422P_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_sse2::convertYUV422P(frame, output);
+}
+
+void QT_FASTCALL qt_convert_YV12_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_sse2::convertYV12(frame, output);
+}
+
+void QT_FASTCALL qt_convert_UYVY_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_sse2::convertUYVY(frame, output);
+}
+
+void QT_FASTCALL qt_convert_YUYV_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_sse2::convertYUYV(frame, output);
+}
+
+void QT_FASTCALL qt_convert_NV12_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_sse2::convertNV12(frame, output);
+}
+
+void QT_FASTCALL qt_convert_NV21_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_sse2::convertNV21(frame, output);
+}
+
+void QT_FASTCALL qt_convert_P016_to_ARGB32_sse2(const VideoFramePlanes &frame, uchar *output)
+{
+    YUVConverter_sse2::convertP016(frame, output);
+}
+
 QT_END_NAMESPACE
 
 #endif
@@ -8,8 +8,14 @@
 #include <QtCore/qcoreapplication.h>
 #include <QtCore/qsize.h>
 #include <QtCore/qhash.h>
+#include <QtCore/qcache.h>
+#include <QtCore/qset.h>
+#include <QtCore/qpromise.h>
+#include <QtCore/qmath.h>
 #include <QtCore/qfile.h>
 #include <QtCore/qthreadstorage.h>
+#include <QtCore/qthreadpool.h>
+#include <QtCore/qsemaphore.h>
 #include <QtGui/qimage.h>
 #include <QtGui/qoffscreensurface.h>
 #include <qpa/qplatformintegration.h>
@@ -28,13 +34,102 @@ static Q_LOGGING_CATEGORY(qLcVideoFrameConverter, "qt.multimedia.video.frameconv
 
 namespace {
 
+struct ConversionPipelineKey
+{
+    QRhi *rhi;
+    QVideoFrameFormat::PixelFormat pixelFormat;
+    QSize targetSize;
+    QString fragmentShader;
+
+    friend bool operator==(const ConversionPipelineKey &lhs,
+                           const ConversionPipelineKey &rhs) noexcept
+    {
+        return lhs.rhi == rhs.rhi && lhs.pixelFormat == rhs.pixelFormat
+                && lhs.targetSize == rhs.targetSize && lhs.fragmentShader == rhs.fragmentShader;
+    }
+
+    friend size_t qHash(const ConversionPipelineKey &key, size_t seed = 0) noexcept
+    {
+        return qHashMulti(seed, key.rhi, int(key.pixelFormat), key.targetSize.width(),
+                          key.targetSize.height(), key.fragmentShader);
+    }
+};
+
+// The GPU resources for converting frames of one pixel format and size,
+// reused by consecutive qImageFromVideoFrame() calls
+struct ConversionPipeline
+{
+    std::unique_ptr<QRhiRenderPassDescriptor> renderPass;
+    std::unique_ptr<QRhiBuffer> vertexBuffer;
+    std::unique_ptr<QRhiBuffer> uniformBuffer;
+    std::unique_ptr<QRhiTexture> targetTexture;
+    std::unique_ptr<QRhiTextureRenderTarget> renderTarget;
+    std::unique_ptr<QRhiSampler> textureSampler;
+    std::unique_ptr<QRhiShaderResourceBindings> shaderResourceBindings;
+    std::unique_ptr<QRhiGraphicsPipeline> graphicsPipeline;
+    // textures uploaded from mapped frames, reused for the next upload
+    std::unique_ptr<QVideoFrameTextures> frameTextures;
+    bool vertexBufferUploaded = false;
+};
+
+class ConversionPipelineCache
+{
+public:
+    ~ConversionPipelineCache()
+    {
+        m_pipelines.clear();
+        for (QRhi *rhi : std::as_const(m_rhis))
+            rhi->removeCleanupCallback(this);
+    }
+
+    ConversionPipeline *object(const ConversionPipelineKey &key) const
+    {
+        return m_pipelines.object(key);
+    }
+
+    ConversionPipeline *insert(const ConversionPipelineKey &key,
+                               std::unique_ptr<ConversionPipeline> pipeline)
+    {
+        // the pipelines must be gone before the QRhi they were created with
+        if (!m_rhis.contains(key.rhi)) {
+            key.rhi->addCleanupCallback(this, [this](QRhi *rhi) { release(rhi); });
+            m_rhis.insert(key.rhi);
+        }
+
+        ConversionPipeline *result = pipeline.get();
+        m_pipelines.insert(key, pipeline.release());
+        return result;
+    }
+
+private:
+    void release(QRhi *rhi)
+    {
+        const QList<ConversionPipelineKey> keys = m_pipelines.keys();
+        for (const ConversionPipelineKey &key : keys) {
+            if (key.rhi == rhi)
+                m_pipelines.remove(key);
+        }
+        m_rhis.remove(rhi);
+    }
+
+    // a few sizes and formats, e.g. for thumbnails next to full size grabs
+    static constexpr qsizetype MaxPipelines = 4;
+
+    QCache<ConversionPipelineKey, ConversionPipeline> m_pipelines{ MaxPipelines };
+    QSet<QRhi *> m_rhis;
+};
+
 struct State
 {
     QRhi *rhi = nullptr;
 #if QT_CONFIG(opengl)
     QOffscreenSurface *fallbackSurface = nullptr;
 #endif
+    ConversionPipelineCache *pipelines = nullptr;
     bool cpuOnly = false;
+    // OpenGL needs its fallback surface created on the GUI thread, so the conversion
+    // thread of qImageFromVideoFrameAsync() doesn't use it
+    bool openGLDisabled = false;
 #if defined(Q_OS_ANDROID)
     QMetaObject::Connection appStateChangedConnection;
 #endif
@@ -43,6 +138,8 @@ struct State
     }
 
     void resetRhi() {
+        delete pipelines;
+        pipelines = nullptr;
         delete rhi;
         rhi = nullptr;
 #if QT_CONFIG(opengl)
@@ -114,8 +211,7 @@ static QShader vfcGetShader(const QString &name)
     return shader;
 }
 
-static void rasterTransform(QImage &image, QtVideo::Rotation rotation,
-                            bool mirrorX, bool mirrorY)
+static QTransform rasterTransformMatrix(QtVideo::Rotation rotation, bool mirrorX, bool mirrorY)
 {
     QTransform t;
     if (mirrorX)
@@ -124,10 +220,124 @@ static void rasterTransform(QImage &image, QtVideo::Rotation rotation,
         t.rotate(float(rotation));
     if (mirrorY)
         t.scale(1.f, -1.f);
+    return t;
+}
+
+static void rasterTransform(QImage &image, QtVideo::Rotation rotation,
+                            bool mirrorX, bool mirrorY)
+{
+    const QTransform t = rasterTransformMatrix(rotation, mirrorX, mirrorY);
     if (!t.isIdentity())
         image = image.transformed(t);
 }
 
+namespace {
+
+// Destination of each source pixel, in pixels from the start of the image, for
+// a rotation by a multiple of 90 degrees combined with mirroring. Gives the same
+// result as rasterTransform(), but lets the CPU conversion place pixels directly.
+struct PixelMapping
+{
+    PixelMapping(QSize sourceSize, QtVideo::Rotation rotation, bool mirrorX, bool mirrorY)
+    {
+        const QTransform transform =
+                QImage::trueMatrix(rasterTransformMatrix(rotation, mirrorX, mirrorY),
+                                   sourceSize.width(), sourceSize.height());
+
+        size = (qToUnderlying(rotation) / 90) % 2 ? sourceSize.transposed() : sourceSize;
+
+        const QPointF originCenter = transform.map(QPointF(0.5, 0.5));
+        const QPointF xDelta = transform.map(QPointF(1.5, 0.5)) - originCenter;
+        const QPointF yDelta = transform.map(QPointF(0.5, 1.5)) - originCenter;
+
+        origin = qsizetype(qFloor(originCenter.y())) * size.width() + qFloor(originCenter.x());
+        xStep = qRound(xDelta.x()) + qsizetype(qRound(xDelta.y())) * size.width();
+        yStep = qRound(yDelta.x()) + qsizetype(qRound(yDelta.y())) * size.width();
+    }
+
+    bool isIdentity() const { return origin == 0 && xStep == 1 && yStep == size.width(); }
+
+    QSize size;
+    qsizetype origin = 0;
+    qsizetype xStep = 1;
+    qsizetype yStep = 0;
+};
+
+// Converts the lines [from, to) of the frame. Unless the output is untransformed,
+// the lines are converted in small chunks into a scratch buffer that stays in
+// cache and then placed at their rotated/mirrored position, which avoids a second
+// pass over the whole image.
+void convertLines(const VideoFramePlanes &planes, VideoFrameConvertFunc convert,
+                  const PixelMapping &mapping, int from, int to, uchar *output)
+{
+    const int width = planes.width();
+
+    if (mapping.isIdentity()) {
+        convert(planes.lines(from, to - from), output + qsizetype(from) * width * 4);
+        return;
+    }
+
+    constexpr int ChunkLines = 16;
+    std::vector<quint32> scratch(size_t(ChunkLines) * width);
+    quint32 *const destination = reinterpret_cast<quint32 *>(output) + mapping.origin;
+
+    for (int y = from; y < to; y += ChunkLines) {
+        const int lineCount = qMin(ChunkLines, to - y);
+        convert(planes.lines(y, lineCount), reinterpret_cast<uchar *>(scratch.data()));
+
+        for (int j = 0; j < lineCount; ++j) {
+            const quint32 *src = scratch.data() + qsizetype(j) * width;
+            quint32 *dst = destination + (y + j) * mapping.yStep;
+            for (int i = 0; i < width; ++i)
+                dst[i * mapping.xStep] = src[i];
+        }
+    }
+}
+
+// Number of stripes a frame is converted in: roughly one per 64k pixels, as
+// for QImage conversions, capped by QT_VIDEO_CPU_CONVERSION_THREADS if set.
+int conversionSegments(QSize size)
+{
+    static const int maxThreads = qEnvironmentVariableIntValue("QT_VIDEO_CPU_CONVERSION_THREADS");
+
+    int segments = int((qsizetype(size.width()) * size.height()) >> 16);
+    segments = std::min(segments, size.height() / 2);
+    if (maxThreads > 0)
+        segments = std::min(segments, maxThreads);
+    return segments;
+}
+
+void convertFrame(const VideoFramePlanes &planes, VideoFrameConvertFunc convert,
+                  const PixelMapping &mapping, QImage &image)
+{
+    const int height = planes.height();
+    uchar *output = image.bits();
+
+#if QT_CONFIG(thread)
+    const int segments = conversionSegments(planes.size);
+    QThreadPool *threadPool = QGuiApplicationPrivate::qtGuiThreadPool();
+    if (segments > 1 && threadPool && !threadPool->contains(QThread::currentThread())) {
+        QSemaphore semaphore;
+        int y = 0;
+        for (int i = 0; i < segments; ++i) {
+            // stripes start on even lines to keep 4:2:0 chroma lines together
+            const int yn = i == segments - 1 ? height - y : ((height - y) / (segments - i)) & ~1;
+            threadPool->start([&, y, yn]() {
+                convertLines(planes, convert, mapping, y, y + yn, output);
+                semaphore.release(1);
+            });
+            y += yn;
+        }
+        semaphore.acquire(segments);
+        return;
+    }
+#endif
+
+    convertLines(planes, convert, mapping, 0, height, output);
+}
+
+} // namespace
+
 static void imageCleanupHandler(void *info)
 {
     QByteArray *imageData = reinterpret_cast<QByteArray *>(info);
@@ -158,7 +368,8 @@ static QRhi *initializeRHI(QRhi *videoFrameRhi)
 #endif
 
 #if QT_CONFIG(opengl)
-        if (!g_state.localData().rhi && (backend == QRhi::OpenGLES2 || backend == QRhi::Null)) {
+        if (!g_state.localData().rhi && !g_state.localData().openGLDisabled
+            && (backend == QRhi::OpenGLES2 || backend == QRhi::Null)) {
             if (QGuiApplicationPrivate::platformIntegration()->hasCapability(QPlatformIntegration::OpenGL)
                     && QGuiApplicationPrivate::platformIntegration()->hasCapability(QPlatformIntegration::RasterGLSurface)
                     && !QCoreApplication::testAttribute(Qt::AA_ForceRasterWidgets)) {
@@ -192,31 +403,67 @@ static QRhi *initializeRHI(QRhi *videoFrameRhi)
     return g_state.localData().rhi;
 }
 
-static bool updateTextures(QRhi *rhi,
-                           std::unique_ptr<QRhiBuffer> &uniformBuffer,
-                           std::unique_ptr<QRhiSampler> &textureSampler,
-                           std::unique_ptr<QRhiShaderResourceBindings> &shaderResourceBindings,
-                           std::unique_ptr<QRhiGraphicsPipeline> &graphicsPipeline,
-                           std::unique_ptr<QRhiRenderPassDescriptor> &renderPass,
-                           QVideoFrame &frame,
-                           const std::unique_ptr<QVideoFrameTextures> &videoFrameTextures)
+static ConversionPipeline *conversionPipeline(QRhi *rhi, const QVideoFrameFormat &format,
+                                              QSize targetSize)
+{
+    State &state = g_state.localData();
+    if (!state.pipelines)
+        state.pipelines = new ConversionPipelineCache;
+
+    const ConversionPipelineKey key{ rhi, format.pixelFormat(), targetSize,
+                                     QVideoTextureHelper::fragmentShaderFileName(format) };
+    if (ConversionPipeline *pipeline = state.pipelines->object(key))
+        return pipeline;
+
+    auto pipeline = std::make_unique<ConversionPipeline>();
+
+    pipeline->vertexBuffer.reset(rhi->newBuffer(QRhiBuffer::Immutable, QRhiBuffer::VertexBuffer, sizeof(g_quad)));
+    pipeline->vertexBuffer->create();
+
+    pipeline->uniformBuffer.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, 64 + 64 + 4 + 4 + 4 + 4));
+    pipeline->uniformBuffer->create();
+
+    pipeline->textureSampler.reset(rhi->newSampler(QRhiSampler::Linear, QRhiSampler::Linear, QRhiSampler::None,
+                                                   QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge));
+    pipeline->textureSampler->create();
+
+    pipeline->shaderResourceBindings.reset(rhi->newShaderResourceBindings());
+
+    pipeline->targetTexture.reset(rhi->newTexture(QRhiTexture::RGBA8, targetSize, 1, QRhiTexture::RenderTarget));
+    if (!pipeline->targetTexture->create())
+        return nullptr;
+
+    pipeline->renderTarget.reset(rhi->newTextureRenderTarget({ { pipeline->targetTexture.get() } }));
+    pipeline->renderPass.reset(pipeline->renderTarget->newCompatibleRenderPassDescriptor());
+    pipeline->renderTarget->setRenderPassDescriptor(pipeline->renderPass.get());
+    pipeline->renderTarget->create();
+
+    return state.pipelines->insert(key, std::move(pipeline));
+}
+
+static bool updatePipeline(QRhi *rhi, ConversionPipeline &pipeline, const QVideoFrameFormat &format,
+                           const QVideoFrameTextures &videoFrameTextures)
 {
-    auto format = frame.surfaceFormat();
     auto pixelFormat = format.pixelFormat();
 
     auto textureDesc = QVideoTextureHelper::textureDescription(pixelFormat);
 
+    // The textures differ from frame to frame, unless they are reused uploads. The new
+    // bindings are layout compatible, so the graphics pipeline stays valid.
     QRhiShaderResourceBinding bindings[4];
     auto *b = bindings;
     *b++ = QRhiShaderResourceBinding::uniformBuffer(0, QRhiShaderResourceBinding::VertexStage | QRhiShaderResourceBinding::FragmentStage,
-                                                    uniformBuffer.get());
+                                                    pipeline.uniformBuffer.get());
     for (int i = 0; i < textureDesc->nplanes; ++i)
         *b++ = QRhiShaderResourceBinding::sampledTexture(i + 1, QRhiShaderResourceBinding::FragmentStage,
-                                                         videoFrameTextures->texture(i), textureSampler.get());
-    shaderResourceBindings->setBindings(bindings, b);
-    shaderResourceBindings->create();
+                                                         videoFrameTextures.texture(i), pipeline.textureSampler.get());
+    pipeline.shaderResourceBindings->setBindings(bindings, b);
+    pipeline.shaderResourceBindings->create();
 
-    graphicsPipeline.reset(rhi->newGraphicsPipeline());
+    if (pipeline.graphicsPipeline)
+        return true;
+
+    std::unique_ptr<QRhiGraphicsPipeline> graphicsPipeline(rhi->newGraphicsPipeline());
     graphicsPipeline->setTopology(QRhiGraphicsPipeline::TriangleStrip);
 
     QShader vs = vfcGetShader(QVideoTextureHelper::vertexShaderFileName(format));
@@ -242,10 +489,12 @@ static bool updateTextures(QRhi *rhi,
     });
 
     graphicsPipeline->setVertexInputLayout(inputLayout);
-    graphicsPipeline->setShaderResourceBindings(shaderResourceBindings.get());
-    graphicsPipeline->setRenderPassDescriptor(renderPass.get());
-    graphicsPipeline->create();
+    graphicsPipeline->setShaderResourceBindings(pipeline.shaderResourceBindings.get());
+    graphicsPipeline->setRenderPassDescriptor(pipeline.renderPass.get());
+    if (!graphicsPipeline->create())
+        return false;
 
+    pipeline.graphicsPipeline = std::move(graphicsPipeline);
     return true;
 }
 
@@ -265,7 +514,8 @@ static QImage convertJPEG(const QVideoFrame &frame, QtVideo::Rotation rotation,
 
 static QImage convertCPU(const QVideoFrame &frame, QtVideo::Rotation rotation, bool mirrorX, bool mirrorY)
 {
-    VideoFrameConvertFunc convert = qConverterForFormat(frame.pixelFormat());
+    VideoFrameConvertFunc convert =
+            qConverterForFormat(frame.pixelFormat(), frame.surfaceFormat().colorTransfer());
     if (!convert) {
         qCDebug(qLcVideoFrameConverter) << Q_FUNC_INFO << ": unsupported pixel format" << frame.pixelFormat();
         return {};
@@ -276,10 +526,10 @@ static QImage convertCPU(const QVideoFrame &frame, QtVideo::Rotation rotation, b
             return {};
         }
         auto format = pixelFormatHasAlpha(varFrame.pixelFormat()) ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32;
-        QImage image = QImage(varFrame.width(), varFrame.height(), format);
-        convert(varFrame, image.bits());
+        const PixelMapping mapping(varFrame.size(), rotation, mirrorX, mirrorY);
+        QImage image = QImage(mapping.size, format);
+        convertFrame(VideoFramePlanes::fromMappedFrame(varFrame), convert, mapping, image);
         varFrame.unmap();
-        rasterTransform(image, rotation, mirrorX, mirrorY);
         return image;
     }
 }
@@ -293,15 +543,6 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, QtVideo::Rotation rotation
     if (!g_state.hasLocalData())
         g_state.setLocalData({});
 
-    std::unique_ptr<QRhiRenderPassDescriptor> renderPass;
-    std::unique_ptr<QRhiBuffer> vertexBuffer;
-    std::unique_ptr<QRhiBuffer> uniformBuffer;
-    std::unique_ptr<QRhiTexture> targetTexture;
-    std::unique_ptr<QRhiTextureRenderTarget> renderTarget;
-    std::unique_ptr<QRhiSampler> textureSampler;
-    std::unique_ptr<QRhiShaderResourceBindings> shaderResourceBindings;
-    std::unique_ptr<QRhiGraphicsPipeline> graphicsPipeline;
-
     if (frame.size().isEmpty() || frame.pixelFormat() == QVideoFrameFormat::Format_Invalid)
         return {};
 
@@ -327,29 +568,12 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, QtVideo::Rotation rotation
     if (rotationIndex % 2)
         frameSize.transpose();
 
-    vertexBuffer.reset(rhi->newBuffer(QRhiBuffer::Immutable, QRhiBuffer::VertexBuffer, sizeof(g_quad)));
-    vertexBuffer->create();
-
-    uniformBuffer.reset(rhi->newBuffer(QRhiBuffer::Dynamic, QRhiBuffer::UniformBuffer, 64 + 64 + 4 + 4 + 4 + 4));
-    uniformBuffer->create();
-
-    textureSampler.reset(rhi->newSampler(QRhiSampler::Linear, QRhiSampler::Linear, QRhiSampler::None,
-                                         QRhiSampler::ClampToEdge, QRhiSampler::ClampToEdge));
-    textureSampler->create();
-
-    shaderResourceBindings.reset(rhi->newShaderResourceBindings());
-
-    targetTexture.reset(rhi->newTexture(QRhiTexture::RGBA8, frameSize, 1, QRhiTexture::RenderTarget));
-    if (!targetTexture->create()) {
+    ConversionPipeline *pipeline = conversionPipeline(rhi, frame.surfaceFormat(), frameSize);
+    if (!pipeline) {
         qCDebug(qLcVideoFrameConverter) << "Failed to create target texture. Using CPU conversion.";
         return convertCPU(frame, rotation, mirrorX, mirrorY);
     }
 
-    renderTarget.reset(rhi->newTextureRenderTarget({ { targetTexture.get() } }));
-    renderPass.reset(renderTarget->newCompatibleRenderPassDescriptor());
-    renderTarget->setRenderPassDescriptor(renderPass.get());
-    renderTarget->create();
-
     QRhiCommandBuffer *cb = nullptr;
     QRhi::FrameOpResult r = rhi->beginOffscreenFrame(&cb);
     if (r != QRhi::FrameOpSuccess) {
@@ -359,18 +583,23 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, QtVideo::Rotation rotation
 
     QRhiResourceUpdateBatch *rub = rhi->nextResourceUpdateBatch();
 
-    rub->uploadStaticBuffer(vertexBuffer.get(), g_quad);
+    if (!pipeline->vertexBufferUploaded)
+        rub->uploadStaticBuffer(pipeline->vertexBuffer.get(), g_quad);
 
     QVideoFrame frameTmp = frame;
-    auto videoFrameTextures = QVideoTextureHelper::createTextures(frameTmp, rhi, rub, {});
+    auto videoFrameTextures = QVideoTextureHelper::createTextures(frameTmp, rhi, rub,
+                                                                  std::move(pipeline->frameTextures));
     if (!videoFrameTextures) {
         qCDebug(qLcVideoFrameConverter) << "Failed obtain textures. Using CPU conversion.";
+        rub->release();
+        rhi->endOffscreenFrame();
         return convertCPU(frame, rotation, mirrorX, mirrorY);
     }
 
-    if (!updateTextures(rhi, uniformBuffer, textureSampler, shaderResourceBindings,
-                        graphicsPipeline, renderPass, frameTmp, videoFrameTextures)) {
+    if (!updatePipeline(rhi, *pipeline, frameTmp.surfaceFormat(), *videoFrameTextures)) {
         qCDebug(qLcVideoFrameConverter) << "Failed to update textures. Using CPU conversion.";
+        rub->release();
+        rhi->endOffscreenFrame();
         return convertCPU(frame, rotation, mirrorX, mirrorY);
     }
 
@@ -385,20 +614,20 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, QtVideo::Rotation rotation
 
     QByteArray uniformData(64 + 64 + 4 + 4, Qt::Uninitialized);
     QVideoTextureHelper::updateUniformData(&uniformData, frame.surfaceFormat(), frame, transform, 1.f);
-    rub->updateDynamicBuffer(uniformBuffer.get(), 0, uniformData.size(), uniformData.constData());
+    rub->updateDynamicBuffer(pipeline->uniformBuffer.get(), 0, uniformData.size(), uniformData.constData());
 
-    cb->beginPass(renderTarget.get(), Qt::black, { 1.0f, 0 }, rub);
-    cb->setGraphicsPipeline(graphicsPipeline.get());
+    cb->beginPass(pipeline->renderTarget.get(), Qt::black, { 1.0f, 0 }, rub);
+    cb->setGraphicsPipeline(pipeline->graphicsPipeline.get());
 
     cb->setViewport({ 0, 0, float(frameSize.width()), float(frameSize.height()) });
-    cb->setShaderResources(shaderResourceBindings.get());
+    cb->setShaderResources(pipeline->shaderResourceBindings.get());
 
     quint32 vertexOffset = quint32(sizeof(float)) * 16 * rotationIndex;
-    const QRhiCommandBuffer::VertexInput vbufBinding(vertexBuffer.get(), vertexOffset);
+    const QRhiCommandBuffer::VertexInput vbufBinding(pipeline->vertexBuffer.get(), vertexOffset);
     cb->setVertexInput(0, 1, &vbufBinding);
     cb->draw(4);
 
-    QRhiReadbackDescription readDesc(targetTexture.get());
+    QRhiReadbackDescription readDesc(pipeline->targetTexture.get());
     QRhiReadbackResult readResult;
     bool readCompleted = false;
 
@@ -410,6 +639,12 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, QtVideo::Rotation rotation
     cb->endPass(rub);
 
     rhi->endOffscreenFrame();
+    pipeline->vertexBufferUploaded = true;
+
+    // Only textures created for uploading mapped frames are ours to reuse, others wrap
+    // the frame's own native textures.
+    if (frame.handleType() == QVideoFrame::NoHandle)
+        pipeline->frameTextures = std::move(videoFrameTextures);
 
     if (!readCompleted) {
         qCDebug(qLcVideoFrameConverter) << "Failed to read back texture. Using CPU conversion.";
@@ -423,5 +658,63 @@ QImage qImageFromVideoFrame(const QVideoFrame &frame, QtVideo::Rotation rotation
                   QImage::Format_RGBA8888_Premultiplied, imageCleanupHandler, imageData);
 }
 
-QT_END_NAMESPACE
+namespace {
+
+void releaseConversionThread();
+
+// Runs the conversions of qImageFromVideoFrameAsync(). A single thread that is
+// kept alive, so that its RHI and cached pipelines are reused.
+class ConversionThreadPool : public QThreadPool
+{
+public:
+    ConversionThreadPool()
+    {
+        setObjectName(QStringLiteral("QVideoFrameConverter"));
+        setMaxThreadCount(1);
+        setExpiryTimeout(-1);
+
+        // the RHI of the thread must be released while the application exists
+        qAddPostRoutine(releaseConversionThread);
+    }
+};
+
+} // namespace
 
+Q_GLOBAL_STATIC(ConversionThreadPool, g_conversionThreadPool)
+
+namespace {
+
+// The thread state, with the RHI, is destroyed when the thread exits
+void releaseConversionThread()
+{
+    if (g_conversionThreadPool.exists())
+        g_conversionThreadPool->waitForDone();
+}
+
+} // namespace
+
+QFuture<QImage> qImageFromVideoFrameAsync(const QVideoFrame &frame, QtVideo::Rotation rotation,
+                                          bool mirrorX, bool mirrorY)
+{
+    // The textures of an OpenGL frame can only be read through the contexts of its
+    // thread, so the frame is converted right away
+    QRhi *frameRhi = frame.videoBuffer() ? frame.videoBuffer()->rhi() : nullptr;
+    if (frameRhi && frameRhi->backend() == QRhi::OpenGLES2)
+        return QtFuture::makeReadyValueFuture(
+                qImageFromVideoFrame(frame, rotation, mirrorX, mirrorY));
+
+    QPromise<QImage> promise;
+    QFuture<QImage> future = promise.future();
+    promise.start();
+
+    g_conversionThreadPool->start(
+            [promise = std::move(promise), frame, rotation, mirrorX, mirrorY]() mutable {
+                g_state.localData().openGLDisabled = true;
+                promise.addResult(qImageFromVideoFrame(frame, rotation, mirrorX, mirrorY));
+                promise.finish();
+            });
+
+    return future;
+}
+
+QT_END_NAMESPACE
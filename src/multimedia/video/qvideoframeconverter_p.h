@@ -16,11 +16,18 @@
 //
 
 #include <qvideoframe.h>
+#include <QtCore/qfuture.h>
 
 QT_BEGIN_NAMESPACE
 
 Q_MULTIMEDIA_EXPORT QImage qImageFromVideoFrame(const QVideoFrame &frame, QtVideo::Rotation rotation = QtVideo::Rotation::None, bool mirrorX = false, bool mirrorY = false);
 
+// Converts on a dedicated thread with its own RHI; the calling thread does not wait
+// for the GPU readback. Continue with QFuture::then() to get the image delivered.
+// The dedicated thread doesn't use OpenGL, and frames with OpenGL textures are
+// converted on the calling thread, which must be the thread of their RHI.
+Q_MULTIMEDIA_EXPORT QFuture<QImage> qImageFromVideoFrameAsync(const QVideoFrame &frame, QtVideo::Rotation rotation = QtVideo::Rotation::None, bool mirrorX = false, bool mirrorY = false);
+
 QT_END_NAMESPACE
 
 #endif
@@ -372,7 +372,7 @@ QString fragmentShaderFileName(const QVideoFrameFormat &format, QRhiSwapChain::F
 //
 
 // clang-format off
-static QMatrix4x4 colorMatrix(const QVideoFrameFormat &format)
+QMatrix4x4 colorMatrix(const QVideoFrameFormat &format)
 {
     auto colorSpace = format.colorSpace();
     if (colorSpace == QVideoFrameFormat::ColorSpace_Undefined) {
@@ -466,40 +466,89 @@ static QMatrix4x4 yuvColorCorrectionMatrix(float brightness, float contrast, flo
 }
 #endif
 
+namespace {
+
 // PQ transfer function, see also https://en.wikipedia.org/wiki/Perceptual_quantizer
 // or https://ieeexplore.ieee.org/document/7291452
-static float convertPQFromLinear(float sig)
+namespace PQ {
+constexpr float m1 = 1305.f/8192.f;
+constexpr float m2 = 2523.f/32.f;
+constexpr float c1 = 107.f/128.f;
+constexpr float c2 = 2413.f/128.f;
+constexpr float c3 = 2392.f/128.f;
+
+constexpr float SDR_LEVEL = 100.f;
+constexpr float MAX_LEVEL = 10000.f;
+} // namespace PQ
+
+namespace HLG {
+constexpr float a = 0.17883277f;
+constexpr float b = 0.28466892f; // = 1 - 4a
+constexpr float c = 0.55991073f; // = 0.5 - a ln(4a)
+} // namespace HLG
+
+} // namespace
+
+float convertPQFromLinear(float sig)
 {
-    const float m1 = 1305.f/8192.f;
-    const float m2 = 2523.f/32.f;
-    const float c1 = 107.f/128.f;
-    const float c2 = 2413.f/128.f;
-    const float c3 = 2392.f/128.f;
-
-    const float SDR_LEVEL = 100.f;
-    sig *= SDR_LEVEL/10000.f;
+    using namespace PQ;
+    sig *= SDR_LEVEL/MAX_LEVEL;
     float psig = powf(sig, m1);
     float num = c1 + c2*psig;
     float den = 1 + c3*psig;
     return powf(num/den, m2);
 }
 
-float convertHLGFromLinear(float sig)
+float convertPQToLinear(float sig)
 {
-    const float a = 0.17883277f;
-    const float b = 0.28466892f; // = 1 - 4a
-    const float c = 0.55991073f; // = 0.5 - a ln(4a)
+    using namespace PQ;
+    float e = powf(sig, 1.f/m2);
+    float num = qMax(e - c1, 0.f);
+    float den = c2 - c3*e;
+    return powf(num/den, 1.f/m1) * MAX_LEVEL/SDR_LEVEL;
+}
 
+float convertHLGFromLinear(float sig)
+{
+    using namespace HLG;
     if (sig < 1.f/12.f)
         return sqrtf(3.f*sig);
     return a*logf(12.f*sig - b) + c;
 }
 
+float convertHLGToLinear(float sig)
+{
+    using namespace HLG;
+    if (sig < .5f)
+        return sig*sig/3.f;
+    return (expf((sig - c)/a) + b)/12.f;
+}
+
 static float convertSDRFromLinear(float sig)
 {
     return sig;
 }
 
+ToneMappingRange toneMappingRange(const QVideoFrameFormat &format, float maxNits)
+{
+    // HDR with a PQ or HLG transfer function uses a BT2390 based tone mapping to cut off the HDR peaks
+    // This requires that we pass the max luminance the tonemapper should clip to over to the fragment
+    // shader. To reduce computations there, it's precomputed in PQ values here.
+    auto fromLinear = convertSDRFromLinear;
+    switch (format.colorTransfer()) {
+    case QVideoFrameFormat::ColorTransfer_ST2084:
+        fromLinear = convertPQFromLinear;
+        break;
+    case QVideoFrameFormat::ColorTransfer_STD_B67:
+        fromLinear = convertHLGFromLinear;
+        break;
+    default:
+        break;
+    }
+
+    return { fromLinear(float(format.maxLuminance())/100.f), fromLinear(maxNits/100.f) };
+}
+
 void updateUniformData(QByteArray *dst, const QVideoFrameFormat &format, const QVideoFrame &frame, const QMatrix4x4 &transform, float opacity, float maxNits)
 {
 #ifndef Q_OS_ANDROID
@@ -560,20 +609,7 @@ void updateUniformData(QByteArray *dst, const QVideoFrameFormat &format, const Q
         break;
     }
 
-    // HDR with a PQ or HLG transfer function uses a BT2390 based tone mapping to cut off the HDR peaks
-    // This requires that we pass the max luminance the tonemapper should clip to over to the fragment
-    // shader. To reduce computations there, it's precomputed in PQ values here.
-    auto fromLinear = convertSDRFromLinear;
-    switch (format.colorTransfer()) {
-    case QVideoFrameFormat::ColorTransfer_ST2084:
-        fromLinear = convertPQFromLinear;
-        break;
-    case QVideoFrameFormat::ColorTransfer_STD_B67:
-        fromLinear = convertHLGFromLinear;
-        break;
-    default:
-        break;
-    }
+    const ToneMappingRange toneMapping = toneMappingRange(format, maxNits);
 
     if (dst->size() < qsizetype(sizeof(UniformData)))
         dst->resize(sizeof(UniformData));
@@ -583,8 +619,8 @@ void updateUniformData(QByteArray *dst, const QVideoFrameFormat &format, const Q
     memcpy(ud->colorMatrix, cmat.constData(), sizeof(ud->transformMatrix));
     ud->opacity = opacity;
     ud->width = float(format.frameWidth());
-    ud->masteringWhite = fromLinear(float(format.maxLuminance())/100.f);
-    ud->maxLum = fromLinear(float(maxNits)/100.f);
+    ud->masteringWhite = toneMapping.masteringWhite;
+    ud->maxLum = toneMapping.maxLum;
 }
 
 static bool updateTextureWithMap(QVideoFrame& frame, QRhi *rhi, QRhiResourceUpdateBatch *rub, int plane, std::unique_ptr<QRhiTexture> &tex)
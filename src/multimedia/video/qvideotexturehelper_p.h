@@ -17,6 +17,7 @@
 
 #include <qvideoframeformat.h>
 #include <rhi/qrhi.h>
+#include <QtGui/qmatrix4x4.h>
 
 #include <QtGui/qtextlayout.h>
 
@@ -62,6 +63,27 @@ Q_MULTIMEDIA_EXPORT const TextureDescription *textureDescription(QVideoFrameForm
 
 Q_MULTIMEDIA_EXPORT QString vertexShaderFileName(const QVideoFrameFormat &format);
 Q_MULTIMEDIA_EXPORT QString fragmentShaderFileName(const QVideoFrameFormat &format, QRhiSwapChain::Format surfaceFormat = QRhiSwapChain::SDR);
+
+// Matrix converting normalized (Y, U, V, 1) to RGB, as used by the shaders and
+// the CPU conversion
+Q_MULTIMEDIA_EXPORT QMatrix4x4 colorMatrix(const QVideoFrameFormat &format);
+
+// The PQ (SMPTE ST 2084) and HLG (ARIB STD-B67) transfer functions, see colortransfer.glsl.
+// Linear PQ values are relative to the SDR level of 100 nits.
+Q_MULTIMEDIA_EXPORT float convertPQFromLinear(float sig);
+Q_MULTIMEDIA_EXPORT float convertPQToLinear(float sig);
+Q_MULTIMEDIA_EXPORT float convertHLGFromLinear(float sig);
+Q_MULTIMEDIA_EXPORT float convertHLGToLinear(float sig);
+
+// Range of the HDR tone mapping (see hdrtonemapper.glsl), in the non linear
+// signal domain of the format's color transfer
+struct ToneMappingRange
+{
+    float masteringWhite;
+    float maxLum;
+};
+Q_MULTIMEDIA_EXPORT ToneMappingRange toneMappingRange(const QVideoFrameFormat &format, float maxNits = 100);
+
 Q_MULTIMEDIA_EXPORT void updateUniformData(QByteArray *dst, const QVideoFrameFormat &format, const QVideoFrame &frame,
                                            const QMatrix4x4 &transform, float opacity, float maxNits = 100);
 Q_MULTIMEDIA_EXPORT std::unique_ptr<QVideoFrameTextures> createTextures(QVideoFrame &frame, QRhi *rhi, QRhiResourceUpdateBatch *rub, std::unique_ptr<QVideoFrameTextures> &&oldTextures);
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "playbackengine/qffmpegaudiorenderer_p.h"
+#include "playbackengine/qffmpegaudiotimestretcher_p.h"
 #include "qaudiosink.h"
 #include "qaudiooutput.h"
 #include "private/qplatformaudiooutput_p.h"
@@ -107,17 +108,23 @@ Renderer::RenderingResult AudioRenderer::renderInternal(Frame frame)
 
     if (!m_bufferedData.isValid()) {
         if (!frame.isValid()) {
-            if (std::exchange(m_drained, true))
-                return {};
+            // write the samples kept by the time stretcher before draining
+            if (!m_drained && m_timeStretcher)
+                m_bufferedData = { m_timeStretcher->flush() };
 
-            const auto time = bufferLoadingTime(syncStamp);
+            if (!m_bufferedData.isValid()) {
+                if (std::exchange(m_drained, true))
+                    return {};
 
-            qCDebug(qLcAudioRenderer) << "Draining AudioRenderer, time:" << time;
+                const auto time = bufferLoadingTime(syncStamp);
 
-            return { time.count() == 0, time };
-        }
+                qCDebug(qLcAudioRenderer) << "Draining AudioRenderer, time:" << time;
 
-        m_bufferedData = { m_resampler->resample(frame.avFrame()) };
+                return { time.count() == 0, time };
+            }
+        } else {
+            m_bufferedData = { processFrame(frame) };
+        }
     }
 
     if (m_bufferedData.isValid()) {
@@ -131,7 +138,8 @@ Renderer::RenderingResult AudioRenderer::renderInternal(Frame frame)
         if (m_bufferedData.size() <= 0) {
             m_bufferedData = {};
 
-            return {};
+            // the end of stream is handled by the next step, after the flushed data is written
+            return { frame.isValid(), 0us };
         }
 
         const auto remainingDuration = durationForBytes(m_bufferedData.size());
@@ -143,11 +151,6 @@ Renderer::RenderingResult AudioRenderer::renderInternal(Frame frame)
     return {};
 }
 
-void AudioRenderer::onPlaybackRateChanged()
-{
-    m_resampler.reset();
-}
-
 int AudioRenderer::timerInterval() const
 {
     constexpr auto MaxFixableInterval = 50; // ms
@@ -183,10 +186,22 @@ void AudioRenderer::initResempler(const Codec *codec)
     #endif
     */
 
+    // The playback rate is applied by the time stretcher, which keeps the pitch
+    // and handles rate changes without recreating the resampler.
     auto resamplerFormat = m_format;
-    resamplerFormat.setSampleRate(
-            qRound(m_format.sampleRate() / playbackRate() * sampleRateFactor()));
+    resamplerFormat.setSampleRate(qRound(m_format.sampleRate() * sampleRateFactor()));
     m_resampler = std::make_unique<QFFmpegResampler>(codec, resamplerFormat);
+    m_timeStretcher = std::make_unique<AudioTimeStretcher>(resamplerFormat);
+}
+
+QAudioBuffer AudioRenderer::processFrame(const Frame &frame)
+{
+    Q_ASSERT(m_resampler && m_timeStretcher);
+
+    m_timeStretcher->setPlaybackRate(playbackRate());
+    // the samples of the frame are written after the ones kept by the stretcher
+    m_timeStretcherLatency = m_timeStretcher->latency();
+    return m_timeStretcher->process(m_resampler->resample(frame.avFrame()));
 }
 
 void AudioRenderer::freeOutput()
@@ -213,6 +228,8 @@ void AudioRenderer::updateOutput(const Codec *codec)
         freeOutput();
         m_format = {};
         m_resampler.reset();
+        m_timeStretcher.reset();
+        m_timeStretcherLatency = Microseconds(0);
     }
 
     if (!m_output)
@@ -259,7 +276,8 @@ void AudioRenderer::updateSynchronization(const SynchronizationStamp &stamp, con
     const auto bufferLoadingTime = this->bufferLoadingTime(stamp);
     const auto currentFrameDelay = frameDelay(frame, stamp.timePoint);
     const auto writtenTime = durationForBytes(stamp.bufferBytesWritten);
-    const auto soundDelay = currentFrameDelay + bufferLoadingTime - writtenTime;
+    const auto soundDelay =
+            currentFrameDelay + bufferLoadingTime + m_timeStretcherLatency - writtenTime;
 
     auto synchronize = [&](microseconds fixedDelay, microseconds targetSoundDelay) {
         // TODO: investigate if we need sample compensation here
@@ -270,8 +288,9 @@ void AudioRenderer::updateSynchronization(const SynchronizationStamp &stamp, con
             qCDebug(qLcAudioRenderer)
                 << "Change rendering time:"
                 << "\n  First frame:" << m_firstFrame
-                << "\n  Delay (frame+buffer-written):" << currentFrameDelay << "+"
-                                                       << bufferLoadingTime << "-"
+                << "\n  Delay (frame+buffer+stretcher-written):" << currentFrameDelay << "+"
+                                                       << bufferLoadingTime << "+"
+                                                       << m_timeStretcherLatency << "-"
                                                        << writtenTime << "="
                                                        << soundDelay
                 << "\n  Fixed delay:" << fixedDelay
@@ -26,6 +26,8 @@ class QFFmpegResampler;
 
 namespace QFFmpeg {
 
+class AudioTimeStretcher;
+
 class AudioRenderer : public Renderer
 {
     Q_OBJECT
@@ -73,8 +75,6 @@ protected:
 
     RenderingResult renderInternal(Frame frame) override;
 
-    void onPlaybackRateChanged() override;
-
     int timerInterval() const override;
 
     void onPauseChanged() override;
@@ -85,6 +85,8 @@ protected:
 
     void initResempler(const Codec *codec);
 
+    QAudioBuffer processFrame(const Frame &frame);
+
     void onDeviceChanged();
 
     void updateVolume();
@@ -103,6 +105,9 @@ private:
     AudioTimings m_timings;
     BufferLoadingInfo m_bufferLoadingInfo;
     std::unique_ptr<QFFmpegResampler> m_resampler;
+    std::unique_ptr<AudioTimeStretcher> m_timeStretcher;
+    // the delay of the samples of the current frame caused by the time stretcher
+    Microseconds m_timeStretcherLatency = Microseconds(0);
     QAudioFormat m_format;
 
     BufferedDataWithOffset m_bufferedData;
@@ -0,0 +1,257 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpegaudiotimestretcher_p.h"
+
+#include <QtCore/qmath.h>
+#include <QtMultimedia/private/qaudiohelpers_p.h>
+
+#include <algorithm>
+#include <cmath>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+namespace {
+
+constexpr int WindowDuration = 24000; // us
+constexpr qsizetype MinWindowLength = 64;
+
+// The segment search is done on every CoarseSearchStep-th position using every
+// CoarseSampleStep-th sample, and then refined around the best match.
+constexpr qsizetype CoarseSearchStep = 4;
+constexpr qsizetype CoarseSampleStep = 2;
+
+constexpr float MinPlaybackRate = 0.0625f;
+constexpr float MaxPlaybackRate = 16.f;
+
+} // namespace
+
+AudioTimeStretcher::AudioTimeStretcher(const QAudioFormat &format)
+    : m_format(format), m_channelCount(qMax(format.channelCount(), 1))
+{
+    Q_ASSERT(format.isValid());
+
+    // the window length is even, so that two halves of the Hann window sum up to 1
+    m_windowLength = qMax(qsizetype(format.framesForDuration(WindowDuration)), MinWindowLength);
+    m_windowLength &= ~qsizetype(1);
+    m_overlapLength = m_windowLength / 2;
+    m_searchRadius = m_windowLength / 4;
+
+    m_window.resize(m_windowLength);
+    for (qsizetype i = 0; i < m_windowLength; ++i)
+        m_window[i] = 0.5f - 0.5f * std::cos(2. * M_PI * i / m_windowLength);
+
+    m_overlap.resize(m_overlapLength * m_channelCount);
+}
+
+void AudioTimeStretcher::setPlaybackRate(float rate)
+{
+    m_playbackRate = rate == 1.f ? rate : std::clamp(rate, MinPlaybackRate, MaxPlaybackRate);
+}
+
+QAudioBuffer AudioTimeStretcher::process(const QAudioBuffer &buffer)
+{
+    Q_ASSERT(!buffer.isValid() || buffer.format() == m_format);
+
+    if (m_format.sampleFormat() == QAudioFormat::Unknown)
+        return buffer;
+
+    if (m_playbackRate == 1.f && isIdle()) {
+        m_framesOutput += buffer.frameCount();
+        return buffer;
+    }
+
+    appendInput(buffer);
+
+    // Back to the normal rate: the pending segment fades into the input,
+    // the following buffers are passed through as is.
+    if (m_playbackRate == 1.f)
+        return flush();
+
+    std::vector<float> output;
+    while (processSegment(output))
+        ;
+
+    discardProcessedInput();
+
+    return makeBuffer(output.data(), static_cast<qsizetype>(output.size()) / m_channelCount);
+}
+
+std::chrono::microseconds AudioTimeStretcher::latency() const
+{
+    // the output so far continues the input at the nominal position
+    const double pending = double(m_inputMono.size()) - (m_started ? m_nominalPos : 0.);
+    if (pending <= 0. || m_format.sampleRate() <= 0)
+        return std::chrono::microseconds(0);
+
+    return std::chrono::microseconds(
+            qRound64(pending * 1000000. / m_format.sampleRate() / m_playbackRate));
+}
+
+QAudioBuffer AudioTimeStretcher::flush()
+{
+    // The falling half of the previous segment and the rising half of its natural
+    // continuation sum up to the continuation itself, so the rest of the input can
+    // be returned as is.
+    const qsizetype from = m_started ? m_previousPos + m_overlapLength : 0;
+    const qsizetype frames = static_cast<qsizetype>(m_inputMono.size()) - from;
+
+    auto result = makeBuffer(m_input.data() + from * m_channelCount, frames);
+
+    m_input.clear();
+    m_inputMono.clear();
+    m_started = false;
+    m_previousPos = 0;
+    m_nominalPos = 0.;
+
+    return result;
+}
+
+void AudioTimeStretcher::appendInput(const QAudioBuffer &buffer)
+{
+    if (!buffer.isValid())
+        return;
+
+    const qsizetype frames = buffer.frameCount();
+    const auto offset = static_cast<qsizetype>(m_inputMono.size());
+    m_input.resize(m_input.size() + frames * m_channelCount);
+    m_inputMono.resize(m_inputMono.size() + frames);
+
+    float *input = m_input.data() + offset * m_channelCount;
+    QAudioHelperInternal::qConvertToFloat(1., m_format, buffer.constData<char>(), input,
+                                          static_cast<int>(frames * m_channelCount));
+
+    const float monoScale = 1.f / m_channelCount;
+    for (qsizetype i = 0; i < frames; ++i) {
+        float sum = 0.f;
+        for (int c = 0; c < m_channelCount; ++c)
+            sum += *input++;
+        m_inputMono[offset + i] = sum * monoScale;
+    }
+}
+
+bool AudioTimeStretcher::processSegment(std::vector<float> &output)
+{
+    const auto available = static_cast<qsizetype>(m_inputMono.size());
+    qsizetype pos = 0;
+
+    if (!m_started) {
+        if (available < m_windowLength)
+            return false;
+
+        // Pretend that the first segment continues a previous one, so that
+        // the stretched stream starts without fading in.
+        for (qsizetype i = 0; i < m_overlapLength; ++i)
+            for (int c = 0; c < m_channelCount; ++c)
+                m_overlap[i * m_channelCount + c] =
+                        m_input[i * m_channelCount + c] * m_window[i + m_overlapLength];
+
+        m_started = true;
+        m_nominalPos = 0.;
+    } else {
+        const auto nominalPos = static_cast<qsizetype>(qRound64(m_nominalPos));
+        if (nominalPos + m_searchRadius + m_windowLength > available)
+            return false;
+
+        pos = findBestSegment(m_previousPos + m_overlapLength, nominalPos);
+    }
+
+    const auto outputOffset = output.size();
+    output.resize(outputOffset + m_overlapLength * m_channelCount);
+
+    const float *segment = m_input.data() + pos * m_channelCount;
+    const float *segmentTail = segment + m_overlapLength * m_channelCount;
+    float *out = output.data() + outputOffset;
+
+    for (qsizetype i = 0; i < m_overlapLength; ++i) {
+        const float rise = m_window[i];
+        const float fall = m_window[i + m_overlapLength];
+        for (int c = 0; c < m_channelCount; ++c) {
+            const auto index = i * m_channelCount + c;
+            out[index] = m_overlap[index] + rise * segment[index];
+            m_overlap[index] = fall * segmentTail[index];
+        }
+    }
+
+    m_previousPos = pos;
+    m_nominalPos += m_overlapLength * double(m_playbackRate);
+
+    return true;
+}
+
+qsizetype AudioTimeStretcher::findBestSegment(qsizetype templatePos, qsizetype nominalPos) const
+{
+    const float *pattern = m_inputMono.data() + templatePos;
+
+    // normalized cross-correlation over the overlapping part of the segments
+    auto similarity = [&](qsizetype pos, qsizetype sampleStep) {
+        const float *candidate = m_inputMono.data() + pos;
+        float correlation = 0.f;
+        float energy = 0.f;
+        for (qsizetype i = 0; i < m_overlapLength; i += sampleStep) {
+            correlation += pattern[i] * candidate[i];
+            energy += candidate[i] * candidate[i];
+        }
+        return correlation / std::sqrt(energy + 1e-9f);
+    };
+
+    const qsizetype from = qMax(nominalPos - m_searchRadius, qsizetype(0));
+    const qsizetype to = nominalPos + m_searchRadius;
+
+    auto search = [&](qsizetype from, qsizetype to, qsizetype step, qsizetype sampleStep,
+                      qsizetype bestPos) {
+        float bestSimilarity = similarity(bestPos, sampleStep);
+        for (qsizetype pos = from; pos <= to; pos += step) {
+            const float value = similarity(pos, sampleStep);
+            if (value > bestSimilarity) {
+                bestSimilarity = value;
+                bestPos = pos;
+            }
+        }
+        return bestPos;
+    };
+
+    const auto coarsePos = search(from, to, CoarseSearchStep, CoarseSampleStep, nominalPos);
+    return search(qMax(coarsePos - CoarseSearchStep + 1, from),
+                  qMin(coarsePos + CoarseSearchStep - 1, to), 1, 1, coarsePos);
+}
+
+void AudioTimeStretcher::discardProcessedInput()
+{
+    const auto nominalPos = static_cast<qsizetype>(m_nominalPos);
+    const auto available = static_cast<qsizetype>(m_inputMono.size());
+    const auto discarded = std::clamp(
+            qMin(m_previousPos + m_overlapLength, nominalPos - m_searchRadius), qsizetype(0),
+            available);
+
+    // keep memmove rare
+    if (discarded < m_windowLength)
+        return;
+
+    m_input.erase(m_input.begin(), m_input.begin() + discarded * m_channelCount);
+    m_inputMono.erase(m_inputMono.begin(), m_inputMono.begin() + discarded);
+    m_previousPos -= discarded;
+    m_nominalPos -= discarded;
+}
+
+QAudioBuffer AudioTimeStretcher::makeBuffer(const float *data, qsizetype frames)
+{
+    if (frames <= 0)
+        return {};
+
+    const qsizetype count = frames * m_channelCount;
+    QByteArray bytes(m_format.bytesForFrames(static_cast<qint32>(frames)), Qt::Uninitialized);
+
+    QAudioHelperInternal::qConvertFromFloat(1., m_format, data, bytes.data(),
+                                            static_cast<int>(count));
+
+    const qint64 startTime = m_framesOutput * 1000000 / m_format.sampleRate();
+    m_framesOutput += frames;
+    return QAudioBuffer(bytes, m_format, startTime);
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
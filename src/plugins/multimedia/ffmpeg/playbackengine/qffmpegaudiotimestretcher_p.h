@@ -0,0 +1,88 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QFFMPEGAUDIOTIMESTRETCHER_P_H
+#define QFFMPEGAUDIOTIMESTRETCHER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qaudiobuffer.h"
+
+#include <chrono>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+// Changes the tempo of an audio stream without changing its pitch (WSOLA).
+//
+// Segments of the input are overlap-added with a fixed synthesis hop, while the
+// analysis hop is scaled by the playback rate. Each segment is picked within a small
+// search window so that it continues the previous segment as smoothly as possible.
+// The rate can be changed at any time without flushing; with the rate 1 the stretcher
+// cross-fades its pending data back into the input and then passes buffers through.
+class AudioTimeStretcher
+{
+public:
+    explicit AudioTimeStretcher(const QAudioFormat &format);
+
+    void setPlaybackRate(float rate);
+    float playbackRate() const { return m_playbackRate; }
+
+    QAudioBuffer process(const QAudioBuffer &buffer);
+
+    // Returns the playing time of the input that is kept and hasn't been output yet;
+    // the samples of the next buffer are delayed by it.
+    std::chrono::microseconds latency() const;
+
+    // Returns the input that hasn't been processed yet and resets the state.
+    QAudioBuffer flush();
+
+private:
+    bool isIdle() const { return !m_started && m_input.empty(); }
+
+    void appendInput(const QAudioBuffer &buffer);
+
+    bool processSegment(std::vector<float> &output);
+
+    qsizetype findBestSegment(qsizetype templatePos, qsizetype nominalPos) const;
+
+    void discardProcessedInput();
+
+    QAudioBuffer makeBuffer(const float *data, qsizetype frames);
+
+private:
+    QAudioFormat m_format;
+    int m_channelCount = 0;
+    qsizetype m_windowLength = 0;
+    qsizetype m_overlapLength = 0;
+    qsizetype m_searchRadius = 0;
+    std::vector<float> m_window;
+
+    float m_playbackRate = 1.f;
+
+    std::vector<float> m_input; // interleaved
+    std::vector<float> m_inputMono; // channels mixed down, used for the segment search
+    std::vector<float> m_overlap; // falling half of the previous segment, interleaved
+
+    bool m_started = false;
+    qsizetype m_previousPos = 0;
+    double m_nominalPos = 0.;
+    qint64 m_framesOutput = 0;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGAUDIOTIMESTRETCHER_P_H
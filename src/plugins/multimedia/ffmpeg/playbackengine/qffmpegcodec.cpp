@@ -25,7 +25,7 @@ Codec::Data::~Data()
     avcodec_close(context.get());
 }
 
-QMaybe<Codec> Codec::create(AVStream *stream, AVFormatContext *formatContext)
+QMaybe<Codec> Codec::create(AVStream *stream, AVFormatContext *formatContext, int threadsCount)
 {
     if (!stream)
         return { "Invalid stream" };
@@ -67,7 +67,10 @@ QMaybe<Codec> Codec::create(AVStream *stream, AVFormatContext *formatContext)
     /* Init the decoder, with reference counting and threading */
     AVDictionaryHolder opts;
     av_dict_set(opts, "refcounted_frames", "1", 0);
-    av_dict_set(opts, "threads", "auto", 0);
+    if (threadsCount > 0)
+        av_dict_set_int(opts, "threads", threadsCount, 0);
+    else
+        av_dict_set(opts, "threads", "auto", 0);
     applyExperimentalCodecOptions(decoder, opts);
 
     ret = avcodec_open2(context.get(), decoder, opts);
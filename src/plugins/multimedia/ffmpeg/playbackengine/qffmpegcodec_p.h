@@ -40,7 +40,9 @@ class Codec
     };
 
 public:
-    static QMaybe<Codec> create(AVStream *stream, AVFormatContext *formatContext);
+    // threadsCount 0 lets FFmpeg choose the number of decoding threads
+    static QMaybe<Codec> create(AVStream *stream, AVFormatContext *formatContext,
+                                int threadsCount = 0);
 
     AVRational pixelAspectRatio(AVFrame *frame) const;
 
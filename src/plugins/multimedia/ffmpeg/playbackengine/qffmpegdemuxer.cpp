@@ -6,12 +6,6 @@
 
 QT_BEGIN_NAMESPACE
 
-// 4 sec for buffering. TODO: maybe move to env var customization
-static constexpr qint64 MaxBufferedDurationUs = 4'000'000;
-
-// around 4 sec of hdr video
-static constexpr qint64 MaxBufferedSize = 32 * 1024 * 1024;
-
 namespace QFFmpeg {
 
 static Q_LOGGING_CATEGORY(qLcDemuxer, "qt.multimedia.ffmpeg.demuxer");
@@ -31,12 +25,19 @@ static qint64 packetEndPos(const AVStream *stream, const Packet &packet)
 }
 
 Demuxer::Demuxer(AVFormatContext *context, const PositionWithOffset &posWithOffset,
-                 const StreamIndexes &streamIndexes, int loops)
-    : m_context(context), m_posWithOffset(posWithOffset), m_loops(loops)
+                 const StreamIndexes &streamIndexes, int loops,
+                 const BufferingPolicy &bufferingPolicy, QMediaPlayer::SeekMode seekMode)
+    : m_context(context),
+      m_posWithOffset(posWithOffset),
+      m_loops(loops),
+      m_bufferingPolicy(bufferingPolicy),
+      m_seekMode(seekMode),
+      m_bufferedPosition(posWithOffset.offset.pos + posWithOffset.pos)
 {
     qCDebug(qLcDemuxer) << "Create demuxer."
                         << "pos:" << posWithOffset.pos << "loop offset:" << posWithOffset.offset.pos
-                        << "loop index:" << posWithOffset.offset.index << "loops:" << loops;
+                        << "loop index:" << posWithOffset.offset.index << "loops:" << loops
+                        << "seek mode:" << seekMode;
 
     Q_ASSERT(m_context);
     Q_ASSERT(loops < 0 || m_posWithOffset.offset.index < loops);
@@ -65,6 +66,8 @@ void Demuxer::doNextStep()
             if (!std::exchange(m_buffered, true))
                 emit packetsBuffered();
 
+            m_bufferedPosition.storeRelease(m_maxPacketsEndPos);
+
             setAtEnd(true);
         } else {
             m_seeked = false;
@@ -101,16 +104,22 @@ void Demuxer::doNextStep()
         streamData.bufferedSize += avPacket.size;
         streamData.maxSentPacketsPos = qMax(streamData.maxSentPacketsPos, endPos);
         updateStreamDataLimitFlag(streamData);
+        updateBufferedPosition();
 
-        if (!m_buffered && streamData.isDataLimitReached) {
+        if (!m_buffered
+            && (streamData.isDataLimitReached
+                || streamData.effectiveBufferedDuration()
+                        >= m_bufferingPolicy.highWatermark.count())) {
             m_buffered = true;
             emit packetsBuffered();
         }
 
         if (!m_firstPacketFound) {
             m_firstPacketFound = true;
-            const auto pos = streamTimeToUs(stream, avPacket.pts);
-            emit firstPacketFound(std::chrono::steady_clock::now(), pos);
+            const auto pos = m_keyFramePosition ? *m_keyFramePosition
+                                                : streamTimeToUs(stream, avPacket.pts);
+            emit firstPacketFound(std::chrono::steady_clock::now(),
+                                  m_posWithOffset.offset.pos + pos);
         }
 
         auto signal = signalByTrackType(it->second.trackType);
@@ -174,7 +183,18 @@ void Demuxer::ensureSeeked()
         return;
 
     if ((m_context->ctx_flags & AVFMTCTX_UNSEEKABLE) == 0) {
-        const qint64 seekPos = m_posWithOffset.pos * AV_TIME_BASE / 1000000;
+        auto pos = m_posWithOffset.pos;
+
+        // Fast seeking goes to the nearest key frame instead of the preceding one, and
+        // the playback starts there, so the decoders have nothing to catch up with.
+        // Loops always start from the beginning.
+        if (std::exchange(m_seekMode, QMediaPlayer::AccurateSeek) == QMediaPlayer::FastSeek) {
+            m_keyFramePosition = nearestKeyFramePosition(pos);
+            pos = m_keyFramePosition.value_or(pos);
+            qCDebug(qLcDemuxer) << "Fast seek from" << m_posWithOffset.pos << "to" << pos;
+        }
+
+        const qint64 seekPos = pos * AV_TIME_BASE / 1000000;
         auto err = av_seek_frame(m_context, -1, seekPos, AVSEEK_FLAG_BACKWARD);
 
         if (err < 0) {
@@ -191,6 +211,40 @@ void Demuxer::ensureSeeked()
     setAtEnd(false);
 }
 
+std::optional<qint64> Demuxer::nearestKeyFramePosition(qint64 position) const
+{
+#if QT_FFMPEG_HAS_INDEX_ENTRY_API
+    for (const auto &[index, streamData] : m_streams) {
+        if (streamData.trackType != QPlatformMediaPlayer::VideoStream)
+            continue;
+
+        AVStream *stream = m_context->streams[index];
+        const auto timestamp = av_rescale_q(position, AVRational{ 1, 1000000 }, stream->time_base);
+
+        std::optional<qint64> result;
+        for (const int flags : { AVSEEK_FLAG_BACKWARD, 0 }) {
+            const int entryIndex = av_index_search_timestamp(stream, timestamp, flags);
+            const AVIndexEntry *entry =
+                    entryIndex >= 0 ? avformat_index_get_entry(stream, entryIndex) : nullptr;
+            if (!entry)
+                continue;
+
+            const auto entryPos = streamTimeToUs(stream, entry->timestamp);
+            if (!result || std::abs(entryPos - position) < std::abs(*result - position))
+                result = entryPos;
+        }
+
+        return result;
+    }
+#else
+    Q_UNUSED(position);
+#endif
+
+    // No index or no video; the demuxer seeks to the preceding key frame
+    // and the playback starts from the first packet.
+    return {};
+}
+
 Demuxer::RequestingSignal Demuxer::signalByTrackType(QPlatformMediaPlayer::TrackType trackType)
 {
     switch (trackType) {
@@ -213,13 +267,53 @@ void Demuxer::setLoops(int loopsCount)
     m_loops.storeRelease(loopsCount);
 }
 
+void Demuxer::setBufferingPolicy(const BufferingPolicy &policy)
+{
+    QMetaObject::invokeMethod(this, [this, policy]() {
+        qCDebug(qLcDemuxer) << "Set buffering policy, max duration:" << policy.maxDuration
+                            << "max size:" << policy.maxSize
+                            << "watermarks:" << policy.lowWatermark << policy.highWatermark;
+
+        m_bufferingPolicy = policy;
+
+        for (auto &[index, streamData] : m_streams) {
+            // re-evaluate from scratch, the low watermark only matters for the reached limit
+            streamData.isDataLimitReached = false;
+            updateStreamDataLimitFlag(streamData);
+        }
+
+        scheduleNextStep();
+    });
+}
+
 void Demuxer::updateStreamDataLimitFlag(StreamData &streamData)
 {
-    const auto packetsPosDiff = streamData.maxSentPacketsPos - streamData.maxProcessedPacketPos;
-    streamData.isDataLimitReached =
-           streamData.bufferedDuration >= MaxBufferedDurationUs
-        || (streamData.bufferedDuration == 0 && packetsPosDiff >= MaxBufferedDurationUs)
-        || streamData.bufferedSize >= MaxBufferedSize;
+    const auto bufferedDuration = streamData.effectiveBufferedDuration();
+    const bool sizeLimitReached = streamData.bufferedSize >= m_bufferingPolicy.maxSize;
+
+    // Once a limit is reached, the demuxer waits until the buffered duration drops
+    // to the low watermark to avoid waking up on each processed packet.
+    streamData.isDataLimitReached = sizeLimitReached
+            || (streamData.isDataLimitReached
+                        ? bufferedDuration > m_bufferingPolicy.lowWatermark.count()
+                        : bufferedDuration >= m_bufferingPolicy.maxDuration.count());
+}
+
+void Demuxer::updateBufferedPosition()
+{
+    std::optional<qint64> position;
+
+    for (const auto &[index, streamData] : m_streams) {
+        // subtitle packets are sparse, so they don't limit the buffered range
+        if (streamData.trackType == QPlatformMediaPlayer::SubtitleStream && m_streams.size() > 1)
+            continue;
+
+        position = position ? qMin(*position, streamData.maxSentPacketsPos)
+                            : streamData.maxSentPacketsPos;
+    }
+
+    if (position && *position > m_bufferedPosition.loadRelaxed())
+        m_bufferedPosition.storeRelease(*position);
 }
 
 } // namespace QFFmpeg
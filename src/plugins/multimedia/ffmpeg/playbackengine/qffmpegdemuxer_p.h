@@ -19,6 +19,7 @@
 #include "playbackengine/qffmpegpacket_p.h"
 #include "playbackengine/qffmpegpositionwithoffset_p.h"
 
+#include <optional>
 #include <unordered_map>
 
 QT_BEGIN_NAMESPACE
@@ -29,14 +30,24 @@ class Demuxer : public PlaybackEngineObject
 {
     Q_OBJECT
 public:
+    using BufferingPolicy = QPlatformMediaPlayer::BufferingPolicy;
+
     Demuxer(AVFormatContext *context, const PositionWithOffset &posWithOffset,
-            const StreamIndexes &streamIndexes, int loops);
+            const StreamIndexes &streamIndexes, int loops,
+            const BufferingPolicy &bufferingPolicy = {},
+            QMediaPlayer::SeekMode seekMode = QMediaPlayer::AccurateSeek);
 
     using RequestingSignal = void (Demuxer::*)(Packet);
     static RequestingSignal signalByTrackType(QPlatformMediaPlayer::TrackType trackType);
 
     void setLoops(int loopsCount);
 
+    void setBufferingPolicy(const BufferingPolicy &policy);
+
+    // The minimal end position of the packets sent by the active streams, including
+    // the loop offset. Thread-safe.
+    qint64 bufferedPosition() const { return m_bufferedPosition.loadAcquire(); }
+
 public slots:
     void onPacketProcessed(Packet);
 
@@ -54,6 +65,8 @@ private:
 
     void ensureSeeked();
 
+    std::optional<qint64> nearestKeyFramePosition(qint64 position) const;
+
 private:
     struct StreamData
     {
@@ -65,10 +78,19 @@ private:
         qint64 maxProcessedPacketPos = 0;
 
         bool isDataLimitReached = false;
+
+        qint64 effectiveBufferedDuration() const
+        {
+            // Some packets have no duration; then the distance between the positions is used.
+            return bufferedDuration == 0 ? maxSentPacketsPos - maxProcessedPacketPos
+                                         : bufferedDuration;
+        }
     };
 
     void updateStreamDataLimitFlag(StreamData &streamData);
 
+    void updateBufferedPosition();
+
 private:
     AVFormatContext *m_context = nullptr;
     bool m_seeked = false;
@@ -78,6 +100,10 @@ private:
     qint64 m_maxPacketsEndPos = 0;
     QAtomicInt m_loops = QMediaPlayer::Once;
     bool m_buffered = false;
+    BufferingPolicy m_bufferingPolicy;
+    QMediaPlayer::SeekMode m_seekMode = QMediaPlayer::AccurateSeek;
+    std::optional<qint64> m_keyFramePosition;
+    QAtomicInteger<qint64> m_bufferedPosition = 0;
 };
 
 } // namespace QFFmpeg
@@ -0,0 +1,265 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "playbackengine/qffmpegplaybackscheduler_p.h"
+
+#include "qthread.h"
+#include "qloggingcategory.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+QT_BEGIN_NAMESPACE
+
+static Q_LOGGING_CATEGORY(qLcPlaybackScheduler, "qt.multimedia.ffmpeg.playbackscheduler");
+
+namespace QFFmpeg {
+
+namespace {
+
+int priorityWeight(PlaybackScheduler::Priority priority)
+{
+    switch (priority) {
+    case PlaybackScheduler::Priority::Low:
+        return 1;
+    case PlaybackScheduler::Priority::High:
+        return 4;
+    default:
+        return 2;
+    }
+}
+
+} // namespace
+
+PlaybackScheduler::Lease::Lease(Lease &&other) noexcept
+    : m_scheduler(std::move(other.m_scheduler)),
+      m_thread(std::exchange(other.m_thread, nullptr)),
+      m_codecThreadsCount(std::exchange(other.m_codecThreadsCount, 0)),
+      m_weight(std::exchange(other.m_weight, 0)),
+      m_codecId(std::exchange(other.m_codecId, 0))
+{
+}
+
+PlaybackScheduler::Lease &PlaybackScheduler::Lease::operator=(Lease &&other) noexcept
+{
+    if (this != &other) {
+        release();
+        m_scheduler = std::move(other.m_scheduler);
+        m_thread = std::exchange(other.m_thread, nullptr);
+        m_codecThreadsCount = std::exchange(other.m_codecThreadsCount, 0);
+        m_weight = std::exchange(other.m_weight, 0);
+        m_codecId = std::exchange(other.m_codecId, 0);
+    }
+
+    return *this;
+}
+
+PlaybackScheduler::Lease::~Lease()
+{
+    release();
+}
+
+void PlaybackScheduler::Lease::release()
+{
+    if (auto scheduler = std::move(m_scheduler))
+        scheduler->release(*this);
+
+    m_thread = nullptr;
+    m_codecThreadsCount = 0;
+    m_weight = 0;
+    m_codecId = 0;
+}
+
+std::shared_ptr<PlaybackScheduler> PlaybackScheduler::instance()
+{
+    static const int threadsCount = qEnvironmentVariableIntValue("QT_FFMPEG_PLAYBACK_THREADS");
+    if (threadsCount <= 0)
+        return {};
+
+    static QBasicMutex mutex;
+    static std::weak_ptr<PlaybackScheduler> instance;
+
+    QMutexLocker locker(&mutex);
+
+    auto result = instance.lock();
+    if (!result) {
+        bool ok = false;
+        int budget = qEnvironmentVariableIntValue("QT_FFMPEG_DECODING_THREADS", &ok);
+        if (!ok || budget <= 0)
+            budget = QThread::idealThreadCount();
+
+        result = std::make_shared<PlaybackScheduler>(threadsCount, budget);
+        instance = result;
+    }
+
+    return result;
+}
+
+PlaybackScheduler::PlaybackScheduler(int threadsCount, int codecThreadsBudget)
+    : m_threadsCount(threadsCount), m_codecThreadsBudget(codecThreadsBudget)
+{
+    qCDebug(qLcPlaybackScheduler) << "Create playback scheduler; threads:" << threadsCount
+                                  << "codec threads budget:" << codecThreadsBudget;
+}
+
+PlaybackScheduler::~PlaybackScheduler()
+{
+    // the leases keep the scheduler alive, so all threads are free at this point
+    for (auto &data : m_threads)
+        data.thread->quit();
+
+    for (auto &data : m_threads)
+        data.thread->wait();
+}
+
+PlaybackScheduler::Lease PlaybackScheduler::acquireThread(Priority priority)
+{
+    QMutexLocker locker(&m_mutex);
+
+    auto found = std::min_element(m_threads.begin(), m_threads.end(),
+                                  [](const ThreadData &a, const ThreadData &b) {
+                                      return a.load < b.load;
+                                  });
+
+    // start new threads only if the existing ones are busy
+    if (found == m_threads.end()
+        || (found->load > 0 && static_cast<int>(m_threads.size()) < m_threadsCount)) {
+        auto thread = std::make_unique<QThread>();
+        thread->setObjectName(QStringLiteral("PlaybackSchedulerThread%1").arg(m_threads.size()));
+        thread->start();
+
+        m_threads.push_back({ std::move(thread), 0 });
+        found = std::prev(m_threads.end());
+    }
+
+    Lease result;
+    result.m_scheduler = shared_from_this();
+    result.m_thread = found->thread.get();
+    result.m_weight = priorityWeight(priority);
+
+    found->load += result.m_weight;
+
+    return result;
+}
+
+PlaybackScheduler::Lease PlaybackScheduler::acquireCodecThreads(Priority priority,
+                                                                std::function<void()> onShareChanged)
+{
+    QMutexLocker locker(&m_mutex);
+
+    Lease result;
+    result.m_scheduler = shared_from_this();
+    result.m_weight = priorityWeight(priority);
+    result.m_codecId = ++m_lastCodecId;
+
+    m_codecsWeight += result.m_weight;
+    result.m_codecThreadsCount = codecShare(result.m_weight);
+
+    const auto notifiers = codecShareChangeNotifiers();
+
+    ShareChangeNotifierPtr notifier;
+    if (onShareChanged) {
+        notifier = std::make_shared<ShareChangeNotifier>();
+        notifier->onShareChanged = std::move(onShareChanged);
+    }
+
+    m_codecs.push_back({ result.m_codecId, result.m_weight, result.m_codecThreadsCount,
+                         std::move(notifier) });
+
+    qCDebug(qLcPlaybackScheduler) << "Codec threads acquired:" << result.m_codecThreadsCount
+                                  << "codecs:" << m_codecs.size();
+
+    locker.unlock();
+
+    notifyCodecShareChanges(notifiers);
+
+    return result;
+}
+
+bool PlaybackScheduler::updateCodecThreads(Lease &lease, double minRelativeChange)
+{
+    Q_ASSERT(lease.m_scheduler.get() == this && lease.m_codecId);
+
+    QMutexLocker locker(&m_mutex);
+
+    auto found = std::find_if(m_codecs.begin(), m_codecs.end(),
+                              [&](const CodecData &data) { return data.id == lease.m_codecId; });
+    Q_ASSERT(found != m_codecs.end());
+
+    const int share = codecShare(found->weight);
+    if (share == found->threadsCount
+        || std::abs(share - found->threadsCount) < minRelativeChange * found->threadsCount)
+        return false;
+
+    qCDebug(qLcPlaybackScheduler) << "Codec threads updated:" << found->threadsCount << "->"
+                                  << share;
+
+    found->threadsCount = share;
+    lease.m_codecThreadsCount = share;
+    return true;
+}
+
+void PlaybackScheduler::release(const Lease &lease)
+{
+    ShareChangeNotifierPtr releasedNotifier;
+    ShareChangeNotifiers notifiers;
+
+    QMutexLocker locker(&m_mutex);
+
+    if (lease.m_thread) {
+        auto found = std::find_if(m_threads.begin(), m_threads.end(),
+                                  [&](const ThreadData &data) {
+                                      return data.thread.get() == lease.m_thread;
+                                  });
+        Q_ASSERT(found != m_threads.end());
+        found->load -= lease.m_weight;
+    } else if (lease.m_codecId) {
+        auto found = std::find_if(m_codecs.begin(), m_codecs.end(), [&](const CodecData &data) {
+            return data.id == lease.m_codecId;
+        });
+        Q_ASSERT(found != m_codecs.end());
+        releasedNotifier = std::move(found->notifier);
+        m_codecs.erase(found);
+        m_codecsWeight -= lease.m_weight;
+
+        notifiers = codecShareChangeNotifiers();
+    }
+
+    locker.unlock();
+
+    // waits for a notification in progress on another thread
+    if (releasedNotifier) {
+        QMutexLocker notifierLocker(&releasedNotifier->mutex);
+        releasedNotifier->onShareChanged = nullptr;
+    }
+
+    notifyCodecShareChanges(notifiers);
+}
+
+int PlaybackScheduler::codecShare(int weight) const
+{
+    Q_ASSERT(m_codecsWeight > 0);
+    return std::max(m_codecThreadsBudget * weight / m_codecsWeight, 1);
+}
+
+PlaybackScheduler::ShareChangeNotifiers PlaybackScheduler::codecShareChangeNotifiers() const
+{
+    ShareChangeNotifiers result;
+    for (const auto &data : m_codecs)
+        if (data.notifier && codecShare(data.weight) != data.threadsCount)
+            result.push_back(data.notifier);
+    return result;
+}
+
+void PlaybackScheduler::notifyCodecShareChanges(const ShareChangeNotifiers &notifiers)
+{
+    for (const auto &notifier : notifiers) {
+        QMutexLocker locker(&notifier->mutex);
+        if (notifier->onShareChanged)
+            notifier->onShareChanged();
+    }
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
@@ -0,0 +1,145 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QFFMPEGPLAYBACKSCHEDULER_P_H
+#define QFFMPEGPLAYBACKSCHEDULER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "private/qplatformmediaplayer_p.h"
+#include "qmutex.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+QT_BEGIN_NAMESPACE
+
+class QThread;
+
+namespace QFFmpeg {
+
+// Shares a fixed number of threads and a budget of codec threads between all
+// playback engines of the process. It's opt-in: QT_FFMPEG_PLAYBACK_THREADS sets
+// the number of threads, QT_FFMPEG_DECODING_THREADS sets the codec threads budget
+// (the ideal thread count by default).
+// Without the scheduler, each playback engine object gets its own thread,
+// and each codec chooses the number of its threads automatically.
+//
+// The playback engine objects stay bound to their threads, so the load is balanced
+// when the objects are created: an object goes to the least loaded thread,
+// and objects of higher priority engines count as a heavier load.
+// The codec threads budget is split between all open codecs proportionally to their
+// priorities. The threads count of a codec is fixed when the codec is opened, so if
+// opening or closing a codec changes the shares of the others, their owners are notified,
+// and take the new shares with updateCodecThreads() when they reopen the codecs.
+// Each codec gets at least one thread,
+// so the budget is exceeded only if there are more codecs than threads in the budget.
+class PlaybackScheduler : public std::enable_shared_from_this<PlaybackScheduler>
+{
+public:
+    using Priority = QPlatformMediaPlayer::PlaybackPriority;
+
+    // Holds a thread or codec threads until destroyed
+    class Lease
+    {
+    public:
+        Lease() = default;
+        Lease(Lease &&other) noexcept;
+        Lease &operator=(Lease &&other) noexcept;
+        ~Lease();
+
+        bool isValid() const { return m_scheduler != nullptr; }
+
+        QThread *thread() const { return m_thread; }
+
+        // 0 means the automatic choice
+        int codecThreadsCount() const { return m_codecThreadsCount; }
+
+    private:
+        friend class PlaybackScheduler;
+
+        void release();
+
+        std::shared_ptr<PlaybackScheduler> m_scheduler;
+        QThread *m_thread = nullptr;
+        int m_codecThreadsCount = 0;
+        int m_weight = 0;
+        quint64 m_codecId = 0;
+    };
+
+    // Returns null if the scheduler is not enabled
+    static std::shared_ptr<PlaybackScheduler> instance();
+
+    PlaybackScheduler(int threadsCount, int codecThreadsBudget);
+
+    ~PlaybackScheduler();
+
+    Lease acquireThread(Priority priority);
+
+    // onShareChanged is invoked, without the scheduler locked, on the thread that
+    // acquires or releases the other codec threads when the share of the codec changes.
+    // It's not invoked any more once the lease is released.
+    Lease acquireCodecThreads(Priority priority, std::function<void()> onShareChanged = {});
+
+    // Returns true if the codec threads count of the lease has been changed to
+    // the current share; the codec has to be reopened then. The count is kept if
+    // it differs from the share by less than minRelativeChange of the count.
+    bool updateCodecThreads(Lease &lease, double minRelativeChange = 0.);
+
+private:
+    struct ThreadData
+    {
+        std::unique_ptr<QThread> thread;
+        int load = 0;
+    };
+
+    // Keeps the callback of a codec valid while it's invoked
+    struct ShareChangeNotifier
+    {
+        QMutex mutex;
+        std::function<void()> onShareChanged;
+    };
+    using ShareChangeNotifierPtr = std::shared_ptr<ShareChangeNotifier>;
+    using ShareChangeNotifiers = std::vector<ShareChangeNotifierPtr>;
+
+    struct CodecData
+    {
+        quint64 id = 0;
+        int weight = 0;
+        int threadsCount = 0;
+        ShareChangeNotifierPtr notifier;
+    };
+
+    void release(const Lease &lease);
+
+    int codecShare(int weight) const;
+
+    ShareChangeNotifiers codecShareChangeNotifiers() const;
+
+    static void notifyCodecShareChanges(const ShareChangeNotifiers &notifiers);
+
+    const int m_threadsCount;
+    const int m_codecThreadsBudget;
+
+    QMutex m_mutex;
+    std::vector<ThreadData> m_threads;
+    std::vector<CodecData> m_codecs;
+    int m_codecsWeight = 0;
+    quint64 m_lastCodecId = 0;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGPLAYBACKSCHEDULER_P_H
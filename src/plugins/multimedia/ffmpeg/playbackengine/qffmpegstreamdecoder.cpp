@@ -23,6 +23,8 @@ StreamDecoder::StreamDecoder(const Codec &codec, qint64 absSeekPos)
 
 StreamDecoder::~StreamDecoder()
 {
+    // the codec context is reused by the next decoder
+    m_codec.context()->skip_frame = AVDISCARD_DEFAULT;
     avcodec_flush_buffers(m_codec.context());
 }
 
@@ -114,8 +116,29 @@ void StreamDecoder::onFrameFound(Frame frame)
     emit requestHandleFrame(frame);
 }
 
+void StreamDecoder::updateFrameSkipping(const Packet &packet)
+{
+    // Until the seek position is reached, the decoded frames are dropped anyway,
+    // so non-reference ones don't need decoding. The reference frames are decoded
+    // fully (incl. loop filtering), as the frame at the seek position depends on them.
+    const AVPacket *avPacket = packet.isValid() ? packet.avPacket() : nullptr;
+    const bool catchingUp = avPacket && avPacket->pts != AV_NOPTS_VALUE && avPacket->duration > 0
+            && packet.loopOffset().pos + m_codec.toUs(avPacket->pts + avPacket->duration)
+                    < m_absSeekPos;
+
+    auto *context = m_codec.context();
+    const auto skipFrame = catchingUp ? AVDISCARD_NONREF : AVDISCARD_DEFAULT;
+    if (context->skip_frame != skipFrame) {
+        qCDebug(qLcStreamDecoder) << "Skip non-reference frames:" << catchingUp;
+        context->skip_frame = skipFrame;
+    }
+}
+
 void StreamDecoder::decodeMedia(Packet packet)
 {
+    if (m_trackType == QPlatformMediaPlayer::VideoStream)
+        updateFrameSkipping(packet);
+
     auto sendPacketResult = sendAVPacket(packet);
 
     if (sendPacketResult == AVERROR(EAGAIN)) {
@@ -57,6 +57,8 @@ protected:
 private:
     void decodeMedia(Packet);
 
+    void updateFrameSkipping(const Packet &packet);
+
     void decodeSubtitle(Packet);
 
     void onFrameFound(Frame frame);
@@ -153,6 +153,17 @@ using AVHWFramesConstraintsUPtr = std::unique_ptr<
 
 using SwrContextUPtr = std::unique_ptr<SwrContext, AVDeleter<decltype(&swr_free), &swr_free>>;
 
+using AVBufferPoolUPtr =
+        std::unique_ptr<AVBufferPool,
+                        AVDeleter<decltype(&av_buffer_pool_uninit), &av_buffer_pool_uninit>>;
+
+struct SwsContextDeleter
+{
+    void operator()(SwsContext *context) const { sws_freeContext(context); }
+};
+
+using SwsContextUPtr = std::unique_ptr<SwsContext, SwsContextDeleter>;
+
 using PixelOrSampleFormat = int;
 using AVScore = int;
 constexpr AVScore BestAVScore = std::numeric_limits<AVScore>::max();
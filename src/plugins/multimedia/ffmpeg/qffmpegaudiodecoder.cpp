@@ -8,6 +8,10 @@
 #include "playbackengine/qffmpegrenderer_p.h"
 
 #include <qloggingcategory.h>
+#include <qcoreapplication.h>
+#include <qmutex.h>
+#include <qqueue.h>
+#include <qwaitcondition.h>
 
 static Q_LOGGING_CATEGORY(qLcAudioDecoder, "qt.multimedia.ffmpeg.audioDecoder")
 
@@ -16,49 +20,210 @@ QT_BEGIN_NAMESPACE
 namespace QFFmpeg
 {
 
+// The renderer decodes up to MaxQueuedBuffers ahead of the reader
+static constexpr qsizetype MaxQueuedBuffers = 16;
+
+// Errors and the end of the stream are delivered to the reader's thread via queued
+// signals; without an event loop, they are checked with this interval.
+static constexpr auto PostedEventsCheckInterval = std::chrono::milliseconds(20);
+
+// Shared between the renderer and the reader, and guarded by the mutex.
+struct AudioBufferQueue
+{
+    QMutex mutex;
+    QWaitCondition condition;
+    QQueue<QAudioBuffer> buffers;
+    qint64 endPosition = -1; // us, -1 means the end of the stream
+    int serial = 0; // incremented on seeking; the buffers of stale renderers are discarded
+    bool atEnd = false;
+    bool stalled = false; // the renderer waits for a free slot
+    bool notificationPending = false;
+};
+
+namespace {
+
+qint64 endTime(const QAudioBuffer &buffer)
+{
+    return buffer.startTime()
+            + buffer.format().durationForFrames(static_cast<qint32>(buffer.frameCount()));
+}
+
+QAudioBuffer midFrames(const QAudioBuffer &buffer, qint64 from, qint64 count)
+{
+    const QAudioFormat format = buffer.format();
+    const qsizetype offset = format.bytesForFrames(static_cast<qint32>(from));
+    QByteArray data(buffer.constData<char>() + offset,
+                    format.bytesForFrames(static_cast<qint32>(count)));
+
+    return QAudioBuffer(data, format,
+                        buffer.startTime() + format.durationForFrames(static_cast<qint32>(from)));
+}
+
+// Cuts the buffer to the range [startPosition, endPosition)
+QAudioBuffer trimmedBuffer(const QAudioBuffer &buffer, qint64 startPosition, qint64 endPosition)
+{
+    const QAudioFormat format = buffer.format();
+    const qint64 frames = buffer.frameCount();
+    const qint64 bufferEnd = endTime(buffer);
+
+    qint64 from = 0;
+    if (buffer.startTime() < startPosition)
+        from = std::min<qint64>(format.framesForDuration(startPosition - buffer.startTime()), frames);
+
+    qint64 to = frames;
+    if (endPosition >= 0 && bufferEnd > endPosition)
+        to = std::max<qint64>(frames - format.framesForDuration(bufferEnd - endPosition), 0);
+
+    if (from >= to)
+        return {};
+
+    return from == 0 && to == frames ? buffer : midFrames(buffer, from, to - from);
+}
+
+// Merges the frames from the front of the queue, splitting the last buffer if needed.
+QAudioBuffer takeFrames(QQueue<QAudioBuffer> &buffers, qint64 maxFrames)
+{
+    Q_ASSERT(!buffers.empty());
+
+    const qint64 frontFrames = buffers.front().frameCount();
+    if (frontFrames == maxFrames || (frontFrames < maxFrames && buffers.size() == 1))
+        return buffers.dequeue();
+
+    const QAudioFormat format = buffers.front().format();
+    const qint64 startTime = buffers.front().startTime();
+
+    qint64 frames = 0;
+    for (const QAudioBuffer &buffer : std::as_const(buffers))
+        frames += buffer.frameCount();
+
+    QByteArray data;
+    data.reserve(format.bytesForFrames(static_cast<qint32>(std::min(frames, maxFrames))));
+
+    frames = 0;
+    while (!buffers.empty() && frames < maxFrames) {
+        QAudioBuffer &buffer = buffers.front();
+        const qint64 count = std::min<qint64>(buffer.frameCount(), maxFrames - frames);
+        const qsizetype bytes = format.bytesForFrames(static_cast<qint32>(count));
+
+        data.append(buffer.constData<char>(), bytes);
+        frames += count;
+
+        if (count < buffer.frameCount()) {
+            buffer = midFrames(buffer, count, buffer.frameCount() - count);
+        } else {
+            buffers.dequeue();
+        }
+    }
+
+    return QAudioBuffer(data, format, startTime);
+}
+
+} // namespace
+
 class SteppingAudioRenderer : public Renderer
 {
     Q_OBJECT
 public:
-    SteppingAudioRenderer(const QAudioFormat &format) : Renderer({}), m_format(format) { }
+    SteppingAudioRenderer(const TimeController &tc, const QAudioFormat &format,
+                          std::shared_ptr<AudioBufferQueue> queue, int serial)
+        : Renderer(tc),
+          m_format(format),
+          m_queue(std::move(queue)),
+          m_serial(serial),
+          m_startPosition(tc.currentPosition())
+    {
+    }
 
     RenderingResult renderInternal(Frame frame) override
     {
-        if (!frame.isValid())
-            return {};
+        QAudioBuffer buffer;
+        if (frame.isValid()) {
+            if (!m_resampler)
+                m_resampler = std::make_unique<QFFmpegResampler>(frame.codec(), m_format,
+                                                                 frame.absolutePts());
+
+            buffer = m_resampler->resample(frame.avFrame());
+        }
+
+        bool notify = false;
+        bool stepFurther = false;
+
+        {
+            QMutexLocker locker(&m_queue->mutex);
+
+            if (m_queue->serial != m_serial || m_queue->atEnd)
+                return {};
+
+            const auto endPosition = m_queue->endPosition;
+
+            if (!frame.isValid()
+                || (endPosition >= 0 && buffer.isValid() && endTime(buffer) >= endPosition))
+                m_queue->atEnd = true;
+
+            // the demuxer seeks to a packet preceding the start position
+            if (buffer.isValid())
+                buffer = trimmedBuffer(buffer, m_startPosition, endPosition);
+
+            if (buffer.isValid())
+                m_queue->buffers.enqueue(buffer);
+
+            if (buffer.isValid() || m_queue->atEnd)
+                notify = !std::exchange(m_queue->notificationPending, true);
+
+            stepFurther = !m_queue->atEnd && m_queue->buffers.size() < MaxQueuedBuffers;
+            m_queue->stalled = !stepFurther && !m_queue->atEnd;
+
+            m_queue->condition.wakeAll();
+        }
 
-        if (!m_resampler)
-            m_resampler = std::make_unique<QFFmpegResampler>(frame.codec(), m_format);
+        if (notify)
+            emit buffersQueued();
 
-        emit newAudioBuffer(m_resampler->resample(frame.avFrame()));
+        // Step on without a round trip to the reader's thread; the step is queued
+        // as the current frame is still to be dequeued.
+        if (stepFurther)
+            QMetaObject::invokeMethod(this, [this]() { doForceStep(); }, Qt::QueuedConnection);
 
         return {};
     }
 
 signals:
-    void newAudioBuffer(QAudioBuffer);
+    void buffersQueued();
 
 private:
     QAudioFormat m_format;
     std::unique_ptr<QFFmpegResampler> m_resampler;
+    std::shared_ptr<AudioBufferQueue> m_queue;
+    const int m_serial;
+    const qint64 m_startPosition;
 };
 
 class AudioDecoder : public PlaybackEngine
 {
     Q_OBJECT
 public:
-    explicit AudioDecoder(const QAudioFormat &format) : m_format(format) { }
+    AudioDecoder(const QAudioFormat &format, std::shared_ptr<AudioBufferQueue> queue)
+        : m_format(format), m_queue(std::move(queue))
+    {
+    }
 
     RendererPtr createRenderer(QPlatformMediaPlayer::TrackType trackType) override
     {
         if (trackType != QPlatformMediaPlayer::AudioStream)
             return RendererPtr{ {}, {} };
 
-        auto result = createPlaybackEngineObject<SteppingAudioRenderer>(m_format);
+        int serial = 0;
+        {
+            QMutexLocker locker(&m_queue->mutex);
+            serial = m_queue->serial;
+        }
+
+        auto result = createPlaybackEngineObject<SteppingAudioRenderer>(timeController(), m_format,
+                                                                        m_queue, serial);
         m_audioRenderer = result.get();
 
-        connect(result.get(), &SteppingAudioRenderer::newAudioBuffer, this,
-                &AudioDecoder::newAudioBuffer);
+        connect(result.get(), &SteppingAudioRenderer::buffersQueued, this,
+                &AudioDecoder::buffersQueued);
 
         return result;
     }
@@ -66,21 +231,21 @@ public:
     void nextBuffer()
     {
         Q_ASSERT(m_audioRenderer);
-        Q_ASSERT(!m_audioRenderer->isStepForced());
 
         m_audioRenderer->doForceStep();
         // updateObjectsPausedState();
     }
 
 signals:
-    void newAudioBuffer(QAudioBuffer);
+    void buffersQueued();
 
 private:
     QPointer<Renderer> m_audioRenderer;
     QAudioFormat m_format;
+    std::shared_ptr<AudioBufferQueue> m_queue;
 };
-}
 
+} // namespace QFFmpeg
 
 QFFmpegAudioDecoder::QFFmpegAudioDecoder(QAudioDecoder *parent)
     : QPlatformAudioDecoder(parent)
@@ -127,15 +292,18 @@ void QFFmpegAudioDecoder::start()
         positionChanged(-1);
 
         m_decoder.reset();
+        m_queue.reset();
 
         return false;
     };
 
-    m_decoder = std::make_unique<AudioDecoder>(m_audioFormat);
+    m_queue = std::make_shared<AudioBufferQueue>();
+    m_queue->endPosition = m_endPosition < 0 ? -1 : m_endPosition * 1000;
+    m_decoder = std::make_unique<AudioDecoder>(m_audioFormat, m_queue);
     connect(m_decoder.get(), &AudioDecoder::errorOccured, this, &QFFmpegAudioDecoder::errorSignal);
     connect(m_decoder.get(), &AudioDecoder::endOfStream, this, &QFFmpegAudioDecoder::done);
-    connect(m_decoder.get(), &AudioDecoder::newAudioBuffer, this,
-            &QFFmpegAudioDecoder::newAudioBuffer);
+    connect(m_decoder.get(), &AudioDecoder::buffersQueued, this,
+            &QFFmpegAudioDecoder::buffersQueued);
 
     QFFmpeg::MediaDataHolder::Maybe media = QFFmpeg::MediaDataHolder::create(m_url, m_sourceDevice, nullptr);
 
@@ -149,6 +317,9 @@ void QFFmpegAudioDecoder::start()
     if (!checkNoError())
         return;
 
+    if (m_startPosition > 0)
+        m_decoder->seek(m_startPosition * 1000);
+
     m_decoder->setState(QMediaPlayer::PausedState);
     if (!checkNoError())
         return;
@@ -166,6 +337,8 @@ void QFFmpegAudioDecoder::stop()
     qCDebug(qLcAudioDecoder) << ">>>>> stop";
     if (m_decoder) {
         m_decoder.reset();
+        m_queue.reset();
+        bufferAvailableChanged(false);
         done();
     }
 }
@@ -181,34 +354,198 @@ void QFFmpegAudioDecoder::setAudioFormat(const QAudioFormat &format)
         formatChanged(m_audioFormat);
 }
 
-QAudioBuffer QFFmpegAudioDecoder::read()
+void QFFmpegAudioDecoder::setPosition(qint64 position)
 {
-    auto buffer = std::exchange(m_audioBuffer, QAudioBuffer{});
-    if (!buffer.isValid())
-        return buffer;
-    qCDebug(qLcAudioDecoder) << "reading buffer" << buffer.startTime();
+    m_startPosition = qMax(position, 0ll);
+
+    if (!m_decoder)
+        return;
+
+    qCDebug(qLcAudioDecoder) << "seek" << m_startPosition;
+
+    {
+        QMutexLocker locker(&m_queue->mutex);
+        ++m_queue->serial;
+        m_queue->buffers.clear();
+        m_queue->atEnd = false;
+        m_queue->stalled = false;
+    }
+
     bufferAvailableChanged(false);
-    if (m_decoder)
+
+    // the renderers are recreated at the new position
+    m_decoder->seek(m_startPosition * 1000);
+    m_decoder->nextBuffer();
+
+    durationChanged(m_decoder->duration() / 1000);
+    setIsDecoding(true);
+}
+
+qint64 QFFmpegAudioDecoder::endPosition() const
+{
+    return m_endPosition;
+}
+
+void QFFmpegAudioDecoder::setEndPosition(qint64 position)
+{
+    m_endPosition = position < 0 ? -1 : position;
+
+    if (!m_queue)
+        return;
+
+    bool available = false;
+    bool atEnd = false;
+
+    {
+        QMutexLocker locker(&m_queue->mutex);
+        const qint64 endPosition = m_endPosition < 0 ? -1 : m_endPosition * 1000;
+        m_queue->endPosition = endPosition;
+
+        // the buffers decoded ahead might lie beyond the new end
+        auto &buffers = m_queue->buffers;
+        if (endPosition >= 0 && !buffers.empty()
+            && QFFmpeg::endTime(buffers.back()) >= endPosition) {
+            while (!buffers.empty() && buffers.back().startTime() >= endPosition)
+                buffers.removeLast();
+
+            if (!buffers.empty()) {
+                buffers.back() = QFFmpeg::trimmedBuffer(buffers.back(), 0, endPosition);
+                if (!buffers.back().isValid())
+                    buffers.removeLast();
+            }
+
+            m_queue->atEnd = true;
+        }
+
+        available = !buffers.empty();
+        atEnd = m_queue->atEnd;
+    }
+
+    if (!available) {
+        bufferAvailableChanged(false);
+        if (atEnd)
+            done();
+    }
+}
+
+QAudioBuffer QFFmpegAudioDecoder::read()
+{
+    return takeBuffers(-1);
+}
+
+QAudioBuffer QFFmpegAudioDecoder::readFrames(qint64 maxFrames)
+{
+    return takeBuffers(maxFrames);
+}
+
+bool QFFmpegAudioDecoder::bufferAvailable() const
+{
+    if (!m_queue)
+        return false;
+
+    QMutexLocker locker(&m_queue->mutex);
+    return !m_queue->buffers.empty();
+}
+
+bool QFFmpegAudioDecoder::waitForBufferAvailable(QDeadlineTimer deadline)
+{
+    while (m_decoder && error() == QAudioDecoder::NoError) {
+        {
+            QMutexLocker locker(&m_queue->mutex);
+            if (!m_queue->buffers.empty())
+                return true;
+            if (m_queue->atEnd || deadline.hasExpired())
+                return false;
+
+            m_queue->condition.wait(&m_queue->mutex,
+                                    std::min(deadline, QDeadlineTimer(PostedEventsCheckInterval)));
+        }
+
+        QCoreApplication::sendPostedEvents(m_decoder.get());
+    }
+
+    return false;
+}
+
+// Takes a single buffer if maxFrames is negative
+QAudioBuffer QFFmpegAudioDecoder::takeBuffers(qint64 maxFrames)
+{
+    if (!m_queue)
+        return {};
+
+    QAudioBuffer buffer;
+    bool resume = false;
+    bool available = false;
+    bool atEnd = false;
+    bool notify = false;
+
+    {
+        QMutexLocker locker(&m_queue->mutex);
+        auto &buffers = m_queue->buffers;
+        if (buffers.empty())
+            return {};
+
+        buffer = maxFrames < 0 ? buffers.dequeue() : QFFmpeg::takeFrames(buffers, maxFrames);
+
+        resume = std::exchange(m_queue->stalled, false);
+        available = !buffers.empty();
+        atEnd = m_queue->atEnd;
+
+        // keep emitting bufferReady for readers that read a buffer per signal
+        notify = available && !std::exchange(m_queue->notificationPending, true);
+    }
+
+    qCDebug(qLcAudioDecoder) << "reading buffer" << buffer.startTime() << buffer.frameCount();
+
+    if (resume && m_decoder)
         m_decoder->nextBuffer();
+
+    positionChanged(buffer.startTime() / 1000);
+
+    if (notify)
+        QMetaObject::invokeMethod(this, &QFFmpegAudioDecoder::buffersQueued, Qt::QueuedConnection);
+
+    if (!available) {
+        bufferAvailableChanged(false);
+        if (atEnd)
+            done();
+    }
+
     return buffer;
 }
 
-void QFFmpegAudioDecoder::newAudioBuffer(const QAudioBuffer &b)
+void QFFmpegAudioDecoder::buffersQueued()
 {
-    Q_ASSERT(b.isValid());
-    Q_ASSERT(!m_audioBuffer.isValid());
-    Q_ASSERT(!bufferAvailable());
+    if (!m_queue)
+        return;
 
-    qCDebug(qLcAudioDecoder) << "new audio buffer" << b.startTime();
-    m_audioBuffer = b;
-    const qint64 pos = b.startTime();
-    positionChanged(pos/1000);
-    bufferAvailableChanged(b.isValid());
+    bool available = false;
+    bool atEnd = false;
+    {
+        QMutexLocker locker(&m_queue->mutex);
+        m_queue->notificationPending = false;
+        available = !m_queue->buffers.empty();
+        atEnd = m_queue->atEnd;
+    }
+
+    if (!available) {
+        // the end of the range or nothing has been decoded
+        if (atEnd)
+            done();
+        return;
+    }
+
+    qCDebug(qLcAudioDecoder) << "new audio buffers";
+    bufferAvailableChanged(true);
     bufferReady();
 }
 
 void QFFmpegAudioDecoder::done()
 {
+    // The end of the stream is reported after the queued buffers are read
+    if (!isDecoding() || bufferAvailable())
+        return;
+
     qCDebug(qLcAudioDecoder) << ">>>>> DONE!";
     finished();
 }
@@ -23,6 +23,7 @@ QT_BEGIN_NAMESPACE
 
 namespace QFFmpeg {
 class AudioDecoder;
+struct AudioBufferQueue;
 }
 
 class QFFmpegAudioDecoder : public QPlatformAudioDecoder
@@ -45,22 +46,35 @@ public:
     QAudioFormat audioFormat() const override;
     void setAudioFormat(const QAudioFormat &format) override;
 
+    void setPosition(qint64 position) override;
+
+    qint64 endPosition() const override;
+    void setEndPosition(qint64 position) override;
+
     QAudioBuffer read() override;
+    QAudioBuffer readFrames(qint64 maxFrames) override;
+    bool bufferAvailable() const override;
+
+    bool waitForBufferAvailable(QDeadlineTimer deadline) override;
 
 public Q_SLOTS:
-    void newAudioBuffer(const QAudioBuffer &b);
+    void buffersQueued();
     void done();
     void errorSignal(int err, const QString &errorString);
 
 private:
     using AudioDecoder = QFFmpeg::AudioDecoder;
+    using AudioBufferQueue = QFFmpeg::AudioBufferQueue;
+
+    QAudioBuffer takeBuffers(qint64 maxFrames);
 
     QUrl m_url;
     QIODevice *m_sourceDevice = nullptr;
     std::unique_ptr<AudioDecoder> m_decoder;
+    std::shared_ptr<AudioBufferQueue> m_queue;
     QAudioFormat m_audioFormat;
-
-    QAudioBuffer m_audioBuffer;
+    qint64 m_startPosition = 0; // ms
+    qint64 m_endPosition = -1; // ms
 };
 
 QT_END_NAMESPACE
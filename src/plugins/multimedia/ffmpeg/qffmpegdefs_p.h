@@ -32,6 +32,8 @@ extern "C" {
   (LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(60, 3, 100)) // since ffmpeg n6.0
 #define QT_FFMPEG_STREAM_SIDE_DATA_DEPRECATED \
   (LIBAVCODEC_VERSION_INT >= AV_VERSION_INT(60, 15, 100)) // since ffmpeg n6.1
+#define QT_FFMPEG_HAS_INDEX_ENTRY_API \
+  (LIBAVFORMAT_VERSION_INT >= AV_VERSION_INT(58, 78, 100)) // since ffmpeg n4.4
 #define QT_FFMPEG_SWR_CONST_CH_LAYOUT (LIBSWRESAMPLE_VERSION_INT >= AV_VERSION_INT(4, 9, 100))
 
 #endif // QFFMPEGDEFS_P_H
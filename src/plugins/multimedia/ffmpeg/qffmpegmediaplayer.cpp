@@ -56,12 +56,17 @@ qint64 QFFmpegMediaPlayer::duration() const
 }
 
 void QFFmpegMediaPlayer::setPosition(qint64 position)
+{
+    seek(position, QMediaPlayer::AccurateSeek);
+}
+
+void QFFmpegMediaPlayer::seek(qint64 position, QMediaPlayer::SeekMode mode)
 {
     if (mediaStatus() == QMediaPlayer::LoadingMedia)
         return;
 
     if (m_playbackEngine) {
-        m_playbackEngine->seek(position * 1000);
+        m_playbackEngine->seek(position * 1000, mode);
         updatePosition();
     }
 
@@ -112,7 +117,14 @@ float QFFmpegMediaPlayer::bufferProgress() const
 
 QMediaTimeRange QFFmpegMediaPlayer::availablePlaybackRanges() const
 {
-    return {};
+    if (!m_playbackEngine)
+        return {};
+
+    QMediaTimeRange result;
+    for (const auto &interval : m_playbackEngine->bufferedTimeRange().intervals())
+        result.addInterval(interval.start() / 1000, interval.end() / 1000);
+
+    return result;
 }
 
 qreal QFFmpegMediaPlayer::playbackRate() const
@@ -231,6 +243,8 @@ void QFFmpegMediaPlayer::setMediaAsync(QFFmpeg::MediaDataHolder::Maybe mediaData
     m_playbackEngine->setVideoSink(m_videoSink);
     m_playbackEngine->setLoops(loops());
     m_playbackEngine->setPlaybackRate(m_playbackRate);
+    m_playbackEngine->setBufferingPolicy(m_bufferingPolicy);
+    m_playbackEngine->setPriority(m_playbackPriority);
 
     durationChanged(duration());
     tracksChanged();
@@ -384,6 +398,22 @@ void QFFmpegMediaPlayer::setLoops(int loops)
     QPlatformMediaPlayer::setLoops(loops);
 }
 
+void QFFmpegMediaPlayer::setBufferingPolicy(const BufferingPolicy &policy)
+{
+    m_bufferingPolicy = policy;
+
+    if (m_playbackEngine)
+        m_playbackEngine->setBufferingPolicy(policy);
+}
+
+void QFFmpegMediaPlayer::setPlaybackPriority(PlaybackPriority priority)
+{
+    m_playbackPriority = priority;
+
+    if (m_playbackEngine)
+        m_playbackEngine->setPriority(priority);
+}
+
 QT_END_NAMESPACE
 
 #include "moc_qffmpegmediaplayer_p.cpp"
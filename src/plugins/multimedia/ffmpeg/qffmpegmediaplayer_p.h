@@ -43,6 +43,7 @@ public:
     qint64 duration() const override;
 
     void setPosition(qint64 position) override;
+    void seek(qint64 position, QMediaPlayer::SeekMode mode) override;
 
     float bufferProgress() const override;
 
@@ -72,6 +73,10 @@ public:
     void setActiveTrack(TrackType, int streamNumber) override;
     void setLoops(int loops) override;
 
+    void setBufferingPolicy(const BufferingPolicy &policy) override;
+
+    void setPlaybackPriority(PlaybackPriority priority) override;
+
 private:
     void runPlayback();
     void handleIncorrectMedia(QMediaPlayer::MediaStatus status);
@@ -101,6 +106,8 @@ private:
     QUrl m_url;
     QPointer<QIODevice> m_device;
     float m_playbackRate = 1.;
+    BufferingPolicy m_bufferingPolicy;
+    PlaybackPriority m_playbackPriority = PlaybackPriority::Normal;
     QFuture<void> m_loadMedia;
     std::shared_ptr<QFFmpeg::CancelToken> m_cancelToken; // For interrupting ongoing
                                                          // network connection attempt
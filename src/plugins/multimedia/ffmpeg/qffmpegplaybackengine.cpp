@@ -42,7 +42,8 @@ static constexpr bool shouldPauseStreams = false;
 PlaybackEngine::PlaybackEngine()
     : m_demuxer({}, {}),
       m_streams(defaultObjectsArray<decltype(m_streams)>()),
-      m_renderers(defaultObjectsArray<decltype(m_renderers)>())
+      m_renderers(defaultObjectsArray<decltype(m_renderers)>()),
+      m_scheduler(PlaybackScheduler::instance())
 {
     qCDebug(qLcPlaybackEngine) << "Create PlaybackEngine";
     qRegisterMetaType<QFFmpeg::Packet>();
@@ -169,7 +170,9 @@ void PlaybackEngine::updateObjectsPausedState()
 void PlaybackEngine::ObjectDeleter::operator()(PlaybackEngineObject *object) const
 {
     Q_ASSERT(engine);
-    if (!std::exchange(engine->m_threadsDirty, true))
+    if (engine->m_scheduler)
+        engine->m_threadLeases.erase(object->id());
+    else if (!std::exchange(engine->m_threadsDirty, true))
         QMetaObject::invokeMethod(engine, &PlaybackEngine::deleteFreeThreads, Qt::QueuedConnection);
 
     object->kill();
@@ -179,6 +182,13 @@ void PlaybackEngine::registerObject(PlaybackEngineObject &object)
 {
     connect(&object, &PlaybackEngineObject::error, this, &PlaybackEngine::errorOccured);
 
+    if (m_scheduler) {
+        auto lease = m_scheduler->acquireThread(m_priority);
+        object.moveToThread(lease.thread());
+        m_threadLeases.emplace(object.id(), std::move(lease));
+        return;
+    }
+
     auto threadName = objectThreadName(object);
     auto &thread = m_threads[threadName];
     if (!thread) {
@@ -232,10 +242,13 @@ void PlaybackEngine::forEachExistingObject(Action &&action)
     forEachExistingObject<PlaybackEngineObject>(std::forward<Action>(action));
 }
 
-void PlaybackEngine::seek(qint64 pos)
+void PlaybackEngine::seek(qint64 pos, QMediaPlayer::SeekMode mode)
 {
     pos = boundPosition(pos);
 
+    // applied to the next demuxer only
+    m_seekMode = mode;
+
     m_timeController.setPaused(true);
     m_timeController.sync(m_currentLoopOffset.pos + pos);
 
@@ -293,12 +306,59 @@ float PlaybackEngine::playbackRate() const {
     return m_timeController.playbackRate();
 }
 
+void PlaybackEngine::setBufferingPolicy(const QPlatformMediaPlayer::BufferingPolicy &policy)
+{
+    if (std::exchange(m_bufferingPolicy, policy) == policy)
+        return;
+
+    if (m_demuxer)
+        m_demuxer->setBufferingPolicy(policy);
+}
+
+void PlaybackEngine::setPriority(QPlatformMediaPlayer::PlaybackPriority priority)
+{
+    if (std::exchange(m_priority, priority) == priority || !m_scheduler)
+        return;
+
+    // The threads and the codec threads are distributed when the objects and the codecs
+    // are created; recreate them to get the share of the new priority.
+    m_codecs = {};
+    m_codecThreads = {};
+
+    forceUpdate();
+}
+
+QMediaTimeRange PlaybackEngine::bufferedTimeRange() const
+{
+    if (!m_demuxer)
+        return {};
+
+    const qint64 position = currentPosition(false);
+    const qint64 bufferedPosition = m_demuxer->bufferedPosition() - m_currentLoopOffset.pos;
+    const qint64 duration = this->duration();
+
+    // the demuxer might have already started the next loop
+    if (duration > 0 && bufferedPosition > duration) {
+        QMediaTimeRange result(position, duration);
+        result.addInterval(0, qMin(bufferedPosition - duration, position));
+        return result;
+    }
+
+    if (bufferedPosition <= position)
+        return {};
+
+    return QMediaTimeRange(position, bufferedPosition);
+}
+
 void PlaybackEngine::recreateObjects()
 {
     m_timeController.setPaused(true);
 
     forEachExistingObject([](auto &object) { object.reset(); });
 
+    // the objects are recreated anyway, so the video codec is reopened with a pending share
+    updateCodecThreads();
+
     createObjectsIfNeeded();
 }
 
@@ -372,10 +432,21 @@ std::optional<Codec> PlaybackEngine::codecForTrack(QPlatformMediaPlayer::TrackTy
     if (!result) {
         qCDebug(qLcPlaybackEngine)
                 << "Create codec for stream:" << streamIndex << "trackType:" << trackType;
-        auto maybeCodec =
-                Codec::create(m_media.avContext()->streams[streamIndex], m_media.avContext());
+        // Video decoding is the heavy part, so the codec threads budget goes to video codecs
+        auto &codecThreads = m_codecThreads[trackType];
+        if (m_scheduler && trackType == QPlatformMediaPlayer::VideoStream
+            && !codecThreads.isValid()) {
+            codecThreads = m_scheduler->acquireCodecThreads(m_priority, [this]() {
+                QMetaObject::invokeMethod(this, &PlaybackEngine::onCodecShareChanged,
+                                          Qt::QueuedConnection);
+            });
+        }
+
+        auto maybeCodec = Codec::create(m_media.avContext()->streams[streamIndex],
+                                        m_media.avContext(), codecThreads.codecThreadsCount());
 
         if (!maybeCodec) {
+            codecThreads = {};
             emit errorOccured(QMediaPlayer::FormatError,
                               "Cannot create codec," + maybeCodec.error());
             return {};
@@ -409,8 +480,11 @@ void PlaybackEngine::createDemuxer()
 
     const PositionWithOffset positionWithOffset{ currentPosition(false), m_currentLoopOffset };
 
+    const auto seekMode = std::exchange(m_seekMode, QMediaPlayer::AccurateSeek);
+
     m_demuxer = createPlaybackEngineObject<Demuxer>(m_media.avContext(), positionWithOffset,
-                                                    streamIndexes, m_loops);
+                                                    streamIndexes, m_loops, m_bufferingPolicy,
+                                                    seekMode);
 
     connect(m_demuxer.get(), &Demuxer::packetsBuffered, this, &PlaybackEngine::buffered);
 
@@ -423,8 +497,9 @@ void PlaybackEngine::createDemuxer()
                 &Demuxer::onPacketProcessed);
     });
 
-    if (!isSeekable() || duration() <= 0) {
-        // We need initial synchronization for such streams
+    if (!isSeekable() || duration() <= 0 || seekMode == QMediaPlayer::FastSeek) {
+        // We need initial synchronization for such streams, and after fast seeking,
+        // where the playback starts from the key frame the demuxer has found
         forEachExistingObject([&](auto &object) {
             using Type = std::remove_reference_t<decltype(*object)>;
             if constexpr (!std::is_same_v<Type, Demuxer>)
@@ -455,6 +530,40 @@ void PlaybackEngine::deleteFreeThreads() {
         thr->wait();
 }
 
+void PlaybackEngine::onCodecShareChanged()
+{
+    // Reopening the codec interrupts the video, so only large changes of the share are
+    // applied right away; the others wait until the codec is reopened on seek or restart.
+    constexpr double minRelativeChange = 0.5;
+
+    if (m_state != QMediaPlayer::StoppedState && updateCodecThreads(minRelativeChange))
+        recreateVideoStream();
+}
+
+bool PlaybackEngine::updateCodecThreads(double minRelativeChange)
+{
+    auto &codecThreads = m_codecThreads[QPlatformMediaPlayer::VideoStream];
+    if (!codecThreads.isValid()
+        || !m_scheduler->updateCodecThreads(codecThreads, minRelativeChange))
+        return false;
+
+    // The codec threads count is fixed when the codec is opened, so the codec
+    // has to be reopened to get the new share of the budget.
+    m_codecs[QPlatformMediaPlayer::VideoStream] = {};
+    return true;
+}
+
+void PlaybackEngine::recreateVideoStream()
+{
+    // the other renderers keep playing
+    m_renderers[QPlatformMediaPlayer::VideoStream].reset();
+    m_streams = defaultObjectsArray<decltype(m_streams)>();
+    m_demuxer.reset();
+
+    createObjectsIfNeeded();
+    updateObjectsPausedState();
+}
+
 void PlaybackEngine::setMedia(MediaDataHolder media)
 {
     Q_ASSERT(!m_media.avContext()); // Playback engine does not support reloading media
@@ -548,6 +657,7 @@ void PlaybackEngine::setActiveTrack(QPlatformMediaPlayer::TrackType trackType, i
         return;
 
     m_codecs[trackType] = {};
+    m_codecThreads[trackType] = {};
 
     m_renderers[trackType].reset();
     m_streams = defaultObjectsArray<decltype(m_streams)>();
@@ -34,6 +34,8 @@
  *   have free threads. If it does, the thread is to be reused.
  * - If all objects for some thread are deleted, the thread becomes free and the engine
  *   postpones its termination.
+ * - If QT_FFMPEG_PLAYBACK_THREADS is set, the engines of the process share a fixed
+ *   number of threads instead, see PlaybackScheduler.
  *
  * OBJECTS WEAK CONNECTIVITY
  *
@@ -50,6 +52,7 @@
 #include "playbackengine/qffmpegmediadataholder_p.h"
 #include "playbackengine/qffmpegcodec_p.h"
 #include "playbackengine/qffmpegpositionwithoffset_p.h"
+#include "playbackengine/qffmpegplaybackscheduler_p.h"
 
 #include <QtCore/qpointer.h>
 
@@ -93,7 +96,7 @@ public:
         setState(QMediaPlayer::StoppedState);
     }
 
-    void seek(qint64 pos);
+    void seek(qint64 pos, QMediaPlayer::SeekMode mode = QMediaPlayer::AccurateSeek);
 
     void setLoops(int loopsCount);
 
@@ -101,6 +104,14 @@ public:
 
     float playbackRate() const;
 
+    void setBufferingPolicy(const QPlatformMediaPlayer::BufferingPolicy &policy);
+
+    // Matters only if the playback engines share the scheduler
+    void setPriority(QPlatformMediaPlayer::PlaybackPriority priority);
+
+    // The ranges of the media, in microseconds, that are read ahead of the current position
+    QMediaTimeRange bufferedTimeRange() const;
+
     void setActiveTrack(QPlatformMediaPlayer::TrackType type, int streamNumber);
 
     qint64 currentPosition(bool topPos = true) const;
@@ -141,6 +152,8 @@ protected: // objects managing
 
     virtual RendererPtr createRenderer(QPlatformMediaPlayer::TrackType trackType);
 
+    const TimeController &timeController() const { return m_timeController; }
+
     void updateActiveAudioOutput(QAudioOutput *output);
 
     void updateActiveVideoOutput(QVideoSink *sink, bool cleanOutput = false);
@@ -168,6 +181,12 @@ private:
 
     void deleteFreeThreads();
 
+    void onCodecShareChanged();
+
+    bool updateCodecThreads(double minRelativeChange = 0.);
+
+    void recreateVideoStream();
+
     void onRendererSynchronized(quint64 id, std::chrono::steady_clock::time_point time,
                                 qint64 trackTime);
 
@@ -201,6 +220,12 @@ private:
     std::unordered_map<QString, std::unique_ptr<QThread>> m_threads;
     bool m_threadsDirty = false;
 
+    std::shared_ptr<PlaybackScheduler> m_scheduler;
+    std::unordered_map<PlaybackEngineObject::Id, PlaybackScheduler::Lease> m_threadLeases;
+    std::array<PlaybackScheduler::Lease, QPlatformMediaPlayer::NTrackTypes> m_codecThreads;
+    QPlatformMediaPlayer::PlaybackPriority m_priority =
+            QPlatformMediaPlayer::PlaybackPriority::Normal;
+
     QPointer<QVideoSink> m_videoSink;
     QPointer<QAudioOutput> m_audioOutput;
 
@@ -213,6 +238,8 @@ private:
     std::array<std::optional<Codec>, QPlatformMediaPlayer::NTrackTypes> m_codecs;
     int m_loops = QMediaPlayer::Once;
     LoopOffset m_currentLoopOffset;
+    QPlatformMediaPlayer::BufferingPolicy m_bufferingPolicy;
+    QMediaPlayer::SeekMode m_seekMode = QMediaPlayer::AccurateSeek;
 };
 
 template<typename T, typename... Args>
@@ -29,7 +29,8 @@ class QFFmpegResampler : public QPlatformAudioResampler
 {
 public:
     QFFmpegResampler(const QAudioFormat &inputFormat, const QAudioFormat &outputFormat);
-    QFFmpegResampler(const QFFmpeg::Codec* codec, const QAudioFormat &outputFormat);
+    QFFmpegResampler(const QFFmpeg::Codec* codec, const QAudioFormat &outputFormat,
+                     qint64 startTime = 0);
 
     ~QFFmpegResampler() override;
 
@@ -50,6 +51,7 @@ private:
     QAudioFormat m_inputFormat;
     QAudioFormat m_outputFormat;
     QFFmpeg::SwrContextUPtr m_resampler;
+    qint64 m_startTime = 0;
     qint64 m_samplesProcessed = 0;
     qint64 m_endCompensationSample = std::numeric_limits<qint64>::min();
     qint32 m_sampleCompensationDelta = 0;
@@ -0,0 +1,109 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "qffmpegswsframeconverter_p.h"
+
+#include <atomic>
+
+extern "C" {
+#include <libavutil/imgutils.h>
+}
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+static std::atomic<quint64> conversionCounter = 0;
+static std::atomic<quint64> contextCounter = 0;
+
+SwsFrameConverter &SwsFrameConverter::instance()
+{
+    thread_local SwsFrameConverter converter;
+    return converter;
+}
+
+AVFrameUPtr SwsFrameConverter::convert(const AVFrame &source, QSize targetSize,
+                                       AVPixelFormat targetFormat)
+{
+    Entry *entry = find(source, targetSize, targetFormat);
+    if (!entry)
+        return {};
+
+    auto result = entry->allocateFrame();
+    if (!result)
+        return {};
+
+    sws_scale(entry->context.get(), source.data, source.linesize, 0, source.height,
+              result->data, result->linesize);
+    conversionCounter.fetch_add(1, std::memory_order_relaxed);
+    return result;
+}
+
+quint64 SwsFrameConverter::conversionCount()
+{
+    return conversionCounter.load(std::memory_order_relaxed);
+}
+
+quint64 SwsFrameConverter::contextCount()
+{
+    return contextCounter.load(std::memory_order_relaxed);
+}
+
+AVFrameUPtr SwsFrameConverter::Entry::allocateFrame()
+{
+    auto frame = makeAVFrame();
+    frame->buf[0] = av_buffer_pool_get(bufferPool.get());
+    if (!frame->buf[0])
+        return {};
+
+    frame->width = targetSize.width();
+    frame->height = targetSize.height();
+    frame->format = targetFormat;
+    av_image_fill_arrays(frame->data, frame->linesize, frame->buf[0]->data, targetFormat,
+                         targetSize.width(), targetSize.height(), BufferAlignment);
+    return frame;
+}
+
+SwsFrameConverter::Entry *SwsFrameConverter::find(const AVFrame &source, QSize targetSize,
+                                                  AVPixelFormat targetFormat)
+{
+    const QSize sourceSize(source.width, source.height);
+    const auto sourceFormat = AVPixelFormat(source.format);
+    ++m_useCounter;
+
+    Entry *leastRecentlyUsed = &m_entries.front();
+    for (Entry &entry : m_entries) {
+        if (entry.context && entry.sourceSize == sourceSize && entry.sourceFormat == sourceFormat
+            && entry.targetSize == targetSize && entry.targetFormat == targetFormat) {
+            entry.lastUse = m_useCounter;
+            return &entry;
+        }
+        if (entry.lastUse < leastRecentlyUsed->lastUse)
+            leastRecentlyUsed = &entry;
+    }
+
+    Entry &entry = *leastRecentlyUsed;
+    entry = {};
+    entry.context.reset(sws_getContext(sourceSize.width(), sourceSize.height(), sourceFormat,
+                                       targetSize.width(), targetSize.height(), targetFormat,
+                                       SWS_BICUBIC, nullptr, nullptr, nullptr));
+    const int bufferSize = av_image_get_buffer_size(targetFormat, targetSize.width(),
+                                                    targetSize.height(), BufferAlignment);
+    if (!entry.context || bufferSize <= 0) {
+        entry = {};
+        return nullptr;
+    }
+
+    contextCounter.fetch_add(1, std::memory_order_relaxed);
+    entry.bufferPool.reset(av_buffer_pool_init(bufferSize, nullptr));
+    entry.sourceSize = sourceSize;
+    entry.sourceFormat = sourceFormat;
+    entry.targetSize = targetSize;
+    entry.targetFormat = targetFormat;
+    entry.lastUse = m_useCounter;
+    return &entry;
+}
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
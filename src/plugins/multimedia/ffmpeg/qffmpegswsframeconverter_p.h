@@ -0,0 +1,71 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#ifndef QFFMPEGSWSFRAMECONVERTER_P_H
+#define QFFMPEGSWSFRAMECONVERTER_P_H
+
+//
+//  W A R N I N G
+//  -------------
+//
+// This file is not part of the Qt API. It exists purely as an
+// implementation detail. This header file may change from version to
+// version without notice, or even be removed.
+//
+// We mean it.
+//
+
+#include "qffmpeg_p.h"
+
+#include <QtCore/qsize.h>
+
+#include <array>
+
+QT_BEGIN_NAMESPACE
+
+namespace QFFmpeg {
+
+// Scaler contexts and destination buffer pools for the software frame
+// conversions of the current thread. Decoders convert every frame of a stream
+// on the same thread, so recreating them per frame is avoided without locking.
+class SwsFrameConverter
+{
+public:
+    static SwsFrameConverter &instance();
+
+    // Returns null if the frame cannot be converted
+    AVFrameUPtr convert(const AVFrame &source, QSize targetSize, AVPixelFormat targetFormat);
+
+    // Numbers of the converted frames and of the created scaler contexts, over all threads
+    static quint64 conversionCount();
+    static quint64 contextCount();
+
+private:
+    struct Entry
+    {
+        AVFrameUPtr allocateFrame();
+
+        QSize sourceSize;
+        AVPixelFormat sourceFormat = AV_PIX_FMT_NONE;
+        QSize targetSize;
+        AVPixelFormat targetFormat = AV_PIX_FMT_NONE;
+        SwsContextUPtr context;
+        // buffers stay valid until the last frame using them is gone
+        AVBufferPoolUPtr bufferPool;
+        quint64 lastUse = 0;
+    };
+
+    Entry *find(const AVFrame &source, QSize targetSize, AVPixelFormat targetFormat);
+
+    static constexpr int BufferAlignment = 64;
+
+    // a few streams may be converted on the same thread
+    std::array<Entry, 4> m_entries;
+    quint64 m_useCounter = 0;
+};
+
+} // namespace QFFmpeg
+
+QT_END_NAMESPACE
+
+#endif // QFFMPEGSWSFRAMECONVERTER_P_H
@@ -5,6 +5,7 @@
 #include "private/qvideotexturehelper_p.h"
 #include "private/qmultimediautils_p.h"
 #include "qffmpeghwaccel_p.h"
+#include "qffmpegswsframeconverter_p.h"
 
 extern "C" {
 #include <libavutil/pixdesc.h>
@@ -54,24 +55,25 @@ void QFFmpegVideoBuffer::convertSWFrame()
         || m_size != QSize(swFrame->width, swFrame->height)) {
         Q_ASSERT(toQtPixelFormat(targetAVPixelFormat) == m_pixelFormat);
         // convert the format into something we can handle
-        SwsContext *c = sws_getContext(swFrame->width, swFrame->height, actualAVPixelFormat,
-                                       m_size.width(), m_size.height(), targetAVPixelFormat,
-                                       SWS_BICUBIC, nullptr, nullptr, nullptr);
-
-        auto newFrame = QFFmpeg::makeAVFrame();
-        newFrame->width = m_size.width();
-        newFrame->height = m_size.height();
-        newFrame->format = targetAVPixelFormat;
-        av_frame_get_buffer(newFrame.get(), 0);
+        auto newFrame = QFFmpeg::SwsFrameConverter::instance().convert(*swFrame, m_size,
+                                                              targetAVPixelFormat);
+        if (!newFrame) {
+            qWarning() << "Failed to convert video frame from" << actualAVPixelFormat << "to"
+                       << targetAVPixelFormat;
+            return;
+        }
 
-        sws_scale(c, swFrame->data, swFrame->linesize, 0, swFrame->height, newFrame->data, newFrame->linesize);
         if (frame == swFrame.get())
             frame = newFrame.get();
         swFrame = std::move(newFrame);
-        sws_freeContext(c);
     }
 }
 
+quint64 QFFmpegVideoBuffer::swFrameConversionCount()
+{
+    return QFFmpeg::SwsFrameConverter::conversionCount();
+}
+
 void QFFmpegVideoBuffer::setTextureConverter(const QFFmpeg::TextureConverter &converter)
 {
     textureConverter = converter;
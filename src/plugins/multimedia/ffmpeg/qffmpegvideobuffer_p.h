@@ -48,6 +48,9 @@ public:
 
     void convertSWFrame();
 
+    // Number of software frames converted to a supported format or size so far
+    static quint64 swFrameConversionCount();
+
     AVFrame *getHWFrame() const { return hwFrame.get(); }
 
     void setTextureConverter(const QFFmpeg::TextureConverter &converter);
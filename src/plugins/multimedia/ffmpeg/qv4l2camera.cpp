@@ -7,16 +7,67 @@
 
 #include <private/qcameradevice_p.h>
 #include <private/qmultimediautils_p.h>
-#include <private/qmemoryvideobuffer_p.h>
 #include <private/qcore_unix_p.h>
 
 #include <qsocketnotifier.h>
 #include <qloggingcategory.h>
+#include <qthread.h>
+
+#include <functional>
 
 QT_BEGIN_NAMESPACE
 
 static Q_LOGGING_CATEGORY(qLcV4L2Camera, "qt.multimedia.ffmpeg.v4l2camera");
 
+namespace {
+
+constexpr quint32 DefaultBuffersCount = 4;
+constexpr quint32 MinBuffersCount = 2;
+constexpr quint32 MaxBuffersCount = 32;
+
+// The number of V4L2 buffers shared by the driver and the frames in use.
+// Can be changed with QT_V4L2_CAMERA_BUFFERS_COUNT, e.g. if the application
+// holds the frames for a long time.
+quint32 buffersCount()
+{
+    bool ok = false;
+    const int count = qEnvironmentVariableIntValue("QT_V4L2_CAMERA_BUFFERS_COUNT", &ok);
+    if (!ok)
+        return DefaultBuffersCount;
+
+    return qBound(MinBuffersCount, quint32(qMax(count, 0)), MaxBuffersCount);
+}
+
+// Reads the frames on its own event loop, so that a busy camera thread
+// doesn't delay or drop them.
+class CaptureThread : public QThread
+{
+public:
+    CaptureThread(int descriptor, std::function<bool()> readFrame)
+        : m_descriptor(descriptor), m_readFrame(std::move(readFrame))
+    {
+        setObjectName(QStringLiteral("V4L2CaptureThread"));
+    }
+
+protected:
+    void run() override
+    {
+        QSocketNotifier notifier(m_descriptor, QSocketNotifier::Read);
+        connect(&notifier, &QSocketNotifier::activated, &notifier, [&]() {
+            if (!m_readFrame())
+                notifier.setEnabled(false);
+        });
+
+        exec();
+    }
+
+private:
+    int m_descriptor;
+    std::function<bool()> m_readFrame;
+};
+
+} // namespace
+
 static const struct {
     QVideoFrameFormat::PixelFormat fmt;
     uint32_t v4l2Format;
@@ -356,7 +407,7 @@ void QV4L2Camera::setColorTemperature(int temperature)
         colorTemperatureChanged(t);
 }
 
-void QV4L2Camera::readFrame()
+bool QV4L2Camera::readFrame()
 {
     Q_ASSERT(m_memoryTransfer);
 
@@ -366,15 +417,21 @@ void QV4L2Camera::readFrame()
 
         if (errno == ENODEV) {
             // camera got removed while being active
-            stopCapturing();
-            closeV4L2Fd();
+            QMetaObject::invokeMethod(
+                    this, [this, descriptor = std::weak_ptr(m_v4l2FileDescriptor)]() {
+                        if (descriptor.lock() != m_v4l2FileDescriptor || !m_v4l2FileDescriptor)
+                            return;
+
+                        stopCapturing();
+                        closeV4L2Fd();
+                    });
+            return false;
         }
 
-        return;
+        return true;
     }
 
-    auto videoBuffer = new QMemoryVideoBuffer(buffer->data, m_bytesPerLine);
-    QVideoFrame frame(videoBuffer, frameFormat());
+    QVideoFrame frame(buffer->videoBuffer.release(), frameFormat());
 
     auto &v4l2Buffer = buffer->v4l2Buffer;
 
@@ -387,8 +444,7 @@ void QV4L2Camera::readFrame()
 
     emit newVideoFrame(frame);
 
-    if (!m_memoryTransfer->enqueueBuffer(v4l2Buffer.index))
-        qCWarning(qLcV4L2Camera) << "Cannot add buffer";
+    return true;
 }
 
 void QV4L2Camera::setCameraBusy()
@@ -635,7 +691,10 @@ void QV4L2Camera::initV4L2MemoryTransfer()
 
     Q_ASSERT(!m_memoryTransfer);
 
-    m_memoryTransfer = makeUserPtrMemoryTransfer(m_v4l2FileDescriptor, m_imageSize);
+    const auto count = buffersCount();
+
+    // The mapped buffers are handed out to the frames without copying
+    m_memoryTransfer = makeMMapMemoryTransfer(m_v4l2FileDescriptor, m_bytesPerLine, count);
 
     if (m_memoryTransfer)
         return;
@@ -645,9 +704,10 @@ void QV4L2Camera::initV4L2MemoryTransfer()
         return;
     }
 
-    qCDebug(qLcV4L2Camera) << "Cannot init V4L2_MEMORY_USERPTR; trying V4L2_MEMORY_MMAP";
+    qCDebug(qLcV4L2Camera) << "Cannot init V4L2_MEMORY_MMAP; trying V4L2_MEMORY_USERPTR";
 
-    m_memoryTransfer = makeMMapMemoryTransfer(m_v4l2FileDescriptor);
+    m_memoryTransfer =
+            makeUserPtrMemoryTransfer(m_v4l2FileDescriptor, m_imageSize, m_bytesPerLine, count);
 
     if (!m_memoryTransfer) {
         qCWarning(qLcV4L2Camera) << "Cannot init v4l2 memory transfer," << qt_error_string(errno);
@@ -660,7 +720,11 @@ void QV4L2Camera::stopCapturing()
     if (!m_memoryTransfer || !m_v4l2FileDescriptor)
         return;
 
-    m_notifier = nullptr;
+    if (m_captureThread) {
+        m_captureThread->quit();
+        m_captureThread->wait();
+        m_captureThread = nullptr;
+    }
 
     if (!m_v4l2FileDescriptor->stopStream()) {
         // TODO: handle the case carefully to avoid possible memory corruption
@@ -688,11 +752,11 @@ void QV4L2Camera::startCapturing()
         return;
     }
 
-    m_notifier =
-            std::make_unique<QSocketNotifier>(m_v4l2FileDescriptor->get(), QSocketNotifier::Read);
-    connect(m_notifier.get(), &QSocketNotifier::activated, this, &QV4L2Camera::readFrame);
-
     m_firstFrameTime = { -1, -1 };
+
+    m_captureThread = std::make_unique<CaptureThread>(m_v4l2FileDescriptor->get(),
+                                                      [this]() { return readFrame(); });
+    m_captureThread->start();
 }
 
 QVideoFrameFormat QV4L2Camera::frameFormat() const
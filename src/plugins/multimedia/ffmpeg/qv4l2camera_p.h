@@ -22,7 +22,7 @@ QT_BEGIN_NAMESPACE
 
 class QV4L2FileDescriptor;
 class QV4L2MemoryTransfer;
-class QSocketNotifier;
+class QThread;
 
 struct V4L2CameraInfo
 {
@@ -94,10 +94,9 @@ public:
 
     QVideoFrameFormat frameFormat() const override;
 
-private Q_SLOTS:
-    void readFrame();
-
 private:
+    bool readFrame();
+
     void setCameraBusy();
     void initV4L2Controls();
     void closeV4L2Fd();
@@ -114,7 +113,7 @@ private:
     bool m_active = false;
     QCameraDevice m_cameraDevice;
 
-    std::unique_ptr<QSocketNotifier> m_notifier;
+    std::unique_ptr<QThread> m_captureThread;
     std::unique_ptr<QV4L2MemoryTransfer> m_memoryTransfer;
     std::shared_ptr<QV4L2FileDescriptor> m_v4l2FileDescriptor;
 
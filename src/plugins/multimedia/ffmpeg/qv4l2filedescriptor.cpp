@@ -36,7 +36,8 @@ bool QV4L2FileDescriptor::call(int request, void *arg) const
     return ::xioctl(m_descriptor, request, arg) >= 0;
 }
 
-bool QV4L2FileDescriptor::requestBuffers(quint32 memoryType, quint32 &buffersCount) const
+bool QV4L2FileDescriptor::requestBuffers(quint32 memoryType, quint32 &buffersCount,
+                                         quint32 *capabilities) const
 {
     v4l2_requestbuffers req = {};
     req.count = buffersCount;
@@ -47,6 +48,15 @@ bool QV4L2FileDescriptor::requestBuffers(quint32 memoryType, quint32 &buffersCou
         return false;
 
     buffersCount = req.count;
+
+    if (capabilities) {
+#ifdef V4L2_BUF_CAP_SUPPORTS_ORPHANED_BUFS
+        *capabilities = req.capabilities;
+#else
+        *capabilities = 0;
+#endif
+    }
+
     return true;
 }
 
@@ -32,7 +32,9 @@ public:
 
     int get() const { return m_descriptor; }
 
-    bool requestBuffers(quint32 memoryType, quint32 &buffersCount) const;
+    // The V4L2_BUF_CAP_* flags of the queue are written to \a capabilities if it's not null
+    bool requestBuffers(quint32 memoryType, quint32 &buffersCount,
+                        quint32 *capabilities = nullptr) const;
 
     bool startStream();
 
@@ -4,15 +4,24 @@
 #include "qv4l2memorytransfer_p.h"
 #include "qv4l2filedescriptor_p.h"
 
+#include <private/qmemoryvideobuffer_p.h>
+
 #include <qloggingcategory.h>
 #include <qdebug.h>
+#include <qmutex.h>
 #include <sys/mman.h>
+#include <cstring>
 #include <optional>
 
 QT_BEGIN_NAMESPACE
 
 static Q_LOGGING_CATEGORY(qLcV4L2MemoryTransfer, "qt.multimedia.ffmpeg.v4l2camera.memorytransfer");
 
+#ifndef V4L2_BUF_CAP_SUPPORTS_ORPHANED_BUFS
+// not reported by kernel headers older than 5.0
+#define V4L2_BUF_CAP_SUPPORTS_ORPHANED_BUFS 0
+#endif
+
 namespace {
 
 v4l2_buffer makeV4l2Buffer(quint32 memoryType, quint32 index = 0)
@@ -27,16 +36,16 @@ v4l2_buffer makeV4l2Buffer(quint32 memoryType, quint32 index = 0)
 class UserPtrMemoryTransfer : public QV4L2MemoryTransfer
 {
 public:
-    static QV4L2MemoryTransferUPtr create(QV4L2FileDescriptorPtr fileDescriptor, quint32 imageSize)
+    static QV4L2MemoryTransferUPtr create(QV4L2FileDescriptorPtr fileDescriptor, quint32 imageSize,
+                                          quint32 bytesPerLine, quint32 buffersCount)
     {
-        quint32 buffersCount = 2;
         if (!fileDescriptor->requestBuffers(V4L2_MEMORY_USERPTR, buffersCount)) {
             qCWarning(qLcV4L2MemoryTransfer) << "Cannot request V4L2_MEMORY_USERPTR buffers";
             return {};
         }
 
-        std::unique_ptr<UserPtrMemoryTransfer> result(
-                new UserPtrMemoryTransfer(std::move(fileDescriptor), buffersCount, imageSize));
+        std::unique_ptr<UserPtrMemoryTransfer> result(new UserPtrMemoryTransfer(
+                std::move(fileDescriptor), buffersCount, imageSize, bytesPerLine));
 
         return result->enqueueBuffers() ? std::move(result) : nullptr;
     }
@@ -47,12 +56,23 @@ public:
         if (!fileDescriptor().call(VIDIOC_DQBUF, &v4l2Buffer))
             return {};
 
-        Q_ASSERT(v4l2Buffer.index < m_byteArrays.size());
-        Q_ASSERT(!m_byteArrays[v4l2Buffer.index].isEmpty());
+        const auto index = v4l2Buffer.index;
+
+        Q_ASSERT(index < m_byteArrays.size());
+        Q_ASSERT(!m_byteArrays[index].isEmpty());
+
+        // The filled byte array goes to the frame, and the driver gets a new one
+        auto data = std::move(m_byteArrays[index]);
+        if (!enqueueBuffer(index))
+            qCWarning(qLcV4L2MemoryTransfer) << "Cannot enqueue V4L2 buffer" << index;
 
-        return Buffer{ v4l2Buffer, std::move(m_byteArrays[v4l2Buffer.index]) };
+        return Buffer{ v4l2Buffer,
+                       std::make_unique<QMemoryVideoBuffer>(std::move(data), m_bytesPerLine) };
     }
 
+    quint32 buffersCount() const override { return static_cast<quint32>(m_byteArrays.size()); }
+
+protected:
     bool enqueueBuffer(quint32 index) override
     {
         Q_ASSERT(index < m_byteArrays.size());
@@ -74,23 +94,29 @@ public:
         return true;
     }
 
-    quint32 buffersCount() const override { return static_cast<quint32>(m_byteArrays.size()); }
-
 private:
     UserPtrMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor, quint32 buffersCount,
-                          quint32 imageSize)
+                          quint32 imageSize, quint32 bytesPerLine)
         : QV4L2MemoryTransfer(std::move(fileDescriptor)),
           m_imageSize(imageSize),
+          m_bytesPerLine(bytesPerLine),
           m_byteArrays(buffersCount)
     {
     }
 
 private:
     quint32 m_imageSize;
+    quint32 m_bytesPerLine;
     std::vector<QByteArray> m_byteArrays;
 };
 
-class MMapMemoryTransfer : public QV4L2MemoryTransfer
+// The mapped V4L2 buffers, shared between the memory transfer and the video frames
+// referencing them. The memory is unmapped when the last owner is gone.
+//
+// Unless the driver supports orphaned buffers, the mappings block VIDIOC_REQBUFS and
+// VIDIOC_S_FMT with EBUSY, so when the memory transfer is destroyed, the memory of the
+// buffers still held by frames is replaced with copies at the same addresses.
+class MMapBufferPool
 {
 public:
     struct MemorySpan
@@ -100,18 +126,16 @@ public:
         bool inQueue = false;
     };
 
-    static QV4L2MemoryTransferUPtr create(QV4L2FileDescriptorPtr fileDescriptor)
+    MMapBufferPool(QV4L2FileDescriptorPtr fileDescriptor, bool orphanedBuffersSupported)
+        : m_fileDescriptor(std::move(fileDescriptor)),
+          m_orphanedBuffersSupported(orphanedBuffersSupported)
     {
-        quint32 buffersCount = 2;
-        if (!fileDescriptor->requestBuffers(V4L2_MEMORY_MMAP, buffersCount)) {
-            qCWarning(qLcV4L2MemoryTransfer) << "Cannot request V4L2_MEMORY_MMAP buffers";
-            return {};
-        }
-
-        std::unique_ptr<MMapMemoryTransfer> result(
-                new MMapMemoryTransfer(std::move(fileDescriptor)));
+    }
 
-        return result->init(buffersCount) ? std::move(result) : nullptr;
+    ~MMapBufferPool()
+    {
+        for (auto &span : m_spans)
+            unmapMemory(span);
     }
 
     bool init(quint32 buffersCount)
@@ -119,13 +143,13 @@ public:
         for (quint32 index = 0; index < buffersCount; ++index) {
             auto buf = makeV4l2Buffer(V4L2_MEMORY_MMAP, index);
 
-            if (!fileDescriptor().call(VIDIOC_QUERYBUF, &buf)) {
+            if (!m_fileDescriptor->call(VIDIOC_QUERYBUF, &buf)) {
                 qWarning() << "Can't map buffer" << index;
                 return false;
             }
 
             auto mappedData = mmap(nullptr, buf.length, PROT_READ | PROT_WRITE, MAP_SHARED,
-                                   fileDescriptor().get(), buf.m.offset);
+                                   m_fileDescriptor->get(), buf.m.offset);
 
             if (mappedData == MAP_FAILED) {
                 qWarning() << "mmap failed" << index << buf.length << buf.m.offset;
@@ -137,54 +161,228 @@ public:
 
         m_spans.shrink_to_fit();
 
-        return enqueueBuffers();
+        return true;
     }
 
-    ~MMapMemoryTransfer() override
+    quint32 buffersCount() const { return static_cast<quint32>(m_spans.size()); }
+
+    const MemorySpan &span(quint32 index) const
     {
-        for (const auto &span : m_spans)
-            munmap(span.data, span.size);
+        Q_ASSERT(index < m_spans.size());
+        return m_spans[index];
     }
 
-    std::optional<Buffer> dequeueBuffer() override
+    // Returns the number of buffers remaining in the driver's queue
+    quint32 markDequeued(quint32 index)
     {
-        auto v4l2Buffer = makeV4l2Buffer(V4L2_MEMORY_MMAP);
-        if (!fileDescriptor().call(VIDIOC_DQBUF, &v4l2Buffer))
-            return {};
-
-        const auto index = v4l2Buffer.index;
+        QMutexLocker locker(&m_mutex);
 
         Q_ASSERT(index < m_spans.size());
+        Q_ASSERT(m_spans[index].inQueue);
 
-        auto &span = m_spans[index];
-
-        Q_ASSERT(span.inQueue);
-        span.inQueue = false;
-
-        return Buffer{ v4l2Buffer,
-                       QByteArray(reinterpret_cast<const char *>(span.data), span.size) };
+        m_spans[index].inQueue = false;
+        return --m_queuedCount;
     }
 
-    bool enqueueBuffer(quint32 index) override
+    bool enqueue(quint32 index)
     {
+        QMutexLocker locker(&m_mutex);
+
+        // the memory transfer has been destroyed, the buffers are not in use anymore
+        if (!m_fileDescriptor)
+            return true;
+
         Q_ASSERT(index < m_spans.size());
         Q_ASSERT(!m_spans[index].inQueue);
 
         auto buf = makeV4l2Buffer(V4L2_MEMORY_MMAP, index);
-        if (!fileDescriptor().call(VIDIOC_QBUF, &buf))
+        if (!m_fileDescriptor->call(VIDIOC_QBUF, &buf))
             return false;
 
         m_spans[index].inQueue = true;
+        ++m_queuedCount;
         return true;
     }
 
-    quint32 buffersCount() const override { return static_cast<quint32>(m_spans.size()); }
+    void detach()
+    {
+        QMutexLocker locker(&m_mutex);
+        m_fileDescriptor = nullptr;
+
+        if (m_orphanedBuffersSupported)
+            return;
+
+        // The buffers out of the queue are held by frames
+        for (auto &span : m_spans) {
+            if (span.inQueue)
+                unmapMemory(span);
+            else if (!replaceWithCopy(span))
+                qCWarning(qLcV4L2MemoryTransfer) << "Cannot copy the held V4L2 buffer";
+        }
+    }
 
 private:
-    using QV4L2MemoryTransfer::QV4L2MemoryTransfer;
+    static void unmapMemory(MemorySpan &span)
+    {
+        if (!span.data)
+            return;
+
+        munmap(span.data, span.size);
+        span.data = nullptr;
+    }
+
+    // Atomically replaces the driver's memory with an anonymous copy, so that
+    // the frames, even mapped ones, keep reading valid data at the same address
+    static bool replaceWithCopy(MemorySpan &span)
+    {
+        void *copy = mmap(nullptr, span.size, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (copy == MAP_FAILED)
+            return false;
+
+        memcpy(copy, span.data, span.size);
+
+        if (mremap(copy, span.size, span.size, MREMAP_MAYMOVE | MREMAP_FIXED, span.data)
+            == MAP_FAILED) {
+            munmap(copy, span.size);
+            return false;
+        }
+
+        return true;
+    }
 
 private:
+    QMutex m_mutex;
+    QV4L2FileDescriptorPtr m_fileDescriptor;
+    const bool m_orphanedBuffersSupported;
     std::vector<MemorySpan> m_spans;
+    quint32 m_queuedCount = 0;
+};
+
+using MMapBufferPoolPtr = std::shared_ptr<MMapBufferPool>;
+
+// References a mapped V4L2 buffer, and gives it back to the driver on destruction
+class MMapVideoBuffer : public QAbstractVideoBuffer
+{
+public:
+    MMapVideoBuffer(MMapBufferPoolPtr pool, quint32 index, int bytesPerLine)
+        : QAbstractVideoBuffer(QVideoFrame::NoHandle),
+          m_pool(std::move(pool)),
+          m_index(index),
+          m_bytesPerLine(bytesPerLine)
+    {
+    }
+
+    ~MMapVideoBuffer() override
+    {
+        if (!m_pool->enqueue(m_index))
+            qCWarning(qLcV4L2MemoryTransfer) << "Cannot enqueue V4L2 buffer" << m_index;
+    }
+
+    QVideoFrame::MapMode mapMode() const override { return m_mapMode; }
+
+    MapData map(QVideoFrame::MapMode mode) override
+    {
+        MapData mapData;
+        if (m_mapMode == QVideoFrame::NotMapped && mode != QVideoFrame::NotMapped) {
+            m_mapMode = mode;
+
+            const auto &span = m_pool->span(m_index);
+            mapData.nPlanes = 1;
+            mapData.bytesPerLine[0] = m_bytesPerLine;
+            mapData.data[0] = static_cast<uchar *>(span.data);
+            mapData.size[0] = static_cast<int>(span.size);
+        }
+
+        return mapData;
+    }
+
+    void unmap() override { m_mapMode = QVideoFrame::NotMapped; }
+
+private:
+    MMapBufferPoolPtr m_pool;
+    quint32 m_index;
+    int m_bytesPerLine;
+    QVideoFrame::MapMode m_mapMode = QVideoFrame::NotMapped;
+};
+
+class MMapMemoryTransfer : public QV4L2MemoryTransfer
+{
+public:
+    static QV4L2MemoryTransferUPtr create(QV4L2FileDescriptorPtr fileDescriptor,
+                                          quint32 bytesPerLine, quint32 buffersCount)
+    {
+        quint32 capabilities = 0;
+        if (!fileDescriptor->requestBuffers(V4L2_MEMORY_MMAP, buffersCount, &capabilities)) {
+            qCWarning(qLcV4L2MemoryTransfer) << "Cannot request V4L2_MEMORY_MMAP buffers";
+            return {};
+        }
+
+        const bool orphanedBuffersSupported =
+                (capabilities & V4L2_BUF_CAP_SUPPORTS_ORPHANED_BUFS) != 0;
+        qCDebug(qLcV4L2MemoryTransfer)
+                << "V4L2 orphaned buffers supported:" << orphanedBuffersSupported;
+
+        std::unique_ptr<MMapMemoryTransfer> result(new MMapMemoryTransfer(
+                std::move(fileDescriptor), bytesPerLine, orphanedBuffersSupported));
+
+        return result->init(buffersCount) ? std::move(result) : nullptr;
+    }
+
+    bool init(quint32 buffersCount)
+    {
+        return m_pool->init(buffersCount) && enqueueBuffers();
+    }
+
+    ~MMapMemoryTransfer() override
+    {
+        // frames still referencing the buffers don't give them back to the driver,
+        // and keep copies of the data unless the driver supports orphaned buffers
+        m_pool->detach();
+    }
+
+    std::optional<Buffer> dequeueBuffer() override
+    {
+        auto v4l2Buffer = makeV4l2Buffer(V4L2_MEMORY_MMAP);
+        if (!fileDescriptor().call(VIDIOC_DQBUF, &v4l2Buffer))
+            return {};
+
+        const auto index = v4l2Buffer.index;
+
+        if (m_pool->markDequeued(index) > 0)
+            return Buffer{ v4l2Buffer,
+                           std::make_unique<MMapVideoBuffer>(m_pool, index, m_bytesPerLine) };
+
+        // The other buffers are held by the frames; copy the data so that
+        // the driver doesn't run out of buffers.
+        const auto &span = m_pool->span(index);
+        QByteArray data(reinterpret_cast<const char *>(span.data), span.size);
+
+        if (!enqueueBuffer(index))
+            qCWarning(qLcV4L2MemoryTransfer) << "Cannot enqueue V4L2 buffer" << index;
+
+        return Buffer{ v4l2Buffer,
+                       std::make_unique<QMemoryVideoBuffer>(std::move(data), m_bytesPerLine) };
+    }
+
+    quint32 buffersCount() const override { return m_pool->buffersCount(); }
+
+protected:
+    bool enqueueBuffer(quint32 index) override { return m_pool->enqueue(index); }
+
+private:
+    MMapMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor, quint32 bytesPerLine,
+                       bool orphanedBuffersSupported)
+        : QV4L2MemoryTransfer(fileDescriptor),
+          m_pool(std::make_shared<MMapBufferPool>(std::move(fileDescriptor),
+                                                  orphanedBuffersSupported)),
+          m_bytesPerLine(bytesPerLine)
+    {
+    }
+
+private:
+    MMapBufferPoolPtr m_pool;
+    int m_bytesPerLine;
 };
 } // namespace
 
@@ -210,14 +408,17 @@ bool QV4L2MemoryTransfer::enqueueBuffers()
 }
 
 QV4L2MemoryTransferUPtr makeUserPtrMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor,
-                                                  quint32 imageSize)
+                                                  quint32 imageSize, quint32 bytesPerLine,
+                                                  quint32 buffersCount)
 {
-    return UserPtrMemoryTransfer::create(std::move(fileDescriptor), imageSize);
+    return UserPtrMemoryTransfer::create(std::move(fileDescriptor), imageSize, bytesPerLine,
+                                         buffersCount);
 }
 
-QV4L2MemoryTransferUPtr makeMMapMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor)
+QV4L2MemoryTransferUPtr makeMMapMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor,
+                                               quint32 bytesPerLine, quint32 buffersCount)
 {
-    return MMapMemoryTransfer::create(std::move(fileDescriptor));
+    return MMapMemoryTransfer::create(std::move(fileDescriptor), bytesPerLine, buffersCount);
 }
 
 QT_END_NAMESPACE
@@ -5,10 +5,12 @@
 #define QV4L2MEMORYTRANSFER_P_H
 
 #include <private/qtmultimediaglobal_p.h>
+#include <private/qabstractvideobuffer_p.h>
 #include <qbytearray.h>
 #include <linux/videodev2.h>
 
 #include <memory>
+#include <optional>
 
 QT_BEGIN_NAMESPACE
 
@@ -32,20 +34,25 @@ public:
     struct Buffer
     {
         v4l2_buffer v4l2Buffer = {};
-        QByteArray data;
+
+        // Holds the frame data. The V4L2 buffer is given back to the driver
+        // either right away or when the video buffer gets destroyed.
+        std::unique_ptr<QAbstractVideoBuffer> videoBuffer;
     };
 
     QV4L2MemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor);
 
     virtual ~QV4L2MemoryTransfer();
 
+    // May be invoked on a capture thread; the video buffers of the dequeued
+    // buffers may be destroyed on any thread.
     virtual std::optional<Buffer> dequeueBuffer() = 0;
 
-    virtual bool enqueueBuffer(quint32 index) = 0;
-
     virtual quint32 buffersCount() const = 0;
 
 protected:
+    virtual bool enqueueBuffer(quint32 index) = 0;
+
     bool enqueueBuffers();
 
     const QV4L2FileDescriptor &fileDescriptor() const { return *m_fileDescriptor; }
@@ -57,9 +64,13 @@ private:
 using QV4L2MemoryTransferUPtr = std::unique_ptr<QV4L2MemoryTransfer>;
 
 QV4L2MemoryTransferUPtr makeUserPtrMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor,
-                                                  quint32 imageSize);
+                                                  quint32 imageSize, quint32 bytesPerLine,
+                                                  quint32 buffersCount);
 
-QV4L2MemoryTransferUPtr makeMMapMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor);
+// The frames reference the mapped memory directly; the pool gets
+// starved if the frames are kept for too long, then the frames are copied.
+QV4L2MemoryTransferUPtr makeMMapMemoryTransfer(QV4L2FileDescriptorPtr fileDescriptor,
+                                               quint32 bytesPerLine, quint32 buffersCount);
 
 QT_END_NAMESPACE
 
@@ -23,6 +23,7 @@
 #include <X11/extensions/Xrandr.h>
 
 #include <optional>
+#include <vector>
 
 QT_BEGIN_NAMESPACE
 
@@ -81,6 +82,127 @@ QVideoFrameFormat::PixelFormat xImagePixelFormat(const XImage &image)
     return QVideoFrameFormat::Format_Invalid;
 }
 
+// The number of XShm images rotated by the grabber; a frame referencing an
+// image keeps it from being reused.
+constexpr size_t MaxShmImagesCount = 4;
+
+// An XShm image attached to the X server while the grabber uses it, and to the
+// process while anything references it.
+class ShmImage
+{
+public:
+    ShmImage(Display *display, Visual *visual, int depth, int width, int height)
+        : m_display(display)
+    {
+        m_shmInfo.shmid = -1;
+
+        m_image.reset(XShmCreateImage(display, visual, depth, ZPixmap, nullptr, &m_shmInfo, width,
+                                      height));
+        if (!m_image)
+            return;
+
+        m_shmInfo.shmid =
+                shmget(IPC_PRIVATE, m_image->bytes_per_line * m_image->height, IPC_CREAT | 0777);
+
+        if (m_shmInfo.shmid == -1)
+            return;
+
+        auto address = shmat(m_shmInfo.shmid, 0, 0);
+        if (address == reinterpret_cast<void *>(-1))
+            return;
+
+        m_shmInfo.readOnly = false;
+        m_shmInfo.shmaddr = m_image->data = static_cast<char *>(address);
+
+        m_attached = XShmAttach(display, &m_shmInfo);
+    }
+
+    ~ShmImage()
+    {
+        // the X server has to release the segment before the display is closed
+        Q_ASSERT(!m_attached);
+
+        m_image.reset();
+
+        if (m_shmInfo.shmaddr)
+            shmdt(m_shmInfo.shmaddr);
+
+        if (m_shmInfo.shmid != -1)
+            shmctl(m_shmInfo.shmid, IPC_RMID, 0);
+    }
+
+    XImage *image() const { return m_image.get(); }
+
+    bool isAttached() const { return m_attached; }
+
+    void detach()
+    {
+        if (std::exchange(m_attached, false))
+            XShmDetach(m_display, &m_shmInfo);
+    }
+
+    uchar *data() const { return reinterpret_cast<uchar *>(m_image->data); }
+
+    int bytesPerLine() const { return m_image->bytes_per_line; }
+
+    int size() const { return m_image->bytes_per_line * m_image->height; }
+
+private:
+    Display *m_display = nullptr;
+    std::unique_ptr<XImage, decltype(&destroyXImage)> m_image{ nullptr, &destroyXImage };
+    XShmSegmentInfo m_shmInfo = {};
+    bool m_attached = false;
+};
+
+using ShmImagePtr = std::shared_ptr<ShmImage>;
+
+// Maps the grabbed XShm image directly. The X server leaves the alpha channel
+// undefined, so it's fixed up in place when the frame is mapped for reading.
+class ShmVideoBuffer : public QAbstractVideoBuffer
+{
+public:
+    ShmVideoBuffer(ShmImagePtr image, QVideoFrameFormat::PixelFormat pixelFormat)
+        : QAbstractVideoBuffer(QVideoFrame::NoHandle),
+          m_image(std::move(image)),
+          m_pixelFormat(pixelFormat)
+    {
+    }
+
+    QVideoFrame::MapMode mapMode() const override { return m_mapMode; }
+
+    MapData map(QVideoFrame::MapMode mode) override
+    {
+        MapData mapData;
+        if (m_mapMode != QVideoFrame::NotMapped || mode == QVideoFrame::NotMapped)
+            return mapData;
+
+        m_mapMode = mode;
+
+        if ((mode & QVideoFrame::ReadOnly) && !std::exchange(m_alphaFixed, true)) {
+            // The alpha doesn't vary in known cases, so checking the first pixel is enough
+            const auto pixels = reinterpret_cast<uint32_t *>(m_image->data());
+            const auto mask = qAlphaMask(m_pixelFormat);
+            if ((pixels[0] & mask) != mask)
+                qCopyPixelsWithMask(pixels, pixels, m_image->size() / 4, mask);
+        }
+
+        mapData.nPlanes = 1;
+        mapData.bytesPerLine[0] = m_image->bytesPerLine();
+        mapData.data[0] = m_image->data();
+        mapData.size[0] = m_image->size();
+
+        return mapData;
+    }
+
+    void unmap() override { m_mapMode = QVideoFrame::NotMapped; }
+
+private:
+    ShmImagePtr m_image;
+    QVideoFrameFormat::PixelFormat m_pixelFormat;
+    QVideoFrame::MapMode m_mapMode = QVideoFrame::NotMapped;
+    bool m_alphaFixed = false;
+};
+
 } // namespace
 
 class QX11SurfaceCapture::Grabber : private QFFmpegSurfaceCaptureGrabber
@@ -102,7 +224,7 @@ public:
     {
         stop();
 
-        detachShm();
+        releaseShmImages();
     }
 
     const QVideoFrameFormat &format() const { return m_format; }
@@ -166,29 +288,60 @@ private:
         return false;
     }
 
-    void detachShm()
+    // The images referenced by frames stay mapped, but the X server doesn't use them anymore
+    void releaseShmImages()
     {
-        if (std::exchange(m_attached, false)) {
-            XShmDetach(m_display.get(), &m_shmInfo);
-            shmdt(m_shmInfo.shmaddr);
-            shmctl(m_shmInfo.shmid, IPC_RMID, 0);
-        }
+        for (auto &image : m_shmImages)
+            image->detach();
+
+        m_shmImages.clear();
+
+        if (m_copyShmImage)
+            m_copyShmImage->detach();
+
+        m_copyShmImage.reset();
     }
 
-    void attachShm()
+    ShmImagePtr createShmImage()
     {
-        Q_ASSERT(!m_attached);
+        auto result = std::make_shared<ShmImage>(m_display.get(), m_visual, m_depth,
+                                                 m_format.frameWidth(), m_format.frameHeight());
+        if (!result->isAttached()) {
+            updateError(QPlatformSurfaceCapture::CaptureFailed,
+                        QLatin1String("Cannot attach shared memory"));
+            return nullptr;
+        }
 
-        m_shmInfo.shmid =
-                shmget(IPC_PRIVATE, m_xImage->bytes_per_line * m_xImage->height, IPC_CREAT | 0777);
+        return result;
+    }
 
-        if (m_shmInfo.shmid == -1)
-            return;
+    // Rotates the images; if all of them are held by frames,
+    // the image reserved for copying is returned.
+    std::pair<ShmImagePtr, bool> takeShmImage()
+    {
+        const auto count = m_shmImages.size();
+        for (size_t i = 0; i < count; ++i) {
+            const auto index = (m_nextShmImage + i) % count;
+            // only the grabber hands out references, so the count cannot grow concurrently
+            if (m_shmImages[index].use_count() == 1) {
+                m_nextShmImage = (index + 1) % count;
+                return { m_shmImages[index], true };
+            }
+        }
 
-        m_shmInfo.readOnly = false;
-        m_shmInfo.shmaddr = m_xImage->data = (char *)shmat(m_shmInfo.shmid, 0, 0);
+        if (count < MaxShmImagesCount) {
+            if (auto image = createShmImage()) {
+                m_shmImages.push_back(image);
+                m_nextShmImage = 0;
+                return { std::move(image), true };
+            }
+            return {};
+        }
+
+        if (!m_copyShmImage)
+            m_copyShmImage = createShmImage();
 
-        m_attached = XShmAttach(m_display.get(), &m_shmInfo);
+        return { m_copyShmImage, false };
     }
 
     bool update()
@@ -207,49 +360,55 @@ private:
 
         // check window params for the root window as well since
         // it potentially can be changed (e.g. on VM with resizing)
-        if (!m_xImage || wndattr.width != m_xImage->width || wndattr.height != m_xImage->height
-            || wndattr.depth != m_xImage->depth || wndattr.visual->visualid != m_visualID) {
+        if (m_shmImages.empty() || wndattr.width != m_format.frameWidth()
+            || wndattr.height != m_format.frameHeight() || wndattr.depth != m_depth
+            || wndattr.visual->visualid != m_visualID) {
 
             qCDebug(qLcX11SurfaceCapture) << "recreate ximage: " << wndattr.width << wndattr.height
                                           << wndattr.depth << wndattr.visual->visualid;
 
-            detachShm();
-            m_xImage.reset();
+            releaseShmImages();
+            m_format = {};
 
             m_visualID = wndattr.visual->visualid;
-            m_xImage.reset(XShmCreateImage(m_display.get(), wndattr.visual, wndattr.depth, ZPixmap,
-                                           nullptr, &m_shmInfo, wndattr.width, wndattr.height));
+            m_visual = wndattr.visual;
+            m_depth = wndattr.depth;
 
-            if (!m_xImage) {
+            auto image = std::make_shared<ShmImage>(m_display.get(), wndattr.visual, wndattr.depth,
+                                                    wndattr.width, wndattr.height);
+
+            if (!image->image()) {
                 updateError(QPlatformSurfaceCapture::CaptureFailed,
                             QLatin1String("Cannot create image"));
                 return false;
             }
 
-            const auto pixelFormat = xImagePixelFormat(*m_xImage);
+            const auto pixelFormat = xImagePixelFormat(*image->image());
 
             // TODO: probably, add a converter instead
             if (pixelFormat == QVideoFrameFormat::Format_Invalid) {
                 updateError(QPlatformSurfaceCapture::CaptureFailed,
                             QLatin1String("Not handled pixel format, bpp=")
-                                    + QString::number(m_xImage->bits_per_pixel));
+                                    + QString::number(image->image()->bits_per_pixel));
+                image->detach();
                 return false;
             }
 
-            attachShm();
-
-            if (!m_attached) {
+            if (!image->isAttached()) {
                 updateError(QPlatformSurfaceCapture::CaptureFailed,
                             QLatin1String("Cannot attach shared memory"));
                 return false;
             }
 
-            QVideoFrameFormat format(QSize(m_xImage->width, m_xImage->height), pixelFormat);
+            QVideoFrameFormat format(QSize(wndattr.width, wndattr.height), pixelFormat);
             format.setFrameRate(frameRate());
             m_format = format;
+
+            m_shmImages.push_back(std::move(image));
+            m_nextShmImage = 0;
         }
 
-        return m_attached;
+        return true;
     }
 
 protected:
@@ -258,7 +417,11 @@ protected:
         if (!update())
             return {};
 
-        if (!XShmGetImage(m_display.get(), m_xid, m_xImage.get(), m_xOffset, m_yOffset,
+        auto [image, shared] = takeShmImage();
+        if (!image)
+            return {};
+
+        if (!XShmGetImage(m_display.get(), m_xid, image->image(), m_xOffset, m_yOffset,
                           AllPlanes)) {
             updateError(QPlatformSurfaceCapture::CaptureFailed,
                         QLatin1String(
@@ -266,9 +429,13 @@ protected:
             return {};
         }
 
-        QByteArray data(m_xImage->bytes_per_line * m_xImage->height, Qt::Uninitialized);
+        if (shared)
+            return QVideoFrame(new ShmVideoBuffer(std::move(image), m_format.pixelFormat()),
+                               m_format);
 
-        const auto pixelSrc = reinterpret_cast<const uint32_t *>(m_xImage->data);
+        QByteArray data(image->size(), Qt::Uninitialized);
+
+        const auto pixelSrc = reinterpret_cast<const uint32_t *>(image->data());
         const auto pixelDst = reinterpret_cast<uint32_t *>(data.data());
         const auto pixelCount = data.size() / 4;
         const auto xImageAlphaVaries = false; // In known cases it doesn't vary - it's 0xff or 0xff
@@ -276,7 +443,7 @@ protected:
         qCopyPixelsWithAlphaMask(pixelDst, pixelSrc, pixelCount, m_format.pixelFormat(),
                                        xImageAlphaVaries);
 
-        auto buffer = new QMemoryVideoBuffer(data, m_xImage->bytes_per_line);
+        auto buffer = new QMemoryVideoBuffer(data, image->bytesPerLine());
         return QVideoFrame(buffer, m_format);
     }
 
@@ -286,10 +453,12 @@ private:
     int m_xOffset = 0;
     int m_yOffset = 0;
     std::unique_ptr<Display, decltype(&XCloseDisplay)> m_display{ nullptr, &XCloseDisplay };
-    std::unique_ptr<XImage, decltype(&destroyXImage)> m_xImage{ nullptr, &destroyXImage };
-    XShmSegmentInfo m_shmInfo;
-    bool m_attached = false;
+    std::vector<ShmImagePtr> m_shmImages;
+    size_t m_nextShmImage = 0;
+    ShmImagePtr m_copyShmImage;
     VisualID m_visualID = None;
+    Visual *m_visual = nullptr;
+    int m_depth = 0;
     QVideoFrameFormat m_format;
 };
 
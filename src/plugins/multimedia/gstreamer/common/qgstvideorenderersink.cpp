@@ -42,10 +42,13 @@ QGstVideoRenderer::QGstVideoRenderer(QGstreamerVideoSink *sink)
     : m_sink(sink)
 {
     createSurfaceCaps();
+
+    m_mailboxMode = qEnvironmentVariableIntValue("QT_GSTREAMER_VIDEO_SINK_MAILBOX") != 0;
 }
 
 QGstVideoRenderer::~QGstVideoRenderer()
 {
+    clearMailbox(false);
 }
 
 void QGstVideoRenderer::createSurfaceCaps()
@@ -131,6 +134,9 @@ bool QGstVideoRenderer::start(const QGstCaps& caps)
 
     m_startCaps = caps;
 
+    // the pending buffer doesn't match the new caps
+    clearMailbox(true);
+
     /*
     Waiting for start() to be invoked in the main thread may block
     if gstreamer blocks the main thread until this call is finished.
@@ -162,7 +168,11 @@ void QGstVideoRenderer::stop()
 
     m_startCaps = {};
 
+    clearMailbox(false);
+
     waitForAsyncEvent(&locker, &m_setupCondition, 500);
+
+    qCDebug(qLcGstVideoRenderer) << "QGstVideoRenderer::stop; dropped frames:" << droppedFrames();
 }
 
 void QGstVideoRenderer::unlock()
@@ -188,11 +198,26 @@ void QGstVideoRenderer::flush()
     m_renderBuffer = nullptr;
     m_renderCondition.wakeAll();
 
+    clearMailbox(false);
+
     notify();
 }
 
 GstFlowReturn QGstVideoRenderer::render(GstBuffer *buffer)
 {
+    if (m_mailboxMode.loadRelaxed()) {
+        gst_buffer_ref(buffer);
+        if (GstBuffer *superseded = m_mailbox.fetchAndStoreAcquire(buffer)) {
+            gst_buffer_unref(superseded);
+            m_droppedFrames.fetchAndAddRelaxed(1);
+        }
+
+        QMutexLocker locker(&m_mutex);
+        notify();
+
+        return GST_FLOW_OK;
+    }
+
     QMutexLocker locker(&m_mutex);
     qCDebug(qLcGstVideoRenderer) << "QGstVideoRenderer::render";
 
@@ -206,6 +231,20 @@ GstFlowReturn QGstVideoRenderer::render(GstBuffer *buffer)
     return m_renderReturn;
 }
 
+void QGstVideoRenderer::setMailboxMode(bool mailbox)
+{
+    m_mailboxMode.storeRelaxed(mailbox);
+}
+
+void QGstVideoRenderer::clearMailbox(bool countDropped)
+{
+    if (GstBuffer *buffer = m_mailbox.fetchAndStoreAcquire(nullptr)) {
+        gst_buffer_unref(buffer);
+        if (countDropped)
+            m_droppedFrames.fetchAndAddRelaxed(1);
+    }
+}
+
 bool QGstVideoRenderer::query(GstQuery *query)
 {
 #if QT_CONFIG(gstreamer_gl)
@@ -337,31 +376,7 @@ bool QGstVideoRenderer::handleEvent(QMutexLocker<QMutex> *locker)
 
             locker->unlock();
 
-            m_flushed = false;
-
-            auto meta = gst_buffer_get_video_crop_meta (buffer);
-            if (meta) {
-                QRect vp(meta->x, meta->y, meta->width, meta->height);
-                if (m_format.viewport() != vp) {
-                    qCDebug(qLcGstVideoRenderer) << Q_FUNC_INFO << " Update viewport on Metadata: [" << meta->height << "x" << meta->width << " | " << meta->x << "x" << meta->y << "]";
-                    // Update viewport if data is not the same
-                    m_format.setViewport(vp);
-                }
-            }
-
-            if (m_sink->inStoppedState()) {
-                qCDebug(qLcGstVideoRenderer) << "    sending empty video frame";
-                m_sink->setVideoFrame(QVideoFrame());
-            } else {
-                QGstVideoBuffer *videoBuffer = new QGstVideoBuffer(buffer, m_videoInfo, m_sink, m_format, memoryFormat);
-                QVideoFrame frame(videoBuffer, m_format);
-                QGstUtils::setFrameTimeStamps(&frame, buffer);
-                frame.setMirrored(m_frameMirrored);
-                frame.setRotation(m_frameRotationAngle);
-
-                qCDebug(qLcGstVideoRenderer) << "    sending video frame";
-                m_sink->setVideoFrame(frame);
-            }
+            showBuffer(buffer);
 
             gst_buffer_unref(buffer);
 
@@ -371,6 +386,20 @@ bool QGstVideoRenderer::handleEvent(QMutexLocker<QMutex> *locker)
         }
 
         m_renderCondition.wakeAll();
+    } else if (GstBuffer *buffer = m_mailbox.fetchAndStoreAcquire(nullptr)) {
+        qCDebug(qLcGstVideoRenderer) << "QGstVideoRenderer::handleEvent(mailbox)" << m_active << m_sink;
+        if (m_active && m_sink) {
+            locker->unlock();
+
+            showBuffer(buffer);
+
+            gst_buffer_unref(buffer);
+
+            locker->relock();
+        } else {
+            gst_buffer_unref(buffer);
+            m_droppedFrames.fetchAndAddRelaxed(1);
+        }
     } else {
         m_setupCondition.wakeAll();
 
@@ -379,6 +408,35 @@ bool QGstVideoRenderer::handleEvent(QMutexLocker<QMutex> *locker)
     return true;
 }
 
+void QGstVideoRenderer::showBuffer(GstBuffer *buffer)
+{
+    m_flushed = false;
+
+    auto meta = gst_buffer_get_video_crop_meta (buffer);
+    if (meta) {
+        QRect vp(meta->x, meta->y, meta->width, meta->height);
+        if (m_format.viewport() != vp) {
+            qCDebug(qLcGstVideoRenderer) << Q_FUNC_INFO << " Update viewport on Metadata: [" << meta->height << "x" << meta->width << " | " << meta->x << "x" << meta->y << "]";
+            // Update viewport if data is not the same
+            m_format.setViewport(vp);
+        }
+    }
+
+    if (m_sink->inStoppedState()) {
+        qCDebug(qLcGstVideoRenderer) << "    sending empty video frame";
+        m_sink->setVideoFrame(QVideoFrame());
+    } else {
+        QGstVideoBuffer *videoBuffer = new QGstVideoBuffer(buffer, m_videoInfo, m_sink, m_format, memoryFormat);
+        QVideoFrame frame(videoBuffer, m_format);
+        QGstUtils::setFrameTimeStamps(&frame, buffer);
+        frame.setMirrored(m_frameMirrored);
+        frame.setRotation(m_frameRotationAngle);
+
+        qCDebug(qLcGstVideoRenderer) << "    sending video frame";
+        m_sink->setVideoFrame(frame);
+    }
+}
+
 void QGstVideoRenderer::notify()
 {
     if (!m_notified) {
@@ -403,6 +461,13 @@ bool QGstVideoRenderer::waitForAsyncEvent(
 }
 
 static GstVideoSinkClass *gvrs_sink_parent_class;
+
+enum {
+    PROP_0,
+    PROP_MAILBOX,
+    PROP_FRAMES_DROPPED,
+};
+
 static thread_local QGstreamerVideoSink *gvrs_current_sink;
 
 #define VO_SINK(s) QGstVideoRendererSink *sink(reinterpret_cast<QGstVideoRendererSink *>(s))
@@ -481,6 +546,22 @@ void QGstVideoRendererSink::class_init(gpointer g_class, gpointer class_data)
 
     GObjectClass *object_class = reinterpret_cast<GObjectClass *>(g_class);
     object_class->finalize = QGstVideoRendererSink::finalize;
+    object_class->set_property = QGstVideoRendererSink::set_property;
+    object_class->get_property = QGstVideoRendererSink::get_property;
+
+    g_object_class_install_property(
+            object_class, PROP_MAILBOX,
+            g_param_spec_boolean("mailbox", "Mailbox",
+                                 "Don't block the streaming thread until the frame is shown; "
+                                 "show the latest frame and drop the superseded ones",
+                                 FALSE,
+                                 GParamFlags(G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS)));
+
+    g_object_class_install_property(
+            object_class, PROP_FRAMES_DROPPED,
+            g_param_spec_uint64("frames-dropped", "Frames dropped",
+                                "Number of frames dropped in the mailbox mode", 0, G_MAXUINT64, 0,
+                                GParamFlags(G_PARAM_READABLE | G_PARAM_STATIC_STRINGS)));
 }
 
 void QGstVideoRendererSink::base_init(gpointer g_class)
@@ -518,6 +599,39 @@ void QGstVideoRendererSink::finalize(GObject *object)
     G_OBJECT_CLASS(gvrs_sink_parent_class)->finalize(object);
 }
 
+void QGstVideoRendererSink::set_property(GObject *object, guint propertyId, const GValue *value,
+                                         GParamSpec *pspec)
+{
+    VO_SINK(object);
+
+    switch (propertyId) {
+    case PROP_MAILBOX:
+        sink->renderer->setMailboxMode(g_value_get_boolean(value));
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, propertyId, pspec);
+        break;
+    }
+}
+
+void QGstVideoRendererSink::get_property(GObject *object, guint propertyId, GValue *value,
+                                         GParamSpec *pspec)
+{
+    VO_SINK(object);
+
+    switch (propertyId) {
+    case PROP_MAILBOX:
+        g_value_set_boolean(value, sink->renderer->mailboxMode());
+        break;
+    case PROP_FRAMES_DROPPED:
+        g_value_set_uint64(value, sink->renderer->droppedFrames());
+        break;
+    default:
+        G_OBJECT_WARN_INVALID_PROPERTY_ID(object, propertyId, pspec);
+        break;
+    }
+}
+
 void QGstVideoRendererSink::handleShowPrerollChange(GObject *o, GParamSpec *p, gpointer d)
 {
     Q_UNUSED(o);
@@ -19,6 +19,7 @@
 #include <gst/video/gstvideosink.h>
 #include <gst/video/video.h>
 
+#include <QtCore/qatomic.h>
 #include <QtCore/qlist.h>
 #include <QtCore/qmutex.h>
 #include <QtCore/qqueue.h>
@@ -50,6 +51,14 @@ public:
 
     GstFlowReturn render(GstBuffer *buffer);
 
+    // In the mailbox mode, render() doesn't wait for the frame to be shown: the buffer
+    // replaces the pending one, if any, and the renderer's thread shows the latest buffer.
+    void setMailboxMode(bool mailbox);
+    bool mailboxMode() const { return m_mailboxMode.loadRelaxed(); }
+
+    // The buffers superseded by newer ones or dropped since the renderer was inactive
+    quint64 droppedFrames() const { return m_droppedFrames.loadRelaxed(); }
+
     bool event(QEvent *event) override;
     bool query(GstQuery *query);
     void gstEvent(GstEvent *event);
@@ -58,6 +67,8 @@ private slots:
     bool handleEvent(QMutexLocker<QMutex> *locker);
 
 private:
+    void showBuffer(GstBuffer *buffer);
+    void clearMailbox(bool countDropped);
     void notify();
     bool waitForAsyncEvent(QMutexLocker<QMutex> *locker, QWaitCondition *condition, unsigned long time);
     void createSurfaceCaps();
@@ -83,6 +94,11 @@ private:
     bool m_frameMirrored = false;
     QtVideo::Rotation m_frameRotationAngle = QtVideo::Rotation::None;
 
+    // --- accessed from multiple threads without the mutex
+    QAtomicInteger<bool> m_mailboxMode = false;
+    QAtomicPointer<GstBuffer> m_mailbox; // holds a reference
+    QAtomicInteger<quint64> m_droppedFrames = 0;
+
     // --- only accessed from one thread
     QVideoFrameFormat m_format;
     GstVideoInfo m_videoInfo;
@@ -106,6 +122,10 @@ private:
 
     static void finalize(GObject *object);
 
+    static void set_property(GObject *object, guint propertyId, const GValue *value,
+                             GParamSpec *pspec);
+    static void get_property(GObject *object, guint propertyId, GValue *value, GParamSpec *pspec);
+
     static void handleShowPrerollChange(GObject *o, GParamSpec *p, gpointer d);
 
     static GstStateChangeReturn change_state(GstElement *element, GstStateChange transition);
@@ -8,19 +8,48 @@
 #include <qurl.h>
 #include <qdebug.h>
 #include <qaudiodecoder.h>
+#include <qloggingcategory.h>
 
 QT_BEGIN_NAMESPACE
 
+static Q_LOGGING_CATEGORY(qLcAmbientSound, "qt.spatialaudio.ambientsound")
+
+// Sources longer than StreamingDurationThreshold are decoded while playing; only
+// StreamingBufferDuration of the decoded audio is kept ahead of the playback position.
+static constexpr qint64 StreamingDurationThreshold = 10000; // ms
+static constexpr qint64 StreamingBufferDuration = 2000; // ms
+
 void QAmbientSoundPrivate::load()
 {
-    decoder.reset(new QAudioDecoder);
-    buffers.clear();
-    currentBuffer = 0;
+    auto *ep = QAudioEnginePrivate::get(engine);
+    ep->releaseAsset(this);
+
+    decoder.reset();
+    {
+        QMutexLocker l(&mutex);
+        buffers.clear();
+        currentBuffer = 0;
+        bufPos = 0;
+        streaming = false;
+        queuedFrames = 0;
+        m_needsRewind = false;
+        m_playing = false;
+        m_loading = true;
+    }
     sourceDeviceFile.reset(nullptr);
-    bufPos = 0;
-    m_playing = false;
-    m_loading = true;
+    m_decodedLoops = 0;
+
+    // Sounds with the same source share the decoded buffers
+    if (ep->acquireAsset(this) != QAudioEnginePrivate::AssetState::Load)
+        return;
+
+    decode();
+}
+
+void QAmbientSoundPrivate::decode()
+{
     auto *ep = QAudioEnginePrivate::get(engine);
+    decoder.reset(new QAudioDecoder);
     QAudioFormat f;
     f.setSampleFormat(QAudioFormat::Float);
     f.setSampleRate(ep->sampleRate);
@@ -28,8 +57,10 @@ void QAmbientSoundPrivate::load()
     decoder->setAudioFormat(f);
     if (url.scheme().compare(u"qrc", Qt::CaseInsensitive) == 0) {
         auto qrcFile = std::make_unique<QFile>(u':' + url.path());
-        if (!qrcFile->open(QFile::ReadOnly))
+        if (!qrcFile->open(QFile::ReadOnly)) {
+            ep->discardAsset(this);
             return;
+        }
         sourceDeviceFile = std::move(qrcFile);
         decoder->setSourceDevice(sourceDeviceFile.get());
     } else {
@@ -37,13 +68,52 @@ void QAmbientSoundPrivate::load()
     }
     connect(decoder.get(), &QAudioDecoder::bufferReady, this, &QAmbientSoundPrivate::bufferReady);
     connect(decoder.get(), &QAudioDecoder::finished, this, &QAmbientSoundPrivate::finished);
+    connect(decoder.get(), qOverload<QAudioDecoder::Error>(&QAudioDecoder::error), this,
+            [this]() { QAudioEnginePrivate::get(engine)->discardAsset(this); });
     decoder->start();
 }
 
+void QAmbientSoundPrivate::setAssetBuffers(const QList<QAudioBuffer> &assetBuffers)
+{
+    QMutexLocker l(&mutex);
+    buffers = assetBuffers;
+    currentBuffer = 0;
+    bufPos = 0;
+    m_loading = false;
+    if (m_autoPlay)
+        m_playing = true;
+}
+
+void QAmbientSoundPrivate::stop()
+{
+    QMutexLocker locker(&mutex);
+    m_playing = false;
+    currentBuffer = 0;
+    bufPos = 0;
+    m_currentLoop = 0;
+
+    if (!streaming)
+        return;
+
+    buffers.clear();
+    queuedFrames = 0;
+    m_needsRewind = false;
+    m_loading = true;
+    locker.unlock();
+
+    m_decodedLoops = 0;
+    restartDecoder();
+}
+
 void QAmbientSoundPrivate::getBuffer(float *buf, int nframes, int channels)
 {
     Q_ASSERT(channels == nchannels);
     QMutexLocker l(&mutex);
+    if (streaming) {
+        getStreamingBuffer(buf, nframes);
+        return;
+    }
+
     if (!m_playing || currentBuffer >= buffers.size()) {
         memset(buf, 0, channels * nframes * sizeof(float));
     } else {
@@ -67,7 +137,7 @@ void QAmbientSoundPrivate::getBuffer(float *buf, int nframes, int channels)
             } else {
                 // no more data available
                 if (m_loading)
-                    qDebug() << "underrun" << frames << "frames when loading" << url;
+                    m_underrunFrames.fetchAndAddRelaxed(frames);
                 memset(ff, 0, frames * channels * sizeof(float));
                 ff += frames * channels;
                 frames = 0;
@@ -87,19 +157,163 @@ void QAmbientSoundPrivate::getBuffer(float *buf, int nframes, int channels)
     }
 }
 
+// Called with the mutex locked
+void QAmbientSoundPrivate::getStreamingBuffer(float *buf, int nframes)
+{
+    float *ff = buf;
+    int frames = m_playing ? nframes : 0;
+    while (frames && !buffers.isEmpty()) {
+        const QAudioBuffer &b = buffers.constFirst();
+        auto *f = b.constData<float>() + bufPos*nchannels;
+        int toCopy = qMin(int(b.frameCount()) - bufPos, frames);
+        memcpy(ff, f, toCopy*sizeof(float)*nchannels);
+        ff += toCopy*nchannels;
+        frames -= toCopy;
+        bufPos += toCopy;
+        queuedFrames -= toCopy;
+        if (bufPos == b.frameCount()) {
+            buffers.removeFirst();
+            bufPos = 0;
+        }
+    }
+
+    if (frames) {
+        if (m_loading) {
+            m_underrunFrames.fetchAndAddRelaxed(frames);
+        } else {
+            // all loops are played; rewind for the next play()
+            m_playing = false;
+            m_needsRewind = true;
+        }
+    }
+    memset(ff, 0, (buf + nframes*nchannels - ff) * sizeof(float));
+
+    const bool needsData = m_loading && queuedFrames < streamingCapacity / 2;
+    if ((needsData || m_needsRewind) && !m_refillPending.fetchAndStoreRelaxed(true))
+        QMetaObject::invokeMethod(this, &QAmbientSoundPrivate::refill, Qt::QueuedConnection);
+}
+
+void QAmbientSoundPrivate::readBuffers()
+{
+    while (decoder->bufferAvailable()) {
+        qint64 maxFrames = 0;
+        {
+            QMutexLocker l(&mutex);
+            maxFrames = streamingCapacity - queuedFrames;
+        }
+        if (maxFrames <= 0)
+            return;
+
+        // decode outside of the lock, so that rendering isn't blocked
+        auto b = decoder->read(maxFrames);
+        if (!b.isValid())
+            return;
+
+        QMutexLocker l(&mutex);
+        buffers.append(b);
+        queuedFrames += b.frameCount();
+    }
+}
+
+void QAmbientSoundPrivate::restartDecoder()
+{
+    if (decoder->isDecoding()) {
+        m_restartingDecoder = true;
+        decoder->stop();
+        m_restartingDecoder = false;
+        decoder->start();
+        return;
+    }
+
+    // Seek back if the backend supports it, decode the source anew otherwise
+    decoder->setPosition(0);
+    if (!decoder->isDecoding())
+        decoder->start();
+}
+
+void QAmbientSoundPrivate::reportUnderruns()
+{
+    // the audio thread doesn't log, so that it isn't blocked
+    if (const qint64 frames = m_underrunFrames.fetchAndStoreRelaxed(0))
+        qCDebug(qLcAmbientSound) << "underrun" << frames << "frames when loading" << url;
+}
+
 void QAmbientSoundPrivate::bufferReady()
 {
+    reportUnderruns();
+
+    if (streaming) {
+        readBuffers();
+        return;
+    }
+
     QMutexLocker l(&mutex);
     auto b = decoder->read();
     //    qDebug() << "read buffer" << b.format() << b.startTime() << b.duration();
     buffers.append(b);
+
+    if (buffers.size() == 1 && decoder->duration() > StreamingDurationThreshold) {
+        streaming = true;
+        queuedFrames = b.frameCount();
+        streamingCapacity = b.format().framesForDuration(StreamingBufferDuration * 1000);
+    }
+
     if (m_autoPlay)
         m_playing = true;
+
+    if (streaming) {
+        // the streamed sources aren't shared
+        l.unlock();
+        QAudioEnginePrivate::get(engine)->discardAsset(this);
+    }
 }
 
 void QAmbientSoundPrivate::finished()
 {
-    m_loading = false;
+    if (m_restartingDecoder)
+        return;
+
+    reportUnderruns();
+
+    if (streaming) {
+        ++m_decodedLoops;
+        const int loops = m_loops.loadRelaxed();
+        if (loops <= 0 || m_decodedLoops < loops) {
+            restartDecoder();
+            return;
+        }
+    }
+
+    {
+        QMutexLocker l(&mutex);
+        m_loading = false;
+    }
+
+    if (!streaming)
+        QAudioEnginePrivate::get(engine)->storeAsset(this);
+}
+
+void QAmbientSoundPrivate::refill()
+{
+    m_refillPending = false;
+    reportUnderruns();
+    if (!decoder)
+        return;
+
+    bool rewind = false;
+    {
+        QMutexLocker l(&mutex);
+        rewind = std::exchange(m_needsRewind, false);
+        if (rewind)
+            m_loading = true;
+    }
+
+    if (rewind) {
+        m_decodedLoops = 0;
+        restartDecoder();
+    }
+
+    readBuffers();
 }
 
 /*!
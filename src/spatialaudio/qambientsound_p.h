@@ -26,7 +26,7 @@ QT_BEGIN_NAMESPACE
 
 class QAudioEngine;
 
-class QAmbientSoundPrivate : public QObject
+class Q_AUTOTEST_EXPORT QAmbientSoundPrivate : public QObject
 {
 public:
     QAmbientSoundPrivate(QObject *parent, int nchannels = 2)
@@ -51,10 +51,28 @@ public:
     QList<QAudioBuffer> buffers;
     int sourceId = -1; // kInvalidSourceId
 
+    // The source of the asset shared via the engine, if any
+    QUrl assetUrl;
+
+    // Long sources are streamed: the played buffers are dropped, and the decoder
+    // is kept ahead of the playback position by up to streamingCapacity frames.
+    bool streaming = false;
+    qint64 queuedFrames = 0;
+    qint64 streamingCapacity = 0;
+    bool m_needsRewind = false;
+
     QAtomicInteger<bool> m_autoPlay = true;
     QAtomicInteger<bool> m_playing = false;
     QAtomicInt m_loops = 1;
     bool m_loading = false;
+    QAtomicInteger<bool> m_refillPending = false;
+
+    // counted on the audio thread, and reported from the object's thread
+    QAtomicInteger<qint64> m_underrunFrames = 0;
+
+    // only accessed from the object's thread
+    int m_decodedLoops = 0;
+    bool m_restartingDecoder = false;
 
     void play() {
         m_playing = true;
@@ -62,20 +80,23 @@ public:
     void pause() {
         m_playing = false;
     }
-    void stop() {
-        QMutexLocker locker(&mutex);
-        m_playing = false;
-        currentBuffer = 0;
-        bufPos = 0;
-        m_currentLoop = 0;
-    }
+    void stop();
 
     void load();
+    void decode();
+    void setAssetBuffers(const QList<QAudioBuffer> &assetBuffers);
     void getBuffer(float *buf, int frames, int channels);
 
+private:
+    void getStreamingBuffer(float *buf, int frames);
+    void readBuffers();
+    void restartDecoder();
+    void reportUnderruns();
+
 private Q_SLOTS:
     void bufferReady();
     void finished();
+    void refill();
 
 };
 
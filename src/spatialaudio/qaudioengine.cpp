@@ -14,9 +14,12 @@
 #include <qaudiosink.h>
 #include <qdebug.h>
 #include <qelapsedtimer.h>
+#include <qmath.h>
 
 #include <QFile>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 // We'd like to have short buffer times, so the sound adjusts itself to changes
@@ -112,65 +115,204 @@ qint64 QAudioOutputStream::readData(char *data, qint64 len)
     if (d->paused.loadRelaxed())
         return 0;
 
-    QMutexLocker l(&d->mutex);
-    d->updateRooms();
-
     int nChannels = ambisonicDecoder ? ambisonicDecoder->nOutputChannels() : 2;
-    if (len < nChannels*int(sizeof(float))*QAudioEnginePrivate::bufferSize)
+    if (len < nChannels*int(sizeof(short))*d->blockSize)
         return 0;
 
-    short *fd = (short *)data;
-    qint64 frames = len / nChannels / sizeof(short);
+    const qint64 frames = d->render((short *)data, len / nChannels / sizeof(short),
+                                    ambisonicDecoder.get());
+    const int bytesProcessed = frames * nChannels * sizeof(short);
+    m_pos += bytesProcessed;
+    return bytesProcessed;
+}
+
+
+QAudioEnginePrivate::QAudioEnginePrivate()
+    : renderList(new RenderList)
+{
+    device = QMediaDevices::defaultAudioOutput();
+
+    bool ok = false;
+    const int cacheSize = qEnvironmentVariableIntValue("QT_SPATIALAUDIO_ASSET_CACHE_SIZE", &ok);
+    if (ok && cacheSize >= 0)
+        assetCacheCapacity = qint64(cacheSize) * 1024 * 1024;
+}
+
+QAudioEnginePrivate::~QAudioEnginePrivate()
+{
+    delete resonanceAudio;
+    delete renderList.load();
+    for (const auto &[list, epoch] : std::as_const(retiredRenderLists))
+        delete list;
+}
+
+qint64 QAudioEnginePrivate::render(short *output, qint64 frames, QAmbisonicDecoder *ambisonicDecoder)
+{
+    renderEpoch.fetch_add(1);
+    RenderList *list = renderList.load();
+    updateRooms(*list);
+    selectVoices(*list);
+
+    const int nChannels = ambisonicDecoder ? ambisonicDecoder->nOutputChannels() : 2;
+    short *fd = output;
     bool ok = true;
-    while (frames >= qint64(QAudioEnginePrivate::bufferSize)) {
+    float *buf = scratch.get();
+    while (frames >= qint64(blockSize)) {
         // Fill input buffers
-        for (auto *source : std::as_const(d->sources)) {
+        for (auto *source : std::as_const(list->sources)) {
             auto *sp = QSpatialSoundPrivate::get(source);
             if (!sp)
                 continue;
-            float buf[QAudioEnginePrivate::bufferSize];
-            sp->getBuffer(buf, QAudioEnginePrivate::bufferSize, 1);
-            d->resonanceAudio->api->SetInterleavedBuffer(sp->sourceId, buf, 1, QAudioEnginePrivate::bufferSize);
+            // Only the latest pose of the source is applied
+            if (sp->pendingPose.load(sp->renderPose)) {
+                const auto &[pos, rotation] = sp->renderPose;
+                resonanceAudio->api->SetSourcePosition(sp->sourceId, pos.x(), pos.y(), pos.z());
+                resonanceAudio->api->SetSourceRotation(sp->sourceId, rotation.x(), rotation.y(),
+                                                       rotation.z(), rotation.scalar());
+            }
+            sp->getBuffer(buf, blockSize, 1);
+            if (sp->renderVoice(buf, blockSize))
+                resonanceAudio->api->SetInterleavedBuffer(sp->sourceId, buf, 1, blockSize);
         }
-        for (auto *source : std::as_const(d->stereoSources)) {
+        for (auto *source : list->stereoSources) {
             auto *sp = QAmbientSoundPrivate::get(source);
             if (!sp)
                 continue;
-            float buf[2*QAudioEnginePrivate::bufferSize];
-            sp->getBuffer(buf, QAudioEnginePrivate::bufferSize, 2);
-            d->resonanceAudio->api->SetInterleavedBuffer(sp->sourceId, buf, 2, QAudioEnginePrivate::bufferSize);
+            sp->getBuffer(buf, blockSize, 2);
+            resonanceAudio->api->SetInterleavedBuffer(sp->sourceId, buf, 2, blockSize);
         }
 
-        if (ambisonicDecoder && d->outputMode == QAudioEngine::Surround) {
+        if (ambisonicDecoder && outputMode == QAudioEngine::Surround) {
             const float *channels[QAmbisonicDecoder::maxAmbisonicChannels];
             const float *reverbBuffers[2];
-            int nSamples = d->resonanceAudio->getAmbisonicOutput(channels, reverbBuffers, ambisonicDecoder->nInputChannels());
+            int nSamples = resonanceAudio->getAmbisonicOutput(channels, reverbBuffers, ambisonicDecoder->nInputChannels());
             Q_ASSERT(ambisonicDecoder->nOutputChannels() <= 8);
             ambisonicDecoder->processBufferWithReverb(channels, reverbBuffers, fd, nSamples);
         } else {
-            ok = d->resonanceAudio->api->FillInterleavedOutputBuffer(2, QAudioEnginePrivate::bufferSize, fd);
+            ok = resonanceAudio->api->FillInterleavedOutputBuffer(2, blockSize, fd);
             if (!ok) {
                 qWarning() << "    Reading failed!";
                 break;
             }
         }
-        fd += nChannels*QAudioEnginePrivate::bufferSize;
-        frames -= QAudioEnginePrivate::bufferSize;
+        fd += nChannels*blockSize;
+        frames -= blockSize;
     }
-    const int bytesProcessed = ((char *)fd - data);
-    m_pos += bytesProcessed;
-    return bytesProcessed;
-}
 
+    renderEpoch.fetch_add(1);
 
-QAudioEnginePrivate::QAudioEnginePrivate()
+    return (fd - output) / nChannels;
+}
+
+// Decides which spatial sounds are rendered by the next render call. The sounds that
+// aren't playing or are out of range are never rendered; above the maximum number of
+// voices, the quietest sounds are virtualized. Called from the audio thread.
+void QAudioEnginePrivate::selectVoices(RenderList &list)
 {
-    device = QMediaDevices::defaultAudioOutput();
+    // about -60 dB
+    constexpr float InaudibleGain = 0.001f;
+
+    pendingListenerPosition.load(renderListenerPosition);
+
+    auto &voices = list.voices;
+    voices.clear();
+    for (auto *source : std::as_const(list.sources)) {
+        auto *sp = QSpatialSoundPrivate::get(source);
+        if (!sp)
+            continue;
+        if (sp->pendingGainParameters.load(sp->renderGainParameters))
+            resonanceAudio->api->SetSourceVolume(
+                    sp->sourceId, sp->renderGainParameters.volume * sp->wallDampening);
+        const float gain = sp->m_playing ? sp->estimatedGain(renderListenerPosition) : 0.f;
+        sp->voiceSelected = gain > InaudibleGain;
+        if (sp->voiceSelected)
+            voices.emplace_back(gain, sp);
+    }
+
+    const auto maxVoices = size_t(maximumVoices.loadRelaxed());
+    if (maxVoices > 0 && voices.size() > maxVoices) {
+        std::nth_element(voices.begin(), voices.begin() + maxVoices, voices.end(),
+                         [](const auto &a, const auto &b) { return a.first > b.first; });
+        for (auto it = voices.begin() + maxVoices; it != voices.end(); ++it)
+            it->second->voiceSelected = false;
+        voices.resize(maxVoices);
+    }
+
+    activeVoices.storeRelaxed(int(voices.size()));
 }
 
-QAudioEnginePrivate::~QAudioEnginePrivate()
+// (Re)creates Resonance Audio with the current block size. The sounds, rooms and
+// the listener are passed to the new instance.
+void QAudioEnginePrivate::createResonanceAudio()
 {
+    Q_ASSERT(!outputStream);
+
     delete resonanceAudio;
+    resonanceAudio = new vraudio::ResonanceAudio(2, blockSize, sampleRate);
+    resonanceAudio->roomEffectsEnabled = roomEffectsEnabled;
+
+    // stereo sources need two channels
+    const size_t scratchSize = 2 * blockSize;
+    scratch.reset(static_cast<float *>(::operator new[](scratchSize * sizeof(float), scratchAlignment)));
+
+    for (auto *sound : std::as_const(sources)) {
+        auto *sd = QSpatialSoundPrivate::get(sound);
+        sd->sourceId = resonanceAudio->api->CreateSoundObjectSource(vraudio::kBinauralHighQuality);
+        sd->applyParameters();
+        sd->updatePose();
+    }
+    for (auto *sound : std::as_const(stereoSources)) {
+        auto *sd = QAmbientSoundPrivate::get(sound);
+        sd->sourceId = resonanceAudio->api->CreateStereoSource(2);
+        resonanceAudio->api->SetSourceVolume(sd->sourceId, sd->volume);
+    }
+
+    // the rooms and the listener position are applied by the next render call
+    for (auto *room : std::as_const(rooms))
+        QAudioRoomPrivate::get(room)->dirty = true;
+    currentRoom = nullptr;
+    listenerPositionDirty = true;
+    if (listener) {
+        const QVector3D pos = listener->position() * distanceScale;
+        const QQuaternion rotation = listener->rotation();
+        resonanceAudio->api->SetHeadPosition(pos.x(), pos.y(), pos.z());
+        resonanceAudio->api->SetHeadRotation(rotation.x(), rotation.y(), rotation.z(),
+                                             rotation.scalar());
+    }
+}
+
+// Called from the thread of the engine with the mutex locked
+void QAudioEnginePrivate::publishRenderList()
+{
+    auto *list = new RenderList{ sources, stereoSources, rooms, {} };
+    list->voices.reserve(sources.size());
+    RenderList *retired = renderList.exchange(list);
+    // a render that started before the exchange may still use the retired list
+    retiredRenderLists.append({ retired, renderEpoch.load() });
+    freeRenderLists();
+}
+
+// Waits until the audio thread doesn't use the objects removed from the render list.
+// Never takes longer than one render call.
+void QAudioEnginePrivate::waitForRender()
+{
+    const quint64 epoch = renderEpoch.load();
+    if (epoch & 1) {
+        while (renderEpoch.load() == epoch)
+            QThread::yieldCurrentThread();
+    }
+    freeRenderLists();
+}
+
+void QAudioEnginePrivate::freeRenderLists()
+{
+    const quint64 epoch = renderEpoch.load();
+    retiredRenderLists.removeIf([epoch](const std::pair<RenderList *, quint64> &retired) {
+        if ((retired.second & 1) && retired.second == epoch)
+            return false;
+        delete retired.first;
+        return true;
+    });
 }
 
 void QAudioEnginePrivate::addSpatialSound(QSpatialSound *sound)
@@ -180,16 +322,21 @@ void QAudioEnginePrivate::addSpatialSound(QSpatialSound *sound)
 
     sd->sourceId = resonanceAudio->api->CreateSoundObjectSource(vraudio::kBinauralHighQuality);
     sources.append(sound);
+    publishRenderList();
 }
 
 void QAudioEnginePrivate::removeSpatialSound(QSpatialSound *sound)
 {
-    QMutexLocker l(&mutex);
     QAmbientSoundPrivate *sd = QAmbientSoundPrivate::get(sound);
+    releaseAsset(sd);
+
+    QMutexLocker l(&mutex);
+    sources.removeOne(sound);
+    publishRenderList();
+    waitForRender();
 
     resonanceAudio->api->DestroySource(sd->sourceId);
     sd->sourceId = vraudio::ResonanceAudioApi::kInvalidSourceId;
-    sources.removeOne(sound);
 }
 
 void QAudioEnginePrivate::addStereoSound(QAmbientSound *sound)
@@ -199,41 +346,168 @@ void QAudioEnginePrivate::addStereoSound(QAmbientSound *sound)
 
     sd->sourceId = resonanceAudio->api->CreateStereoSource(2);
     stereoSources.append(sound);
+    publishRenderList();
 }
 
 void QAudioEnginePrivate::removeStereoSound(QAmbientSound *sound)
 {
-    QMutexLocker l(&mutex);
     QAmbientSoundPrivate *sd = QAmbientSoundPrivate::get(sound);
+    releaseAsset(sd);
+
+    QMutexLocker l(&mutex);
+    stereoSources.removeOne(sound);
+    publishRenderList();
+    waitForRender();
 
     resonanceAudio->api->DestroySource(sd->sourceId);
     sd->sourceId = vraudio::ResonanceAudioApi::kInvalidSourceId;
-    stereoSources.removeOne(sound);
+}
+
+QAudioEnginePrivate::AssetState QAudioEnginePrivate::acquireAsset(QAmbientSoundPrivate *sound)
+{
+    Q_ASSERT(sound->assetUrl.isEmpty());
+    if (sound->url.isEmpty())
+        return AssetState::Load;
+
+    Asset &asset = assets[{ sound->url, sampleRate, int(sound->nchannels) }];
+    asset.users.append(sound);
+    sound->assetUrl = sound->url;
+
+    if (asset.loaded) {
+        sound->setAssetBuffers(asset.buffers);
+        return AssetState::Loaded;
+    }
+    if (asset.loader)
+        return AssetState::Waiting;
+
+    asset.loader = sound;
+    return AssetState::Load;
+}
+
+void QAudioEnginePrivate::storeAsset(QAmbientSoundPrivate *sound)
+{
+    auto it = assets.find({ sound->assetUrl, sampleRate, int(sound->nchannels) });
+    if (sound->assetUrl.isEmpty() || it == assets.end() || it->loader != sound)
+        return;
+
+    {
+        QMutexLocker l(&sound->mutex);
+        it->buffers = sound->buffers;
+    }
+    for (const auto &buffer : std::as_const(it->buffers))
+        it->bytes += buffer.byteCount();
+    it->loaded = true;
+    it->loader = nullptr;
+    assetCacheSize += it->bytes;
+
+    for (auto *user : std::as_const(it->users)) {
+        if (user != sound)
+            user->setAssetBuffers(it->buffers);
+    }
+
+    evictAssets();
+}
+
+void QAudioEnginePrivate::discardAsset(QAmbientSoundPrivate *sound)
+{
+    if (sound->assetUrl.isEmpty())
+        return;
+
+    const auto asset = assets.take({ sound->assetUrl, sampleRate, int(sound->nchannels) });
+    if (asset.loaded)
+        assetCacheSize -= asset.bytes;
+
+    // The users decode the source on their own, as before the sharing
+    for (auto *user : asset.users)
+        user->assetUrl.clear();
+    for (auto *user : asset.users) {
+        if (user != sound && !asset.loaded)
+            user->decode();
+    }
+}
+
+void QAudioEnginePrivate::releaseAsset(QAmbientSoundPrivate *sound)
+{
+    if (sound->assetUrl.isEmpty())
+        return;
+
+    const AssetKey key{ sound->assetUrl, sampleRate, int(sound->nchannels) };
+    sound->assetUrl.clear();
+
+    auto it = assets.find(key);
+    if (it == assets.end())
+        return;
+
+    it->users.removeOne(sound);
+
+    if (it->loader == sound) {
+        it->loader = nullptr;
+        if (it->users.isEmpty()) {
+            assets.erase(it);
+            return;
+        }
+
+        // hand the loading over to the next user
+        it->loader = it->users.first();
+        it->loader->decode();
+        return;
+    }
+
+    if (it->users.isEmpty()) {
+        it->lastUsed = ++assetUseCounter;
+        evictAssets();
+    }
+}
+
+void QAudioEnginePrivate::evictAssets()
+{
+    // the assets in use are never evicted, they don't take extra memory
+    qint64 unusedSize = 0;
+    for (const auto &asset : std::as_const(assets)) {
+        if (asset.loaded && asset.users.isEmpty())
+            unusedSize += asset.bytes;
+    }
+
+    while (unusedSize > assetCacheCapacity) {
+        auto lru = assets.end();
+        for (auto it = assets.begin(); it != assets.end(); ++it) {
+            if (it->loaded && it->users.isEmpty()
+                && (lru == assets.end() || it->lastUsed < lru->lastUsed))
+                lru = it;
+        }
+        Q_ASSERT(lru != assets.end());
+
+        unusedSize -= lru->bytes;
+        assetCacheSize -= lru->bytes;
+        assets.erase(lru);
+    }
 }
 
 void QAudioEnginePrivate::addRoom(QAudioRoom *room)
 {
     QMutexLocker l(&mutex);
     rooms.append(room);
+    publishRenderList();
 }
 
 void QAudioEnginePrivate::removeRoom(QAudioRoom *room)
 {
     QMutexLocker l(&mutex);
     rooms.removeOne(room);
+    publishRenderList();
+    waitForRender();
 }
 
 // This method is called from the audio thread
-void QAudioEnginePrivate::updateRooms()
+void QAudioEnginePrivate::updateRooms(const RenderList &list)
 {
     if (!roomEffectsEnabled)
         return;
 
-    bool needUpdate = listenerPositionDirty;
-    listenerPositionDirty = false;
+    bool needUpdate = listenerPositionDirty.fetchAndStoreRelaxed(false);
 
     bool roomDirty = false;
-    for (const auto &room : rooms) {
+    for (const auto &room : list.rooms) {
         auto *rd = QAudioRoomPrivate::get(room);
         if (rd->dirty) {
             roomDirty = true;
@@ -249,7 +523,7 @@ void QAudioEnginePrivate::updateRooms()
     float roomVolume = float(qInf());
     QAudioRoom *room = nullptr;
     // Find the smallest room that contains the listener and apply its room effects
-    for (auto *r : std::as_const(rooms)) {
+    for (auto *r : list.rooms) {
         QVector3D dim2 = r->dimensions()/2.;
         float vol = dim2.x()*dim2.y()*dim2.z();
         if (vol > roomVolume)
@@ -285,7 +559,7 @@ void QAudioEnginePrivate::updateRooms()
     resonanceAudio->api->SetReverbProperties(rp->reverb);
 
     // update room effects for all sound sources
-    for (auto *s : std::as_const(sources)) {
+    for (auto *s : list.sources) {
         auto *sp = QSpatialSoundPrivate::get(s);
         if (!sp)
             continue;
@@ -364,7 +638,7 @@ QAudioEngine::QAudioEngine(int sampleRate, QObject *parent)
     , d(new QAudioEnginePrivate)
 {
     d->sampleRate = sampleRate;
-    d->resonanceAudio = new vraudio::ResonanceAudio(2, QAudioEnginePrivate::bufferSize, d->sampleRate);
+    d->createResonanceAudio();
 }
 
 /*!
@@ -564,6 +838,70 @@ float QAudioEngine::distanceScale() const
     return d->distanceScale*100.f;
 }
 
+/*!
+    \property QAudioEngine::blockSize
+    \since 6.8
+
+    Defines the number of frames the engine processes at once. The default value is 128.
+
+    Smaller blocks make changes to the sound field, such as moving sounds, audible
+    sooner, and are needed for low latency output. Larger blocks reduce the processing
+    overhead, and thus the CPU usage, when latency doesn't matter.
+
+    The value is rounded up to a power of two between 32 and 4096. The block size can
+    only be changed while the engine is stopped.
+*/
+void QAudioEngine::setBlockSize(int frames)
+{
+    // bound first, the rounding up wraps around for huge values
+    frames = qBound(QAudioEnginePrivate::minimumBlockSize, frames,
+                    QAudioEnginePrivate::maximumBlockSize);
+    frames = int(qNextPowerOfTwo(quint32(frames - 1)));
+    if (d->blockSize == frames)
+        return;
+    if (d->outputStream) {
+        qWarning() << "Changing the block size on a running engine not implemented";
+        return;
+    }
+    d->blockSize = frames;
+    d->createResonanceAudio();
+    emit blockSizeChanged();
+}
+
+int QAudioEngine::blockSize() const
+{
+    return d->blockSize;
+}
+
+/*!
+    \property QAudioEngine::maximumVoices
+    \since 6.8
+
+    Defines the maximum number of spatial sounds that are rendered at the same time.
+    The default value is 0, which means that there is no limit.
+
+    When more sounds are audible, only the loudest ones, as heard at the position of
+    the listener, are rendered. The other sounds are virtualized: their playback
+    position keeps advancing, but they are not spatialized until they become loud
+    enough to be rendered again.
+
+    Regardless of this property, the sounds that are not playing or that are out of
+    the range of the listener (see QSpatialSound::distanceCutoff) are not rendered.
+*/
+void QAudioEngine::setMaximumVoices(int voices)
+{
+    voices = qMax(voices, 0);
+    if (d->maximumVoices.loadRelaxed() == voices)
+        return;
+    d->maximumVoices.storeRelaxed(voices);
+    emit maximumVoicesChanged();
+}
+
+int QAudioEngine::maximumVoices() const
+{
+    return d->maximumVoices.loadRelaxed();
+}
+
 /*!
     \fn void QAudioEngine::pause()
 
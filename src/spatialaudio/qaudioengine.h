@@ -20,6 +20,8 @@ class Q_SPATIALAUDIO_EXPORT QAudioEngine : public QObject
     Q_PROPERTY(float masterVolume READ masterVolume WRITE setMasterVolume NOTIFY masterVolumeChanged)
     Q_PROPERTY(bool paused READ paused WRITE setPaused NOTIFY pausedChanged)
     Q_PROPERTY(float distanceScale READ distanceScale WRITE setDistanceScale NOTIFY distanceScaleChanged)
+    Q_PROPERTY(int blockSize READ blockSize WRITE setBlockSize NOTIFY blockSizeChanged)
+    Q_PROPERTY(int maximumVoices READ maximumVoices WRITE setMaximumVoices NOTIFY maximumVoicesChanged)
 public:
     QAudioEngine() : QAudioEngine(nullptr) {};
     explicit QAudioEngine(QObject *parent) : QAudioEngine(44100, parent) {}
@@ -56,12 +58,20 @@ public:
     void setDistanceScale(float scale);
     float distanceScale() const;
 
+    void setBlockSize(int frames);
+    int blockSize() const;
+
+    void setMaximumVoices(int voices);
+    int maximumVoices() const;
+
 Q_SIGNALS:
     void outputModeChanged();
     void outputDeviceChanged();
     void masterVolumeChanged();
     void pausedChanged();
     void distanceScaleChanged();
+    void blockSizeChanged();
+    void maximumVoicesChanged();
 
 public Q_SLOTS:
     void start();
@@ -15,7 +15,7 @@
 // We mean it.
 //
 
-#include <qtspatialaudioglobal_p.h>
+#include <QtSpatialAudio/private/qtspatialaudioglobal_p.h>
 #include <qaudioengine.h>
 #include <qaudiodevice.h>
 #include <qaudiodecoder.h>
@@ -25,6 +25,12 @@
 #include <qaudiobuffer.h>
 #include <qvector3d.h>
 #include <qfile.h>
+#include <qhash.h>
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <vector>
 
 namespace vraudio {
 class ResonanceAudio;
@@ -40,18 +46,67 @@ class QAmbisonicDecoder;
 class QAudioDecoder;
 class QAudioRoom;
 class QAudioListener;
+class QAmbientSoundPrivate;
+class QSpatialSoundPrivate;
+
+// Passes the latest value of a parameter from one thread to another without
+// blocking either of them (triple buffering). There must be one writer thread
+// and one reader thread.
+template <typename T>
+class QAudioParameterSnapshot
+{
+public:
+    void store(const T &value)
+    {
+        m_slots[m_back] = value;
+        m_back = m_middle.exchange(m_back | Dirty) & IndexMask;
+    }
+
+    // Returns false if no value has been stored since the last call
+    bool load(T &value)
+    {
+        if (!(m_middle.load(std::memory_order_relaxed) & Dirty))
+            return false;
+        m_front = m_middle.exchange(m_front) & IndexMask;
+        value = m_slots[m_front];
+        return true;
+    }
+
+private:
+    static constexpr int Dirty = 4;
+    static constexpr int IndexMask = 3;
+
+    T m_slots[3] = {};
+    int m_back = 0; // writer only
+    std::atomic<int> m_middle = 1;
+    int m_front = 2; // reader only
+};
 
-class QAudioEnginePrivate
+class Q_SPATIALAUDIO_EXPORT QAudioEnginePrivate
 {
 public:
     static QAudioEnginePrivate *get(QAudioEngine *engine) { return engine ? engine->d : nullptr; }
 
-    static constexpr int bufferSize = 128;
+    static constexpr int defaultBlockSize = 128;
+    static constexpr int minimumBlockSize = 32;
+    static constexpr int maximumBlockSize = 4096;
+    static constexpr std::align_val_t scratchAlignment{ 64 };
 
     QAudioEnginePrivate();
     ~QAudioEnginePrivate();
     vraudio::ResonanceAudio *resonanceAudio = nullptr;
     int sampleRate = 44100;
+    // The number of frames processed at once. Only changed while the audio thread isn't running.
+    int blockSize = defaultBlockSize;
+
+    // Scratch memory for the blocks of the sources, aligned for SIMD; audio thread only
+    struct AlignedDelete
+    {
+        void operator()(float *p) const { ::operator delete[](p, scratchAlignment); }
+    };
+    std::unique_ptr<float[], AlignedDelete> scratch;
+
+    void createResonanceAudio();
     float masterVolume = 1.;
     QAudioEngine::OutputMode outputMode = QAudioEngine::Surround;
     bool roomEffectsEnabled = true;
@@ -61,6 +116,7 @@ public:
     // and convert in the setters and getters.
     float distanceScale = 0.01f;
 
+    // Serializes the changes of the sounds and rooms; the audio thread doesn't lock it
     QMutex mutex;
     QAudioDevice device;
     QAtomicInteger<bool> paused = false;
@@ -72,17 +128,97 @@ public:
     QList<QSpatialSound *> sources;
     QList<QAmbientSound *> stereoSources;
     QList<QAudioRoom *> rooms;
-    mutable bool listenerPositionDirty = true;
+    QAtomicInteger<bool> listenerPositionDirty = true;
     QAudioRoom *currentRoom = nullptr;
 
+    QAudioParameterSnapshot<QVector3D> pendingListenerPosition;
+    QVector3D renderListenerPosition; // audio thread only
+
+    // 0 means no limit
+    QAtomicInt maximumVoices = 0;
+    // the number of spatial sounds rendered by the last render call
+    QAtomicInt activeVoices = 0;
+
+    // The sounds and rooms seen by the audio thread. The thread of the engine publishes
+    // a new list on each change, and the audio thread picks it up when it starts
+    // rendering, so that the rendering never waits for the thread of the engine.
+    struct RenderList
+    {
+        QList<QSpatialSound *> sources;
+        QList<QAmbientSound *> stereoSources;
+        QList<QAudioRoom *> rooms;
+
+        // reserved for the audio thread, which ranks the voices in it
+        std::vector<std::pair<float, QSpatialSoundPrivate *>> voices;
+    };
+
+    std::atomic<RenderList *> renderList;
+    // odd while the audio thread is rendering
+    std::atomic<quint64> renderEpoch = 0;
+    // the lists replaced while the audio thread might have used them, with the epoch
+    QList<std::pair<RenderList *, quint64>> retiredRenderLists;
+
+    void publishRenderList();
+    void waitForRender();
+    void freeRenderLists();
+
+    void selectVoices(RenderList &list);
+
+    // Renders whole blocks of frames to the interleaved output, returns the number of frames
+    // rendered. Called from the audio thread.
+    qint64 render(short *output, qint64 frames, QAmbisonicDecoder *ambisonicDecoder);
+
     void addSpatialSound(QSpatialSound *sound);
     void removeSpatialSound(QSpatialSound *sound);
     void addStereoSound(QAmbientSound *sound);
     void removeStereoSound(QAmbientSound *sound);
 
+    // Decoded sources shared between the sounds of the engine. Only accessed
+    // from the thread of the engine; streamed sources are not shared.
+    struct AssetKey
+    {
+        QUrl url;
+        int sampleRate = 0;
+        int channelCount = 0;
+
+        friend bool operator==(const AssetKey &a, const AssetKey &b) noexcept
+        {
+            return a.url == b.url && a.sampleRate == b.sampleRate
+                    && a.channelCount == b.channelCount;
+        }
+        friend size_t qHash(const AssetKey &key, size_t seed = 0) noexcept
+        {
+            return qHashMulti(seed, key.url, key.sampleRate, key.channelCount);
+        }
+    };
+
+    struct Asset
+    {
+        QList<QAudioBuffer> buffers;
+        qint64 bytes = 0;
+        bool loaded = false;
+        QAmbientSoundPrivate *loader = nullptr;
+        QList<QAmbientSoundPrivate *> users;
+        quint64 lastUsed = 0;
+    };
+
+    enum class AssetState { Loaded, Waiting, Load };
+
+    QHash<AssetKey, Asset> assets;
+    qint64 assetCacheSize = 0;
+    // the size of the unreferenced assets kept in the cache, QT_SPATIALAUDIO_ASSET_CACHE_SIZE in MB
+    qint64 assetCacheCapacity = 64 * 1024 * 1024;
+    quint64 assetUseCounter = 0;
+
+    AssetState acquireAsset(QAmbientSoundPrivate *sound);
+    void storeAsset(QAmbientSoundPrivate *sound);
+    void discardAsset(QAmbientSoundPrivate *sound);
+    void releaseAsset(QAmbientSoundPrivate *sound);
+    void evictAssets();
+
     void addRoom(QAudioRoom *room);
     void removeRoom(QAudioRoom *room);
-    void updateRooms();
+    void updateRooms(const RenderList &list);
 
     QVector3D listenerPosition() const;
 };
@@ -66,6 +66,7 @@ void QAudioListener::setPosition(QVector3D pos)
         return;
 
     d->pos = pos;
+    ep->pendingListenerPosition.store(pos);
     if (ep && ep->resonanceAudio->api) {
         ep->resonanceAudio->api->SetHeadPosition(pos.x(), pos.y(), pos.z());
         ep->listenerPositionDirty = true;
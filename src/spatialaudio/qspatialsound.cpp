@@ -10,6 +10,8 @@
 #include <qdebug.h>
 #include <qaudiodecoder.h>
 
+#include <algorithm>
+
 QT_BEGIN_NAMESPACE
 
 /*!
@@ -59,8 +61,7 @@ void QSpatialSound::setPosition(QVector3D pos)
     auto *ep = QAudioEnginePrivate::get(d->engine);
     pos *= ep->distanceScale;
     d->pos = pos;
-    if (ep)
-        ep->resonanceAudio->api->SetSourcePosition(d->sourceId, pos.x(), pos.y(), pos.z());
+    d->updatePose();
     emit positionChanged();
 }
 
@@ -78,9 +79,7 @@ QVector3D QSpatialSound::position() const
 void QSpatialSound::setRotation(const QQuaternion &q)
 {
     d->rotation = q;
-    auto *ep = QAudioEnginePrivate::get(d->engine);
-    if (ep)
-        ep->resonanceAudio->api->SetSourceRotation(d->sourceId, q.x(), q.y(), q.z(), q.scalar());
+    d->updatePose();
     emit rotationChanged();
 }
 
@@ -102,9 +101,8 @@ void QSpatialSound::setVolume(float volume)
     if (d->volume == volume)
         return;
     d->volume = volume;
-    auto *ep = QAudioEnginePrivate::get(d->engine);
-    if (ep)
-        ep->resonanceAudio->api->SetSourceVolume(d->sourceId, d->volume*d->wallDampening);
+    // the audio thread applies the volume along with the wall dampening
+    d->updateGainParameters();
     emit volumeChanged();
 }
 
@@ -140,6 +138,7 @@ void QSpatialSound::setDistanceModel(DistanceModel model)
     d->distanceModel = model;
 
     d->updateDistanceModel();
+    d->updateGainParameters();
     emit distanceModelChanged();
 }
 
@@ -164,6 +163,80 @@ void QSpatialSoundPrivate::updateDistanceModel()
     ep->resonanceAudio->api->SetSourceDistanceModel(sourceId, dm, size, distanceCutoff);
 }
 
+// Passes the parameters of the sound to a newly created source
+void QSpatialSoundPrivate::applyParameters()
+{
+    auto *ep = QAudioEnginePrivate::get(engine);
+    ep->resonanceAudio->api->SetSourceVolume(sourceId, volume);
+    ep->resonanceAudio->api->SetSoundObjectDirectivity(sourceId, directivity, directivityOrder);
+    ep->resonanceAudio->api->SetSoundObjectNearFieldEffectGain(sourceId, nearFieldGain);
+    updateDistanceModel();
+}
+
+// Estimates the gain of the direct sound at the position of the listener, following
+// the distance models of Resonance Audio. Called from the audio thread.
+float QSpatialSoundPrivate::estimatedGain(QVector3D listenerPosition) const
+{
+    const GainParameters &p = renderGainParameters;
+    const float gain = p.volume * wallDampening;
+    if (p.distanceModel == QSpatialSound::DistanceModel::ManualAttenuation)
+        return gain * p.manualAttenuation;
+
+    const float distance = (renderPose.position - listenerPosition).length();
+    if (distance > p.distanceCutoff)
+        return 0.f;
+
+    // Resonance Audio doesn't attenuate within its near field threshold (1m)
+    const float minDistance = qMax(p.size, 1.f);
+    const float interval = p.distanceCutoff - minDistance;
+    if (distance <= minDistance || interval <= 0.f)
+        return gain;
+
+    if (p.distanceModel == QSpatialSound::DistanceModel::Linear)
+        return gain * (p.distanceCutoff - distance) / interval;
+
+    const float attenuation = 1.f / (distance - minDistance + 1.f);
+    const float minAttenuation = 1.f / (interval + 1.f);
+    return gain * (attenuation - minAttenuation) / (1.f - minAttenuation);
+}
+
+// Applies the voice selection to the next block of the sound. Returns false if the block
+// doesn't need to be rendered. A sound fades in and out within a block when it's
+// selected or culled, so that the virtualized sounds come back without clicks.
+// Called from the audio thread.
+bool QSpatialSoundPrivate::renderVoice(float *buf, int frames)
+{
+    auto ramp = [&](float from, float to) {
+        const float step = (to - from) / frames;
+        for (int i = 0; i < frames; ++i)
+            buf[i] *= from + step * i;
+    };
+
+    if (voiceSelected) {
+        if (!voiceActive)
+            ramp(0.f, 1.f);
+        voiceActive = true;
+        voiceFlushPending = false;
+        return true;
+    }
+
+    if (voiceActive) {
+        ramp(1.f, 0.f);
+        voiceActive = false;
+        voiceFlushPending = true;
+        return true;
+    }
+
+    // one block of silence flushes the filter tails of the sound
+    if (voiceFlushPending) {
+        std::fill_n(buf, frames, 0.f);
+        voiceFlushPending = false;
+        return true;
+    }
+
+    return false;
+}
+
 void QSpatialSoundPrivate::updateRoomEffects()
 {
     if (!engine || sourceId < 0)
@@ -178,7 +251,7 @@ void QSpatialSoundPrivate::updateRoomEffects()
     QVector3D roomDim2 = ep->currentRoom->dimensions()/2.;
     QVector3D roomPos = ep->currentRoom->position();
     QQuaternion roomRot = ep->currentRoom->rotation();
-    QVector3D dist = pos - roomPos;
+    QVector3D dist = renderPose.position - roomPos;
     // transform into room coordinates
     dist = roomRot.rotatedVector(dist);
     if (qAbs(dist.x()) <= roomDim2.x() &&
@@ -203,7 +276,7 @@ void QSpatialSoundPrivate::updateRoomEffects()
         };
         // Very rough approximation, use the size of the source plus twice the size of our head.
         // One could probably improve upon this.
-        const float transitionDistance = size + 0.4;
+        const float transitionDistance = renderGainParameters.size + 0.4;
         QAudioRoom::Wall walls[3];
         walls[X] = direction.x() > 0 ? QAudioRoom::RightWall : QAudioRoom::LeftWall;
         walls[Y] = direction.y() > 0 ? QAudioRoom::FrontWall : QAudioRoom::BackWall;
@@ -267,7 +340,7 @@ void QSpatialSoundPrivate::updateRoomEffects()
         ep->resonanceAudio->api->SetSourceRoomEffectsGain(sourceId, 0);
     }
     ep->resonanceAudio->api->SetSoundObjectOcclusionIntensity(sourceId, occlusionIntensity + wallOcclusion);
-    ep->resonanceAudio->api->SetSourceVolume(sourceId, volume*wallDampening);
+    ep->resonanceAudio->api->SetSourceVolume(sourceId, renderGainParameters.volume*wallDampening);
 }
 
 QSpatialSound::DistanceModel QSpatialSound::distanceModel() const
@@ -291,6 +364,7 @@ void QSpatialSound::setSize(float size)
     d->size = size;
 
     d->updateDistanceModel();
+    d->updateGainParameters();
     emit sizeChanged();
 }
 
@@ -316,6 +390,7 @@ void QSpatialSound::setDistanceCutoff(float cutoff)
     d->distanceCutoff = cutoff;
 
     d->updateDistanceModel();
+    d->updateGainParameters();
     emit distanceCutoffChanged();
 }
 
@@ -339,6 +414,7 @@ void QSpatialSound::setManualAttenuation(float attenuation)
     auto *ep = QAudioEnginePrivate::get(d->engine);
     if (ep)
         ep->resonanceAudio->api->SetSourceDistanceAttenuation(d->sourceId, d->manualAttenuation);
+    d->updateGainParameters();
     emit manualAttenuationChanged();
 }
 
@@ -572,13 +648,9 @@ void QSpatialSound::setEngine(QAudioEngine *engine)
     // Add self to new engine if necessary
     ep = QAudioEnginePrivate::get(d->engine);
     if (ep) {
+        d->updatePose();
         ep->addSpatialSound(this);
-        ep->resonanceAudio->api->SetSourcePosition(d->sourceId, d->pos.x(), d->pos.y(), d->pos.z());
-        ep->resonanceAudio->api->SetSourceRotation(d->sourceId, d->rotation.x(), d->rotation.y(), d->rotation.z(), d->rotation.scalar());
-        ep->resonanceAudio->api->SetSourceVolume(d->sourceId, d->volume);
-        ep->resonanceAudio->api->SetSoundObjectDirectivity(d->sourceId, d->directivity, d->directivityOrder);
-        ep->resonanceAudio->api->SetSoundObjectNearFieldEffectGain(d->sourceId, d->nearFieldGain);
-        d->updateDistanceModel();
+        d->applyParameters();
     }
 }
 
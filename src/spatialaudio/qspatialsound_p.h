@@ -30,7 +30,7 @@ QT_BEGIN_NAMESPACE
 class QAudioDecoder;
 class QAudioEnginePrivate;
 
-class QSpatialSoundPrivate : public QAmbientSoundPrivate
+class Q_AUTOTEST_EXPORT QSpatialSoundPrivate : public QAmbientSoundPrivate
 {
 public:
     QSpatialSoundPrivate(QObject *parent)
@@ -50,9 +50,47 @@ public:
     float directivity = 0.f;
     float directivityOrder = 1.f;
     float nearFieldGain = 0.f;
-    float wallDampening = 1.f;
-    float wallOcclusion = 0.f;
+    float wallDampening = 1.f; // audio thread only
+    float wallOcclusion = 0.f; // audio thread only
 
+    // The position and rotation are passed to the audio thread as one snapshot,
+    // which the audio thread applies at the start of a block.
+    struct Pose
+    {
+        QVector3D position;
+        QQuaternion rotation;
+    };
+    QAudioParameterSnapshot<Pose> pendingPose;
+    Pose renderPose; // audio thread only
+
+    void updatePose() { pendingPose.store({ pos, rotation }); }
+
+    // The parameters the audio thread estimates the gain of the sound from
+    struct GainParameters
+    {
+        float volume = 1.f;
+        QSpatialSound::DistanceModel distanceModel = QSpatialSound::DistanceModel::Logarithmic;
+        float size = .1f;
+        float distanceCutoff = 50.f;
+        float manualAttenuation = 0.f;
+    };
+    QAudioParameterSnapshot<GainParameters> pendingGainParameters;
+    GainParameters renderGainParameters; // audio thread only
+
+    void updateGainParameters()
+    {
+        pendingGainParameters.store({ volume, distanceModel, size, distanceCutoff, manualAttenuation });
+    }
+
+    // Voice state, audio thread only
+    bool voiceSelected = true;
+    bool voiceActive = false;
+    bool voiceFlushPending = false;
+
+    float estimatedGain(QVector3D listenerPosition) const;
+    bool renderVoice(float *buf, int frames);
+
+    void applyParameters();
     void updateDistanceModel();
     void updateRoomEffects();
 };
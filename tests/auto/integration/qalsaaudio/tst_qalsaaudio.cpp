@@ -0,0 +1,155 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+//TESTED_COMPONENT=src/multimedia
+
+#include <QtTest/QtTest>
+#include <QtMultimedia/qaudioformat.h>
+
+#include <private/qalsaaudiosink_p.h>
+#include <private/qalsaaudiosource_p.h>
+
+#include <atomic>
+
+// Runs the ALSA backend on the devices of alsa-lib's plugins, so that it doesn't depend
+// on the sound hardware. The "null" device doesn't consume the samples in real time,
+// so the timing is only reported; the tests check the transfer itself.
+class tst_QAlsaAudio : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void callbackRendering_data();
+    void callbackRendering();
+
+    void pushCapture_data();
+    void pushCapture();
+
+private:
+    void generateTransferRows();
+};
+
+namespace {
+
+QAudioFormat testFormat()
+{
+    QAudioFormat format;
+    format.setSampleRate(48000);
+    format.setChannelCount(2);
+    format.setSampleFormat(QAudioFormat::Int16);
+    return format;
+}
+
+} // namespace
+
+void tst_QAlsaAudio::generateTransferRows()
+{
+    QTest::addColumn<QByteArray>("device");
+    QTest::addColumn<bool>("mmap");
+
+    for (const char *device : { "null", "dmix" }) {
+        QTest::addRow("%s, rw", device) << QByteArray(device) << false;
+        QTest::addRow("%s, mmap", device) << QByteArray(device) << true;
+    }
+}
+
+void tst_QAlsaAudio::callbackRendering_data()
+{
+    generateTransferRows();
+}
+
+void tst_QAlsaAudio::callbackRendering()
+{
+    QFETCH(QByteArray, device);
+    QFETCH(bool, mmap);
+
+    qputenv("QT_ALSA_MMAP", mmap ? "1" : "0");
+    auto resetEnv = qScopeGuard([] { qunsetenv("QT_ALSA_MMAP"); });
+
+    const QAudioFormat format = testFormat();
+    std::atomic<qint64> renderedBytes = 0;
+    std::atomic<bool> partialFrames = false;
+
+    QAlsaAudioSink sink(device, nullptr);
+    sink.setFormat(format);
+    sink.setVolume(0.5);
+    QVERIFY(sink.start([&](QSpan<char> buffer) {
+        std::fill(buffer.begin(), buffer.end(), char(0x10));
+        if (buffer.size() % format.bytesPerFrame() != 0)
+            partialFrames = true;
+        renderedBytes += buffer.size();
+    }));
+
+    if (sink.state() == QAudio::StoppedState)
+        QSKIP("The device cannot be opened");
+
+    QCOMPARE(sink.state(), QAudio::ActiveState);
+    QCOMPARE(sink.error(), QAudio::NoError);
+
+    QTRY_VERIFY(sink.processedUSecs() > 0);
+    const qint64 processedBefore = sink.processedUSecs();
+    QTRY_VERIFY(sink.processedUSecs() > processedBefore);
+
+    QVERIFY(renderedBytes > 0);
+    QVERIFY(!partialFrames);
+    QCOMPARE(sink.xrunCount(), 0);
+
+    // a period of 5 ms and a few periods of buffering, unless the device enforces more
+    const qint64 latency = format.durationForBytes(sink.bufferSize());
+    qInfo() << "device:" << device << "mmap:" << mmap << "latency:" << latency / 1000. << "ms";
+    if (device == "null")
+        QCOMPARE_LE(latency, 40000);
+
+    sink.stop();
+    QCOMPARE(sink.state(), QAudio::StoppedState);
+
+    const qint64 renderedAfterStop = renderedBytes;
+    QTest::qWait(50);
+    QCOMPARE(renderedBytes.load(), renderedAfterStop);
+}
+
+void tst_QAlsaAudio::pushCapture_data()
+{
+    QTest::addColumn<QByteArray>("device");
+    QTest::addColumn<bool>("mmap");
+
+    QTest::addRow("null, rw") << QByteArray("null") << false;
+    QTest::addRow("null, mmap") << QByteArray("null") << true;
+}
+
+void tst_QAlsaAudio::pushCapture()
+{
+    QFETCH(QByteArray, device);
+    QFETCH(bool, mmap);
+
+    qputenv("QT_ALSA_MMAP", mmap ? "1" : "0");
+    auto resetEnv = qScopeGuard([] { qunsetenv("QT_ALSA_MMAP"); });
+
+    const QAudioFormat format = testFormat();
+
+    QAlsaAudioSource source(device, nullptr);
+    source.setFormat(format);
+    source.setVolume(0.5);
+    QIODevice *io = source.start();
+
+    if (source.state() == QAudio::StoppedState)
+        QSKIP("The device cannot be opened");
+    QVERIFY(io);
+
+    qint64 capturedBytes = 0;
+    QTRY_VERIFY([&] {
+        capturedBytes += io->readAll().size();
+        return capturedBytes >= format.bytesForDuration(100000);
+    }());
+
+    QCOMPARE(capturedBytes % format.bytesPerFrame(), 0);
+    QVERIFY(source.processedUSecs() > 0);
+    qInfo() << "device:" << device << "mmap:" << mmap << "overruns:" << source.xrunCount();
+
+    source.stop();
+    QCOMPARE(source.state(), QAudio::StoppedState);
+}
+
+QTEST_MAIN(tst_QAlsaAudio)
+
+#include "tst_qalsaaudio.moc"
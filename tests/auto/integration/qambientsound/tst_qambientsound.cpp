@@ -0,0 +1,143 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtCore/qtemporaryfile.h>
+#include <QtMultimedia/qaudiodecoder.h>
+#include <QtSpatialAudio/qaudioengine.h>
+#include <QtSpatialAudio/qambientsound.h>
+#include <private/qambientsound_p.h>
+#include <qwavedecoder.h>
+
+QT_USE_NAMESPACE
+
+namespace {
+
+constexpr int SampleRate = 8000;
+constexpr int DurationSeconds = 12; // long enough to be streamed
+constexpr int BlockFrames = 512;
+constexpr qint16 Amplitude = 16384; // 0.5 as float
+
+// Writes a mono tone of constant amplitude, so that the rendered frames can be
+// told from the silence of underruns.
+bool writeConstantTone(QIODevice *device)
+{
+    QAudioFormat format;
+    format.setSampleRate(SampleRate);
+    format.setChannelCount(1);
+    format.setSampleFormat(QAudioFormat::Int16);
+
+    QWaveDecoder writer(device, format);
+    if (!writer.open(QIODevice::WriteOnly))
+        return false;
+
+    const QList<qint16> second(SampleRate, Amplitude);
+    const qint64 secondBytes = second.size() * sizeof(qint16);
+    for (int i = 0; i < DurationSeconds; ++i) {
+        if (writer.write(reinterpret_cast<const char *>(second.constData()), secondBytes)
+            != secondBytes)
+            return false;
+    }
+
+    writer.close();
+    return true;
+}
+
+bool isStreaming(QAmbientSoundPrivate *d)
+{
+    QMutexLocker locker(&d->mutex);
+    return d->streaming;
+}
+
+bool canRenderBlock(QAmbientSoundPrivate *d)
+{
+    QMutexLocker locker(&d->mutex);
+    return d->queuedFrames >= BlockFrames || !d->m_loading;
+}
+
+} // namespace
+
+class tst_QAmbientSound : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void getBuffer_streamsLongSource_withBoundedQueue();
+    void getBuffer_reportsUnderruns_outsideOfRendering();
+
+private:
+    QTemporaryFile m_longSource{ QDir::tempPath() + QStringLiteral("/XXXXXX.wav") };
+};
+
+void tst_QAmbientSound::initTestCase()
+{
+    if (!QAudioDecoder().isSupported())
+        QSKIP("Audio decoding is not supported on this platform");
+
+    QVERIFY(m_longSource.open());
+    QVERIFY(writeConstantTone(&m_longSource));
+    m_longSource.close();
+}
+
+void tst_QAmbientSound::getBuffer_streamsLongSource_withBoundedQueue()
+{
+    // the engine isn't started, the test renders the sound itself
+    QAudioEngine engine(SampleRate);
+    QAmbientSound sound(&engine);
+    sound.setSource(QUrl::fromLocalFile(m_longSource.fileName()));
+
+    auto *d = QAmbientSoundPrivate::get(&sound);
+    QTRY_VERIFY(isStreaming(d));
+
+    std::vector<float> block(2 * BlockFrames);
+    qint64 audibleFrames = 0;
+
+    while (d->m_playing) {
+        // let the decoder keep ahead of the rendering
+        QTRY_VERIFY(canRenderBlock(d));
+
+        {
+            QMutexLocker locker(&d->mutex);
+            QCOMPARE_LE(d->queuedFrames, d->streamingCapacity);
+        }
+
+        d->getBuffer(block.data(), BlockFrames, 2);
+
+        for (int i = 0; i < BlockFrames; ++i)
+            if (block[2 * i] > 0.25f && block[2 * i + 1] > 0.25f)
+                ++audibleFrames;
+    }
+
+    QCOMPARE_LE(qAbs(audibleFrames - qint64(SampleRate) * DurationSeconds), BlockFrames);
+    QCOMPARE(d->m_underrunFrames.loadRelaxed(), qint64(0));
+}
+
+void tst_QAmbientSound::getBuffer_reportsUnderruns_outsideOfRendering()
+{
+    QAudioEngine engine(SampleRate);
+    QAmbientSound sound(&engine);
+    sound.setSource(QUrl::fromLocalFile(m_longSource.fileName()));
+
+    auto *d = QAmbientSoundPrivate::get(&sound);
+    QTRY_VERIFY(isStreaming(d));
+
+    // without processing events, the queue isn't refilled
+    std::vector<float> block(2 * BlockFrames);
+    for (int i = 0; i < 4 * SampleRate / BlockFrames && d->m_underrunFrames.loadRelaxed() == 0;
+         ++i)
+        d->getBuffer(block.data(), BlockFrames, 2);
+
+    QCOMPARE_GT(d->m_underrunFrames.loadRelaxed(), 0);
+
+    QLoggingCategory::setFilterRules(QStringLiteral("qt.spatialaudio.ambientsound.debug=true"));
+    auto resetFilterRules = qScopeGuard([]() { QLoggingCategory::setFilterRules({}); });
+
+    QTest::ignoreMessage(QtDebugMsg, QRegularExpression(QStringLiteral("^underrun \\d+ frames")));
+    QTRY_COMPARE(d->m_underrunFrames.loadRelaxed(), qint64(0));
+}
+
+QTEST_GUILESS_MAIN(tst_QAmbientSound)
+
+#include "tst_qambientsound.moc"
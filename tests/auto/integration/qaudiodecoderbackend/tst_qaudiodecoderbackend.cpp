@@ -4,9 +4,12 @@
 #include <QtTest/QtTest>
 #include <QDebug>
 #include "qaudiodecoder.h"
+#include <private/qplatformmediaintegration_p.h>
 
 #include "../shared/mediafileselector.h"
 
+#include <numeric>
+
 #define TEST_FILE_NAME "testdata/test.wav"
 #define TEST_UNSUPPORTED_FILE_NAME "testdata/test-unsupported.avi"
 #define TEST_CORRUPTED_FILE_NAME "testdata/test-corrupted.wav"
@@ -14,6 +17,17 @@
 
 QT_USE_NAMESPACE
 
+// Test file is 44.1K 16bit mono
+static constexpr qint64 TestFileFrames = 44094;
+
+// The FFmpeg decoder decodes up to this number of buffers ahead of the reader
+static constexpr qsizetype FFmpegMaxQueuedBuffers = 16;
+
+static bool isFFmpegBackend()
+{
+    return QPlatformMediaIntegration::backendName() == QLatin1String("ffmpeg");
+}
+
 /*
  This is the backend conformance test.
 
@@ -42,10 +56,17 @@ private slots:
     void corruptedFileTest();
     void invalidSource();
     void deviceTest();
+    void read_splitsAndMergesQueuedBuffers_whenMaxFramesIsGiven();
+    void read_returnsQueueLimit_whenDecodingIsAheadOfReader();
+    void setPosition_decodesRange_data();
+    void setPosition_decodesRange();
+    void setPosition_discardsQueuedBuffers_whenDecoding();
+    void setEndPosition_trimsQueuedBuffers_whenDecoding();
 
 private:
     QUrl testFileUrl(const QString filePath);
     void checkNoMoreChanges(QAudioDecoder &decoder);
+    void checkBuffersAreContiguous(const QList<QAudioBuffer> &buffers);
 #ifdef Q_OS_ANDROID
     QTemporaryFile *temporaryFile = nullptr;
 #endif
@@ -110,6 +131,42 @@ void tst_QAudioDecoderBackend::checkNoMoreChanges(QAudioDecoder &decoder)
     QCOMPARE(bufferAvailableSpy.size(), 0);
 }
 
+// Compares timestamps and frame counts allowing for rounding to microseconds and frames
+static constexpr qint64 FramesTolerance = 2;
+
+// Reads the buffers until the decoding finishes
+static QList<QAudioBuffer> readAllBuffers(QAudioDecoder &decoder, qint64 maxFrames = 0)
+{
+    using namespace std::chrono_literals;
+
+    QList<QAudioBuffer> result;
+    while (decoder.waitForBufferAvailable(QDeadlineTimer(10s)))
+        result.push_back(maxFrames > 0 ? decoder.read(maxFrames) : decoder.read());
+
+    return result;
+}
+
+static qint64 frameCount(const QList<QAudioBuffer> &buffers)
+{
+    return std::accumulate(buffers.begin(), buffers.end(), qint64(0),
+                           [](qint64 frames, const QAudioBuffer &buffer) {
+                               return frames + buffer.frameCount();
+                           });
+}
+
+void tst_QAudioDecoderBackend::checkBuffersAreContiguous(const QList<QAudioBuffer> &buffers)
+{
+    for (qsizetype i = 1; i < buffers.size(); ++i) {
+        const QAudioBuffer &previous = buffers[i - 1];
+        QVERIFY(previous.isValid());
+
+        // allow for rounding the timestamps to microseconds
+        const qint64 expectedStartTime = previous.startTime() + previous.duration();
+        QCOMPARE_LE(qAbs(buffers[i].startTime() - expectedStartTime),
+                     previous.format().durationForFrames(1));
+    }
+}
+
 void tst_QAudioDecoderBackend::testMediaFilesAreSupported()
 {
     QCOMPARE(m_mediaSelector.dumpErrors(), "");
@@ -168,7 +225,6 @@ void tst_QAudioDecoderBackend::indirectReadingByBufferReadySignal()
 
         auto buffer = decoder.read();
         QVERIFY(buffer.isValid());
-        QVERIFY(!decoder.bufferAvailable());
 
         sampleCount += buffer.sampleCount();
     });
@@ -279,7 +335,6 @@ void tst_QAudioDecoderBackend::restartOnBufferReady()
 
         auto buffer = decoder.read();
         QVERIFY(buffer.isValid());
-        QVERIFY(!decoder.bufferAvailable());
 
         sampleCount += buffer.sampleCount();
 
@@ -921,6 +976,215 @@ void tst_QAudioDecoderBackend::deviceTest()
     QCOMPARE(d.duration(), qint64(-1));
 }
 
+void tst_QAudioDecoderBackend::read_splitsAndMergesQueuedBuffers_whenMaxFramesIsGiven()
+{
+    using namespace std::chrono_literals;
+
+    CHECK_SELECTED_URL(m_wavFile);
+
+    if (!isFFmpegBackend())
+        QSKIP("Only the FFmpeg backend merges the decoded buffers");
+
+    QAudioDecoder decoder;
+    decoder.setSource(*m_wavFile);
+    decoder.start();
+
+    QVERIFY(decoder.waitForBufferAvailable(QDeadlineTimer(10s)));
+    QTest::qWait(100); // let the decoder fill the queue
+
+    QList<QAudioBuffer> buffers;
+
+    // a whole buffer
+    buffers.push_back(decoder.read());
+    QVERIFY(buffers.back().isValid());
+    QCOMPARE(buffers.back().startTime(), qint64(0));
+
+    const qsizetype bufferFrames = buffers.back().frameCount();
+    QCOMPARE_GT(bufferFrames, 1);
+    QCOMPARE_GT(TestFileFrames, bufferFrames * 3);
+
+    // the first half of the second buffer
+    buffers.push_back(decoder.read(bufferFrames / 2));
+    QCOMPARE(buffers.back().frameCount(), bufferFrames / 2);
+
+    // the rest of the second buffer and the first half of the third one
+    buffers.push_back(decoder.read(bufferFrames));
+    QCOMPARE(buffers.back().frameCount(), bufferFrames);
+
+    buffers.append(readAllBuffers(decoder, bufferFrames));
+
+    for (const QAudioBuffer &buffer : std::as_const(buffers))
+        QCOMPARE_LE(buffer.frameCount(), bufferFrames);
+
+    checkBuffersAreContiguous(buffers);
+    QCOMPARE(frameCount(buffers), TestFileFrames);
+    QVERIFY(!decoder.isDecoding());
+}
+
+void tst_QAudioDecoderBackend::read_returnsQueueLimit_whenDecodingIsAheadOfReader()
+{
+    using namespace std::chrono_literals;
+
+    CHECK_SELECTED_URL(m_wavFile);
+
+    if (!isFFmpegBackend())
+        QSKIP("Only the FFmpeg backend decodes ahead of the reader");
+
+    QAudioDecoder decoder;
+    decoder.setSource(*m_wavFile);
+    decoder.start();
+
+    QVERIFY(decoder.waitForBufferAvailable(QDeadlineTimer(10s)));
+    QTest::qWait(100);
+
+    QList<QAudioBuffer> buffers;
+    buffers.push_back(decoder.read());
+    QVERIFY(buffers.back().isValid());
+
+    const qsizetype bufferFrames = buffers.back().frameCount();
+    if (TestFileFrames <= bufferFrames * (FFmpegMaxQueuedBuffers + 1))
+        QSKIP("The test file is too short to fill the queue");
+
+    // reading a buffer frees a slot, and the decoder fills it up again
+    QTest::qWait(100);
+
+    // the decoder waits for the reader, so the queue holds exactly the limit
+    buffers.push_back(decoder.read(TestFileFrames));
+    QCOMPARE(buffers.back().frameCount(), bufferFrames * FFmpegMaxQueuedBuffers);
+    QVERIFY(decoder.isDecoding());
+
+    // reading resumes the decoding
+    buffers.append(readAllBuffers(decoder, TestFileFrames));
+
+    checkBuffersAreContiguous(buffers);
+    QCOMPARE(frameCount(buffers), TestFileFrames);
+    QVERIFY(!decoder.isDecoding());
+}
+
+void tst_QAudioDecoderBackend::setPosition_decodesRange_data()
+{
+    QTest::addColumn<qint64>("position");
+    QTest::addColumn<qint64>("endPosition");
+
+    QTest::newRow("from position to end") << qint64(250) << qint64(-1);
+    QTest::newRow("from start to end position") << qint64(0) << qint64(500);
+    QTest::newRow("range") << qint64(250) << qint64(750);
+    QTest::newRow("range within a buffer") << qint64(400) << qint64(410);
+}
+
+void tst_QAudioDecoderBackend::setPosition_decodesRange()
+{
+    CHECK_SELECTED_URL(m_wavFile);
+
+    if (!isFFmpegBackend())
+        QSKIP("Range decoding is only implemented by the FFmpeg backend");
+
+    QFETCH(qint64, position);
+    QFETCH(qint64, endPosition);
+
+    QAudioDecoder decoder;
+    decoder.setSource(*m_wavFile);
+    decoder.setPosition(position);
+    decoder.setEndPosition(endPosition);
+    QCOMPARE(decoder.endPosition(), endPosition);
+
+    QSignalSpy finishSpy(&decoder, &QAudioDecoder::finished);
+    decoder.start();
+
+    const QList<QAudioBuffer> buffers = readAllBuffers(decoder);
+    QVERIFY(!buffers.empty());
+    checkBuffersAreContiguous(buffers);
+
+    const QAudioFormat format = buffers.front().format();
+    const qint64 tolerance = format.durationForFrames(FramesTolerance);
+
+    // the timestamps are absolute, and the range is [position, endPosition)
+    QCOMPARE_LE(qAbs(buffers.front().startTime() - position * 1000), tolerance);
+
+    const QAudioBuffer &last = buffers.back();
+    const qint64 lastEndTime = last.startTime() + last.duration();
+    if (endPosition >= 0)
+        QCOMPARE_LE(qAbs(lastEndTime - endPosition * 1000), tolerance);
+    else
+        QCOMPARE_LE(qAbs(lastEndTime - format.durationForFrames(TestFileFrames)), tolerance);
+
+    const qint64 endFrame =
+            endPosition >= 0 ? format.framesForDuration(endPosition * 1000) : TestFileFrames;
+    const qint64 expectedFrames = endFrame - format.framesForDuration(position * 1000);
+    QCOMPARE_LE(qAbs(frameCount(buffers) - expectedFrames), FramesTolerance);
+
+    QTRY_COMPARE(finishSpy.size(), 1);
+    QVERIFY(!decoder.isDecoding());
+}
+
+void tst_QAudioDecoderBackend::setPosition_discardsQueuedBuffers_whenDecoding()
+{
+    using namespace std::chrono_literals;
+
+    CHECK_SELECTED_URL(m_wavFile);
+
+    if (!isFFmpegBackend())
+        QSKIP("Seeking while decoding is only implemented by the FFmpeg backend");
+
+    QAudioDecoder decoder;
+    decoder.setSource(*m_wavFile);
+    decoder.start();
+
+    QVERIFY(decoder.waitForBufferAvailable(QDeadlineTimer(10s)));
+    QTest::qWait(100); // let the decoder fill the queue
+
+    const QAudioBuffer first = decoder.read();
+    QVERIFY(first.isValid());
+    QCOMPARE(first.startTime(), qint64(0));
+
+    // the queued buffers and the ones of the replaced renderer are discarded
+    decoder.setPosition(500);
+    QVERIFY(!decoder.bufferAvailable());
+
+    const QList<QAudioBuffer> buffers = readAllBuffers(decoder);
+    QVERIFY(!buffers.empty());
+    checkBuffersAreContiguous(buffers);
+
+    const QAudioFormat format = first.format();
+    QCOMPARE_LE(qAbs(buffers.front().startTime() - 500'000), format.durationForFrames(FramesTolerance));
+
+    const qint64 expectedFrames = TestFileFrames - format.framesForDuration(500'000);
+    QCOMPARE_LE(qAbs(frameCount(buffers) - expectedFrames), FramesTolerance);
+}
+
+void tst_QAudioDecoderBackend::setEndPosition_trimsQueuedBuffers_whenDecoding()
+{
+    using namespace std::chrono_literals;
+
+    CHECK_SELECTED_URL(m_wavFile);
+
+    if (!isFFmpegBackend())
+        QSKIP("Range decoding is only implemented by the FFmpeg backend");
+
+    QAudioDecoder decoder;
+    decoder.setSource(*m_wavFile);
+    decoder.start();
+
+    QVERIFY(decoder.waitForBufferAvailable(QDeadlineTimer(10s)));
+    QTest::qWait(100); // let the decoder queue buffers beyond the end position
+
+    QSignalSpy finishSpy(&decoder, &QAudioDecoder::finished);
+    decoder.setEndPosition(100);
+
+    const QList<QAudioBuffer> buffers = readAllBuffers(decoder);
+    QVERIFY(!buffers.empty());
+    checkBuffersAreContiguous(buffers);
+
+    const QAudioFormat format = buffers.front().format();
+    const QAudioBuffer &last = buffers.back();
+    QCOMPARE_LE(qAbs(last.startTime() + last.duration() - 100'000),
+                format.durationForFrames(FramesTolerance));
+    QCOMPARE_LE(qAbs(frameCount(buffers) - format.framesForDuration(100'000)), FramesTolerance);
+
+    QTRY_COMPARE(finishSpy.size(), 1);
+    QVERIFY(!decoder.isDecoding());
+}
+
 QTEST_MAIN(tst_QAudioDecoderBackend)
 
 #include "tst_qaudiodecoderbackend.moc"
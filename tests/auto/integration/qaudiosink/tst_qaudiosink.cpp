@@ -43,6 +43,7 @@ private slots:
     void pullSuspendResume_data(){generate_audiofile_testrows();}
     void pullSuspendResume();
     void pullResumeFromUnderrun();
+    void pullCallback();
 
     void push_data(){generate_audiofile_testrows();}
     void push();
@@ -642,6 +643,49 @@ void tst_QAudioSink::pullResumeFromUnderrun()
     QTRY_COMPARE(audioOutput.processedUSecs(), expectedUSecs);
 }
 
+void tst_QAudioSink::pullCallback()
+{
+    const QAudioFormat format = audioDevice.preferredFormat();
+    const char silence = format.sampleFormat() == QAudioFormat::UInt8 ? char(0x80) : char(0);
+    QThread *testThread = QThread::currentThread();
+
+    std::atomic<qint64> renderedBytes = 0;
+    std::atomic<bool> partialFrames = false;
+    std::atomic<bool> calledOnTestThread = false;
+
+    QAudioSink audioOutput(audioDevice, format, this);
+    audioOutput.start([&](QSpan<char> buffer) {
+        std::fill(buffer.begin(), buffer.end(), silence);
+        if (buffer.size() % format.bytesPerFrame() != 0)
+            partialFrames = true;
+        if (QThread::currentThread() == testThread)
+            calledOnTestThread = true;
+        renderedBytes += buffer.size();
+    });
+
+    if (audioOutput.state() == QAudio::StoppedState && audioOutput.error() == QAudio::NoError)
+        QSKIP("The audio backend doesn't support rendering with a callback");
+
+    QCOMPARE(audioOutput.state(), QAudio::ActiveState);
+    QCOMPARE(audioOutput.error(), QAudio::NoError);
+
+    // rendering doesn't depend on the event loop of the sink's thread
+    const qint64 renderedBeforeBlocking = renderedBytes;
+    QThread::msleep(500);
+    QVERIFY(renderedBytes > renderedBeforeBlocking);
+
+    QTRY_VERIFY(audioOutput.processedUSecs() > 0);
+    QVERIFY(!partialFrames);
+    QVERIFY(!calledOnTestThread);
+
+    audioOutput.stop();
+    QCOMPARE(audioOutput.state(), QAudio::StoppedState);
+
+    const qint64 renderedAfterStop = renderedBytes;
+    QTest::qWait(100);
+    QCOMPARE(renderedBytes.load(), renderedAfterStop);
+}
+
 void tst_QAudioSink::push()
 {
     QFETCH(FilePtr, audioFile);
@@ -65,6 +65,9 @@ private slots:
 
     void multipleCameraSet();
 
+    void testRestartWithHeldFrames_data();
+    void testRestartWithHeldFrames();
+
 private:
     bool noCamera = false;
 };
@@ -728,6 +731,96 @@ void tst_QCameraBackend::multipleCameraSet()
     }
 }
 
+// The V4L2 test driver (vivid), which is loaded on the Linux CI machines
+static QCameraDevice findVividCamera()
+{
+    const auto cameras = QMediaDevices::videoInputs();
+    for (const QCameraDevice &camera : cameras)
+        if (camera.description().contains(QLatin1String("vivid"), Qt::CaseInsensitive))
+            return camera;
+    return {};
+}
+
+void tst_QCameraBackend::testRestartWithHeldFrames_data()
+{
+    QTest::addColumn<bool>("changeFormat");
+
+    QTest::newRow("same format") << false;
+    QTest::newRow("format change") << true;
+}
+
+void tst_QCameraBackend::testRestartWithHeldFrames()
+{
+    QFETCH(bool, changeFormat);
+
+    // Frames of the V4L2 camera may reference the mapped driver buffers, which must not
+    // make the driver refuse the new buffers and format with EBUSY on restart.
+    const QCameraDevice device = findVividCamera();
+    if (device.isNull())
+        QSKIP("The vivid V4L2 driver is not loaded");
+
+    const auto videoFormats = device.videoFormats();
+    QVERIFY(!videoFormats.isEmpty());
+    const QCameraFormat firstFormat = videoFormats.first();
+    auto secondFormat = firstFormat;
+    if (changeFormat) {
+        auto it = std::find_if(videoFormats.begin(), videoFormats.end(),
+                               [&](const QCameraFormat &format) {
+                                   return format.resolution() != firstFormat.resolution();
+                               });
+        if (it == videoFormats.end())
+            QSKIP("The camera has a single resolution");
+        secondFormat = *it;
+    }
+
+    QMediaCaptureSession session;
+    QCamera camera(device);
+    QVideoSink sink;
+    session.setCamera(&camera);
+    session.setVideoSink(&sink);
+
+    QList<QVideoFrame> heldFrames;
+    connect(&sink, &QVideoSink::videoFrameChanged, this, [&](const QVideoFrame &frame) {
+        if (heldFrames.size() < 3)
+            heldFrames.push_back(frame);
+    });
+
+    QSignalSpy errorSpy(&camera, &QCamera::errorOccurred);
+
+    camera.setCameraFormat(firstFormat);
+    camera.start();
+    QTRY_COMPARE(heldFrames.size(), 3);
+
+    // keep one of the frames mapped over the restart
+    QVideoFrame &mappedFrame = heldFrames.front();
+    QVERIFY(mappedFrame.map(QVideoFrame::ReadOnly));
+
+    camera.stop();
+
+    camera.setCameraFormat(secondFormat);
+    QVideoFrame frameAfterRestart;
+    connect(&sink, &QVideoSink::videoFrameChanged, this,
+            [&](const QVideoFrame &frame) { frameAfterRestart = frame; });
+    camera.start();
+
+    QTRY_VERIFY(frameAfterRestart.isValid());
+    QCOMPARE(frameAfterRestart.size(), secondFormat.resolution());
+    QVERIFY(camera.isActive());
+    QCOMPARE(errorSpy.size(), 0);
+
+    // the held frames stay readable
+    QVERIFY(mappedFrame.bits(0) != nullptr);
+    mappedFrame.unmap();
+    for (QVideoFrame &frame : heldFrames) {
+        QCOMPARE(frame.size(), firstFormat.resolution());
+        QVERIFY(frame.map(QVideoFrame::ReadOnly));
+        QVERIFY(frame.bits(0) != nullptr);
+        frame.unmap();
+    }
+
+    camera.stop();
+}
+
 QTEST_MAIN(tst_QCameraBackend)
 
 #include "tst_qcamerabackend.moc"
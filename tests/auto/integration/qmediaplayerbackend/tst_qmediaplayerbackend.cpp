@@ -20,6 +20,8 @@
 #endif
 #include <qmediatimerange.h>
 #include <private/qplatformvideosink_p.h>
+#include <private/qplatformmediaplayer_p.h>
+#include <private/qplatformmediaintegration_p.h>
 
 #include <QtQml/qqmlengine.h>
 #include <QtQml/qqmlcomponent.h>
@@ -166,6 +168,7 @@ private slots:
     void lazyLoadVideo();
     void videoSinkSignals();
     void nonAsciiFileName();
+    void bufferedTimeRange_followsBufferingPolicy_whenFFmpegBackendIsUsed();
     void setMedia_setsVideoSinkSize_beforePlaying();
     void play_playsRotatedVideoOutput_whenVideoFileHasOrientationMetadata_data();
     void play_playsRotatedVideoOutput_whenVideoFileHasOrientationMetadata();
@@ -2744,6 +2747,45 @@ void tst_QMediaPlayerBackend::nonAsciiFileName()
     QCOMPARE(m_fixture->errorOccurred.size(), 0);
 }
 
+void tst_QMediaPlayerBackend::bufferedTimeRange_followsBufferingPolicy_whenFFmpegBackendIsUsed()
+{
+    using namespace std::chrono_literals;
+
+    if (QPlatformMediaIntegration::backendName() != QLatin1String("ffmpeg"))
+        QSKIP("The buffering policy is only implemented by the FFmpeg backend");
+
+    CHECK_SELECTED_URL(m_localCompressedSoundFile);
+
+    QMediaPlayer player;
+    QAudioOutput output;
+    player.setAudioOutput(&output);
+
+    QPlatformMediaPlayer::BufferingPolicy policy;
+    policy.maxDuration = 500ms;
+    policy.lowWatermark = 100ms;
+    policy.highWatermark = 250ms;
+    QPlatformMediaPlayer::setBufferingPolicy(&player, policy);
+
+    player.setSource(*m_localCompressedSoundFile);
+    QTRY_COMPARE(player.mediaStatus(), QMediaPlayer::LoadedMedia);
+    QCOMPARE_GT(player.duration(), 2000);
+
+    player.pause();
+    QTRY_VERIFY(!player.bufferedTimeRange().isEmpty());
+
+    // let the demuxer run into the limit; the decoder keeps a few frames on top of it
+    QTest::qWait(200);
+    QCOMPARE(player.position(), 0);
+    QCOMPARE_GT(player.bufferedTimeRange().latestTime(), 0);
+    QCOMPARE_LT(player.bufferedTimeRange().latestTime(), 1500);
+
+    // lifting the limit makes the whole file buffered
+    QPlatformMediaPlayer::setBufferingPolicy(&player, {});
+    // the end of the last packet might differ slightly from the duration of the container
+    QTRY_COMPARE_GE(player.bufferedTimeRange().latestTime(), player.duration() - 100);
+    QCOMPARE(player.bufferedTimeRange().earliestTime(), 0);
+}
+
 void tst_QMediaPlayerBackend::setMedia_setsVideoSinkSize_beforePlaying()
 {
     CHECK_SELECTED_URL(m_localVideoFile3ColorsWithSound);
@@ -9,6 +9,7 @@
 #include <qaudio.h>
 #include "qsoundeffect.h"
 #include "qmediadevices.h"
+#include <private/qsoundeffectmixer_p.h>
 
 class tst_QSoundEffect : public QObject
 {
@@ -28,6 +29,7 @@ private slots:
     void testMuting();
 
     void testPlaying();
+    void testPolyphony();
     void testStatus();
 
     void testDestroyWhilePlaying();
@@ -53,6 +55,7 @@ void tst_QSoundEffect::init()
     sound->setLoopCount(1);
     sound->setVolume(1.0);
     sound->setMuted(false);
+    sound->setPolyphony(1);
 }
 
 void tst_QSoundEffect::cleanup()
@@ -244,6 +247,56 @@ void tst_QSoundEffect::testPlaying()
     sound->setLoopCount(1); // TODO: What if one of the tests fail?
 }
 
+void tst_QSoundEffect::testPolyphony()
+{
+    QSignalSpy polyphonySpy(sound, &QSoundEffect::polyphonyChanged);
+
+    QTest::ignoreMessage(QtWarningMsg, "SoundEffect: polyphony should be a positive integer");
+    sound->setPolyphony(0);
+    QCOMPARE(sound->polyphony(), 1);
+
+    sound->setPolyphony(3);
+    QCOMPARE(sound->polyphony(), 3);
+    QCOMPARE(polyphonySpy.size(), 1);
+
+    sound->setVolume(0.1f);
+    sound->setSource(url);
+    QTRY_COMPARE(sound->status(), QSoundEffect::Ready);
+
+    sound->play();
+    QTest::qWait(50);
+    sound->play();
+    QTest::qWait(50);
+    sound->play();
+    QCOMPARE(sound->isPlaying(), true);
+
+    QTRY_COMPARE(sound->isPlaying(), false);
+    QCOMPARE(sound->loopsRemaining(), 0);
+
+    auto mixer = QSoundEffectMixer::instance(QMediaDevices::defaultAudioOutput());
+    if (!mixer)
+        return;
+
+    // the voices loop until they're stopped, so that they can be counted
+    sound->setLoopCount(QSoundEffect::Infinite);
+    sound->play();
+    if (mixer->activeVoiceCount() == 0)
+        QSKIP("The sound effect is not played with the mixer");
+
+    for (int i = 2; i <= 3; ++i) {
+        sound->play();
+        QCOMPARE(mixer->activeVoiceCount(), i);
+    }
+
+    // above the limit, the oldest voice of the sound is restarted
+    sound->play();
+    sound->play();
+    QCOMPARE(mixer->activeVoiceCount(), 3);
+
+    sound->stop();
+    QCOMPARE(mixer->activeVoiceCount(), 0);
+}
+
 void tst_QSoundEffect::testStatus()
 {
     sound->setSource(QUrl());
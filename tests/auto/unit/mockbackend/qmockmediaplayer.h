@@ -7,6 +7,8 @@
 #include "private/qplatformmediaplayer_p.h"
 #include <qurl.h>
 
+#include <optional>
+
 QT_BEGIN_NAMESPACE
 
 class QMockMediaPlayer : public QPlatformMediaPlayer
@@ -49,6 +51,11 @@ public:
     qint64 position() const override { return _position; }
 
     void setPosition(qint64 position) override { if (position != _position) emit positionChanged(_position = position); }
+    void seek(qint64 position, QMediaPlayer::SeekMode mode) override
+    {
+        m_seekMode = mode;
+        setPosition(position);
+    }
 
     float bufferProgress() const override { return _bufferProgress; }
     void setBufferStatus(float status)
@@ -92,6 +99,8 @@ public:
 
     void setAudioOutput(QPlatformAudioOutput *output) override { m_audioOutput = output; }
 
+    void setBufferingPolicy(const BufferingPolicy &policy) override { m_bufferingPolicy = policy; }
+
     void emitError(QMediaPlayer::Error err, const QString &errorString)
     {
         emit error(err, errorString);
@@ -155,6 +164,8 @@ public:
     QString _errorString;
     bool m_supportsStreamPlayback = false;
     QPlatformAudioOutput *m_audioOutput = nullptr;
+    BufferingPolicy m_bufferingPolicy;
+    std::optional<QMediaPlayer::SeekMode> m_seekMode;
 };
 
 QT_END_NAMESPACE
@@ -28,6 +28,8 @@ private Q_SLOTS:
     void format();
     void source();
     void readAll();
+    void waitForBufferAvailable();
+    void readMaxFrames();
     void nullControl();
 };
 
@@ -294,6 +296,63 @@ void tst_QAudioDecoder::readAll()
     }
 }
 
+void tst_QAudioDecoder::waitForBufferAvailable()
+{
+    QAudioDecoder d;
+    d.setSource(QUrl::fromLocalFile("Foo"));
+    QVERIFY(!d.waitForBufferAvailable(QDeadlineTimer(0)));
+
+    QSignalSpy finishedSpy(&d, SIGNAL(finished()));
+    d.start();
+
+    int count = 0;
+    while (d.waitForBufferAvailable(QDeadlineTimer(5000))) {
+        QAudioBuffer b = d.read(1024);
+        QVERIFY(b.isValid());
+        QCOMPARE(b.startTime() / 1000, d.position());
+        ++count;
+    }
+
+    QCOMPARE(count, MOCK_DECODER_MAX_BUFFERS);
+    QCOMPARE(finishedSpy.size(), 1);
+    QVERIFY(!d.isDecoding());
+    QVERIFY(!d.read(1024).isValid());
+}
+
+void tst_QAudioDecoder::readMaxFrames()
+{
+    QAudioDecoder d;
+    d.setSource(QUrl::fromLocalFile("Foo"));
+    d.start();
+    QVERIFY(d.waitForBufferAvailable(QDeadlineTimer(5000)));
+
+    // the mock buffers hold 4 frames; the rest of a split buffer goes to the next read
+    QAudioBuffer head = d.read(3);
+    QVERIFY(head.isValid());
+    QCOMPARE(head.frameCount(), 3);
+    QVERIFY(d.bufferAvailable());
+
+    QAudioBuffer rest = d.read(3);
+    QVERIFY(rest.isValid());
+    QCOMPARE(rest.frameCount(), 1);
+    QCOMPARE(rest.startTime(), head.startTime() + head.format().durationForFrames(3));
+
+    const QByteArray data = QByteArray(head.constData<char>(), head.byteCount())
+            + QByteArray(rest.constData<char>(), rest.byteCount());
+    int serial = -1;
+    memcpy(&serial, data.constData(), sizeof(serial));
+    QCOMPARE(serial, 0);
+
+    // read() returns the rest too, and stop() discards it
+    QVERIFY(d.waitForBufferAvailable(QDeadlineTimer(5000)));
+    QCOMPARE(d.read(1).frameCount(), 1);
+    QCOMPARE(d.read().frameCount(), 3);
+    QVERIFY(d.waitForBufferAvailable(QDeadlineTimer(5000)));
+    QCOMPARE(d.read(1).frameCount(), 1);
+    d.stop();
+    QVERIFY(!d.bufferAvailable());
+}
+
 void tst_QAudioDecoder::nullControl()
 {
     QMockIntegration::instance()->setFlags(QMockIntegration::NoAudioDecoderInterface);
@@ -320,11 +379,18 @@ void tst_QAudioDecoder::nullControl()
     QVERIFY(!d.audioFormat().isValid());
 
     QVERIFY(!d.read().isValid());
+    QVERIFY(!d.read(1024).isValid());
     QVERIFY(!d.bufferAvailable());
+    QVERIFY(!d.waitForBufferAvailable(QDeadlineTimer(0)));
 
     QVERIFY(d.position() == -1);
     QVERIFY(d.duration() == -1);
 
+    d.setPosition(1000);
+    d.setEndPosition(2000);
+    QVERIFY(d.position() == -1);
+    QVERIFY(d.endPosition() == -1);
+
     d.start();
     QVERIFY(d.error() == QAudioDecoder::NotSupportedError);
     QVERIFY(!d.errorString().isEmpty());
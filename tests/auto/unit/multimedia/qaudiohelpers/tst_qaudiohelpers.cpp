@@ -0,0 +1,289 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtCore/qrandom.h>
+#include <private/qaudiohelpers_p.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+QT_USE_NAMESPACE
+
+using namespace QAudioHelperInternal;
+
+namespace {
+
+// more than the widest vector of the SIMD kernels, twice, so that all their leftovers are run
+constexpr int MaxSamples = 67;
+
+// Int32 samples are scaled in double precision, as in the kernels
+template <typename T>
+using Factor = std::conditional_t<std::is_same_v<T, qint32>, double, float>;
+
+template <typename T>
+QAudioFormat audioFormat(int channelCount = 1)
+{
+    QAudioFormat format;
+    format.setSampleRate(48000);
+    format.setChannelCount(channelCount);
+    if constexpr (std::is_same_v<T, quint8>)
+        format.setSampleFormat(QAudioFormat::UInt8);
+    else if constexpr (std::is_same_v<T, qint16>)
+        format.setSampleFormat(QAudioFormat::Int16);
+    else if constexpr (std::is_same_v<T, qint32>)
+        format.setSampleFormat(QAudioFormat::Int32);
+    else
+        format.setSampleFormat(QAudioFormat::Float);
+    return format;
+}
+
+// the scale of the float conversions
+template <typename T>
+constexpr double floatRange()
+{
+    if constexpr (std::is_same_v<T, quint8>)
+        return 128.;
+    else if constexpr (std::is_same_v<T, qint16>)
+        return 32768.;
+    else
+        return 2147483648.;
+}
+
+// Returns deterministic samples, with the extremes of the format first
+template <typename T>
+std::vector<T> testSamples(int count)
+{
+    QRandomGenerator generator(count);
+    std::vector<T> samples(count);
+    for (T &sample : samples) {
+        if constexpr (std::is_floating_point_v<T>)
+            sample = T(generator.bounded(2.) - 1.);
+        else
+            sample = T(generator.generate());
+    }
+
+    const T extremes[] = { std::is_floating_point_v<T> ? T(-1) : std::numeric_limits<T>::min(),
+                           std::is_floating_point_v<T> ? T(1) : std::numeric_limits<T>::max() };
+    std::copy_n(extremes, qMin(count, 2), samples.begin());
+    return samples;
+}
+
+// Returns floats in [-1.5, 1.5], so that the conversions saturate
+std::vector<float> testFloats(int count)
+{
+    QRandomGenerator generator(count);
+    std::vector<float> samples(count);
+    for (float &sample : samples)
+        sample = float(generator.bounded(3.) - 1.5);
+    return samples;
+}
+
+template <typename T>
+void compareMultiplyWithScalar(double factor)
+{
+    for (int count = 0; count <= MaxSamples; ++count) {
+        const std::vector<T> src = testSamples<T>(count);
+        std::vector<T> dest(count);
+        qMultiplySamples(factor, audioFormat<T>(), src.data(), dest.data(),
+                         count * int(sizeof(T)));
+
+        for (int i = 0; i < count; ++i)
+            QCOMPARE(dest[i], Scalar::multiply(src[i], Factor<T>(factor)));
+    }
+}
+
+template <typename T>
+void compareToFloatWithScalar(double factor)
+{
+    for (int count = 0; count <= MaxSamples; ++count) {
+        const std::vector<T> src = testSamples<T>(count);
+        std::vector<float> dest(count);
+        qConvertToFloat(factor, audioFormat<T>(), src.data(), dest.data(), count);
+
+        for (int i = 0; i < count; ++i) {
+            if constexpr (std::is_floating_point_v<T>)
+                QCOMPARE(dest[i], src[i] * float(factor));
+            else
+                QCOMPARE(dest[i], Scalar::toFloat(src[i], Factor<T>(factor / floatRange<T>())));
+        }
+    }
+}
+
+template <typename T>
+void compareFromFloatWithScalar(double factor)
+{
+    for (int count = 0; count <= MaxSamples; ++count) {
+        const std::vector<float> src = testFloats(count);
+        std::vector<T> dest(count);
+        qConvertFromFloat(factor, audioFormat<T>(), src.data(), dest.data(), count);
+
+        for (int i = 0; i < count; ++i) {
+            T expected;
+            if constexpr (std::is_floating_point_v<T>)
+                expected = std::clamp(src[i] * float(factor), -1.f, 1.f);
+            else
+                Scalar::fromFloat(src[i], Factor<T>(factor * floatRange<T>()), expected);
+            QCOMPARE(dest[i], expected);
+        }
+    }
+}
+
+template <typename T>
+void verifySaturation()
+{
+    const T src[] = { std::numeric_limits<T>::min(), std::numeric_limits<T>::max() };
+    T dest[2];
+    qMultiplySamples(2., audioFormat<T>(), src, dest, int(sizeof(src)));
+    QCOMPARE(dest[0], src[0]);
+    QCOMPARE(dest[1], src[1]);
+}
+
+template <typename T>
+void verifyLosslessRoundTrip()
+{
+    std::vector<T> src(size_t(std::numeric_limits<T>::max()) - std::numeric_limits<T>::min() + 1);
+    std::iota(src.begin(), src.end(), std::numeric_limits<T>::min());
+    const int count = int(src.size());
+
+    std::vector<float> floats(count);
+    std::vector<T> dest(count);
+    qConvertToFloat(1., audioFormat<T>(), src.data(), floats.data(), count);
+    qConvertFromFloat(1., audioFormat<T>(), floats.data(), dest.data(), count);
+    QCOMPARE(dest, src);
+}
+
+} // namespace
+
+class tst_QAudioHelpers : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void qMultiplySamples_matchesScalarKernel_data();
+    void qMultiplySamples_matchesScalarKernel();
+    void qMultiplySamples_saturates_whenFactorIsAboveOne();
+
+    void qConvertToFloat_matchesScalarKernel_data();
+    void qConvertToFloat_matchesScalarKernel();
+    void qConvertFromFloat_matchesScalarKernel_data();
+    void qConvertFromFloat_matchesScalarKernel();
+    void qConvertFromFloat_isInverseOfToFloat_whenFactorIsOne();
+
+    void qRampSamples_reachesEndFactor_atLastFrame();
+
+    void qUnpackInt24_matchesScalarKernel();
+};
+
+static void addFactors()
+{
+    QTest::addColumn<double>("factor");
+
+    QTest::newRow("zero") << 0.;
+    QTest::newRow("attenuation") << 0.3;
+    QTest::newRow("boost") << 1.7;
+    QTest::newRow("large boost") << 100.;
+}
+
+void tst_QAudioHelpers::qMultiplySamples_matchesScalarKernel_data()
+{
+    addFactors();
+}
+
+void tst_QAudioHelpers::qMultiplySamples_matchesScalarKernel()
+{
+    QFETCH(double, factor);
+
+    compareMultiplyWithScalar<quint8>(factor);
+    compareMultiplyWithScalar<qint16>(factor);
+    compareMultiplyWithScalar<qint32>(factor);
+    compareMultiplyWithScalar<float>(factor);
+}
+
+void tst_QAudioHelpers::qMultiplySamples_saturates_whenFactorIsAboveOne()
+{
+    verifySaturation<quint8>();
+    verifySaturation<qint16>();
+    verifySaturation<qint32>();
+}
+
+void tst_QAudioHelpers::qConvertToFloat_matchesScalarKernel_data()
+{
+    addFactors();
+}
+
+void tst_QAudioHelpers::qConvertToFloat_matchesScalarKernel()
+{
+    QFETCH(double, factor);
+
+    compareToFloatWithScalar<quint8>(factor);
+    compareToFloatWithScalar<qint16>(factor);
+    compareToFloatWithScalar<qint32>(factor);
+    compareToFloatWithScalar<float>(factor);
+}
+
+void tst_QAudioHelpers::qConvertFromFloat_matchesScalarKernel_data()
+{
+    addFactors();
+}
+
+void tst_QAudioHelpers::qConvertFromFloat_matchesScalarKernel()
+{
+    QFETCH(double, factor);
+
+    compareFromFloatWithScalar<quint8>(factor);
+    compareFromFloatWithScalar<qint16>(factor);
+    compareFromFloatWithScalar<qint32>(factor);
+    compareFromFloatWithScalar<float>(factor);
+}
+
+void tst_QAudioHelpers::qConvertFromFloat_isInverseOfToFloat_whenFactorIsOne()
+{
+    verifyLosslessRoundTrip<quint8>();
+    verifyLosslessRoundTrip<qint16>();
+}
+
+void tst_QAudioHelpers::qRampSamples_reachesEndFactor_atLastFrame()
+{
+    constexpr int Frames = 10;
+    const std::vector<qint16> src(2 * Frames, 10000);
+    std::vector<qint16> dest(src.size());
+
+    qRampSamples(0.5, 1., audioFormat<qint16>(2), src.data(), dest.data(),
+                 int(src.size() * sizeof(qint16)));
+
+    // the channels of a frame get the same factor, which grows up to the end factor
+    QCOMPARE(dest[0], qint16(5500));
+    for (int frame = 0; frame < Frames; ++frame) {
+        QCOMPARE(dest[2 * frame], dest[2 * frame + 1]);
+        if (frame > 0)
+            QCOMPARE_GT(dest[2 * frame], dest[2 * frame - 2]);
+    }
+    QCOMPARE(dest.back(), qint16(10000));
+
+    // the end factor may be above 1
+    const std::vector<float> floats(Frames, 0.5f);
+    std::vector<float> ramped(Frames);
+    qRampSamples(1., 3., audioFormat<float>(), floats.data(), ramped.data(),
+                 int(floats.size() * sizeof(float)));
+    QCOMPARE(ramped.back(), 1.5f);
+}
+
+void tst_QAudioHelpers::qUnpackInt24_matchesScalarKernel()
+{
+    for (int count = 0; count <= MaxSamples; ++count) {
+        const std::vector<quint8> src = testSamples<quint8>(3 * count);
+        std::vector<qint32> dest(count);
+        qUnpackInt24(src.data(), dest.data(), count);
+
+        for (int i = 0; i < count; ++i)
+            QCOMPARE(dest[i], Scalar::unpackInt24(src.data() + 3 * i));
+    }
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioHelpers)
+
+#include "tst_qaudiohelpers.moc"
@@ -0,0 +1,172 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtCore/qmath.h>
+
+#include "playbackengine/qffmpegaudiotimestretcher_p.h"
+
+QT_USE_NAMESPACE
+
+using QFFmpeg::AudioTimeStretcher;
+
+namespace {
+
+constexpr int SampleRate = 48000;
+constexpr qint32 BufferFrames = 1024;
+constexpr qint32 TotalFrames = 96 * BufferFrames;
+
+// The stretcher outputs half a window per segment, and keeps up to a window and
+// the search radius of the input
+constexpr qint32 WindowFrames = SampleRate * 24 / 1000;
+constexpr qint32 SynthesisHopFrames = WindowFrames / 2;
+constexpr qint32 MaxPendingFrames = WindowFrames * 3 / 2;
+
+QAudioFormat makeFormat()
+{
+    QAudioFormat format;
+    format.setSampleRate(SampleRate);
+    format.setChannelCount(2);
+    format.setSampleFormat(QAudioFormat::Int16);
+    return format;
+}
+
+// A 440 Hz tone, so that the segment search has a periodic signal to match
+QAudioBuffer makeBuffer(const QAudioFormat &format, qint32 firstFrame, qint32 frames)
+{
+    QByteArray data(format.bytesForFrames(frames), Qt::Uninitialized);
+    auto *samples = reinterpret_cast<qint16 *>(data.data());
+    for (qint32 i = 0; i < frames; ++i) {
+        const auto value =
+                qint16(16000 * std::sin(2 * M_PI * 440 * (firstFrame + i) / format.sampleRate()));
+        samples[2 * i] = value;
+        samples[2 * i + 1] = value;
+    }
+    return QAudioBuffer(data, format, format.durationForFrames(firstFrame));
+}
+
+} // namespace
+
+class tst_QFFmpegAudioTimeStretcher : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void process_passesBuffersThrough_whenRateIsOne();
+    void process_scalesOutputLength_byPlaybackRate_data();
+    void process_scalesOutputLength_byPlaybackRate();
+    void latency_coversPendingInput();
+    void flush_returnsPendingInput_whenRateReturnsToOne();
+};
+
+void tst_QFFmpegAudioTimeStretcher::process_passesBuffersThrough_whenRateIsOne()
+{
+    const QAudioFormat format = makeFormat();
+    AudioTimeStretcher stretcher(format);
+
+    for (qint32 frame = 0; frame < SampleRate / 4; frame += BufferFrames) {
+        const QAudioBuffer input = makeBuffer(format, frame, BufferFrames);
+        const QAudioBuffer output = stretcher.process(input);
+
+        QCOMPARE(output.format(), format);
+        QCOMPARE(output.frameCount(), input.frameCount());
+        QCOMPARE(output.startTime(), input.startTime());
+        QCOMPARE(QByteArrayView(output.constData<char>(), output.byteCount()),
+                 QByteArrayView(input.constData<char>(), input.byteCount()));
+        QCOMPARE(stretcher.latency().count(), 0);
+    }
+
+    QVERIFY(!stretcher.flush().isValid());
+}
+
+void tst_QFFmpegAudioTimeStretcher::process_scalesOutputLength_byPlaybackRate_data()
+{
+    QTest::addColumn<float>("rate");
+
+    QTest::addRow("0.5") << 0.5f;
+    QTest::addRow("0.8") << 0.8f;
+    QTest::addRow("1.25") << 1.25f;
+    QTest::addRow("2") << 2.f;
+    QTest::addRow("4") << 4.f;
+}
+
+void tst_QFFmpegAudioTimeStretcher::process_scalesOutputLength_byPlaybackRate()
+{
+    QFETCH(const float, rate);
+
+    const QAudioFormat format = makeFormat();
+    AudioTimeStretcher stretcher(format);
+    stretcher.setPlaybackRate(rate);
+
+    qint64 outputFrames = 0;
+    qint64 expectedStartTime = 0;
+    for (qint32 frame = 0; frame < TotalFrames; frame += BufferFrames) {
+        const QAudioBuffer output = stretcher.process(makeBuffer(format, frame, BufferFrames));
+        if (!output.isValid())
+            continue;
+
+        QCOMPARE(output.format(), format);
+        // the output is continuous
+        QCOMPARE_LE(qAbs(output.startTime() - expectedStartTime), 1);
+        expectedStartTime = output.startTime() + output.duration();
+        outputFrames += output.frameCount();
+    }
+
+    // all input but the pending part is stretched; the last segment may reach
+    // up to an analysis hop into the input that isn't received yet
+    const qint64 consumedFrames = qRound64(outputFrames * double(rate));
+    QCOMPARE_LE(consumedFrames, TotalFrames + qRound64(SynthesisHopFrames * double(rate)));
+    QCOMPARE_GE(consumedFrames, TotalFrames - MaxPendingFrames);
+}
+
+void tst_QFFmpegAudioTimeStretcher::latency_coversPendingInput()
+{
+    const QAudioFormat format = makeFormat();
+    AudioTimeStretcher stretcher(format);
+    stretcher.setPlaybackRate(2.f);
+
+    // nothing is output before a full window is received
+    QVERIFY(!stretcher.process(makeBuffer(format, 0, 256)).isValid());
+    QCOMPARE_LE(qAbs(stretcher.latency().count() - format.durationForFrames(256) / 2), 1);
+
+    qint64 inputFrames = 256;
+    qint64 outputFrames = 0;
+    for (; inputFrames < SampleRate; inputFrames += BufferFrames) {
+        const QAudioBuffer output =
+                stretcher.process(makeBuffer(format, qint32(inputFrames), BufferFrames));
+        outputFrames += output.frameCount();
+
+        // the pending input and the input of the output add up to the whole input
+        const qint64 pendingFrames = format.framesForDuration(stretcher.latency().count()) * 2;
+        QCOMPARE_GT(pendingFrames, 0);
+        QCOMPARE_LE(pendingFrames, MaxPendingFrames);
+        QCOMPARE_LE(qAbs(outputFrames * 2 + pendingFrames - (inputFrames + BufferFrames)), 4);
+    }
+}
+
+void tst_QFFmpegAudioTimeStretcher::flush_returnsPendingInput_whenRateReturnsToOne()
+{
+    const QAudioFormat format = makeFormat();
+    AudioTimeStretcher stretcher(format);
+    stretcher.setPlaybackRate(1.5f);
+
+    qint32 frame = 0;
+    for (; frame < SampleRate / 2; frame += BufferFrames)
+        stretcher.process(makeBuffer(format, frame, BufferFrames));
+    QCOMPARE_GT(stretcher.latency().count(), 0);
+
+    // the pending input is returned with the next buffer, and then buffers pass through
+    stretcher.setPlaybackRate(1.f);
+    const QAudioBuffer output = stretcher.process(makeBuffer(format, frame, BufferFrames));
+    QCOMPARE_GT(output.frameCount(), BufferFrames);
+    QCOMPARE(stretcher.latency().count(), 0);
+
+    frame += BufferFrames;
+    const QAudioBuffer input = makeBuffer(format, frame, BufferFrames);
+    QCOMPARE(stretcher.process(input).frameCount(), BufferFrames);
+    QCOMPARE(stretcher.latency().count(), 0);
+}
+
+QTEST_GUILESS_MAIN(tst_QFFmpegAudioTimeStretcher)
+
+#include "tst_qffmpegaudiotimestretcher.moc"
@@ -0,0 +1,206 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include "playbackengine/qffmpegplaybackscheduler_p.h"
+
+QT_USE_NAMESPACE
+
+using QFFmpeg::PlaybackScheduler;
+using Priority = PlaybackScheduler::Priority;
+
+namespace {
+
+// A codec as the playback engine manages it: it counts the notifications,
+// and reopens on demand to get the new share.
+struct TestCodec
+{
+    PlaybackScheduler::Lease lease;
+    int notifications = 0;
+
+    void open(PlaybackScheduler &scheduler, Priority priority)
+    {
+        lease = scheduler.acquireCodecThreads(priority, [this]() { ++notifications; });
+    }
+
+    bool reopen(PlaybackScheduler &scheduler)
+    {
+        notifications = 0;
+        return scheduler.updateCodecThreads(lease);
+    }
+
+    int threads() const { return lease.codecThreadsCount(); }
+};
+
+} // namespace
+
+class tst_QFFmpegPlaybackScheduler : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void acquireCodecThreads_splitsBudgetByPriority();
+    void acquireCodecThreads_rebalancesCodecs_whenCodecIsReleased();
+    void acquireCodecThreads_givesOneThreadPerCodec_whenBudgetIsExhausted();
+    void acquireCodecThreads_letsCallbackUpdateLease_whenShareChanges();
+    void updateCodecThreads_keepsCount_whenChangeIsBelowMinimum();
+    void acquireThread_balancesLoadByPriority();
+};
+
+void tst_QFFmpegPlaybackScheduler::acquireCodecThreads_splitsBudgetByPriority()
+{
+    auto scheduler = std::make_shared<PlaybackScheduler>(1, 14);
+
+    TestCodec high;
+    high.open(*scheduler, Priority::High);
+    QCOMPARE(high.threads(), 14);
+
+    TestCodec normal;
+    normal.open(*scheduler, Priority::Normal);
+    QCOMPARE(normal.threads(), 4);
+    QCOMPARE(high.notifications, 1);
+
+    TestCodec low;
+    low.open(*scheduler, Priority::Low);
+    QCOMPARE(low.threads(), 2);
+    QCOMPARE(normal.notifications, 0);
+
+    // the weights are 4:2:1
+    QVERIFY(high.reopen(*scheduler));
+    QCOMPARE(high.threads(), 8);
+    QVERIFY(!normal.reopen(*scheduler));
+    QCOMPARE(normal.threads(), 4);
+    QVERIFY(!low.reopen(*scheduler));
+
+    QCOMPARE(high.threads() + normal.threads() + low.threads(), 14);
+}
+
+void tst_QFFmpegPlaybackScheduler::acquireCodecThreads_rebalancesCodecs_whenCodecIsReleased()
+{
+    auto scheduler = std::make_shared<PlaybackScheduler>(1, 14);
+
+    TestCodec high;
+    TestCodec normal;
+    TestCodec low;
+    high.open(*scheduler, Priority::High);
+    normal.open(*scheduler, Priority::Normal);
+    low.open(*scheduler, Priority::Low);
+    high.reopen(*scheduler);
+
+    high.lease = {};
+
+    QCOMPARE(normal.notifications, 1);
+    QCOMPARE(low.notifications, 1);
+
+    QVERIFY(normal.reopen(*scheduler));
+    QVERIFY(low.reopen(*scheduler));
+    QCOMPARE(normal.threads(), 9);
+    QCOMPARE(low.threads(), 4);
+
+    // the shares don't change any more, so the codecs are not notified
+    QVERIFY(!normal.reopen(*scheduler));
+    QCOMPARE(normal.notifications, 0);
+    QCOMPARE(low.notifications, 0);
+}
+
+void tst_QFFmpegPlaybackScheduler::acquireCodecThreads_givesOneThreadPerCodec_whenBudgetIsExhausted()
+{
+    auto scheduler = std::make_shared<PlaybackScheduler>(1, 2);
+
+    std::array<TestCodec, 3> codecs;
+    for (auto &codec : codecs)
+        codec.open(*scheduler, Priority::Normal);
+
+    for (auto &codec : codecs) {
+        codec.reopen(*scheduler);
+        QCOMPARE(codec.threads(), 1);
+    }
+}
+
+void tst_QFFmpegPlaybackScheduler::acquireCodecThreads_letsCallbackUpdateLease_whenShareChanges()
+{
+    auto scheduler = std::make_shared<PlaybackScheduler>(1, 6);
+
+    // the callback is invoked without the scheduler locked
+    PlaybackScheduler::Lease first;
+    int updates = 0;
+    first = scheduler->acquireCodecThreads(Priority::Normal, [&]() {
+        if (scheduler->updateCodecThreads(first))
+            ++updates;
+    });
+    QCOMPARE(first.codecThreadsCount(), 6);
+
+    TestCodec second;
+    second.open(*scheduler, Priority::Normal);
+    QCOMPARE(updates, 1);
+    QCOMPARE(first.codecThreadsCount(), 3);
+    QCOMPARE(second.threads(), 3);
+
+    second.lease = {};
+    QCOMPARE(updates, 2);
+    QCOMPARE(first.codecThreadsCount(), 6);
+}
+
+void tst_QFFmpegPlaybackScheduler::updateCodecThreads_keepsCount_whenChangeIsBelowMinimum()
+{
+    auto scheduler = std::make_shared<PlaybackScheduler>(1, 8);
+
+    TestCodec normal;
+    normal.open(*scheduler, Priority::Normal);
+    QCOMPARE(normal.threads(), 8);
+
+    // the weights are 2:1, so the share goes down from 8 to 5
+    TestCodec low;
+    low.open(*scheduler, Priority::Low);
+    QCOMPARE(normal.notifications, 1);
+    QVERIFY(!scheduler->updateCodecThreads(normal.lease, 0.5));
+    QCOMPARE(normal.threads(), 8);
+
+    // small changes are taken without the minimum
+    QVERIFY(normal.reopen(*scheduler));
+    QCOMPARE(normal.threads(), 5);
+
+    // the weights are 2:1:4, so the share goes down from 5 to 2
+    TestCodec high;
+    high.open(*scheduler, Priority::High);
+    QVERIFY(scheduler->updateCodecThreads(normal.lease, 0.5));
+    QCOMPARE(normal.threads(), 2);
+}
+
+void tst_QFFmpegPlaybackScheduler::acquireThread_balancesLoadByPriority()
+{
+    auto scheduler = std::make_shared<PlaybackScheduler>(2, 1);
+
+    auto high = scheduler->acquireThread(Priority::High);
+    QVERIFY(high.thread());
+    QVERIFY(high.thread()->isRunning());
+
+    // a new thread is started as the first one is busy
+    auto low1 = scheduler->acquireThread(Priority::Low);
+    QVERIFY(low1.thread());
+    QCOMPARE_NE(low1.thread(), high.thread());
+
+    // a high priority object weighs as much as two low and one normal priority objects
+    auto low2 = scheduler->acquireThread(Priority::Low);
+    QCOMPARE(low2.thread(), low1.thread());
+    auto normal = scheduler->acquireThread(Priority::Normal);
+    QCOMPARE(normal.thread(), low1.thread());
+
+    // the number of threads is limited, and the loads are equal now
+    QThread *secondThread = low1.thread();
+    normal = {};
+    auto other = scheduler->acquireThread(Priority::Normal);
+    QCOMPARE(other.thread(), secondThread);
+
+    // released objects don't count as the load
+    other = {};
+    low1 = {};
+    low2 = {};
+    other = scheduler->acquireThread(Priority::High);
+    QCOMPARE(other.thread(), secondThread);
+}
+
+QTEST_GUILESS_MAIN(tst_QFFmpegPlaybackScheduler)
+
+#include "tst_qffmpegplaybackscheduler.moc"
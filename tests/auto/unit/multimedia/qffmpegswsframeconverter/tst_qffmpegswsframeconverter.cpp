@@ -0,0 +1,108 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+
+#include "qffmpegswsframeconverter_p.h"
+
+QT_USE_NAMESPACE
+
+using QFFmpeg::SwsFrameConverter;
+
+namespace {
+
+// Returns a gray YUV420P frame, as a software decoder outputs it
+QFFmpeg::AVFrameUPtr createDecodedFrame(QSize size)
+{
+    auto frame = QFFmpeg::makeAVFrame();
+    frame->width = size.width();
+    frame->height = size.height();
+    frame->format = AV_PIX_FMT_YUV420P;
+    if (av_frame_get_buffer(frame.get(), 0) < 0)
+        return {};
+
+    const int planeHeights[] = { size.height(), size.height() / 2, size.height() / 2 };
+    for (int plane = 0; plane < 3; ++plane)
+        memset(frame->data[plane], 0x80, frame->linesize[plane] * planeHeights[plane]);
+    return frame;
+}
+
+} // namespace
+
+class tst_QFFmpegSwsFrameConverter : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void convert_reusesScalerContext_forFramesOfOneStream();
+    void convert_createsScalerContext_perSizeAndFormat();
+    void convert_recreatesLeastRecentlyUsedContext_whenCacheIsFull();
+};
+
+void tst_QFFmpegSwsFrameConverter::convert_reusesScalerContext_forFramesOfOneStream()
+{
+    auto &converter = SwsFrameConverter::instance();
+    const quint64 conversions = SwsFrameConverter::conversionCount();
+    const quint64 contexts = SwsFrameConverter::contextCount();
+
+    constexpr int Frames = 5;
+    for (int i = 0; i < Frames; ++i) {
+        const auto source = createDecodedFrame({ 64, 48 });
+        QVERIFY(source);
+
+        const auto converted = converter.convert(*source, { 64, 48 }, AV_PIX_FMT_BGRA);
+        QVERIFY(converted);
+        QCOMPARE(converted->width, 64);
+        QCOMPARE(converted->height, 48);
+        QCOMPARE(AVPixelFormat(converted->format), AV_PIX_FMT_BGRA);
+
+        QCOMPARE(SwsFrameConverter::conversionCount(), conversions + i + 1);
+        QCOMPARE(SwsFrameConverter::contextCount(), contexts + 1);
+    }
+}
+
+void tst_QFFmpegSwsFrameConverter::convert_createsScalerContext_perSizeAndFormat()
+{
+    auto &converter = SwsFrameConverter::instance();
+    const auto source = createDecodedFrame({ 64, 48 });
+    QVERIFY(source);
+
+    // a context of the previous test may be cached
+    QVERIFY(converter.convert(*source, { 64, 48 }, AV_PIX_FMT_NV12));
+    const quint64 contexts = SwsFrameConverter::contextCount();
+
+    QVERIFY(converter.convert(*source, { 32, 24 }, AV_PIX_FMT_NV12));
+    QCOMPARE(SwsFrameConverter::contextCount(), contexts + 1);
+
+    QVERIFY(converter.convert(*source, { 64, 48 }, AV_PIX_FMT_RGBA));
+    QCOMPARE(SwsFrameConverter::contextCount(), contexts + 2);
+
+    // both are cached now
+    QVERIFY(converter.convert(*source, { 32, 24 }, AV_PIX_FMT_NV12));
+    QVERIFY(converter.convert(*source, { 64, 48 }, AV_PIX_FMT_NV12));
+    QCOMPARE(SwsFrameConverter::contextCount(), contexts + 2);
+}
+
+void tst_QFFmpegSwsFrameConverter::convert_recreatesLeastRecentlyUsedContext_whenCacheIsFull()
+{
+    auto &converter = SwsFrameConverter::instance();
+    const auto source = createDecodedFrame({ 64, 48 });
+    QVERIFY(source);
+
+    // more target sizes than the cache holds
+    const QSize sizes[] = { { 16, 12 }, { 24, 18 }, { 40, 30 }, { 48, 36 }, { 56, 42 } };
+    const quint64 contexts = SwsFrameConverter::contextCount();
+    for (QSize size : sizes)
+        QVERIFY(converter.convert(*source, size, AV_PIX_FMT_BGRA));
+    QCOMPARE(SwsFrameConverter::contextCount(), contexts + 5);
+
+    // the last four are cached, the first one was evicted
+    QVERIFY(converter.convert(*source, sizes[4], AV_PIX_FMT_BGRA));
+    QCOMPARE(SwsFrameConverter::contextCount(), contexts + 5);
+    QVERIFY(converter.convert(*source, sizes[0], AV_PIX_FMT_BGRA));
+    QCOMPARE(SwsFrameConverter::contextCount(), contexts + 6);
+}
+
+QTEST_GUILESS_MAIN(tst_QFFmpegSwsFrameConverter)
+
+#include "tst_qffmpegswsframeconverter.moc"
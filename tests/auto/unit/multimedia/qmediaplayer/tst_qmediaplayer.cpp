@@ -64,6 +64,7 @@ private slots:
     void testDuration();
     void testPosition_data();
     void testPosition();
+    void testSeek();
     void testVolume_data();
     void testVolume();
     void testMuted_data();
@@ -75,6 +76,8 @@ private slots:
     void testBufferStatus();
     void testSeekable_data();
     void testSeekable();
+    void testBufferedTimeRange();
+    void testBufferingPolicy();
     void testPlaybackRate_data();
     void testPlaybackRate();
     void testError_data();
@@ -329,6 +332,30 @@ void tst_QMediaPlayer::testPosition()
     }
 }
 
+void tst_QMediaPlayer::testSeek()
+{
+    // setPosition must stay unambiguous for the pointer-to-member connect syntax
+    static_assert(std::is_member_function_pointer_v<decltype(&QMediaPlayer::setPosition)>);
+
+    mockPlayer->setSeekable(true);
+
+    player->seek(1000, QMediaPlayer::FastSeek);
+    QVERIFY(mockPlayer->m_seekMode);
+    QCOMPARE(*mockPlayer->m_seekMode, QMediaPlayer::FastSeek);
+    QCOMPARE(player->position(), qint64(1000));
+
+    player->seek(2000, QMediaPlayer::AccurateSeek);
+    QVERIFY(mockPlayer->m_seekMode);
+    QCOMPARE(*mockPlayer->m_seekMode, QMediaPlayer::AccurateSeek);
+    QCOMPARE(player->position(), qint64(2000));
+
+    mockPlayer->m_seekMode.reset();
+    mockPlayer->setSeekable(false);
+    player->seek(3000, QMediaPlayer::FastSeek);
+    QVERIFY(!mockPlayer->m_seekMode);
+    QCOMPARE(player->position(), qint64(2000));
+}
+
 void tst_QMediaPlayer::testVolume_data()
 {
     setupCommonTestData();
@@ -430,6 +457,60 @@ void tst_QMediaPlayer::testSeekable()
     QVERIFY(player->isSeekable() == seekable);
 }
 
+void tst_QMediaPlayer::testBufferedTimeRange()
+{
+    mockPlayer->setSeekRange(1000, 5000);
+    QCOMPARE(player->bufferedTimeRange(), QMediaTimeRange(1000, 5000));
+}
+
+void tst_QMediaPlayer::testBufferingPolicy()
+{
+    using namespace std::chrono_literals;
+
+    QPlatformMediaPlayer::BufferingPolicy policy;
+    policy.maxDuration = 30s;
+    policy.maxSize = 256 * 1024 * 1024;
+    policy.lowWatermark = 2s;
+    policy.highWatermark = 10s;
+
+    QPlatformMediaPlayer::setBufferingPolicy(player, policy);
+    QVERIFY(mockPlayer->m_bufferingPolicy == policy);
+
+    // invalid policies are ignored
+    const auto checkIgnored = [&](QPlatformMediaPlayer::BufferingPolicy invalidPolicy) {
+        QVERIFY(!invalidPolicy.isValid());
+        QTest::ignoreMessage(QtWarningMsg,
+                             QRegularExpression("Ignoring invalid buffering policy"));
+        QPlatformMediaPlayer::setBufferingPolicy(player, invalidPolicy);
+        QVERIFY(mockPlayer->m_bufferingPolicy == policy);
+    };
+
+    auto invalidPolicy = policy;
+    invalidPolicy.maxDuration = -1s;
+    checkIgnored(invalidPolicy);
+
+    invalidPolicy = policy;
+    invalidPolicy.maxSize = 0;
+    checkIgnored(invalidPolicy);
+
+    invalidPolicy = policy;
+    invalidPolicy.lowWatermark = -1s;
+    checkIgnored(invalidPolicy);
+
+    invalidPolicy = policy;
+    invalidPolicy.highWatermark = 31s;
+    checkIgnored(invalidPolicy);
+
+    invalidPolicy = policy;
+    invalidPolicy.lowWatermark = 11s;
+    checkIgnored(invalidPolicy);
+
+    QVERIFY(QPlatformMediaPlayer::BufferingPolicy{}.isValid());
+
+    // doesn't crash
+    QPlatformMediaPlayer::setBufferingPolicy(nullptr, policy);
+}
+
 void tst_QMediaPlayer::testPlaybackRate_data()
 {
     setupCommonTestData();
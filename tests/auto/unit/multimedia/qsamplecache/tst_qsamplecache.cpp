@@ -4,6 +4,7 @@
 //TESTED_COMPONENT=src/multimedia
 
 #include <QtTest/QtTest>
+#include <QtMultimedia/qaudiodecoder.h>
 #include <private/qsamplecache_p.h>
 
 class tst_QSampleCache : public QObject
@@ -19,6 +20,10 @@ private slots:
     void testEnoughCapacity();
     void testNotEnoughCapacity();
     void testInvalidFile();
+    void testTargetFormat();
+    void testCompressedSample();
+    void testParallelLoading();
+    void testStatistics();
 
 private:
 
@@ -141,6 +146,97 @@ void tst_QSampleCache::testInvalidFile()
     QVERIFY(!cache.isCached(QUrl::fromLocalFile("invalid")));
 }
 
+void tst_QSampleCache::testTargetFormat()
+{
+    QSampleCache cache;
+
+    // the format of test.wav, except for the sample format
+    QAudioFormat format;
+    format.setSampleRate(44100);
+    format.setChannelCount(1);
+    format.setSampleFormat(QAudioFormat::Float);
+
+    QSample* sample = cache.requestSample(QUrl::fromLocalFile(QFINDTESTDATA("testdata/test.wav")), format);
+    QVERIFY(sample);
+    QTRY_COMPARE(sample->state(), QSample::Ready);
+    QCOMPARE(sample->format(), format);
+    QCOMPARE(sample->data().size(), 44094 * qsizetype(sizeof(float)));
+
+    sample->release();
+}
+
+void tst_QSampleCache::testCompressedSample()
+{
+    if (!QAudioDecoder().isSupported())
+        QSKIP("No audio decoder available");
+
+    QSampleCache cache;
+
+    QSample* sample = cache.requestSample(QUrl::fromLocalFile(QFINDTESTDATA("testdata/nokia-tune.mp3")));
+    QVERIFY(sample);
+    QTRY_VERIFY_WITH_TIMEOUT(sample->state() != QSample::Loading, 10000);
+    QCOMPARE(sample->state(), QSample::Ready);
+    QVERIFY(sample->format().isValid());
+    QVERIFY(sample->format().durationForBytes(sample->data().size()) > 1000000);
+
+    sample->release();
+}
+
+void tst_QSampleCache::testParallelLoading()
+{
+    QSampleCache cache;
+
+    const QUrl urls[] = {
+        QUrl::fromLocalFile(QFINDTESTDATA("testdata/test.wav")),
+        QUrl::fromLocalFile(QFINDTESTDATA("testdata/test2.wav")),
+        QUrl::fromLocalFile("invalid"),
+    };
+
+    QList<QSample*> samples;
+    for (const QUrl &url : urls)
+        samples.append(cache.requestSample(url));
+
+    QTRY_VERIFY(!cache.isLoading());
+    QCOMPARE(samples[0]->state(), QSample::Ready);
+    QCOMPARE(samples[1]->state(), QSample::Ready);
+    QCOMPARE(samples[2]->state(), QSample::Error);
+    QCOMPARE(samples[0]->data(), samples[1]->data());
+
+    for (QSample* sample : samples)
+        sample->release();
+}
+
+void tst_QSampleCache::testStatistics()
+{
+    QSampleCache cache;
+    cache.setCapacity(1024 * 1024);
+
+    const QUrl url = QUrl::fromLocalFile(QFINDTESTDATA("testdata/test.wav"));
+    QSample* sample = cache.requestSample(url);
+    QTRY_COMPARE(sample->state(), QSample::Ready);
+    QSample* sampleCached = cache.requestSample(url);
+    QCOMPARE(sample, sampleCached);
+
+    QSample* sampleInvalid = cache.requestSample(QUrl::fromLocalFile("invalid"));
+    QTRY_COMPARE(sampleInvalid->state(), QSample::Error);
+    QTRY_VERIFY(!cache.isLoading());
+
+    const QSampleCache::Statistics statistics = cache.statistics();
+    QCOMPARE(statistics.requests, qint64(3));
+    QCOMPARE(statistics.hits, qint64(1));
+    QCOMPARE(statistics.hitRate(), 1. / 3);
+    QCOMPARE(statistics.loadedSamples, qint64(1));
+    QCOMPARE(statistics.failedSamples, qint64(1));
+    QCOMPARE(statistics.decodedBytes, sample->data().size());
+    QCOMPARE(statistics.usage, sample->data().size());
+    QCOMPARE(statistics.capacity, qint64(1024 * 1024));
+    QVERIFY(statistics.averageLoadingTime() > std::chrono::nanoseconds{ 0 });
+
+    sample->release();
+    sampleCached->release();
+    sampleInvalid->release();
+}
+
 QTEST_MAIN(tst_QSampleCache)
 
 #include "tst_qsamplecache.moc"
@@ -8,6 +8,7 @@
 #include <qvideoframe.h>
 #include <qvideoframeformat.h>
 #include "private/qmemoryvideobuffer_p.h"
+#include "private/qvideoframeconverter_p.h"
 #include <QtGui/QImage>
 #include <QtCore/QPointer>
 #include <QtMultimedia/private/qtmultimedia-config_p.h>
@@ -60,6 +61,18 @@ private slots:
     void image_data();
     void image();
 
+    void toImage_appliesRotationAndMirroring_data();
+    void toImage_appliesRotationAndMirroring();
+
+    void toImage_appliesColorRange_data();
+    void toImage_appliesColorRange();
+
+    void toImage_appliesHdrTransfer_data();
+    void toImage_appliesHdrTransfer();
+
+    void qImageFromVideoFrame_convertsConsecutiveFramesIndependently();
+    void qImageFromVideoFrameAsync_returnsSameImageAsBlockingConversion();
+
     void emptyData();
 };
 
@@ -977,6 +990,198 @@ void tst_QVideoFrame::image()
     QCOMPARE(img.size(), size);
 }
 
+static QVideoFrame createPatternFrame(QSize size, QVideoFrameFormat::PixelFormat pixelFormat)
+{
+    QVideoFrame frame(QVideoFrameFormat(size, pixelFormat));
+    if (!frame.map(QVideoFrame::WriteOnly))
+        return {};
+
+    for (int plane = 0; plane < frame.planeCount(); ++plane) {
+        uchar *data = frame.bits(plane);
+        for (int i = 0; i < frame.mappedBytes(plane); ++i)
+            data[i] = uchar(i * 13 + (i >> 10) + plane);
+    }
+
+    frame.unmap();
+    return frame;
+}
+
+void tst_QVideoFrame::toImage_appliesRotationAndMirroring_data()
+{
+    QTest::addColumn<QtVideo::Rotation>("rotation");
+    QTest::addColumn<bool>("mirrored");
+
+    for (const QtVideo::Rotation rotation :
+         { QtVideo::Rotation::None, QtVideo::Rotation::Clockwise90,
+           QtVideo::Rotation::Clockwise180, QtVideo::Rotation::Clockwise270 }) {
+        for (const bool mirrored : { false, true })
+            QTest::addRow("%d%s", int(rotation), mirrored ? "_mirrored" : "")
+                    << rotation << mirrored;
+    }
+}
+
+void tst_QVideoFrame::toImage_appliesRotationAndMirroring()
+{
+    QFETCH(const QtVideo::Rotation, rotation);
+    QFETCH(const bool, mirrored);
+
+    // large enough for the CPU conversion to be split into several stripes
+    const QSize size(640, 482);
+    const QVideoFrame frame = createPatternFrame(size, QVideoFrameFormat::Format_BGRX8888);
+    QVideoFrame transformedFrame = createPatternFrame(size, QVideoFrameFormat::Format_BGRX8888);
+    transformedFrame.setRotation(rotation);
+    transformedFrame.setMirrored(mirrored);
+
+    QTransform transform;
+    if (mirrored)
+        transform.scale(-1, 1);
+    transform.rotate(qToUnderlying(rotation));
+    const QImage expected =
+            frame.toImage().transformed(transform).convertToFormat(QImage::Format_RGB32);
+
+    const QImage actual = transformedFrame.toImage().convertToFormat(QImage::Format_RGB32);
+
+    QCOMPARE(actual.size(), expected.size());
+    QCOMPARE(actual, expected);
+}
+
+void tst_QVideoFrame::toImage_appliesColorRange_data()
+{
+    QTest::addColumn<QVideoFrameFormat::ColorSpace>("colorSpace");
+    QTest::addColumn<QVideoFrameFormat::ColorRange>("colorRange");
+    QTest::addColumn<int>("luma");
+    QTest::addColumn<int>("expectedGray");
+
+    for (const QVideoFrameFormat::ColorSpace colorSpace :
+         { QVideoFrameFormat::ColorSpace_BT601, QVideoFrameFormat::ColorSpace_BT709,
+           QVideoFrameFormat::ColorSpace_BT2020 }) {
+        const auto addRow = [colorSpace](QVideoFrameFormat::ColorRange colorRange, int luma,
+                                         int expectedGray) {
+            QTest::addRow("%d_%s_%d", int(colorSpace),
+                          colorRange == QVideoFrameFormat::ColorRange_Full ? "full" : "video",
+                          luma)
+                    << colorSpace << colorRange << luma << expectedGray;
+        };
+        addRow(QVideoFrameFormat::ColorRange_Video, 16, 0);
+        addRow(QVideoFrameFormat::ColorRange_Video, 235, 255);
+        addRow(QVideoFrameFormat::ColorRange_Full, 0, 0);
+        addRow(QVideoFrameFormat::ColorRange_Full, 128, 128);
+        addRow(QVideoFrameFormat::ColorRange_Full, 255, 255);
+    }
+}
+
+void tst_QVideoFrame::toImage_appliesColorRange()
+{
+    QFETCH(const QVideoFrameFormat::ColorSpace, colorSpace);
+    QFETCH(const QVideoFrameFormat::ColorRange, colorRange);
+    QFETCH(const int, luma);
+    QFETCH(const int, expectedGray);
+
+    QVideoFrameFormat format(QSize(64, 16), QVideoFrameFormat::Format_NV12);
+    format.setColorSpace(colorSpace);
+    format.setColorRange(colorRange);
+    QVideoFrame frame(format);
+    QVERIFY(frame.map(QVideoFrame::WriteOnly));
+    memset(frame.bits(0), luma, frame.mappedBytes(0));
+    memset(frame.bits(1), 128, frame.mappedBytes(1));
+    frame.unmap();
+
+    const QImage image = frame.toImage().convertToFormat(QImage::Format_RGB32);
+    QCOMPARE(image.size(), format.frameSize());
+
+    for (const QPoint point : { QPoint(0, 0), QPoint(31, 7), QPoint(63, 15) }) {
+        const QRgb pixel = image.pixel(point);
+        QCOMPARE_LE(qAbs(qRed(pixel) - expectedGray), 1);
+        QCOMPARE_LE(qAbs(qGreen(pixel) - expectedGray), 1);
+        QCOMPARE_LE(qAbs(qBlue(pixel) - expectedGray), 1);
+    }
+}
+
+void tst_QVideoFrame::qImageFromVideoFrame_convertsConsecutiveFramesIndependently()
+{
+    // Frames of the same format and size share cached conversion resources
+    const QSize size(64, 48);
+    const QVideoFrame patternFrame = createPatternFrame(size, QVideoFrameFormat::Format_NV12);
+
+    QVideoFrame grayFrame(QVideoFrameFormat(size, QVideoFrameFormat::Format_NV12));
+    QVERIFY(grayFrame.map(QVideoFrame::WriteOnly));
+    memset(grayFrame.bits(0), 126, grayFrame.mappedBytes(0));
+    memset(grayFrame.bits(1), 128, grayFrame.mappedBytes(1));
+    grayFrame.unmap();
+
+    const QImage first = qImageFromVideoFrame(patternFrame).convertToFormat(QImage::Format_RGB32);
+    const QImage second = qImageFromVideoFrame(grayFrame).convertToFormat(QImage::Format_RGB32);
+    const QImage third = qImageFromVideoFrame(patternFrame).convertToFormat(QImage::Format_RGB32);
+
+    QCOMPARE(first.size(), size);
+    QCOMPARE_NE(first, second);
+    QCOMPARE(second.pixel(10, 10), second.pixel(50, 40));
+    QCOMPARE(third, first);
+}
+
+void tst_QVideoFrame::qImageFromVideoFrameAsync_returnsSameImageAsBlockingConversion()
+{
+    const QVideoFrame frame = createPatternFrame(QSize(64, 48), QVideoFrameFormat::Format_YUV420P);
+
+    QFuture<QImage> future = qImageFromVideoFrameAsync(frame, QtVideo::Rotation::Clockwise90);
+    QVERIFY(future.isValid());
+    future.waitForFinished();
+    QVERIFY(future.isResultReadyAt(0));
+
+    const QImage expected = qImageFromVideoFrame(frame, QtVideo::Rotation::Clockwise90);
+    QCOMPARE(future.result().convertToFormat(QImage::Format_RGB32),
+             expected.convertToFormat(QImage::Format_RGB32));
+}
+
+void tst_QVideoFrame::toImage_appliesHdrTransfer_data()
+{
+    QTest::addColumn<QVideoFrameFormat::ColorTransfer>("colorTransfer");
+    QTest::addColumn<float>("signal");
+    QTest::addColumn<int>("expectedGray");
+    QTest::addColumn<int>("tolerance");
+
+    // The gray levels stay below the knee of the tone mapping, and are converted to
+    // sRGB with gamma 2.2 like in the shaders.
+    // PQ signal of 5 nits (ST 2084), 5% of the SDR level. The curve is steep there, which
+    // amplifies the rounding of the color matrix.
+    QTest::addRow("PQ") << QVideoFrameFormat::ColorTransfer_ST2084 << 0.247848f
+                        << qRound(255 * std::pow(0.05, 1 / 2.2)) << 4;
+    // HLG signal of 1/12 linear scene light (BT.2100), with the system gamma of 1.2
+    QTest::addRow("HLG") << QVideoFrameFormat::ColorTransfer_STD_B67 << 0.5f
+                         << qRound(255 * std::pow(std::pow(1. / 12, 1.2), 1 / 2.2)) << 2;
+}
+
+void tst_QVideoFrame::toImage_appliesHdrTransfer()
+{
+    QFETCH(const QVideoFrameFormat::ColorTransfer, colorTransfer);
+    QFETCH(const float, signal);
+    QFETCH(const int, expectedGray);
+    QFETCH(const int, tolerance);
+
+    QVideoFrameFormat format(QSize(64, 16), QVideoFrameFormat::Format_P010);
+    format.setColorSpace(QVideoFrameFormat::ColorSpace_BT2020);
+    format.setColorRange(QVideoFrameFormat::ColorRange_Video);
+    format.setColorTransfer(colorTransfer);
+    QVideoFrame frame(format);
+    QVERIFY(frame.map(QVideoFrame::WriteOnly));
+    // 10 bit video range values in the upper bits
+    const quint16 luma = quint16(qRound(64 + 876 * signal) << 6);
+    const quint16 chroma = quint16(512 << 6);
+    std::fill_n(reinterpret_cast<quint16 *>(frame.bits(0)), frame.mappedBytes(0) / 2, luma);
+    std::fill_n(reinterpret_cast<quint16 *>(frame.bits(1)), frame.mappedBytes(1) / 2, chroma);
+    frame.unmap();
+
+    const QImage image = frame.toImage().convertToFormat(QImage::Format_RGB32);
+    QCOMPARE(image.size(), format.frameSize());
+
+    for (const QPoint point : { QPoint(0, 0), QPoint(31, 7), QPoint(63, 15) }) {
+        const QRgb pixel = image.pixel(point);
+        QCOMPARE_LE(qAbs(qRed(pixel) - expectedGray), tolerance);
+        QCOMPARE_LE(qAbs(qGreen(pixel) - expectedGray), tolerance);
+        QCOMPARE_LE(qAbs(qBlue(pixel) - expectedGray), tolerance);
+    }
+}
+
 void tst_QVideoFrame::emptyData()
 {
     QByteArray data(nullptr, 0);
@@ -253,6 +253,51 @@ private slots:
             QVERIFY(fuzzyCompareWithTolerance(actualBlackRgb, expectedBlackRgb, 5e-4f));
         }
     }
+
+    void convertPQ_matchesReferenceValues_data()
+    {
+        QTest::addColumn<float>("nits");
+        QTest::addColumn<float>("signal");
+
+        // ITU-R BT.2100 and BT.2408; linear PQ values are relative to 100 nits
+        QTest::addRow("0.1 nits") << 0.1f << 0.062337f;
+        QTest::addRow("SDR level") << 100.f << 0.508078f;
+        QTest::addRow("HDR reference white") << 203.f << 0.580689f;
+        QTest::addRow("1000 nits") << 1000.f << 0.751827f;
+        QTest::addRow("peak") << 10000.f << 1.f;
+    }
+
+    void convertPQ_matchesReferenceValues()
+    {
+        QFETCH(const float, nits);
+        QFETCH(const float, signal);
+
+        QCOMPARE_LE(qAbs(QVideoTextureHelper::convertPQFromLinear(nits / 100.f) - signal), 1e-4f);
+        QCOMPARE_LE(qAbs(QVideoTextureHelper::convertPQToLinear(signal) * 100.f / nits - 1.f),
+                    2e-3f);
+    }
+
+    void convertHLG_matchesReferenceValues_data()
+    {
+        QTest::addColumn<float>("linear");
+        QTest::addColumn<float>("signal");
+
+        // ITU-R BT.2100 Table 5
+        QTest::addRow("black") << 0.f << 0.f;
+        QTest::addRow("1/12") << 1.f / 12.f << 0.5f;
+        QTest::addRow("0.25") << 0.25f << 0.738549f;
+        QTest::addRow("0.5") << 0.5f << 0.871643f;
+        QTest::addRow("peak") << 1.f << 1.f;
+    }
+
+    void convertHLG_matchesReferenceValues()
+    {
+        QFETCH(const float, linear);
+        QFETCH(const float, signal);
+
+        QCOMPARE_LE(qAbs(QVideoTextureHelper::convertHLGFromLinear(linear) - signal), 1e-4f);
+        QCOMPARE_LE(qAbs(QVideoTextureHelper::convertHLGToLinear(signal) - linear), 1e-4f);
+    }
 };
 
 QTEST_MAIN(tst_qvideotexturehelper)
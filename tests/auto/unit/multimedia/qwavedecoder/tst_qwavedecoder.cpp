@@ -4,6 +4,9 @@
 //TESTED_COMPONENT=src/multimedia
 
 #include <QtTest/QtTest>
+#include <QtCore/qbuffer.h>
+#include <QtCore/qendian.h>
+#include <QtCore/qtemporaryfile.h>
 #include <qwavedecoder.h>
 
 #include <QNetworkAccessManager>
@@ -40,6 +43,17 @@ private slots:
 
     void readAllAtOnce();
     void readPerByte();
+
+    void read24Bit_data();
+    void read24Bit();
+
+    void readFloat_data();
+    void readFloat();
+
+private:
+    QIODevice *openDevice(const QByteArray &data, bool mapped);
+
+    std::unique_ptr<QIODevice> m_device;
 };
 
 void tst_QWaveDecoder::init()
@@ -48,6 +62,7 @@ void tst_QWaveDecoder::init()
 
 void tst_QWaveDecoder::cleanup()
 {
+    m_device.reset();
 }
 
 void tst_QWaveDecoder::initTestCase()
@@ -64,6 +79,67 @@ static QString testFilePath(const char *filename)
     return QFINDTESTDATA(path);
 }
 
+// Creates a mono wave file with the samples; the WAVE_FORMAT_EXTENSIBLE header
+// has the audio format as its sub format.
+static QByteArray createWave(quint16 audioFormat, bool extensible, int bitsPerSample,
+                             const QByteArray &samples, bool bigEndian = false)
+{
+    QByteArray wave;
+    const auto append16 = [&](quint16 value) {
+        char bytes[2];
+        bigEndian ? qToBigEndian(value, bytes) : qToLittleEndian(value, bytes);
+        wave.append(bytes, 2);
+    };
+    const auto append32 = [&](quint32 value) {
+        char bytes[4];
+        bigEndian ? qToBigEndian(value, bytes) : qToLittleEndian(value, bytes);
+        wave.append(bytes, 4);
+    };
+
+    const int blockAlign = bitsPerSample / 8;
+    const quint32 fmtSize = extensible ? 40 : 16;
+
+    wave.append(bigEndian ? "RIFX" : "RIFF");
+    append32(4 + 8 + fmtSize + 8 + samples.size());
+    wave.append("WAVEfmt ");
+    append32(fmtSize);
+    append16(extensible ? 0xFFFE : audioFormat);
+    append16(1);
+    append32(48000);
+    append32(48000 * blockAlign);
+    append16(blockAlign);
+    append16(bitsPerSample);
+    if (extensible) {
+        append16(22);
+        append16(bitsPerSample);
+        append32(0x4); // front center
+        append32(audioFormat);
+        wave.append("\x00\x00\x10\x00\x80\x00\x00\xaa\x00\x38\x9b\x71", 12);
+    }
+    wave.append("data");
+    append32(samples.size());
+    wave.append(samples);
+    return wave;
+}
+
+QIODevice *tst_QWaveDecoder::openDevice(const QByteArray &data, bool mapped)
+{
+    // the decoder maps files, and reads other devices
+    if (mapped) {
+        auto file = std::make_unique<QTemporaryFile>();
+        if (!file->open() || file->write(data) != data.size() || !file->seek(0))
+            return nullptr;
+        m_device = std::move(file);
+    } else {
+        auto buffer = std::make_unique<QBuffer>();
+        buffer->setData(data);
+        if (!buffer->open(QIODevice::ReadOnly))
+            return nullptr;
+        m_device = std::move(buffer);
+    }
+    return m_device.get();
+}
+
 void tst_QWaveDecoder::file_data()
 {
     QTest::addColumn<QString>("file");
@@ -71,33 +147,32 @@ void tst_QWaveDecoder::file_data()
     QTest::addColumn<int>("channels");
     QTest::addColumn<int>("samplesize");
     QTest::addColumn<int>("samplerate");
-    QTest::addColumn<QAudioFormat::Endian>("byteorder");
-
-    QTest::newRow("File is empty")  << testFilePath("empty.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("File is one byte")  << testFilePath("onebyte.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("File is not a wav(text)")  << testFilePath("notawav.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("Wav file has no sample data")  << testFilePath("nosampledata.wav") << tst_QWaveDecoder::NoSampleData << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("corrupt fmt chunk descriptor")  << testFilePath("corrupt_fmtdesc_1_16_8000.le.wav") << tst_QWaveDecoder::FormatDescriptor << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("corrupt fmt string")  << testFilePath("corrupt_fmtstring_1_16_8000.le.wav") << tst_QWaveDecoder::FormatString << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-    QTest::newRow("corrupt data chunk descriptor")  << testFilePath("corrupt_datadesc_1_16_8000.le.wav") << tst_QWaveDecoder::DataDescriptor << -1 << -1 << -1 << QAudioFormat::LittleEndian;
-
-    QTest::newRow("File isawav_1_8_8000.wav") << testFilePath("isawav_1_8_8000.wav")  << tst_QWaveDecoder::None << 1 << 8 << 8000 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_1_8_44100.wav") << testFilePath("isawav_1_8_44100.wav")  << tst_QWaveDecoder::None << 1 << 8 << 44100 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_2_8_8000.wav") << testFilePath("isawav_2_8_8000.wav")  << tst_QWaveDecoder::None << 2 << 8 << 8000 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_2_8_44100.wav") << testFilePath("isawav_2_8_44100.wav")  << tst_QWaveDecoder::None << 2 << 8 << 44100 << QAudioFormat::LittleEndian;
-
-    QTest::newRow("File isawav_1_16_8000_le.wav") << testFilePath("isawav_1_16_8000_le.wav")  << tst_QWaveDecoder::None << 1 << 16 << 8000 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_1_16_44100_le.wav") << testFilePath("isawav_1_16_44100_le.wav")  << tst_QWaveDecoder::None << 1 << 16 << 44100 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_2_16_8000_be.wav") << testFilePath("isawav_2_16_8000_be.wav")  << tst_QWaveDecoder::None << 2 << 16 << 8000 << QAudioFormat::BigEndian;
-    QTest::newRow("File isawav_2_16_44100_be.wav") << testFilePath("isawav_2_16_44100_be.wav")  << tst_QWaveDecoder::None << 2 << 16 << 44100 << QAudioFormat::BigEndian;
+
+    QTest::newRow("File is empty")  << testFilePath("empty.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1;
+    QTest::newRow("File is one byte")  << testFilePath("onebyte.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1;
+    QTest::newRow("File is not a wav(text)")  << testFilePath("notawav.wav") << tst_QWaveDecoder::NotAWav << -1 << -1 << -1;
+    QTest::newRow("Wav file has no sample data")  << testFilePath("nosampledata.wav") << tst_QWaveDecoder::NoSampleData << -1 << -1 << -1;
+    QTest::newRow("corrupt fmt chunk descriptor")  << testFilePath("corrupt_fmtdesc_1_16_8000.le.wav") << tst_QWaveDecoder::FormatDescriptor << -1 << -1 << -1;
+    QTest::newRow("corrupt fmt string")  << testFilePath("corrupt_fmtstring_1_16_8000.le.wav") << tst_QWaveDecoder::FormatString << -1 << -1 << -1;
+    QTest::newRow("corrupt data chunk descriptor")  << testFilePath("corrupt_datadesc_1_16_8000.le.wav") << tst_QWaveDecoder::DataDescriptor << -1 << -1 << -1;
+
+    QTest::newRow("File isawav_1_8_8000.wav") << testFilePath("isawav_1_8_8000.wav")  << tst_QWaveDecoder::None << 1 << 8 << 8000;
+    QTest::newRow("File isawav_1_8_44100.wav") << testFilePath("isawav_1_8_44100.wav")  << tst_QWaveDecoder::None << 1 << 8 << 44100;
+    QTest::newRow("File isawav_2_8_8000.wav") << testFilePath("isawav_2_8_8000.wav")  << tst_QWaveDecoder::None << 2 << 8 << 8000;
+    QTest::newRow("File isawav_2_8_44100.wav") << testFilePath("isawav_2_8_44100.wav")  << tst_QWaveDecoder::None << 2 << 8 << 44100;
+
+    QTest::newRow("File isawav_1_16_8000_le.wav") << testFilePath("isawav_1_16_8000_le.wav")  << tst_QWaveDecoder::None << 1 << 16 << 8000;
+    QTest::newRow("File isawav_1_16_44100_le.wav") << testFilePath("isawav_1_16_44100_le.wav")  << tst_QWaveDecoder::None << 1 << 16 << 44100;
+    QTest::newRow("File isawav_2_16_8000_be.wav") << testFilePath("isawav_2_16_8000_be.wav")  << tst_QWaveDecoder::None << 2 << 16 << 8000;
+    QTest::newRow("File isawav_2_16_44100_be.wav") << testFilePath("isawav_2_16_44100_be.wav")  << tst_QWaveDecoder::None << 2 << 16 << 44100;
     // The next file has extra data in the wave header.
-    QTest::newRow("File isawav_1_16_44100_le_2.wav") << testFilePath("isawav_1_16_44100_le_2.wav")  << tst_QWaveDecoder::None << 1 << 16 << 44100 << QAudioFormat::LittleEndian;
+    QTest::newRow("File isawav_1_16_44100_le_2.wav") << testFilePath("isawav_1_16_44100_le_2.wav")  << tst_QWaveDecoder::None << 1 << 16 << 44100;
 
-    // 32 bit waves are not supported
-    QTest::newRow("File isawav_1_32_8000_le.wav") << testFilePath("isawav_1_32_8000_le.wav")  << tst_QWaveDecoder::FormatDescriptor << 1 << 32 << 8000 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_1_32_44100_le.wav") << testFilePath("isawav_1_32_44100_le.wav")  << tst_QWaveDecoder::FormatDescriptor << 1 << 32 << 44100 << QAudioFormat::LittleEndian;
-    QTest::newRow("File isawav_2_32_8000_be.wav") << testFilePath("isawav_2_32_8000_be.wav")  << tst_QWaveDecoder::FormatDescriptor << 2 << 32 << 8000 << QAudioFormat::BigEndian;
-    QTest::newRow("File isawav_2_32_44100_be.wav") << testFilePath("isawav_2_32_44100_be.wav")  << tst_QWaveDecoder::FormatDescriptor << 2 << 32 << 44100 << QAudioFormat::BigEndian;
+    // 32 bit waves have the WAVE_FORMAT_EXTENSIBLE format
+    QTest::newRow("File isawav_1_32_8000_le.wav") << testFilePath("isawav_1_32_8000_le.wav")  << tst_QWaveDecoder::None << 1 << 32 << 8000;
+    QTest::newRow("File isawav_1_32_44100_le.wav") << testFilePath("isawav_1_32_44100_le.wav")  << tst_QWaveDecoder::None << 1 << 32 << 44100;
+    QTest::newRow("File isawav_2_32_8000_be.wav") << testFilePath("isawav_2_32_8000_be.wav")  << tst_QWaveDecoder::None << 2 << 32 << 8000;
+    QTest::newRow("File isawav_2_32_44100_be.wav") << testFilePath("isawav_2_32_44100_be.wav")  << tst_QWaveDecoder::None << 2 << 32 << 44100;
 }
 
 void tst_QWaveDecoder::file()
@@ -107,7 +182,6 @@ void tst_QWaveDecoder::file()
     QFETCH(int, channels);
     QFETCH(int, samplesize);
     QFETCH(int, samplerate);
-    QFETCH(QAudioFormat::Endian, byteorder);
 
     QFile stream;
     stream.setFileName(file);
@@ -118,6 +192,7 @@ void tst_QWaveDecoder::file()
     QWaveDecoder waveDecoder(&stream);
     QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
     QSignalSpy parsingErrorSpy(&waveDecoder, SIGNAL(parsingError()));
+    QVERIFY(waveDecoder.open(QIODevice::ReadOnly));
 
     if (corruption == NotAWav) {
         QSKIP("Not all failures detected correctly yet");
@@ -149,11 +224,8 @@ void tst_QWaveDecoder::file()
         QAudioFormat format = waveDecoder.audioFormat();
         QVERIFY(format.isValid());
         QVERIFY(format.channelCount() == channels);
-        QVERIFY(format.sampleSize() == samplesize);
+        QVERIFY(format.bytesPerSample() * 8 == samplesize);
         QVERIFY(format.sampleRate() == samplerate);
-        if (format.sampleSize() != 8) {
-            QVERIFY(format.byteOrder() == byteorder);
-        }
     }
 
     stream.close();
@@ -166,7 +238,6 @@ void tst_QWaveDecoder::http()
     QFETCH(int, channels);
     QFETCH(int, samplesize);
     QFETCH(int, samplerate);
-    QFETCH(QAudioFormat::Endian, byteorder);
 
     QFile stream;
     stream.setFileName(file);
@@ -181,6 +252,7 @@ void tst_QWaveDecoder::http()
     QWaveDecoder waveDecoder(reply);
     QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
     QSignalSpy parsingErrorSpy(&waveDecoder, SIGNAL(parsingError()));
+    QVERIFY(waveDecoder.open(QIODevice::ReadOnly));
 
     if (corruption == NotAWav) {
         QSKIP("Not all failures detected correctly yet");
@@ -212,11 +284,8 @@ void tst_QWaveDecoder::http()
         QAudioFormat format = waveDecoder.audioFormat();
         QVERIFY(format.isValid());
         QVERIFY(format.channelCount() == channels);
-        QVERIFY(format.sampleSize() == samplesize);
+        QVERIFY(format.bytesPerSample() * 8 == samplesize);
         QVERIFY(format.sampleRate() == samplerate);
-        if (format.sampleSize() != 8) {
-            QVERIFY(format.byteOrder() == byteorder);
-        }
     }
 
     delete reply;
@@ -232,6 +301,7 @@ void tst_QWaveDecoder::readAllAtOnce()
 
     QWaveDecoder waveDecoder(&stream);
     QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
+    QVERIFY(waveDecoder.open(QIODevice::ReadOnly));
 
     QTRY_COMPARE(validFormatSpy.count(), 1);
     QVERIFY(waveDecoder.size() > 0);
@@ -258,6 +328,7 @@ void tst_QWaveDecoder::readPerByte()
 
     QWaveDecoder waveDecoder(&stream);
     QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
+    QVERIFY(waveDecoder.open(QIODevice::ReadOnly));
 
     QTRY_COMPARE(validFormatSpy.count(), 1);
     QVERIFY(waveDecoder.size() > 0);
@@ -272,6 +343,108 @@ void tst_QWaveDecoder::readPerByte()
     stream.close();
 }
 
+void tst_QWaveDecoder::read24Bit_data()
+{
+    QTest::addColumn<bool>("extensible");
+    QTest::addColumn<bool>("bigEndian");
+    QTest::addColumn<bool>("mapped");
+
+    QTest::newRow("pcm") << false << false << false;
+    QTest::newRow("pcm, big endian") << false << true << false;
+    QTest::newRow("extensible") << true << false << false;
+    QTest::newRow("pcm, mapped") << false << false << true;
+    QTest::newRow("pcm, big endian, mapped") << false << true << true;
+    QTest::newRow("extensible, mapped") << true << false << true;
+}
+
+void tst_QWaveDecoder::read24Bit()
+{
+    QFETCH(bool, extensible);
+    QFETCH(bool, bigEndian);
+    QFETCH(bool, mapped);
+
+    // enough samples for the vectorized expansion, and some left over,
+    // spread over the whole 24 bit range
+    QList<qint32> samples;
+    for (int i = 0; i < 99; ++i)
+        samples.append(qint32((quint32(i) * 0x2a5a5bu) & 0xffffff) - 0x800000);
+    samples.append({ -0x800000, 0x7fffff, -1, 0, 1 });
+
+    QByteArray packed;
+    for (qint32 sample : samples) {
+        char bytes[] = { char(sample), char(sample >> 8), char(sample >> 16) };
+        if (bigEndian)
+            std::swap(bytes[0], bytes[2]);
+        packed.append(bytes, 3);
+    }
+
+    QIODevice *device = openDevice(createWave(1, extensible, 24, packed, bigEndian), mapped);
+    QVERIFY(device);
+
+    QWaveDecoder waveDecoder(device);
+    QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
+    QVERIFY(waveDecoder.open(QIODevice::ReadOnly));
+
+    QTRY_COMPARE(validFormatSpy.count(), 1);
+    QCOMPARE(waveDecoder.audioFormat().sampleFormat(), QAudioFormat::Int32);
+    QCOMPARE(waveDecoder.size(), samples.size() * qint64(sizeof(qint32)));
+
+    // read in two parts, to continue from the middle of the samples
+    QList<qint32> decoded(samples.size());
+    char *data = reinterpret_cast<char *>(decoded.data());
+    const qint64 firstPart = 21 * sizeof(qint32);
+    QCOMPARE(waveDecoder.read(data, firstPart), firstPart);
+    QCOMPARE(waveDecoder.read(data + firstPart, waveDecoder.size()),
+             waveDecoder.size() - firstPart);
+
+    for (qsizetype i = 0; i < samples.size(); ++i)
+        QCOMPARE(decoded[i], samples[i] * 256);
+}
+
+void tst_QWaveDecoder::readFloat_data()
+{
+    QTest::addColumn<bool>("extensible");
+    QTest::addColumn<bool>("mapped");
+
+    QTest::newRow("ieee float") << false << false;
+    QTest::newRow("extensible") << true << false;
+    QTest::newRow("ieee float, mapped") << false << true;
+    QTest::newRow("extensible, mapped") << true << true;
+}
+
+void tst_QWaveDecoder::readFloat()
+{
+    QFETCH(bool, extensible);
+    QFETCH(bool, mapped);
+
+    QList<float> samples;
+    for (int i = 0; i < 50; ++i)
+        samples.append(std::sin(i * 0.3f));
+
+    QByteArray data;
+    for (float sample : samples) {
+        char bytes[4];
+        qToLittleEndian(sample, bytes);
+        data.append(bytes, 4);
+    }
+
+    QIODevice *device = openDevice(createWave(3, extensible, 32, data), mapped);
+    QVERIFY(device);
+
+    QWaveDecoder waveDecoder(device);
+    QSignalSpy validFormatSpy(&waveDecoder, SIGNAL(formatKnown()));
+    QVERIFY(waveDecoder.open(QIODevice::ReadOnly));
+
+    QTRY_COMPARE(validFormatSpy.count(), 1);
+    QCOMPARE(waveDecoder.audioFormat().sampleFormat(), QAudioFormat::Float);
+    QCOMPARE(waveDecoder.size(), data.size());
+
+    QList<float> decoded(samples.size());
+    QCOMPARE(waveDecoder.read(reinterpret_cast<char *>(decoded.data()), waveDecoder.size()),
+             waveDecoder.size());
+    QCOMPARE(decoded, samples);
+}
+
 QTEST_MAIN(tst_QWaveDecoder)
 
 #include "tst_qwavedecoder.moc"
@@ -0,0 +1,281 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtSpatialAudio/qaudioengine.h>
+#include <QtSpatialAudio/qambientsound.h>
+#include <QtSpatialAudio/qspatialsound.h>
+#include <private/qaudioengine_p.h>
+#include <private/qambientsound_p.h>
+#include <private/qspatialsound_p.h>
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+QT_USE_NAMESPACE
+
+namespace {
+
+constexpr int SampleRate = 48000;
+constexpr qint64 MB = 1024 * 1024;
+constexpr int BlockFrames = 256;
+
+using AssetState = QAudioEnginePrivate::AssetState;
+
+// Decoded audio of the given size, as the sounds store it in the cache
+QList<QAudioBuffer> decodedBuffers(qint64 bytes, int channelCount)
+{
+    QAudioFormat format;
+    format.setSampleFormat(QAudioFormat::Float);
+    format.setSampleRate(SampleRate);
+    format.setChannelCount(channelCount);
+    return { QAudioBuffer(QByteArray(bytes, 0), format) };
+}
+
+// Acquires the asset of the source for the sound, and stores the decoded buffers
+// if the sound is the one to load it; the test doesn't decode anything.
+AssetState acquireAsset(QAmbientSoundPrivate *sound, const QUrl &url, qint64 bytes = 1024)
+{
+    auto *ep = QAudioEnginePrivate::get(sound->engine);
+
+    sound->url = url;
+    const AssetState state = ep->acquireAsset(sound);
+    if (state == AssetState::Load) {
+        sound->buffers = decodedBuffers(bytes, sound->nchannels);
+        ep->storeAsset(sound);
+    }
+    return state;
+}
+
+const void *assetData(QAmbientSoundPrivate *sound)
+{
+    QMutexLocker locker(&sound->mutex);
+    return sound->buffers.isEmpty() ? nullptr : sound->buffers.first().constData<void>();
+}
+
+bool hasAsset(QAudioEnginePrivate *ep, const QUrl &url, int channelCount)
+{
+    return ep->assets.contains({ url, SampleRate, channelCount });
+}
+
+// A playing sound whose gain at the listener is the given attenuation
+void setUpVoice(QSpatialSound &sound, float attenuation)
+{
+    sound.setDistanceModel(QSpatialSound::DistanceModel::ManualAttenuation);
+    sound.setManualAttenuation(attenuation);
+    sound.play();
+}
+
+void selectVoices(QAudioEngine &engine)
+{
+    auto *ep = QAudioEnginePrivate::get(&engine);
+    ep->selectVoices(*ep->renderList.load());
+}
+
+// Applies the voice selection to a block of a constant signal, as the rendering does
+std::vector<float> renderVoice(QSpatialSound &sound, bool *rendered = nullptr)
+{
+    std::vector<float> block(BlockFrames, 1.f);
+    const bool result = QSpatialSoundPrivate::get(&sound)->renderVoice(block.data(), BlockFrames);
+    if (rendered)
+        *rendered = result;
+    return block;
+}
+
+} // namespace
+
+class tst_QAudioEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void acquireAsset_sharesDecodedAsset_forSameSourceRateAndChannels();
+    void evictAssets_evictsOnlyUnreferencedAssets_whenCacheIsFull();
+
+    void selectVoices_rendersLoudestSounds_whenAboveMaximumVoices();
+    void renderVoice_rampsCulledVoiceOut_andFlushesOneBlock();
+};
+
+void tst_QAudioEngine::acquireAsset_sharesDecodedAsset_forSameSourceRateAndChannels()
+{
+    // the engine isn't started; the sounds have no source, so nothing is decoded
+    QAudioEngine engine(SampleRate);
+    auto *ep = QAudioEnginePrivate::get(&engine);
+    const QUrl url(QStringLiteral("file:///sound.wav"));
+
+    QAmbientSound first(&engine);
+    QAmbientSound second(&engine);
+    auto *firstD = QAmbientSoundPrivate::get(&first);
+    auto *secondD = QAmbientSoundPrivate::get(&second);
+
+    QCOMPARE(acquireAsset(firstD, url), AssetState::Load);
+    QCOMPARE(acquireAsset(secondD, url), AssetState::Loaded);
+    QCOMPARE(ep->assets.size(), 1);
+    QVERIFY(assetData(secondD) != nullptr);
+    QCOMPARE(assetData(secondD), assetData(firstD));
+
+    // the mono spatial sound needs an asset of its own
+    QSpatialSound mono(&engine);
+    auto *monoD = QAmbientSoundPrivate::get(&mono);
+    QCOMPARE(acquireAsset(monoD, url), AssetState::Load);
+    QCOMPARE_NE(assetData(monoD), assetData(firstD));
+    QVERIFY(hasAsset(ep, url, 1));
+    QVERIFY(hasAsset(ep, url, 2));
+
+    // so does another source
+    QAmbientSound other(&engine);
+    auto *otherD = QAmbientSoundPrivate::get(&other);
+    QCOMPARE(acquireAsset(otherD, QUrl(QStringLiteral("file:///other.wav"))), AssetState::Load);
+    QCOMPARE(ep->assets.size(), 3);
+
+    // and the same source decoded at another sample rate
+    QAudioEngine otherRateEngine(SampleRate / 2);
+    QAmbientSound otherRate(&otherRateEngine);
+    auto *otherRateD = QAmbientSoundPrivate::get(&otherRate);
+    QCOMPARE(acquireAsset(otherRateD, url), AssetState::Load);
+    QCOMPARE_NE(assetData(otherRateD), assetData(firstD));
+}
+
+void tst_QAudioEngine::evictAssets_evictsOnlyUnreferencedAssets_whenCacheIsFull()
+{
+    if (qEnvironmentVariableIsSet("QT_SPATIALAUDIO_ASSET_CACHE_SIZE"))
+        QSKIP("The asset cache size is set by the environment");
+
+    QAudioEngine engine(SampleRate);
+    auto *ep = QAudioEnginePrivate::get(&engine);
+    QCOMPARE(ep->assetCacheCapacity, 64 * MB);
+
+    constexpr qint64 AssetBytes = 24 * MB;
+    const std::array urls = { QUrl(QStringLiteral("file:///a.wav")),
+                              QUrl(QStringLiteral("file:///b.wav")),
+                              QUrl(QStringLiteral("file:///c.wav")),
+                              QUrl(QStringLiteral("file:///d.wav")) };
+
+    std::array<std::unique_ptr<QAmbientSound>, 4> sounds;
+    for (size_t i = 0; i < sounds.size(); ++i) {
+        sounds[i] = std::make_unique<QAmbientSound>(&engine);
+        QCOMPARE(acquireAsset(QAmbientSoundPrivate::get(sounds[i].get()), urls[i], AssetBytes),
+                 AssetState::Load);
+    }
+
+    // the assets in use are kept whatever their size
+    QCOMPARE(ep->assetCacheSize, 4 * AssetBytes);
+    QCOMPARE(ep->assets.size(), 4);
+
+    // the unreferenced assets are kept up to the capacity
+    sounds[1].reset();
+    sounds[2].reset();
+    QCOMPARE(ep->assets.size(), 4);
+
+    // the least recently used of them is evicted when the capacity is exceeded,
+    // while the referenced one is kept
+    sounds[3].reset();
+    QCOMPARE(ep->assets.size(), 3);
+    QVERIFY(hasAsset(ep, urls[0], 2));
+    QVERIFY(!hasAsset(ep, urls[1], 2));
+    QVERIFY(hasAsset(ep, urls[2], 2));
+    QVERIFY(hasAsset(ep, urls[3], 2));
+    QCOMPARE(ep->assetCacheSize, 3 * AssetBytes);
+
+    sounds[0].reset();
+    QCOMPARE(ep->assets.size(), 2);
+    QVERIFY(!hasAsset(ep, urls[2], 2));
+    QCOMPARE(ep->assetCacheSize, 2 * AssetBytes);
+
+    // a cached asset is reused without decoding
+    QAmbientSound sound(&engine);
+    QCOMPARE(acquireAsset(QAmbientSoundPrivate::get(&sound), urls[3]), AssetState::Loaded);
+}
+
+void tst_QAudioEngine::selectVoices_rendersLoudestSounds_whenAboveMaximumVoices()
+{
+    // the engine isn't started, the test selects the voices itself
+    QAudioEngine engine(SampleRate);
+    engine.setMaximumVoices(2);
+
+    const std::array<float, 4> attenuations = { 0.2f, 0.4f, 0.1f, 0.3f };
+    std::array<std::unique_ptr<QSpatialSound>, 4> sounds;
+    for (size_t i = 0; i < sounds.size(); ++i) {
+        sounds[i] = std::make_unique<QSpatialSound>(&engine);
+        setUpVoice(*sounds[i], attenuations[i]);
+    }
+
+    // a paused sound is never rendered, however loud
+    QSpatialSound paused(&engine);
+    setUpVoice(paused, 1.f);
+    paused.pause();
+
+    auto isSelected = [](QSpatialSound &sound) {
+        return QSpatialSoundPrivate::get(&sound)->voiceSelected;
+    };
+
+    selectVoices(engine);
+    QCOMPARE(QAudioEnginePrivate::get(&engine)->activeVoices.loadRelaxed(), 2);
+    QVERIFY(!isSelected(*sounds[0]));
+    QVERIFY(isSelected(*sounds[1]));
+    QVERIFY(!isSelected(*sounds[2]));
+    QVERIFY(isSelected(*sounds[3]));
+    QVERIFY(!isSelected(paused));
+
+    // a sound getting louder takes the voice of the quietest selected one
+    sounds[2]->setManualAttenuation(0.5f);
+    selectVoices(engine);
+    QCOMPARE(QAudioEnginePrivate::get(&engine)->activeVoices.loadRelaxed(), 2);
+    QVERIFY(isSelected(*sounds[1]));
+    QVERIFY(isSelected(*sounds[2]));
+    QVERIFY(!isSelected(*sounds[3]));
+
+    // without the limit, all playing sounds are rendered
+    engine.setMaximumVoices(0);
+    selectVoices(engine);
+    QCOMPARE(QAudioEnginePrivate::get(&engine)->activeVoices.loadRelaxed(), 4);
+    QVERIFY(!isSelected(paused));
+}
+
+void tst_QAudioEngine::renderVoice_rampsCulledVoiceOut_andFlushesOneBlock()
+{
+    QAudioEngine engine(SampleRate);
+    QSpatialSound loud(&engine);
+    QSpatialSound quiet(&engine);
+    setUpVoice(loud, 0.4f);
+    setUpVoice(quiet, 0.1f);
+
+    // the selected voices ramp in, then render the signal as is
+    selectVoices(engine);
+    std::vector<float> block = renderVoice(quiet);
+    QCOMPARE(block.front(), 0.f);
+    QCOMPARE_GT(block.back(), 0.99f);
+    QVERIFY(std::is_sorted(block.begin(), block.end()));
+    block = renderVoice(quiet);
+    QVERIFY(std::all_of(block.begin(), block.end(), [](float x) { return x == 1.f; }));
+    renderVoice(loud);
+
+    // the culled voice ramps out within a block
+    engine.setMaximumVoices(1);
+    selectVoices(engine);
+
+    bool rendered = false;
+    block = renderVoice(quiet, &rendered);
+    QVERIFY(rendered);
+    QCOMPARE(block.front(), 1.f);
+    QCOMPARE_LT(block.back(), 0.01f);
+    QVERIFY(std::is_sorted(block.rbegin(), block.rend()));
+
+    block = renderVoice(loud, &rendered);
+    QVERIFY(rendered);
+    QVERIFY(std::all_of(block.begin(), block.end(), [](float x) { return x == 1.f; }));
+
+    // then one silent block flushes its filters, and it's not rendered any more
+    block = renderVoice(quiet, &rendered);
+    QVERIFY(rendered);
+    QVERIFY(std::all_of(block.begin(), block.end(), [](float x) { return x == 0.f; }));
+
+    renderVoice(quiet, &rendered);
+    QVERIFY(!rendered);
+}
+
+QTEST_GUILESS_MAIN(tst_QAudioEngine)
+
+#include "tst_qaudioengine.moc"
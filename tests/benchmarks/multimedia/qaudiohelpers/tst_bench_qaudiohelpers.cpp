@@ -0,0 +1,157 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtCore/qmath.h>
+#include <QtMultimedia/qaudioformat.h>
+
+#include <private/qaudiohelpers_p.h>
+
+#include <vector>
+
+QT_USE_NAMESPACE
+
+// Measures the sample kernels used by the audio sinks and sources to apply the volume,
+// the conversions to and from float, and the expansion of packed 24 bit samples,
+// on one second of stereo audio per format.
+// Run with QT_NO_CPU_FEATURE=neon to compare against the scalar kernels on ARM.
+class tst_bench_QAudioHelpers : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void multiplySamples_data() { generateFormatRows(); }
+    void multiplySamples();
+
+    void rampSamples_data() { generateFormatRows(); }
+    void rampSamples();
+
+    void convertToFloat_data() { generateFormatRows(); }
+    void convertToFloat();
+
+    void convertFromFloat_data() { generateFormatRows(); }
+    void convertFromFloat();
+
+    void unpackInt24();
+
+private:
+    void generateFormatRows();
+};
+
+namespace {
+
+constexpr int SampleRate = 48000;
+constexpr int ChannelCount = 2;
+constexpr int SamplesCount = SampleRate * ChannelCount;
+
+QAudioFormat createFormat(QAudioFormat::SampleFormat sampleFormat)
+{
+    QAudioFormat format;
+    format.setSampleRate(SampleRate);
+    format.setChannelCount(ChannelCount);
+    format.setSampleFormat(sampleFormat);
+    return format;
+}
+
+// a sine wave, so that the samples are neither silent nor clipped
+std::vector<float> createSignal()
+{
+    std::vector<float> signal(SamplesCount);
+    for (int i = 0; i < SamplesCount; ++i)
+        signal[i] = 0.8f * std::sin(2.f * float(M_PI) * 440.f * (i / ChannelCount) / SampleRate);
+    return signal;
+}
+
+QByteArray createSamples(const QAudioFormat &format)
+{
+    QByteArray samples(format.bytesPerSample() * SamplesCount, Qt::Uninitialized);
+    QAudioHelperInternal::qConvertFromFloat(1., format, createSignal().data(), samples.data(),
+                                            SamplesCount);
+    return samples;
+}
+
+} // namespace
+
+void tst_bench_QAudioHelpers::generateFormatRows()
+{
+    QTest::addColumn<QAudioFormat::SampleFormat>("sampleFormat");
+
+    QTest::newRow("UInt8") << QAudioFormat::UInt8;
+    QTest::newRow("Int16") << QAudioFormat::Int16;
+    QTest::newRow("Int32") << QAudioFormat::Int32;
+    QTest::newRow("Float") << QAudioFormat::Float;
+}
+
+void tst_bench_QAudioHelpers::multiplySamples()
+{
+    QFETCH(const QAudioFormat::SampleFormat, sampleFormat);
+
+    const QAudioFormat format = createFormat(sampleFormat);
+    const QByteArray input = createSamples(format);
+    QByteArray output(input.size(), Qt::Uninitialized);
+
+    QBENCHMARK {
+        QAudioHelperInternal::qMultiplySamples(0.5, format, input.constData(), output.data(),
+                                               input.size());
+    }
+}
+
+void tst_bench_QAudioHelpers::rampSamples()
+{
+    QFETCH(const QAudioFormat::SampleFormat, sampleFormat);
+
+    const QAudioFormat format = createFormat(sampleFormat);
+    const QByteArray input = createSamples(format);
+    QByteArray output(input.size(), Qt::Uninitialized);
+
+    QBENCHMARK {
+        QAudioHelperInternal::qRampSamples(1., 0.5, format, input.constData(), output.data(),
+                                           input.size());
+    }
+}
+
+void tst_bench_QAudioHelpers::convertToFloat()
+{
+    QFETCH(const QAudioFormat::SampleFormat, sampleFormat);
+
+    const QAudioFormat format = createFormat(sampleFormat);
+    const QByteArray input = createSamples(format);
+    std::vector<float> output(SamplesCount);
+
+    QBENCHMARK {
+        QAudioHelperInternal::qConvertToFloat(0.5, format, input.constData(), output.data(),
+                                              SamplesCount);
+    }
+}
+
+void tst_bench_QAudioHelpers::convertFromFloat()
+{
+    QFETCH(const QAudioFormat::SampleFormat, sampleFormat);
+
+    const QAudioFormat format = createFormat(sampleFormat);
+    const std::vector<float> input = createSignal();
+    QByteArray output(format.bytesPerSample() * SamplesCount, Qt::Uninitialized);
+
+    QBENCHMARK {
+        QAudioHelperInternal::qConvertFromFloat(0.5, format, input.data(), output.data(),
+                                                SamplesCount);
+    }
+}
+
+void tst_bench_QAudioHelpers::unpackInt24()
+{
+    const QByteArray input = createSamples(createFormat(QAudioFormat::Int32));
+    // the upper 3 bytes of the little endian Int32 samples
+    QByteArray packed;
+    for (qsizetype i = 0; i < input.size(); i += 4)
+        packed.append(input.constData() + i + 1, 3);
+    std::vector<qint32> output(SamplesCount);
+
+    QBENCHMARK {
+        QAudioHelperInternal::qUnpackInt24(packed.constData(), output.data(), SamplesCount);
+    }
+}
+
+QTEST_MAIN(tst_bench_QAudioHelpers)
+
+#include "tst_bench_qaudiohelpers.moc"
@@ -0,0 +1,77 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtMultimedia/qmediaplayer.h>
+#include <QtMultimedia/qvideosink.h>
+
+QT_USE_NAMESPACE
+
+// Measures the latency between a seek request on a paused player and the
+// presentation of the first frame at the new position.
+// Set QT_BENCH_SEEK_MEDIA to a local file to measure long-GOP content;
+// the bundled clip is short and has dense key frames.
+class tst_bench_QMediaPlayerSeek : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void seek_data();
+    void seek();
+
+private:
+    QUrl m_source;
+};
+
+void tst_bench_QMediaPlayerSeek::initTestCase()
+{
+    const QString path = qEnvironmentVariable("QT_BENCH_SEEK_MEDIA");
+    m_source = path.isEmpty() ? QUrl(QStringLiteral("qrc:/testdata/colors.mp4"))
+                              : QUrl::fromLocalFile(path);
+}
+
+void tst_bench_QMediaPlayerSeek::seek_data()
+{
+    QTest::addColumn<QMediaPlayer::SeekMode>("mode");
+    QTest::addColumn<qreal>("position");
+
+    QTest::newRow("accurate, middle") << QMediaPlayer::AccurateSeek << 0.5;
+    QTest::newRow("fast, middle") << QMediaPlayer::FastSeek << 0.5;
+    QTest::newRow("accurate, end") << QMediaPlayer::AccurateSeek << 0.9;
+    QTest::newRow("fast, end") << QMediaPlayer::FastSeek << 0.9;
+}
+
+void tst_bench_QMediaPlayerSeek::seek()
+{
+    QFETCH(QMediaPlayer::SeekMode, mode);
+    QFETCH(qreal, position);
+
+    QMediaPlayer player;
+    QVideoSink sink;
+    player.setVideoOutput(&sink);
+    player.setSource(m_source);
+
+    QTRY_VERIFY(player.mediaStatus() == QMediaPlayer::LoadedMedia
+                || player.mediaStatus() == QMediaPlayer::InvalidMedia);
+
+    if (!player.hasVideo() || !player.isSeekable())
+        QSKIP("The media cannot be played or seeked");
+
+    QSignalSpy frameSpy(&sink, &QVideoSink::videoFrameChanged);
+    player.pause();
+    QVERIFY(frameSpy.wait());
+
+    const auto target = qint64(player.duration() * position);
+
+    QBENCHMARK {
+        frameSpy.clear();
+        player.seek(target, mode);
+        QVERIFY(frameSpy.wait());
+    }
+}
+
+QTEST_MAIN(tst_bench_QMediaPlayerSeek)
+
+#include "tst_bench_qmediaplayerseek.moc"
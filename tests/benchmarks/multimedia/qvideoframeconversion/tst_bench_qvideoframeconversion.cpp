@@ -0,0 +1,103 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtMultimedia/qvideoframe.h>
+#include <QtMultimedia/qvideoframeformat.h>
+
+#include <private/qvideoframeconversionhelper_p.h>
+
+QT_USE_NAMESPACE
+
+// Measures the CPU conversion of video frames to ARGB32, as used by
+// QVideoFrame::toImage() when no RHI is available.
+// Run with QT_NO_CPU_FEATURE=sse2,avx2 (or neon) to compare against
+// the scalar converters.
+class tst_bench_QVideoFrameConversion : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void convertToARGB32_data();
+    void convertToARGB32();
+};
+
+namespace {
+
+QVideoFrame createFrame(QVideoFrameFormat::PixelFormat pixelFormat, QSize size,
+                        QVideoFrameFormat::ColorTransfer colorTransfer)
+{
+    QVideoFrameFormat format(size, pixelFormat);
+    format.setColorTransfer(colorTransfer);
+    QVideoFrame frame(format);
+    if (!frame.map(QVideoFrame::WriteOnly))
+        return {};
+
+    // fill with a deterministic, non-uniform pattern
+    for (int plane = 0; plane < frame.planeCount(); ++plane) {
+        uchar *data = frame.bits(plane);
+        const int bytes = frame.mappedBytes(plane);
+        for (int i = 0; i < bytes; ++i)
+            data[i] = uchar((i * 7 + plane * 31) ^ (i >> 8));
+    }
+
+    frame.unmap();
+    return frame;
+}
+
+} // namespace
+
+void tst_bench_QVideoFrameConversion::convertToARGB32_data()
+{
+    QTest::addColumn<QVideoFrameFormat::PixelFormat>("pixelFormat");
+    QTest::addColumn<QSize>("size");
+    QTest::addColumn<QVideoFrameFormat::ColorTransfer>("colorTransfer");
+
+    const QVideoFrameFormat::PixelFormat pixelFormats[] = {
+        QVideoFrameFormat::Format_YUV420P, QVideoFrameFormat::Format_YUV422P,
+        QVideoFrameFormat::Format_YV12,    QVideoFrameFormat::Format_UYVY,
+        QVideoFrameFormat::Format_YUYV,    QVideoFrameFormat::Format_NV12,
+        QVideoFrameFormat::Format_NV21,    QVideoFrameFormat::Format_P010,
+        QVideoFrameFormat::Format_P016,    QVideoFrameFormat::Format_ARGB8888,
+    };
+
+    for (const QSize size : { QSize(640, 480), QSize(1920, 1080), QSize(3840, 2160) }) {
+        for (const QVideoFrameFormat::PixelFormat pixelFormat : pixelFormats)
+            QTest::addRow("%s_%dx%d",
+                          QVideoFrameFormat::pixelFormatToString(pixelFormat).toLatin1().constData(),
+                          size.width(), size.height())
+                    << pixelFormat << size << QVideoFrameFormat::ColorTransfer_Unknown;
+
+        // HDR frames get tone mapped
+        QTest::addRow("P010_PQ_%dx%d", size.width(), size.height())
+                << QVideoFrameFormat::Format_P010 << size << QVideoFrameFormat::ColorTransfer_ST2084;
+        QTest::addRow("P010_HLG_%dx%d", size.width(), size.height())
+                << QVideoFrameFormat::Format_P010 << size << QVideoFrameFormat::ColorTransfer_STD_B67;
+    }
+}
+
+void tst_bench_QVideoFrameConversion::convertToARGB32()
+{
+    QFETCH(const QVideoFrameFormat::PixelFormat, pixelFormat);
+    QFETCH(const QSize, size);
+    QFETCH(const QVideoFrameFormat::ColorTransfer, colorTransfer);
+
+    VideoFrameConvertFunc convert = qConverterForFormat(pixelFormat, colorTransfer);
+    QVERIFY(convert);
+
+    QVideoFrame frame = createFrame(pixelFormat, size, colorTransfer);
+    QVERIFY(frame.map(QVideoFrame::ReadOnly));
+
+    const VideoFramePlanes planes = VideoFramePlanes::fromMappedFrame(frame);
+    QImage image(size, QImage::Format_RGB32);
+
+    QBENCHMARK {
+        convert(planes, image.bits());
+    }
+
+    frame.unmap();
+}
+
+QTEST_MAIN(tst_bench_QVideoFrameConversion)
+
+#include "tst_bench_qvideoframeconversion.moc"
@@ -0,0 +1,199 @@
+// Copyright (C) 2024 The Qt Company Ltd.
+// SPDX-License-Identifier: LicenseRef-Qt-Commercial OR GPL-3.0-only WITH Qt-GPL-exception-1.0
+
+#include <QtTest/QtTest>
+#include <QtSpatialAudio/qaudioengine.h>
+#include <QtSpatialAudio/qspatialsound.h>
+
+#include <QtSpatialAudio/private/qaudioengine_p.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+QT_USE_NAMESPACE
+
+using namespace std::chrono_literals;
+
+// renderCost measures the CPU time needed to render one second of the sound field.
+//
+// renderWhileMoving moves many spatial sounds from the main thread while a render thread
+// pulls the sound field in real time, as the audio sink would, and reports the duration
+// of the render calls. Blocking between the threads shows up as jitter of the render
+// duration and as missed periods.
+class tst_bench_QAudioEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void renderCost_data();
+    void renderCost();
+
+    void renderWhileMoving_data();
+    void renderWhileMoving();
+};
+
+namespace {
+
+constexpr int SampleRate = 48000;
+constexpr int PeriodFrames = 4 * QAudioEnginePrivate::defaultBlockSize;
+constexpr auto Period = std::chrono::nanoseconds(1s) * PeriodFrames / SampleRate;
+constexpr auto MeasuringTime = 3s;
+
+// Creates playing sounds that are spread around the listener
+std::vector<std::unique_ptr<QSpatialSound>> createSounds(QAudioEngine &engine, int count)
+{
+    std::vector<std::unique_ptr<QSpatialSound>> sounds;
+    for (int i = 0; i < count; ++i) {
+        sounds.push_back(std::make_unique<QSpatialSound>(&engine));
+        const float angle = i * 2.f * float(M_PI) / count;
+        sounds.back()->setPosition(QVector3D(std::cos(angle), 0.f, std::sin(angle)) * 500.f);
+        // only the playing sounds are rendered
+        sounds.back()->setLoops(QSpatialSound::Infinite);
+        sounds.back()->setSource(QUrl(QStringLiteral("qrc:/testdata/test_tone.wav")));
+    }
+    return sounds;
+}
+
+// The sounds share the decoded source, and start playing when it's loaded
+bool waitForPlayback(QAudioEnginePrivate *d)
+{
+    std::vector<short> output(d->blockSize * 2);
+    return QTest::qWaitFor([&] {
+        d->render(output.data(), d->blockSize, nullptr);
+        return d->activeVoices.loadRelaxed() > 0;
+    }, 10000);
+}
+
+} // namespace
+
+void tst_bench_QAudioEngine::renderCost_data()
+{
+    QTest::addColumn<int>("blockSize");
+    QTest::addColumn<int>("sourceCount");
+
+    for (int sourceCount : { 1, 16, 64, 256 }) {
+        for (int blockSize : { 64, 128, 256, 512, 1024 }) {
+            QTest::addRow("%d sources, %d frames", sourceCount, blockSize)
+                    << blockSize << sourceCount;
+        }
+    }
+}
+
+void tst_bench_QAudioEngine::renderCost()
+{
+    QFETCH(int, blockSize);
+    QFETCH(int, sourceCount);
+
+    QAudioEngine engine(SampleRate);
+    engine.setBlockSize(blockSize);
+    QCOMPARE(engine.blockSize(), blockSize);
+    auto *d = QAudioEnginePrivate::get(&engine);
+
+    const auto sounds = createSounds(engine, sourceCount);
+    QVERIFY(waitForPlayback(d));
+
+    // one second of audio, rendered in periods of the sink
+    const int periodFrames = qMax(PeriodFrames, blockSize);
+    std::vector<short> output(periodFrames * 2);
+    QBENCHMARK {
+        for (int frames = 0; frames < SampleRate; frames += periodFrames)
+            d->render(output.data(), periodFrames, nullptr);
+    }
+}
+
+void tst_bench_QAudioEngine::renderWhileMoving_data()
+{
+    QTest::addColumn<int>("sourceCount");
+    QTest::addColumn<int>("updateRate");
+    QTest::addColumn<int>("maximumVoices");
+
+    QTest::newRow("500 static sources") << 500 << 0 << 0;
+    QTest::newRow("500 sources moved at 120 Hz") << 500 << 120 << 0;
+    QTest::newRow("500 sources moved at 120 Hz, 32 voices") << 500 << 120 << 32;
+}
+
+void tst_bench_QAudioEngine::renderWhileMoving()
+{
+    QFETCH(int, sourceCount);
+    QFETCH(int, updateRate);
+    QFETCH(int, maximumVoices);
+
+    QAudioEngine engine(SampleRate);
+    engine.setMaximumVoices(maximumVoices);
+    auto *d = QAudioEnginePrivate::get(&engine);
+
+    const auto sounds = createSounds(engine, sourceCount);
+    QVERIFY(waitForPlayback(d));
+    std::vector<short> output(PeriodFrames * 2);
+
+    // preallocated, so that the render thread doesn't allocate
+    std::vector<std::chrono::nanoseconds> renderTimes(MeasuringTime / Period + 16);
+    size_t renderCount = 0;
+    std::atomic<bool> stopRendering = false;
+
+    std::unique_ptr<QThread> renderThread(QThread::create([&] {
+        auto deadline = std::chrono::steady_clock::now();
+        while (!stopRendering && renderCount < renderTimes.size()) {
+            const auto start = std::chrono::steady_clock::now();
+            d->render(output.data(), PeriodFrames, nullptr);
+            renderTimes[renderCount++] = std::chrono::steady_clock::now() - start;
+
+            deadline += Period;
+            std::this_thread::sleep_until(deadline);
+        }
+    }));
+    renderThread->start(QThread::TimeCriticalPriority);
+
+    std::chrono::nanoseconds maxUpdateTime{};
+    QElapsedTimer elapsed;
+    elapsed.start();
+
+    QTimer updateTimer;
+    updateTimer.setTimerType(Qt::PreciseTimer);
+    connect(&updateTimer, &QTimer::timeout, this, [&] {
+        const auto start = std::chrono::steady_clock::now();
+        const float phase = elapsed.elapsed() / 1000.f;
+        for (int i = 0; i < sourceCount; ++i) {
+            const float angle = phase + i * 2.f * float(M_PI) / sourceCount;
+            sounds[i]->setPosition(QVector3D(std::cos(angle), 0.f, std::sin(angle)) * 500.f);
+            sounds[i]->setRotation(QQuaternion::fromEulerAngles(0.f, qRadiansToDegrees(angle), 0.f));
+        }
+        maxUpdateTime = std::max(maxUpdateTime, std::chrono::steady_clock::now() - start);
+    });
+    if (updateRate > 0)
+        updateTimer.start(1000 / updateRate);
+
+    QTest::qWait(std::chrono::duration_cast<std::chrono::milliseconds>(MeasuringTime).count());
+
+    updateTimer.stop();
+    stopRendering = true;
+    renderThread->wait();
+
+    QVERIFY(renderCount > 0);
+    renderTimes.resize(renderCount);
+    std::sort(renderTimes.begin(), renderTimes.end());
+
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+    const auto percentile = [&](double p) {
+        return Milliseconds(renderTimes[size_t((renderTimes.size() - 1) * p)]).count();
+    };
+    const auto missedPeriods = renderTimes.end()
+            - std::upper_bound(renderTimes.begin(), renderTimes.end(), Period);
+
+    qInfo() << "render calls:" << renderCount << "period:" << Milliseconds(Period).count()
+            << "ms; render time median:" << percentile(0.5) << "ms, p99:" << percentile(0.99)
+            << "ms, max:" << percentile(1.) << "ms; jitter (max - median):"
+            << percentile(1.) - percentile(0.5) << "ms; missed periods:" << missedPeriods
+            << "; max update time:" << Milliseconds(maxUpdateTime).count()
+            << "ms; active voices:" << d->activeVoices.loadRelaxed();
+
+    QTest::setBenchmarkResult(percentile(1.) - percentile(0.5), QTest::WalltimeMilliseconds);
+}
+
+QTEST_MAIN(tst_bench_QAudioEngine)
+
+#include "tst_bench_qaudioengine.moc"